@@ -1,22 +1,23 @@
 #ifndef HOST_DEVICE_SHARED_VARS
 #define HOST_DEVICE_SHARED_VARS
 
-#if NDEBUG
-const int MAX_TEXTURE_COUNT = 24;
-#else
-const int MAX_TEXTURE_COUNT = 1;
-#endif
+// upper bound of the bindless texture table; the device limits may lower it
+const int MAX_BINDLESS_TEXTURE_COUNT = 16384;
 
 // ----- MAIN RENDER DESCRIPTOR SET ----- START (shared between rasterizer and
 // raytracer)
 #define globalUBO_BINDING 0
 #define sceneUBO_BINDING 1
 #define OBJECT_DESCRIPTION_BINDING 2
-#define TEXTURES_BINDING 3
-#define SAMPLER_BINDING 4
 // ----- MAIN RENDER DESCRIPTOR SET ----- END
 
-// ---- RAYTRACING BINDING ---- START
+// ----- TEXTURE TABLE DESCRIPTOR SET ----- START (set 1; update after bind,
+// which the dynamic uniform buffers of the main set must not be)
+#define TEXTURES_BINDING 0
+#define SAMPLER_BINDING 1
+// ----- TEXTURE TABLE DESCRIPTOR SET ----- END
+
+// ---- RAYTRACING BINDING ---- START (set 2)
 #define TLAS_BINDING 0
 #define OUT_IMAGE_BINDING 1
 // ---- RAYTRACING BINDING ---- END
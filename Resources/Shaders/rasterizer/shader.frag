@@ -27,6 +27,7 @@ layout (location = 0) in vec2 texture_coordinates;
 layout (location = 1) in vec3 shading_normal;
 layout (location = 2) in vec3 fragment_color;
 layout (location = 3) in vec3 worldPosition;
+layout (location = 4) flat in uint object_description_index;
 
 layout (set = 0, binding = sceneUBO_BINDING) uniform _SceneUBO {
 	SceneUBO sceneUBO;
@@ -44,25 +45,20 @@ layout(buffer_reference, scalar) buffer Indices {
     ivec3 i[]; 
 }; // Triangle indices
 
-layout(buffer_reference, scalar) buffer MaterialIDs {
-    int i[]; 
-}; // per triangle material id
-
 layout(buffer_reference, scalar) buffer Materials {
 	ObjMaterial m[]; 
-}; // all materials of .obj
+}; // material of the submesh
 
-layout(set = 0, binding = SAMPLER_BINDING) uniform sampler texture_sampler[MAX_TEXTURE_COUNT];
-layout(set = 0, binding = TEXTURES_BINDING) uniform texture2D tex[MAX_TEXTURE_COUNT];
+layout(set = 1, binding = SAMPLER_BINDING) uniform sampler texture_sampler[];
+layout(set = 1, binding = TEXTURES_BINDING) uniform texture2D tex[];
 
 layout (location = 0) out vec4 out_color;
 
 void main() {
 	
 	
-	ObjectDescription obj_res	= object_description.i[0];						// for now only one object allowed :)
-    MaterialIDs materialIDs		= MaterialIDs(obj_res.material_index_address);	// material id per triangle (face)
-	Materials materials			= Materials(obj_res.material_address);			// array of all materials
+	ObjectDescription obj_res	= object_description.i[object_description_index];	// submesh of this draw
+	Materials materials			= Materials(obj_res.material_address);			// material of the submesh
 
 	vec3 L = normalize(vec3(-sceneUBO.light_dir));
 	vec3 N = normalize(shading_normal);
@@ -70,9 +66,9 @@ void main() {
 	
 	vec3 ambient = vec3(0.f);
 
-	int texture_id	= materials.m[materialIDs.i[gl_PrimitiveID]].textureID;
-	ambient			+= texture(sampler2D(tex[texture_id], texture_sampler[texture_id]), texture_coordinates).xyz;
-	//ambient			+= materials.m[materialIDs.i[gl_PrimitiveID]].diffuse;
+	int texture_id	= materials.m[0].textureID;
+	ambient			+= texture(sampler2D(tex[nonuniformEXT(texture_id)], texture_sampler[nonuniformEXT(texture_id)]), texture_coordinates).xyz;
+	//ambient			+= materials.m[0].diffuse;
 
 	float roughness = 0.9;
 	vec3 light_color = vec3(1.f);
@@ -16,10 +16,16 @@
 #include "../../../Src/GraphicsEngineVulkan/renderer/SceneUBO.hpp"
 
 #include "../../../Src/GraphicsEngineVulkan/renderer/pushConstants/PushConstantRasterizer.hpp"
+#include "../../../Src/GraphicsEngineVulkan/scene/Vertex.hpp"
 
+// see vertex::getVertexInputAttributeDesc() for the formats of each layout
 layout (location = 0) in vec3 positions; 
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_FULL
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec3 color;
+#else
+layout (location = 1) in vec2 octahedral_normal;
+#endif
 layout (location = 3) in vec2 tex_coords;
 
 layout (set = 0, binding = globalUBO_BINDING) uniform _GlobalUBO {
@@ -38,6 +44,8 @@ layout (location = 0) out vec2 texture_coordinates;
 layout (location = 1) out vec3 shading_normal;
 layout (location = 2) out vec3 fragment_color;
 layout (location = 3) out vec3 worldPosition;
+// the draw's first instance is the submesh's object description index
+layout (location = 4) flat out uint object_description_index;
 
 out gl_PerVertex
 {
@@ -45,6 +53,11 @@ out gl_PerVertex
 };
 
 void main () {
+
+#if VERTEX_LAYOUT != VERTEX_LAYOUT_FULL
+	const vec3 normal = decodeOctahedral(octahedral_normal);
+	const vec3 color = vec3(-1.0f);
+#endif
 	
 	// -- WE ARE CALCULATION THE MVP WITH THE GLM LIBRARY WHO IS DESIGNED FOR OPENGL
 	// -- THEREFORE TAKE THE DIFFERENT COORDINATE SYSTEMS INTO ACCOUNT
@@ -57,6 +70,7 @@ void main () {
 	texture_coordinates = tex_coords;
 
 	fragment_color = color;
+	object_description_index = gl_InstanceIndex;
 
 	gl_Position = vulkan_position;
 
@@ -37,6 +37,9 @@ int App::run()
     VulkanRenderer vulkan_renderer{ window.get(), scene.get(), gui.get(), camera.get() };
 
     while (!window->get_should_close()) {
+        // sample input as late as the frames queued for presentation allow
+        vulkan_renderer.paceFrame();
+
         // poll all events incoming from user
         glfwPollEvents();
 
@@ -19,3 +19,4 @@ source_group("shaders/common/" FILES ${COMMON_SHADER_FILTER})
 source_group("shaders/post/" FILES ${POST_SHADER_FILTER})
 source_group("shaders/brdf/" FILES ${BRDF_SHADER_FILTER})
 source_group("shaders/path_tracing/" FILES ${PATH_TRACING_SHADER_FILTER})
+source_group("shaders/mip_generation/" FILES ${MIP_GENERATION_SHADER_FILTER})
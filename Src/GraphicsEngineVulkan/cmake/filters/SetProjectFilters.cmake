@@ -23,6 +23,13 @@ set(RENDERER_FILTER
     ${PROJECT_RENDERER_INCLUDE_DIR}PostStage.hpp
     ${PROJECT_RENDERER_SRC_DIR}CommandBufferManager.cpp
     ${PROJECT_RENDERER_INCLUDE_DIR}CommandBufferManager.hpp
+    ${PROJECT_RENDERER_INCLUDE_DIR}FrameContext.hpp
+    ${PROJECT_RENDERER_SRC_DIR}FramePacer.cpp
+    ${PROJECT_RENDERER_INCLUDE_DIR}FramePacer.hpp
+    ${PROJECT_RENDERER_SRC_DIR}ParallelRecorder.cpp
+    ${PROJECT_RENDERER_INCLUDE_DIR}ParallelRecorder.hpp
+    ${PROJECT_RENDERER_SRC_DIR}RenderGraph.cpp
+    ${PROJECT_RENDERER_INCLUDE_DIR}RenderGraph.hpp
     ${PROJECT_RENDERER_INCLUDE_DIR}GlobalUBO.hpp
     ${PROJECT_RENDERER_INCLUDE_DIR}GUIRendererSharedVars.hpp
     ${PROJECT_RENDERER_INCLUDE_DIR}QueueFamilyIndices.hpp
@@ -35,6 +42,7 @@ set(RENDERER_FILTER
 set(PROJECT_PC_INCLUDE_DIR ${PROJECT_INCLUDE_DIR}renderer/pushConstants/)
 set(PC_FILTER
     ${PC_FILTER}
+    ${PROJECT_PC_INCLUDE_DIR}PushConstantMipGeneration.hpp
     ${PROJECT_PC_INCLUDE_DIR}PushConstantPathTracing.hpp
     ${PROJECT_PC_INCLUDE_DIR}PushConstantPost.hpp
     ${PROJECT_PC_INCLUDE_DIR}PushConstantRasterizer.hpp
@@ -62,20 +70,26 @@ set(VULKAN_BASE_FILTER
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanBufferManager.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanDebug.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanDevice.cpp
+    ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanFrameAllocator.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanImage.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanImageView.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanInstance.cpp
+    ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanMipGenerator.cpp
     ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanSwapChain.cpp
+    ${PROJECT_VULKAN_BASE_SRC_DIR}VulkanUploadManager.cpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}ShaderIncludes.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}ShaderHelper.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanBuffer.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanBufferManager.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanDebug.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanDevice.hpp
+    ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanFrameAllocator.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanImage.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanImageView.hpp
     ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanInstance.hpp
-    ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanSwapChain.hpp)
+    ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanMipGenerator.hpp
+    ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanSwapChain.hpp
+    ${PROJECT_VULKAN_BASE_INCLUDE_DIR}VulkanUploadManager.hpp)
 # ---- VULKAN_BASE FILTER  --- END
 
 # ---- SCENE FILTER  --- BEGIN
@@ -84,23 +98,46 @@ set(PROJECT_SCENE_INCLUDE_DIR ${PROJECT_INCLUDE_DIR}scene/)
 set(SCENE_FILTER
     ${SCENE_FILTER}
     ${PROJECT_SCENE_SRC_DIR}ObjLoader.cpp
+    ${PROJECT_SCENE_SRC_DIR}ObjParser.cpp
+    ${PROJECT_SCENE_SRC_DIR}MeshCache.cpp
+    ${PROJECT_SCENE_SRC_DIR}VertexWelder.cpp
+    ${PROJECT_SCENE_SRC_DIR}MeshOptimizer.cpp
+    ${PROJECT_SCENE_SRC_DIR}MeshSimplifier.cpp
+    ${PROJECT_SCENE_SRC_DIR}MeshLod.cpp
     ${PROJECT_SCENE_SRC_DIR}Model.cpp
     ${PROJECT_SCENE_SRC_DIR}Mesh.cpp
+    ${PROJECT_SCENE_SRC_DIR}GeometryPool.cpp
     ${PROJECT_SCENE_SRC_DIR}Scene.cpp
     ${PROJECT_SCENE_SRC_DIR}Camera.cpp
     ${PROJECT_SCENE_SRC_DIR}SceneConfig.cpp
     ${PROJECT_SCENE_SRC_DIR}Texture.cpp
+    ${PROJECT_SCENE_SRC_DIR}TextureCache.cpp
+    ${PROJECT_SCENE_SRC_DIR}TextureCooker.cpp
+    ${PROJECT_SCENE_SRC_DIR}TextureDecoder.cpp
+    ${PROJECT_SCENE_SRC_DIR}TextureStreamer.cpp
     ${PROJECT_SCENE_SRC_DIR}Vertex.cpp
     ${PROJECT_SCENE_INCLUDE_DIR}ObjMaterial.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Model.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}ObjLoader.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}ObjParser.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}MeshCache.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}VertexWelder.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}MeshOptimizer.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}MeshSimplifier.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}MeshLod.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Mesh.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}GeometryPool.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}Submesh.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Vertex.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Scene.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}SceneConfig.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}GUISceneSharedVars.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}ObjectDescription.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Texture.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}TextureCache.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}TextureCooker.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}TextureDecoder.hpp
+    ${PROJECT_SCENE_INCLUDE_DIR}TextureStreamer.hpp
     ${PROJECT_SCENE_INCLUDE_DIR}Camera.hpp)
 # ---- SCENE FILTER  --- END
 
@@ -113,7 +150,12 @@ set(WINDOW_FILTER ${WINDOW_FILTER} ${PROJECT_WINDOW_SRC_DIR}Window.cpp ${PROJECT
 # ---- UTIL FILTER  --- BEGIN
 set(PROJECT_UTIL_SRC_DIR ${PROJECT_SRC_DIR}util/)
 set(PROJECT_UTIL_INCLUDE_DIR ${PROJECT_INCLUDE_DIR}util/)
-set(UTIL_FILTER ${UTIL_FILTER} ${PROJECT_UTIL_SRC_DIR}File.cpp ${PROJECT_UTIL_INCLUDE_DIR}File.hpp)
+set(UTIL_FILTER
+    ${UTIL_FILTER}
+    ${PROJECT_UTIL_SRC_DIR}File.cpp
+    ${PROJECT_UTIL_SRC_DIR}MappedFile.cpp
+    ${PROJECT_UTIL_INCLUDE_DIR}File.hpp
+    ${PROJECT_UTIL_INCLUDE_DIR}MappedFile.hpp)
 # ---- UTIL FILTER  --- END
 
 # ---- APP FILTER  --- BEGIN
@@ -136,7 +178,20 @@ set(COMMON_FILTER
 # ---- MEMORY FILTER  --- BEGIN
 set(PROJECT_MEMORY_SRC_DIR ${PROJECT_SRC_DIR}memory/)
 set(PROJECT_MEMORY_INCLUDE_DIR ${PROJECT_INCLUDE_DIR}memory/)
-set(MEMORY_FILTER ${MEMORY_FILTER} ${PROJECT_MEMORY_INCLUDE_DIR}Allocator.hpp ${PROJECT_MEMORY_SRC_DIR}Allocator.cpp)
+set(MEMORY_FILTER
+    ${MEMORY_FILTER}
+    ${PROJECT_MEMORY_SRC_DIR}Allocator.cpp
+    ${PROJECT_MEMORY_SRC_DIR}DeletionQueue.cpp
+    ${PROJECT_MEMORY_SRC_DIR}LinearAllocator.cpp
+    ${PROJECT_MEMORY_SRC_DIR}MemoryBudget.cpp
+    ${PROJECT_MEMORY_SRC_DIR}RangeAllocator.cpp
+    ${PROJECT_MEMORY_SRC_DIR}StagingRing.cpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}Allocator.hpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}DeletionQueue.hpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}LinearAllocator.hpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}MemoryBudget.hpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}RangeAllocator.hpp
+    ${PROJECT_MEMORY_INCLUDE_DIR}StagingRing.hpp)
 # ---- MEMORY FILTER  --- END
 
 # ---- MAIN FILTER  --- BEGIN
@@ -36,6 +36,11 @@ set(SHADER_PATH_TRACING_SRC_DIR ${SHADER_SRC_DIR}path_tracing/)
 set(PATH_TRACING_SHADER_FILTER ${PATH_TRACING_SHADER_FILTER} ${SHADER_PATH_TRACING_SRC_DIR}path_tracing.comp)
 # ---- SHADER PATH_TRACING FILTER  --- END
 
+# ---- SHADER MIP_GENERATION FILTER  --- BEGIN
+set(SHADER_MIP_GENERATION_SRC_DIR ${SHADER_SRC_DIR}mip_generation/)
+set(MIP_GENERATION_SHADER_FILTER ${MIP_GENERATION_SHADER_FILTER} ${SHADER_MIP_GENERATION_SRC_DIR}mip_generation.comp)
+# ---- SHADER MIP_GENERATION FILTER  --- END
+
 # ---- SHADER PBR FILTER  --- BEGIN
 set(SHADER_PBR_SRC_DIR ${SHADER_SRC_DIR}pbr/)
 set(PBR_SHADER_FILTER ${PBR_SHADER_FILTER} ${SHADER_PBR_SRC_DIR}microfacet.glsl)
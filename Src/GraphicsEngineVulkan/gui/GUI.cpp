@@ -106,6 +106,63 @@ void GUI::render()
 
     ImGui::Separator();
 
+    if (ImGui::CollapsingHeader("Presentation")) {
+        static const VkPresentModeKHR present_modes[] = { VK_PRESENT_MODE_FIFO_KHR,
+            VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+            VK_PRESENT_MODE_MAILBOX_KHR,
+            VK_PRESENT_MODE_IMMEDIATE_KHR };
+        static const char *present_mode_names[] = { "FIFO", "FIFO relaxed", "Mailbox", "Immediate" };
+
+        int selected = 0;
+        for (int i = 0; i < IM_ARRAYSIZE(present_modes); i++) {
+            if (present_modes[i] == guiRendererSharedVars.present_mode) selected = i;
+        }
+        if (ImGui::Combo("Present mode", &selected, present_mode_names, IM_ARRAYSIZE(present_mode_names))) {
+            guiRendererSharedVars.present_mode = present_modes[selected];
+        }
+        for (int i = 0; i < IM_ARRAYSIZE(present_modes); i++) {
+            if (present_modes[i] == guiRendererSharedVars.active_present_mode && i != selected) {
+                ImGui::Text("Not supported, using %s", present_mode_names[i]);
+            }
+        }
+
+        int max_queued_frames = static_cast<int>(guiRendererSharedVars.max_queued_frames);
+        if (ImGui::SliderInt("Max queued frames", &max_queued_frames, 1, MAX_FRAME_DRAWS)) {
+            guiRendererSharedVars.max_queued_frames = static_cast<uint32_t>(max_queued_frames);
+        }
+
+        if (guiRendererSharedVars.present_wait) {
+            ImGui::Text("Input to present: %.2f ms (average %.2f ms)",
+              guiRendererSharedVars.input_to_present_ms,
+              guiRendererSharedVars.average_input_to_present_ms);
+        } else {
+            ImGui::Text("Input to present: n/a (no VK_KHR_present_wait)");
+        }
+    }
+
+    ImGui::Separator();
+
+    if (ImGui::CollapsingHeader("GPU Memory")) {
+        const MemoryBudget &memoryBudget = device->getAllocator().getMemoryBudget();
+        ImGui::Text("Device local: %.1f / %.1f MiB (%s pressure)",
+          memoryBudget.getHeapUsage() / (1024.0 * 1024.0),
+          memoryBudget.getHeapBudget() / (1024.0 * 1024.0),
+          getMemoryPressureName(memoryBudget.getPressure()));
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++) {
+            const MemoryCategory category = static_cast<MemoryCategory>(i);
+            const MemoryCategoryUsage &usage = memoryBudget.getUsage(category);
+            ImGui::Text("%-24s %9.1f MiB %6u allocations",
+              getMemoryCategoryName(category),
+              usage.bytes / (1024.0 * 1024.0),
+              usage.allocations);
+        }
+
+        if (ImGui::Button("Dump as JSON")) { memoryBudget.writeJson("gpu_memory.json"); }
+    }
+
+    ImGui::Separator();
+
     if (ImGui::CollapsingHeader("KEY Bindings")) {
         ImGui::Text("WASD for moving Forward, backward and to the side\n QE for rotating ");
     }
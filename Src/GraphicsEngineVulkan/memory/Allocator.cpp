@@ -4,12 +4,16 @@
 
 Allocator::Allocator() {}
 
-Allocator::Allocator(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkInstance &instance)
+Allocator::Allocator(const VkDevice &device,
+  const VkPhysicalDevice &physicalDevice,
+  const VkInstance &instance,
+  bool memoryBudget)
 {
     // see here:
     // https://gpuopen-librariesandsdks.github.io/VulkanMemoryAllocator/html/quick_start.html
     VmaAllocatorCreateInfo allocatorCreateInfo = {};
     allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    if (memoryBudget) allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
     allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_3;
     allocatorCreateInfo.physicalDevice = physicalDevice;
     allocatorCreateInfo.device = device;
@@ -18,6 +22,102 @@ Allocator::Allocator(const VkDevice &device, const VkPhysicalDevice &physicalDev
     ASSERT_VULKAN(vmaCreateAllocator(&allocatorCreateInfo, &vmaAllocator), "Failed to create vma allocator!")
 }
 
-void Allocator::cleanUp() { vmaDestroyAllocator(vmaAllocator); }
+VmaAllocationCreateInfo Allocator::allocationCreateInfo(VkMemoryPropertyFlags memoryPropertyFlags)
+{
+    VmaAllocationCreateInfo allocation_create_info{};
+    allocation_create_info.requiredFlags = memoryPropertyFlags;
+
+    if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        // staging/upload memory: map once on creation and keep it mapped for
+        // the whole lifetime instead of vkMapMemory/vkUnmapMemory per upload
+        allocation_create_info.usage = VMA_MEMORY_USAGE_AUTO;
+        allocation_create_info.flags =
+          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    } else {
+        allocation_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    }
+
+    return allocation_create_info;
+}
+
+AllocatorStats Allocator::getStats() const
+{
+    AllocatorStats stats{};
+    if (vmaAllocator == VK_NULL_HANDLE) return stats;
+
+    VmaTotalStatistics total_statistics{};
+    vmaCalculateStatistics(vmaAllocator, &total_statistics);
+
+    const VmaStatistics &statistics = total_statistics.total.statistics;
+    stats.blockCount = statistics.blockCount;
+    stats.allocationCount = statistics.allocationCount;
+    stats.blockBytes = statistics.blockBytes;
+    stats.bytesUsed = statistics.allocationBytes;
+    stats.bytesWasted = statistics.blockBytes - statistics.allocationBytes;
+
+    return stats;
+}
+
+AllocatorBudget Allocator::getDeviceLocalBudget() const
+{
+    AllocatorBudget budget{};
+    if (vmaAllocator == VK_NULL_HANDLE) return budget;
+
+    const VkPhysicalDeviceMemoryProperties *memory_properties = nullptr;
+    vmaGetMemoryProperties(vmaAllocator, &memory_properties);
+
+    VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS]{};
+    vmaGetHeapBudgets(vmaAllocator, heap_budgets);
+
+    for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; heap++) {
+        if (!(memory_properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+        budget.usage += heap_budgets[heap].usage;
+        budget.budget += heap_budgets[heap].budget;
+    }
+
+    return budget;
+}
+
+void Allocator::updateMemoryBudget()
+{
+    const MemoryPressure previous = memoryBudget.getPressure();
+    const AllocatorBudget budget = getDeviceLocalBudget();
+    memoryBudget.setHeapBudget(budget.usage, budget.budget);
+
+    if (memoryBudget.getPressure() == MemoryPressure::Critical && previous != MemoryPressure::Critical) {
+        spdlog::warn("GPU memory pressure is critical: {} of {} MiB device local memory in use",
+          budget.usage >> 20,
+          budget.budget >> 20);
+        logStats();
+    }
+}
+
+void Allocator::logStats() const
+{
+    AllocatorStats stats = getStats();
+    spdlog::info("GPU memory: {} blocks, {} allocations, {} KiB used, {} KiB wasted",
+      stats.blockCount,
+      stats.allocationCount,
+      stats.bytesUsed / 1024,
+      stats.bytesWasted / 1024);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++) {
+        const MemoryCategory category = static_cast<MemoryCategory>(i);
+        const MemoryCategoryUsage &usage = memoryBudget.getUsage(category);
+        if (usage.allocations == 0) continue;
+        spdlog::info("  {}: {} allocations, {} KiB",
+          getMemoryCategoryName(category),
+          usage.allocations,
+          usage.bytes / 1024);
+    }
+}
+
+void Allocator::cleanUp()
+{
+    if (vmaAllocator != VK_NULL_HANDLE) {
+        vmaDestroyAllocator(vmaAllocator);
+        vmaAllocator = VK_NULL_HANDLE;
+    }
+}
 
 Allocator::~Allocator() {}
@@ -4,16 +4,56 @@
 
 #include <stdexcept>
 
+#include "MemoryBudget.hpp"
+
+// snapshot of the vma heaps; wasted bytes are reserved in blocks
+// but not handed out to any allocation (fragmentation + slack)
+struct AllocatorStats
+{
+    uint32_t blockCount{ 0 };
+    uint32_t allocationCount{ 0 };
+    VkDeviceSize blockBytes{ 0 };
+    VkDeviceSize bytesUsed{ 0 };
+    VkDeviceSize bytesWasted{ 0 };
+};
+
+// device local heaps; the budget comes from VK_EXT_memory_budget if the
+// device has it, otherwise vma estimates it from the heap sizes
+struct AllocatorBudget
+{
+    VkDeviceSize usage{ 0 };
+    VkDeviceSize budget{ 0 };
+};
+
 class Allocator
 {
   public:
     Allocator();
-    Allocator(const VkDevice &device, const VkPhysicalDevice &physicalDevice, const VkInstance &instance);
+    Allocator(const VkDevice &device,
+      const VkPhysicalDevice &physicalDevice,
+      const VkInstance &instance,
+      bool memoryBudget = false);
+
+    VmaAllocator getVmaAllocator() const { return vmaAllocator; };
+
+    // translate the old memory property flags into a vma request;
+    // host visible requests end up persistently mapped
+    static VmaAllocationCreateInfo allocationCreateInfo(VkMemoryPropertyFlags memoryPropertyFlags);
+
+    AllocatorStats getStats() const;
+    AllocatorBudget getDeviceLocalBudget() const;
+    // per category accounting of every VulkanBuffer and VulkanImage
+    MemoryBudget &getMemoryBudget() { return memoryBudget; };
+    const MemoryBudget &getMemoryBudget() const { return memoryBudget; };
+    // refreshes the heap numbers of getMemoryBudget(); once per frame is enough
+    void updateMemoryBudget();
+    void logStats() const;
 
     void cleanUp();
 
     ~Allocator();
 
   private:
-    VmaAllocator vmaAllocator;
+    VmaAllocator vmaAllocator{ VK_NULL_HANDLE };
+    MemoryBudget memoryBudget;
 };
@@ -0,0 +1,26 @@
+#include "DeletionQueue.hpp"
+
+DeletionQueue::DeletionQueue() {}
+
+void DeletionQueue::push(std::function<void()> deleter) { pending.push_back({ frame, std::move(deleter) }); }
+
+void DeletionQueue::release(uint64_t completed_frames)
+{
+    while (!pending.empty() && pending.front().frame < completed_frames) {
+        // take it out first; a deleter may push follow up deletions
+        std::function<void()> deleter = std::move(pending.front().deleter);
+        pending.pop_front();
+        deleter();
+    }
+}
+
+void DeletionQueue::flush()
+{
+    while (!pending.empty()) {
+        std::function<void()> deleter = std::move(pending.front().deleter);
+        pending.pop_front();
+        deleter();
+    }
+}
+
+DeletionQueue::~DeletionQueue() {}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// destroys resources once every frame that may still use them has finished
+// on the gpu instead of waiting for the device to go idle. frames are counted
+// by the renderer: whatever is pushed while frame n is (or was last) recorded
+// is released as soon as more than n frames are known to be complete
+class DeletionQueue
+{
+  public:
+    DeletionQueue();
+
+    // index of the frame about to be recorded
+    void setFrame(uint64_t frame) { this->frame = frame; };
+    uint64_t getFrame() const { return frame; };
+
+    void push(std::function<void()> deleter);
+    // frames [0, completed_frames) have finished on the gpu
+    void release(uint64_t completed_frames);
+    // the device has to be idle
+    void flush();
+
+    size_t getPendingCount() const { return pending.size(); };
+
+    ~DeletionQueue();
+
+  private:
+    struct PendingDeletion
+    {
+        uint64_t frame{ 0 };
+        std::function<void()> deleter;
+    };
+
+    uint64_t frame{ 0 };
+    // ordered by frame since frames only count up
+    std::deque<PendingDeletion> pending;
+};
@@ -0,0 +1,34 @@
+#include "LinearAllocator.hpp"
+
+#include <algorithm>
+
+LinearAllocator::LinearAllocator() {}
+
+void LinearAllocator::init(VkDeviceSize frame_size, uint32_t frame_count, VkDeviceSize alignment)
+{
+    this->alignment = std::max(alignment, VkDeviceSize{ 1 });
+    this->frame_size = (frame_size + this->alignment - 1) / this->alignment * this->alignment;
+    this->frame_count = frame_count;
+    frame = 0;
+    head = 0;
+    peak = 0;
+}
+
+void LinearAllocator::beginFrame(uint32_t frame)
+{
+    this->frame = frame_count > 0 ? frame % frame_count : 0;
+    head = 0;
+}
+
+bool LinearAllocator::allocate(VkDeviceSize size, VkDeviceSize &offset)
+{
+    const VkDeviceSize aligned = (head + alignment - 1) / alignment * alignment;
+    if (size == 0 || aligned + size > frame_size) return false;
+
+    offset = frame * frame_size + aligned;
+    head = aligned + size;
+    peak = std::max(peak, head);
+    return true;
+}
+
+LinearAllocator::~LinearAllocator() {}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+// bookkeeping for data that only lives for one frame: the capacity is split
+// into one region per frame in flight, allocations just bump the head of the
+// current region and beginFrame() drops everything that frame allocated the
+// last time around (its fence has signalled by then)
+class LinearAllocator
+{
+  public:
+    LinearAllocator();
+
+    // frame_size is rounded up to the alignment so every region starts aligned
+    void init(VkDeviceSize frame_size, uint32_t frame_count, VkDeviceSize alignment);
+
+    void beginFrame(uint32_t frame);
+    // offset is relative to the start of the whole buffer, not the region;
+    // returns false if the current frame's region is full
+    bool allocate(VkDeviceSize size, VkDeviceSize &offset);
+
+    VkDeviceSize getFrameSize() const { return frame_size; };
+    uint32_t getFrameCount() const { return frame_count; };
+    VkDeviceSize getCapacity() const { return frame_size * frame_count; };
+    VkDeviceSize getAlignment() const { return alignment; };
+    // alignment padding included
+    VkDeviceSize getFrameUsed() const { return head; };
+    VkDeviceSize getPeakFrameUsed() const { return peak; };
+
+    ~LinearAllocator();
+
+  private:
+    VkDeviceSize frame_size{ 0 };
+    uint32_t frame_count{ 0 };
+    VkDeviceSize alignment{ 1 };
+
+    uint32_t frame{ 0 };
+    VkDeviceSize head{ 0 };
+    VkDeviceSize peak{ 0 };
+};
@@ -0,0 +1,132 @@
+#include "MemoryBudget.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "spdlog/spdlog.h"
+
+const char *getMemoryCategoryName(MemoryCategory category)
+{
+    switch (category) {
+    case MemoryCategory::Geometry:
+        return "geometry";
+    case MemoryCategory::Texture:
+        return "texture";
+    case MemoryCategory::AccelerationStructure:
+        return "acceleration_structure";
+    case MemoryCategory::RenderTarget:
+        return "render_target";
+    case MemoryCategory::Staging:
+        return "staging";
+    case MemoryCategory::Uniform:
+        return "uniform";
+    case MemoryCategory::Other:
+        return "other";
+    default:
+        return "unknown";
+    }
+}
+
+const char *getMemoryPressureName(MemoryPressure pressure)
+{
+    switch (pressure) {
+    case MemoryPressure::Low:
+        return "low";
+    case MemoryPressure::High:
+        return "high";
+    case MemoryPressure::Critical:
+        return "critical";
+    default:
+        return "unknown";
+    }
+}
+
+MemoryBudget::MemoryBudget() {}
+
+void MemoryBudget::track(MemoryCategory category, VkDeviceSize bytes)
+{
+    MemoryCategoryUsage &category_usage = usage[static_cast<size_t>(category)];
+    category_usage.bytes += bytes;
+    category_usage.peak_bytes = std::max(category_usage.peak_bytes, category_usage.bytes);
+    category_usage.allocations++;
+}
+
+void MemoryBudget::untrack(MemoryCategory category, VkDeviceSize bytes)
+{
+    MemoryCategoryUsage &category_usage = usage[static_cast<size_t>(category)];
+    if (category_usage.bytes < bytes || category_usage.allocations == 0) {
+        spdlog::error("Released more {} memory than was allocated!", getMemoryCategoryName(category));
+        category_usage.bytes = 0;
+        category_usage.allocations = 0;
+        return;
+    }
+    category_usage.bytes -= bytes;
+    category_usage.allocations--;
+}
+
+void MemoryBudget::setHeapBudget(VkDeviceSize heap_usage, VkDeviceSize heap_budget)
+{
+    this->heap_usage = heap_usage;
+    this->heap_budget = heap_budget;
+}
+
+MemoryPressure MemoryBudget::getPressure() const
+{
+    // no budget known yet: nothing to react to
+    if (heap_budget == 0) return MemoryPressure::Low;
+
+    const double fill = static_cast<double>(heap_usage) / static_cast<double>(heap_budget);
+    if (fill >= CRITICAL_PRESSURE) return MemoryPressure::Critical;
+    if (fill >= HIGH_PRESSURE) return MemoryPressure::High;
+    return MemoryPressure::Low;
+}
+
+VkDeviceSize MemoryBudget::getTrackedBytes() const
+{
+    VkDeviceSize bytes = 0;
+    for (const MemoryCategoryUsage &category_usage : usage) bytes += category_usage.bytes;
+    return bytes;
+}
+
+VkDeviceSize MemoryBudget::getStreamingBudget(VkDeviceSize limit, VkDeviceSize streamed_bytes) const
+{
+    if (heap_budget == 0) return limit;
+
+    const VkDeviceSize others = heap_usage > streamed_bytes ? heap_usage - streamed_bytes : 0;
+    const auto target = static_cast<VkDeviceSize>(static_cast<double>(heap_budget) * HIGH_PRESSURE);
+    const VkDeviceSize available = target > others ? target - others : 0;
+    return std::min(limit, available);
+}
+
+std::string MemoryBudget::toJson() const
+{
+    nlohmann::json json;
+    json["heap"]["usage"] = heap_usage;
+    json["heap"]["budget"] = heap_budget;
+    json["heap"]["pressure"] = getMemoryPressureName(getPressure());
+    json["tracked_bytes"] = getTrackedBytes();
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++) {
+        const MemoryCategoryUsage &category_usage = usage[i];
+        nlohmann::json &category = json["categories"][getMemoryCategoryName(static_cast<MemoryCategory>(i))];
+        category["bytes"] = category_usage.bytes;
+        category["peak_bytes"] = category_usage.peak_bytes;
+        category["allocations"] = category_usage.allocations;
+    }
+
+    return json.dump(2);
+}
+
+bool MemoryBudget::writeJson(const std::string &file) const
+{
+    std::ofstream stream(file, std::ios::trunc);
+    if (!stream.is_open()) {
+        spdlog::error("Failed to write the memory budget to {}!", file);
+        return false;
+    }
+    stream << toJson() << '\n';
+    return stream.good();
+}
+
+MemoryBudget::~MemoryBudget() {}
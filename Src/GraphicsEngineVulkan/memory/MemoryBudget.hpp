@@ -0,0 +1,78 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// what an allocation is used for; every VulkanBuffer and VulkanImage names one
+enum class MemoryCategory : uint32_t {
+    Geometry,
+    Texture,
+    AccelerationStructure,
+    RenderTarget,
+    Staging,
+    Uniform,
+    // shader binding tables, indirect counters, ...
+    Other,
+    Count
+};
+
+const char *getMemoryCategoryName(MemoryCategory category);
+
+// how full the device local heaps are, relative to their budget
+enum class MemoryPressure : uint32_t { Low, High, Critical };
+
+const char *getMemoryPressureName(MemoryPressure pressure);
+
+struct MemoryCategoryUsage
+{
+    VkDeviceSize bytes{ 0 };
+    VkDeviceSize peak_bytes{ 0 };
+    uint32_t allocations{ 0 };
+};
+
+// bytes per category of everything allocated through VulkanBuffer and
+// VulkanImage, next to the device local heap usage and budget the allocator
+// reports. the heap numbers also cover memory we do not track ourselves
+// (swapchain, driver internals, other processes with VK_EXT_memory_budget).
+// streaming systems size themselves with getStreamingBudget(), so they give
+// memory back as soon as everything else grows
+class MemoryBudget
+{
+  public:
+    // fraction of the heap budget from which on we are under high/critical pressure;
+    // streaming only fills the heaps up to HIGH_PRESSURE
+    static constexpr float HIGH_PRESSURE = 0.85f;
+    static constexpr float CRITICAL_PRESSURE = 0.95f;
+
+    MemoryBudget();
+
+    void track(MemoryCategory category, VkDeviceSize bytes);
+    void untrack(MemoryCategory category, VkDeviceSize bytes);
+
+    void setHeapBudget(VkDeviceSize heap_usage, VkDeviceSize heap_budget);
+    VkDeviceSize getHeapUsage() const { return heap_usage; };
+    VkDeviceSize getHeapBudget() const { return heap_budget; };
+    MemoryPressure getPressure() const;
+
+    const MemoryCategoryUsage &getUsage(MemoryCategory category) const
+    {
+        return usage[static_cast<size_t>(category)];
+    };
+    VkDeviceSize getTrackedBytes() const;
+
+    // bytes a streaming system holding streamed_bytes may keep, at most limit:
+    // what is left of the heap budget up to HIGH_PRESSURE once everyone else is served
+    VkDeviceSize getStreamingBudget(VkDeviceSize limit, VkDeviceSize streamed_bytes) const;
+
+    std::string toJson() const;
+    bool writeJson(const std::string &file) const;
+
+    ~MemoryBudget();
+
+  private:
+    std::array<MemoryCategoryUsage, static_cast<size_t>(MemoryCategory::Count)> usage{};
+    VkDeviceSize heap_usage{ 0 };
+    VkDeviceSize heap_budget{ 0 };
+};
@@ -0,0 +1,78 @@
+#include "RangeAllocator.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "spdlog/spdlog.h"
+
+RangeAllocator::RangeAllocator() {}
+
+void RangeAllocator::init(VkDeviceSize capacity)
+{
+    this->capacity = capacity;
+    used = 0;
+    free_ranges.clear();
+    if (capacity > 0) free_ranges.emplace(0, capacity);
+}
+
+bool RangeAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    if (size == 0) return false;
+    if (alignment == 0) alignment = 1;
+
+    for (auto range = free_ranges.begin(); range != free_ranges.end(); ++range) {
+        const VkDeviceSize range_offset = range->first;
+        const VkDeviceSize range_end = range->first + range->second;
+        const VkDeviceSize aligned = (range_offset + alignment - 1) / alignment * alignment;
+        if (aligned + size > range_end) continue;
+
+        // the padding in front stays free, so does whatever is left behind
+        free_ranges.erase(range);
+        if (aligned > range_offset) free_ranges.emplace(range_offset, aligned - range_offset);
+        if (aligned + size < range_end) free_ranges.emplace(aligned + size, range_end - aligned - size);
+
+        offset = aligned;
+        used += size;
+        return true;
+    }
+    return false;
+}
+
+void RangeAllocator::free(VkDeviceSize offset, VkDeviceSize size)
+{
+    if (size == 0) return;
+    if (offset + size > capacity || size > used) {
+        spdlog::error("Freed range [{}, {}) was not allocated!", offset, offset + size);
+        return;
+    }
+    used -= size;
+
+    auto next = free_ranges.lower_bound(offset);
+    VkDeviceSize start = offset;
+    VkDeviceSize end = offset + size;
+
+    // merge with the free range in front ...
+    if (next != free_ranges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start) {
+            start = previous->first;
+            free_ranges.erase(previous);
+        }
+    }
+    // ... and the one behind
+    if (next != free_ranges.end() && next->first == end) {
+        end += next->second;
+        free_ranges.erase(next);
+    }
+
+    free_ranges.emplace(start, end - start);
+}
+
+VkDeviceSize RangeAllocator::getLargestFreeRange() const
+{
+    VkDeviceSize largest = 0;
+    for (const auto &[offset, size] : free_ranges) largest = std::max(largest, size);
+    return largest;
+}
+
+RangeAllocator::~RangeAllocator() {}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <map>
+
+// first fit sub-allocation of [0, capacity) for ranges that are freed in any
+// order; free ranges are kept sorted by offset and merged with their
+// neighbours on free(), so a pool that is emptied ends up as one range again
+class RangeAllocator
+{
+  public:
+    RangeAllocator();
+
+    void init(VkDeviceSize capacity);
+
+    // alignment does not have to be a power of two (e.g. a vertex stride);
+    // returns false if no free range is large enough
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+    // size has to be the one passed to allocate()
+    void free(VkDeviceSize offset, VkDeviceSize size);
+
+    VkDeviceSize getCapacity() const { return capacity; };
+    VkDeviceSize getUsed() const { return used; };
+    VkDeviceSize getLargestFreeRange() const;
+    size_t getFreeRangeCount() const { return free_ranges.size(); };
+
+    ~RangeAllocator();
+
+  private:
+    VkDeviceSize capacity{ 0 };
+    VkDeviceSize used{ 0 };
+    // offset -> size
+    std::map<VkDeviceSize, VkDeviceSize> free_ranges;
+};
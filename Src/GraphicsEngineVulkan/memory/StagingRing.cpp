@@ -0,0 +1,47 @@
+#include "StagingRing.hpp"
+
+StagingRing::StagingRing() {}
+
+void StagingRing::init(VkDeviceSize capacity)
+{
+    this->capacity = capacity;
+    head = 0;
+    used = 0;
+}
+
+bool StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset, VkDeviceSize &consumed)
+{
+    if (size > capacity) return false;
+    if (alignment == 0) alignment = 1;
+
+    VkDeviceSize aligned_head = (head + alignment - 1) / alignment * alignment;
+    VkDeviceSize start = aligned_head;
+    VkDeviceSize padding = aligned_head - head;
+
+    // not enough room until the end of the ring; skip the rest and start at 0
+    if (aligned_head + size > capacity) {
+        start = 0;
+        padding = capacity - head;
+    }
+
+    // in flight data occupies the range ending at head, so the new
+    // allocation fits as long as both together fit into the ring
+    if (used + padding + size > capacity) return false;
+
+    offset = start;
+    consumed = padding + size;
+    head = start + size;
+    if (head == capacity) head = 0;
+    used += consumed;
+
+    return true;
+}
+
+void StagingRing::release(VkDeviceSize consumed)
+{
+    used -= consumed;
+    // ring drained: start over at 0 to avoid needless wrapping
+    if (used == 0) head = 0;
+}
+
+StagingRing::~StagingRing() {}
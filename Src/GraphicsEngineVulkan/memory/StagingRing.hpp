@@ -0,0 +1,29 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// bookkeeping for a fixed size ring of staging memory;
+// allocations are released in the same order they were handed out
+// (one release per retired upload batch), so tracking the write head
+// and the amount of bytes still in flight is enough
+class StagingRing
+{
+  public:
+    StagingRing();
+
+    void init(VkDeviceSize capacity);
+
+    // returns false if the ring is too full right now; consumed also counts
+    // alignment padding and the skipped tail when we wrap around
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset, VkDeviceSize &consumed);
+    void release(VkDeviceSize consumed);
+
+    VkDeviceSize getCapacity() const { return capacity; };
+    VkDeviceSize getUsed() const { return used; };
+
+    ~StagingRing();
+
+  private:
+    VkDeviceSize capacity{ 0 };
+    VkDeviceSize head{ 0 };
+    VkDeviceSize used{ 0 };
+};
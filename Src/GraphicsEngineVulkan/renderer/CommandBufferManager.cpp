@@ -1,23 +1,52 @@
 #include "CommandBufferManager.hpp"
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "Utilities.hpp"
 
+namespace {
+// shared by all CommandBufferManager instances; they are plain members of
+// images, buffer managers and stages and get copied around freely
+struct RecycledSubmits
+{
+    std::vector<VkCommandBuffer> command_buffers;
+    std::vector<VkFence> fences;
+};
+
+std::mutex recycled_mutex;
+std::unordered_map<VkCommandPool, RecycledSubmits> recycled;
+}// namespace
+
 CommandBufferManager::CommandBufferManager() {}
 
 VkCommandBuffer CommandBufferManager::beginCommandBuffer(VkDevice device, VkCommandPool command_pool)
 {
     // command buffer to hold transfer commands
-    VkCommandBuffer command_buffer;
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+
+    {
+        std::lock_guard<std::mutex> lock(recycled_mutex);
+        std::vector<VkCommandBuffer> &command_buffers = recycled[command_pool].command_buffers;
+        if (!command_buffers.empty()) {
+            command_buffer = command_buffers.back();
+            command_buffers.pop_back();
+        }
+    }
 
-    // command buffer details
-    VkCommandBufferAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = command_pool;
-    alloc_info.commandBufferCount = 1;
+    if (command_buffer == VK_NULL_HANDLE) {
+        // command buffer details
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool = command_pool;
+        alloc_info.commandBufferCount = 1;
 
-    // allocate command buffer from pool
-    vkAllocateCommandBuffers(device, &alloc_info, &command_buffer);
+        // allocate command buffer from pool
+        VkResult result = vkAllocateCommandBuffers(device, &alloc_info, &command_buffer);
+        ASSERT_VULKAN(result, "Failed to allocate command buffer!")
+    }
 
     // infromation to begin the command buffer record
     VkCommandBufferBeginInfo begin_info{};
@@ -25,7 +54,8 @@ VkCommandBuffer CommandBufferManager::beginCommandBuffer(VkDevice device, VkComm
     // we are only using the command buffer once, so set up for one time submit
     begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    // begin recording transfer commands
+    // begin recording transfer commands; a recycled buffer is reset implicitly
+    // (all pools are created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
     vkBeginCommandBuffer(command_buffer, &begin_info);
 
     return command_buffer;
@@ -40,6 +70,23 @@ void CommandBufferManager::endAndSubmitCommandBuffer(VkDevice device,
     VkResult result = vkEndCommandBuffer(command_buffer);
     ASSERT_VULKAN(result, "Failed to end command buffer!")
 
+    VkFence fence = VK_NULL_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(recycled_mutex);
+        std::vector<VkFence> &fences = recycled[command_pool].fences;
+        if (!fences.empty()) {
+            fence = fences.back();
+            fences.pop_back();
+        }
+    }
+
+    if (fence == VK_NULL_HANDLE) {
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        result = vkCreateFence(device, &fence_info, nullptr, &fence);
+        ASSERT_VULKAN(result, "Failed to create fence!")
+    }
+
     // queue submission information
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -47,14 +94,37 @@ void CommandBufferManager::endAndSubmitCommandBuffer(VkDevice device,
     submit_info.pCommandBuffers = &command_buffer;
 
     // submit transfer command to transfer queue and wait until it finishes
-    result = vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+    result = vkQueueSubmit(queue, 1, &submit_info, fence);
     ASSERT_VULKAN(result, "Failed to submit to queue!")
 
-    result = vkQueueWaitIdle(queue);
-    ASSERT_VULKAN(result, "Failed to wait Idle!")
+    result = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    ASSERT_VULKAN(result, "Failed to wait for fence!")
+    result = vkResetFences(device, 1, &fence);
+    ASSERT_VULKAN(result, "Failed to reset fence!")
+
+    // hand both back for the next submit
+    std::lock_guard<std::mutex> lock(recycled_mutex);
+    RecycledSubmits &submits = recycled[command_pool];
+    submits.command_buffers.push_back(command_buffer);
+    submits.fences.push_back(fence);
+    command_buffer = VK_NULL_HANDLE;
+}
+
+void CommandBufferManager::releaseCommandPool(VkDevice device, VkCommandPool command_pool)
+{
+    std::lock_guard<std::mutex> lock(recycled_mutex);
+    auto submits = recycled.find(command_pool);
+    if (submits == recycled.end()) return;
+
+    if (!submits->second.command_buffers.empty()) {
+        vkFreeCommandBuffers(device,
+          command_pool,
+          static_cast<uint32_t>(submits->second.command_buffers.size()),
+          submits->second.command_buffers.data());
+    }
+    for (VkFence fence : submits->second.fences) vkDestroyFence(device, fence, nullptr);
 
-    // free temporary command buffer back to pool
-    vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
+    recycled.erase(submits);
 }
 
 CommandBufferManager::~CommandBufferManager() {}
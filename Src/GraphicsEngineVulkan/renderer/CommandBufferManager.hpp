@@ -1,6 +1,10 @@
 #pragma once
 #include <vulkan/vulkan.h>
 
+// immediate submits for one-shot work (transitions, copies, blits, AS builds).
+// command buffers and fences are recycled per command pool instead of being
+// allocated and freed every time, and a submit only waits on its own fence
+// instead of draining the whole queue with vkQueueWaitIdle
 class CommandBufferManager
 {
   public:
@@ -12,6 +16,9 @@ class CommandBufferManager
       VkQueue queue,
       VkCommandBuffer &command_buffer);
 
+    // frees the recycled command buffers and fences; before destroying the pool
+    static void releaseCommandPool(VkDevice device, VkCommandPool command_pool);
+
     ~CommandBufferManager();
 
   private:
@@ -0,0 +1,37 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+// everything one frame in flight records into and reads from. a context is
+// reused once its fence has signalled, independent of which swapchain image
+// the frame ends up presenting; only framebuffers of the swapchain images
+// and the semaphores presentation waits on are indexed by the image
+struct FrameContext
+{
+    // reset as a whole once per frame instead of resetting single command buffers
+    VkCommandPool command_pool{ VK_NULL_HANDLE };
+    VkCommandBuffer command_buffer{ VK_NULL_HANDLE };
+
+    VkSemaphore image_available{ VK_NULL_HANDLE };
+    VkFence in_flight_fence{ VK_NULL_HANDLE };
+
+    // globalUBO and sceneUBO of this frame in the frame allocator's region
+    std::vector<uint32_t> ubo_dynamic_offsets;
+
+    VkDescriptorSet shared_render_descriptor_set{ VK_NULL_HANDLE };
+    // bindless textures and samplers; the only set written after it was bound
+    VkDescriptorSet texture_table_descriptor_set{ VK_NULL_HANDLE };
+    VkDescriptorSet raytracing_descriptor_set{ VK_NULL_HANDLE };
+    VkDescriptorSet post_descriptor_set{ VK_NULL_HANDLE };
+
+    // texture table slots the shared set still has to get and the table version it is at;
+    // the set is only written once this frame has finished on the gpu
+    std::vector<uint32_t> texture_slots_to_write;
+    uint64_t texture_table_version{ 0 };
+
+    // swapchain recreation the post and raytracing sets point to the offscreen image of;
+    // they are rewritten once this frame has finished on the gpu
+    uint64_t render_target_version{ 0 };
+};
@@ -0,0 +1,93 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+
+#include "Globals.hpp"
+#include "VulkanDevice.hpp"
+
+namespace {
+// a present dropped with an out of date swapchain never completes; it is given up on after this
+constexpr uint64_t PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+// weight of a new measurement in the average latency
+constexpr double LATENCY_SMOOTHING = 0.1;
+}// namespace
+
+FramePacer::FramePacer() {}
+
+void FramePacer::init(VulkanDevice *device)
+{
+    this->device = device;
+
+    if (device->supportsPresentWait()) {
+        pvkWaitForPresentKHR = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+          vkGetDeviceProcAddr(device->getLogicalDevice(), "vkWaitForPresentKHR"));
+    }
+    present_wait = pvkWaitForPresentKHR != nullptr;
+}
+
+void FramePacer::setMaxQueuedFrames(uint32_t count)
+{
+    max_queued_frames = std::clamp(count, 1u, static_cast<uint32_t>(MAX_FRAME_DRAWS));
+}
+
+void FramePacer::waitForFrameSlot(VkSwapchainKHR swapchain)
+{
+    const uint64_t wait_id = getWaitId();
+    if (!present_wait || wait_id == 0) return;
+
+    VkResult result = pvkWaitForPresentKHR(device->getLogicalDevice(), swapchain, wait_id, PRESENT_WAIT_TIMEOUT_NS);
+    if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+        // if the frame was on screen before we asked this is an upper bound
+        presentCompleted(wait_id, Clock::now());
+    } else {
+        // timed out or out of date; the swapchain is recreated and the id not asked for again
+        retire(wait_id);
+    }
+}
+
+void FramePacer::markInputSampled(Clock::time_point time) { input_time = time; }
+
+uint64_t FramePacer::beginPresent()
+{
+    last_id++;
+    pending.push_back({ last_id, input_time });
+    return last_id;
+}
+
+void FramePacer::resetSwapchain()
+{
+    first_id = last_id + 1;
+    pending.clear();
+}
+
+uint64_t FramePacer::getWaitId() const
+{
+    // the next frame gets id last_id + 1; the max_queued_frames - 1 before it may still be queued
+    if (last_id + 1 <= max_queued_frames) return 0;
+    const uint64_t id = last_id + 1 - max_queued_frames;
+    if (id < first_id || id <= completed_id) return 0;
+    return id;
+}
+
+void FramePacer::presentCompleted(uint64_t id, Clock::time_point time)
+{
+    for (const PendingPresent &present : pending) {
+        if (present.id != id) continue;
+
+        latency_ms = std::chrono::duration<double, std::milli>(time - present.input_time).count();
+        average_latency_ms = average_latency_ms == 0.0
+                               ? latency_ms
+                               : average_latency_ms + LATENCY_SMOOTHING * (latency_ms - average_latency_ms);
+        break;
+    }
+
+    retire(id);
+}
+
+FramePacer::~FramePacer() {}
+
+void FramePacer::retire(uint64_t id)
+{
+    while (!pending.empty() && pending.front().id <= id) pending.pop_front();
+    completed_id = std::max(completed_id, id);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+class VulkanDevice;
+
+// limits the frames queued between sampling input and the screen. right
+// before the input of a frame is polled, waitForFrameSlot() blocks until the
+// frame max_queued_frames before it is on screen (VK_KHR_present_wait), so
+// input is sampled as late as the queue allows instead of whenever a frame
+// context is free. every present carries an id (VK_KHR_present_id); the time
+// from sampling the input of a frame to the completed wait for its id is the
+// measured input to present latency
+class FramePacer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer();
+
+    // without a device only the bookkeeping runs, e.g. in tests
+    void init(VulkanDevice *device);
+
+    // clamped to [1, MAX_FRAME_DRAWS]
+    void setMaxQueuedFrames(uint32_t count);
+    uint32_t getMaxQueuedFrames() const { return max_queued_frames; };
+    // presents are waited for by id; otherwise pacing falls back to the frame fences of the renderer
+    bool usesPresentWait() const { return present_wait; };
+
+    // blocks until the frame max_queued_frames before the next one is on screen
+    void waitForFrameSlot(VkSwapchainKHR swapchain);
+    // the input of the next frame is sampled now
+    void markInputSampled(Clock::time_point time = Clock::now());
+    // id the next present carries in VkPresentIdKHR; remembers when its input was sampled
+    uint64_t beginPresent();
+    // presents so far went to a retired swapchain and are never waited for
+    void resetSwapchain();
+
+    // id the next waitForFrameSlot() waits for; 0 if there is nothing to wait for
+    uint64_t getWaitId() const;
+    // the present with the given id was on screen at time
+    void presentCompleted(uint64_t id, Clock::time_point time);
+
+    // of the last measured present and averaged over the recent ones; 0 until one was measured
+    double getLatencyMs() const { return latency_ms; };
+    double getAverageLatencyMs() const { return average_latency_ms; };
+
+    ~FramePacer();
+
+  private:
+    struct PendingPresent
+    {
+        uint64_t id{ 0 };
+        Clock::time_point input_time;
+    };
+
+    VulkanDevice *device{ nullptr };
+    bool present_wait{ false };
+    PFN_vkWaitForPresentKHR pvkWaitForPresentKHR{ nullptr };
+
+    uint32_t max_queued_frames{ 2 };
+
+    Clock::time_point input_time;
+    // ids count up over all swapchains; first_id is the first one of the current swapchain
+    uint64_t last_id{ 0 };
+    uint64_t first_id{ 1 };
+    uint64_t completed_id{ 0 };
+    std::deque<PendingPresent> pending;
+
+    double latency_ms{ 0.0 };
+    double average_latency_ms{ 0.0 };
+
+    // presents up to id are done with, measured or not
+    void retire(uint64_t id);
+};
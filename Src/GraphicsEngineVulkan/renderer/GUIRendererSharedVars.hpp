@@ -1,3 +1,8 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
 struct GUIRendererSharedVars
 {
     bool raytracing = false;
@@ -5,5 +10,16 @@ struct GUIRendererSharedVars
 
     bool shader_hot_reload_triggered = false;
 
+    // presentation; the swapchain is recreated once these change
+    VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    uint32_t max_queued_frames = 1;
+
+    // written by the renderer: mode the swapchain actually uses and, with VK_KHR_present_wait,
+    // the measured time from sampling input to the frame being on screen
+    VkPresentModeKHR active_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    bool present_wait = false;
+    float input_to_present_ms = 0.f;
+    float average_input_to_present_ms = 0.f;
+
     // path tracing vars
 };
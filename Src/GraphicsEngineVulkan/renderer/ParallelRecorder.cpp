@@ -0,0 +1,101 @@
+#include "ParallelRecorder.hpp"
+
+#include <algorithm>
+
+ParallelRecorder::ParallelRecorder(uint32_t worker_count)
+{
+    if (worker_count == 0) worker_count = std::min(std::max(1u, std::thread::hardware_concurrency()), MAX_WORKERS);
+
+    // worker 0 is the calling thread
+    threads.reserve(worker_count - 1);
+    for (uint32_t w = 1; w < worker_count; w++) threads.emplace_back([this, w]() { work(w); });
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_condition.notify_all();
+    for (std::thread &thread : threads) thread.join();
+}
+
+uint32_t ParallelRecorder::record(uint32_t item_count, uint32_t min_items, const RecordFunction &recordRange)
+{
+    std::vector<Range> split_ranges = split(item_count, getWorkerCount(), min_items);
+    if (split_ranges.empty()) return 0;
+
+    const uint32_t range_count = static_cast<uint32_t>(split_ranges.size());
+    const Range first = split_ranges[0];
+    if (range_count == 1) {
+        recordRange(0, first.begin, first.end);
+        return 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ranges = std::move(split_ranges);
+        this->recordRange = &recordRange;
+        pending = range_count - 1;
+        generation++;
+    }
+    start_condition.notify_all();
+
+    recordRange(0, first.begin, first.end);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_condition.wait(lock, [this]() { return pending == 0; });
+    this->recordRange = nullptr;
+    return range_count;
+}
+
+std::vector<ParallelRecorder::Range>
+  ParallelRecorder::split(uint32_t item_count, uint32_t range_count, uint32_t min_items)
+{
+    std::vector<Range> split_ranges;
+    if (item_count == 0 || range_count == 0) return split_ranges;
+
+    // fewer ranges for few items; waking a worker costs more than a handful of draws
+    const uint32_t max_ranges = std::max(1u, item_count / std::max(1u, min_items));
+    range_count = std::min(range_count, max_ranges);
+
+    // the first item_count % range_count ranges get one item more
+    const uint32_t size = item_count / range_count;
+    const uint32_t remainder = item_count % range_count;
+    uint32_t begin = 0;
+    for (uint32_t r = 0; r < range_count; r++) {
+        const uint32_t end = begin + size + (r < remainder ? 1 : 0);
+        split_ranges.push_back({ begin, end });
+        begin = end;
+    }
+    return split_ranges;
+}
+
+void ParallelRecorder::work(uint32_t worker)
+{
+    uint64_t seen_generation = 0;
+    while (true) {
+        Range range;
+        const RecordFunction *function = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_condition.wait(lock, [&]() { return stop || generation != seen_generation; });
+            if (stop) return;
+            seen_generation = generation;
+            // fewer ranges than workers: this one sits the call out
+            if (worker >= ranges.size()) continue;
+            range = ranges[worker];
+            function = recordRange;
+        }
+
+        (*function)(worker, range.begin, range.end);
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = --pending == 0;
+        }
+        if (done) done_condition.notify_one();
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// splits a list of draws into contiguous ranges and records them on a pool
+// of persistent worker threads, e.g. into one secondary command buffer per
+// worker. the threads live as long as the recorder since spawning them every
+// frame would cost more than the recording itself; the calling thread
+// records the first range
+class ParallelRecorder
+{
+  public:
+    struct Range
+    {
+        uint32_t begin{ 0 };
+        uint32_t end{ 0 };
+    };
+
+    // worker w records one range with all commands of it
+    using RecordFunction = std::function<void(uint32_t worker, uint32_t begin, uint32_t end)>;
+
+    // worker_count includes the calling thread; 0 picks std::thread::hardware_concurrency()
+    // limited to MAX_WORKERS
+    explicit ParallelRecorder(uint32_t worker_count = 0);
+    ~ParallelRecorder();
+
+    ParallelRecorder(const ParallelRecorder &) = delete;
+    ParallelRecorder &operator=(const ParallelRecorder &) = delete;
+
+    static constexpr uint32_t MAX_WORKERS = 8;
+
+    // records [0, item_count) in at most getWorkerCount() ranges of at least min_items
+    // (except for fewer items in total) and blocks until all are done; returns the
+    // number of ranges, range r was recorded by worker r
+    uint32_t record(uint32_t item_count, uint32_t min_items, const RecordFunction &recordRange);
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(threads.size()) + 1; };
+
+    // at most range_count ranges of about equal size covering [0, item_count)
+    static std::vector<Range> split(uint32_t item_count, uint32_t range_count, uint32_t min_items);
+
+  private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+    // counts up with every record() call so workers notice new work
+    uint64_t generation{ 0 };
+    uint32_t pending{ 0 };
+    bool stop{ false };
+    std::vector<Range> ranges;
+    const RecordFunction *recordRange{ nullptr };
+
+    void work(uint32_t worker);
+};
@@ -5,6 +5,7 @@
 #include <filesystem>
 
 #include "File.hpp"
+#include "SceneConfig.hpp"
 #include "ShaderHelper.hpp"
 
 #include "VulkanRendererConfig.hpp"
@@ -41,15 +42,20 @@ void PathTracing::init(VulkanDevice *device, const std::vector<VkDescriptorSetLa
 
 void PathTracing::shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts)
 {
-    vkDestroyPipeline(device->getLogicalDevice(), pipeline, nullptr);
+    // frames in flight may still use the old pipeline
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device, old_pipeline = pipeline, old_layout = pipeline_layout]() {
+        vkDestroyPipeline(logical_device, old_pipeline, nullptr);
+        vkDestroyPipelineLayout(logical_device, old_layout, nullptr);
+    });
     createPipeline(descriptor_set_layouts);
 }
 
 void PathTracing::recordCommands(VkCommandBuffer &commandBuffer,
   uint32_t image_index,
-  VulkanImage &vulkanImage,
   VulkanSwapChain *vulkanSwapChain,
-  const std::vector<VkDescriptorSet> &descriptorSets)
+  const std::vector<VkDescriptorSet> &descriptorSets,
+  const std::vector<uint32_t> &dynamicOffsets)
 {
     // we have reset the pool; hence start by 0
     uint32_t query = 0;
@@ -59,39 +65,6 @@ void PathTracing::recordCommands(VkCommandBuffer &commandBuffer,
     vkCmdWriteTimestamp(
       commandBuffer, VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, queryPool, query++);
 
-    QueueFamilyIndices indices = device->getQueueFamilies();
-
-    VkImageSubresourceRange subresourceRange{};
-    subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresourceRange.baseMipLevel = 0;
-    subresourceRange.baseArrayLayer = 0;
-    subresourceRange.levelCount = 1;
-    subresourceRange.layerCount = 1;
-
-    VkImageMemoryBarrier presentToPathTracingImageBarrier{};
-    presentToPathTracingImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    presentToPathTracingImageBarrier.pNext = nullptr;
-    presentToPathTracingImageBarrier.srcQueueFamilyIndex = indices.graphics_family;
-    presentToPathTracingImageBarrier.dstQueueFamilyIndex = indices.compute_family;
-    presentToPathTracingImageBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    presentToPathTracingImageBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    presentToPathTracingImageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-    presentToPathTracingImageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-    presentToPathTracingImageBarrier.subresourceRange = subresourceRange;
-    presentToPathTracingImageBarrier.image = vulkanImage.getImage();
-
-    vkCmdPipelineBarrier(commandBuffer,
-      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-
-      0,
-      0,
-      nullptr,
-      0,
-      nullptr,
-      1,
-      &presentToPathTracingImageBarrier);
-
     VkExtent2D imageSize = vulkanSwapChain->getSwapChainExtent();
     push_constant.width = imageSize.width;
     push_constant.height = imageSize.height;
@@ -108,8 +81,8 @@ void PathTracing::recordCommands(VkCommandBuffer &commandBuffer,
       0,
       static_cast<uint32_t>(descriptorSets.size()),
       descriptorSets.data(),
-      0,
-      0);
+      static_cast<uint32_t>(dynamicOffsets.size()),
+      dynamicOffsets.data());
 
     uint32_t workGroupCountX = std::max(
       (imageSize.width + specializationData.specWorkGroupSizeX - 1) / specializationData.specWorkGroupSizeX, 1U);
@@ -119,29 +92,6 @@ void PathTracing::recordCommands(VkCommandBuffer &commandBuffer,
 
     vkCmdDispatch(commandBuffer, workGroupCountX, workGroupCountY, workGroupCountZ);
 
-    VkImageMemoryBarrier pathTracingToPresentImageBarrier{};
-    pathTracingToPresentImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    pathTracingToPresentImageBarrier.pNext = nullptr;
-    pathTracingToPresentImageBarrier.srcQueueFamilyIndex = indices.compute_family;
-    pathTracingToPresentImageBarrier.dstQueueFamilyIndex = indices.graphics_family;
-    pathTracingToPresentImageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    pathTracingToPresentImageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    pathTracingToPresentImageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-    pathTracingToPresentImageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-    pathTracingToPresentImageBarrier.image = vulkanImage.getImage();
-    pathTracingToPresentImageBarrier.subresourceRange = subresourceRange;
-
-    vkCmdPipelineBarrier(commandBuffer,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-      0,
-      0,
-      nullptr,
-      0,
-      nullptr,
-      1,
-      &pathTracingToPresentImageBarrier);
-
     vkCmdWriteTimestamp(
       commandBuffer, VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, queryPool, query++);
     VkResult result = vkGetQueryPoolResults(device->getLogicalDevice(),
@@ -209,11 +159,12 @@ void PathTracing::createPipeline(const std::vector<VkDescriptorSetLayout> &descr
     std::string pathTracing_shader = "path_tracing.comp";
 
     ShaderHelper shaderHelper;
+    shaderHelper.compileShader(
+      pathTracing_shader_dir.str(), pathTracing_shader, vertex::getShaderDefines(sceneConfig::getVertexLayout()));
+
     File pathTracingShaderFile(shaderHelper.getShaderSpvDir(pathTracing_shader_dir.str(), pathTracing_shader));
     std::vector<char> pathTracingShadercode = pathTracingShaderFile.readCharSequence();
 
-    shaderHelper.compileShader(pathTracing_shader_dir.str(), pathTracing_shader);
-
     // build shader modules to link to graphics pipeline
     VkShaderModule pathTracingModule = shaderHelper.createShaderModule(device, pathTracingShadercode);
 
@@ -17,9 +17,9 @@ class PathTracing
 
     void recordCommands(VkCommandBuffer &commandBuffer,
       uint32_t image_index,
-      VulkanImage &vulkanImage,
       VulkanSwapChain *vulkanSwapChain,
-      const std::vector<VkDescriptorSet> &descriptorSets);
+      const std::vector<VkDescriptorSet> &descriptorSets,
+      const std::vector<uint32_t> &dynamicOffsets);
 
     void cleanUp();
 
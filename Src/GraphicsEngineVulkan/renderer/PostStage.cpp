@@ -38,10 +38,31 @@ void PostStage::init(VulkanDevice *device,
 
 void PostStage::shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts)
 {
-    vkDestroyPipeline(device->getLogicalDevice(), graphics_pipeline, nullptr);
+    // frames in flight may still use the old pipeline
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device, old_pipeline = graphics_pipeline, old_layout = pipeline_layout]() {
+        vkDestroyPipeline(logical_device, old_pipeline, nullptr);
+        vkDestroyPipelineLayout(logical_device, old_layout, nullptr);
+    });
     createGraphicsPipeline(descriptor_set_layouts);
 }
 
+void PostStage::resize()
+{
+    // frames in flight may still render into the old framebuffers
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push(
+      [logical_device, old_framebuffers = framebuffers, old_depth = depthBufferImage]() mutable {
+          for (VkFramebuffer old_framebuffer : old_framebuffers) {
+              vkDestroyFramebuffer(logical_device, old_framebuffer, nullptr);
+          }
+          old_depth.cleanUp();
+      });
+
+    createDepthbufferImage();
+    createFramebuffer();
+}
+
 void PostStage::recordCommands(VkCommandBuffer &commandBuffer,
   uint32_t image_index,
   const std::vector<VkDescriptorSet> &descriptorSets)
@@ -81,6 +102,10 @@ void PostStage::recordCommands(VkCommandBuffer &commandBuffer,
       sizeof(PushConstantPost),
       &pc_post);
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+    VkViewport viewport{ 0.0f, 0.0f, (float)swap_chain_extent.width, (float)swap_chain_extent.height, 0.0f, 1.0f };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    VkRect2D scissor{ { 0, 0 }, swap_chain_extent };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     vkCmdBindDescriptorSets(commandBuffer,
       VK_PIPELINE_BIND_POINT_GRAPHICS,
       pipeline_layout,
@@ -131,7 +156,8 @@ void PostStage::createDepthbufferImage()
       depth_format,
       VK_IMAGE_TILING_OPTIMAL,
       VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::RenderTarget);
 
     // depth buffer image view
     // MIP LEVELS: for depth texture we only want 1 level :)
@@ -303,7 +329,7 @@ void PostStage::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     binding_description.stride = sizeof(Vertex);
     binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-    std::array<VkVertexInputAttributeDescription, 4> attribute_describtions = vertex::getVertexInputAttributeDesc();
+    std::vector<VkVertexInputAttributeDescription> attribute_describtions = vertex::getVertexInputAttributeDesc();
 
     // CREATE PIPELINE
     // 1.) Vertex input
@@ -320,28 +346,17 @@ void PostStage::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     input_assembly.primitiveRestartEnable = VK_FALSE;
 
-    // viewport & scissor
-    // create a viewport info struct
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    const VkExtent2D &swap_chain_extent = vulkanSwapChain->getSwapChainExtent();
-    viewport.width = (float)swap_chain_extent.width;
-    viewport.height = (float)swap_chain_extent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    // create a scissor info struct
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = swap_chain_extent;
-
+    // viewport & scissor are set while recording so a resize does not need a new pipeline
     VkPipelineViewportStateCreateInfo viewport_state_create_info{};
     viewport_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewport_state_create_info.viewportCount = 1;
-    viewport_state_create_info.pViewports = &viewport;
     viewport_state_create_info.scissorCount = 1;
-    viewport_state_create_info.pScissors = &scissor;
+
+    std::array<VkDynamicState, 2> dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamic_state_create_info{};
+    dynamic_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state_create_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+    dynamic_state_create_info.pDynamicStates = dynamic_states.data();
 
     // RASTERIZER
     VkPipelineRasterizationStateCreateInfo rasterizer_create_info{};
@@ -415,7 +430,7 @@ void PostStage::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     graphics_pipeline_create_info.pVertexInputState = &vertex_input_create_info;
     graphics_pipeline_create_info.pInputAssemblyState = &input_assembly;
     graphics_pipeline_create_info.pViewportState = &viewport_state_create_info;
-    graphics_pipeline_create_info.pDynamicState = nullptr;
+    graphics_pipeline_create_info.pDynamicState = &dynamic_state_create_info;
     graphics_pipeline_create_info.pRasterizationState = &rasterizer_create_info;
     graphics_pipeline_create_info.pMultisampleState = &multisample_create_info;
     graphics_pipeline_create_info.pColorBlendState = &color_blending_create_info;
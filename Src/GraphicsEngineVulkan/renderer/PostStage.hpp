@@ -15,6 +15,8 @@ class PostStage
       const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts);
 
     void shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts);
+    // new depth buffer and framebuffers for the current swapchain; the old ones go to the deletion queue
+    void resize();
 
     VkRenderPass &getRenderPass() { return render_pass; };
     VkSampler &getOffscreenSampler() { return offscreenTextureSampler; };
@@ -5,6 +5,7 @@ struct QueueFamilyIndices
     int graphics_family = -1;// location of graphics family
     int presentation_family = -1;// location of presentation queue family
     int compute_family = -1;// location of compute queue family
+    int transfer_family = -1;// dedicated transfer family; falls back to graphics_family
 
     // check if queue families are valid
     bool is_valid() { return graphics_family >= 0 && presentation_family >= 0 && compute_family >= 0; }
@@ -6,6 +6,7 @@
 
 #include "File.hpp"
 #include "FormatHelper.hpp"
+#include "SceneConfig.hpp"
 #include "ShaderHelper.hpp"
 #include "Vertex.hpp"
 
@@ -16,33 +17,65 @@ Rasterizer::Rasterizer() {}
 
 void Rasterizer::init(VulkanDevice *device,
   VulkanSwapChain *vulkanSwapChain,
-  const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts,
-  VkCommandPool &commandPool)
+  const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts)
 {
     this->device = device;
     this->vulkanSwapChain = vulkanSwapChain;
 
-    createTextures(commandPool);
+    createTextures();
     createRenderPass();
     createPushConstantRange();
     createGraphicsPipeline(descriptorSetLayouts);
     createFramebuffer();
+    createWorkerCommands();
 }
 
 void Rasterizer::shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts)
 {
-    vkDestroyPipeline(device->getLogicalDevice(), graphics_pipeline, nullptr);
+    // frames in flight may still use the old pipeline
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device, old_pipeline = graphics_pipeline, old_layout = pipeline_layout]() {
+        vkDestroyPipeline(logical_device, old_pipeline, nullptr);
+        vkDestroyPipelineLayout(logical_device, old_layout, nullptr);
+    });
     createGraphicsPipeline(descriptor_set_layouts);
 }
 
+void Rasterizer::resize()
+{
+    // frames in flight still render into the old targets
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device,
+                                      old_framebuffers = framebuffer,
+                                      old_textures = offscreenTextures,
+                                      old_depth = depthBufferImage]() mutable {
+        for (VkFramebuffer old_framebuffer : old_framebuffers) {
+            vkDestroyFramebuffer(logical_device, old_framebuffer, nullptr);
+        }
+        for (Texture &texture : old_textures) texture.cleanUp();
+        old_depth.cleanUp();
+    });
+
+    // the render pass only depends on the formats and the pipeline has a dynamic viewport
+    createTextures();
+    createFramebuffer();
+}
+
 Texture &Rasterizer::getOffscreenTexture(uint32_t index) { return offscreenTextures[index]; }
 
 void Rasterizer::setPushConstant(PushConstantRasterizer pushConstant) { this->pushConstant = pushConstant; }
 
+void Rasterizer::setLodSelection(glm::vec3 camera_position, float projection_scale)
+{
+    lod_camera_position = camera_position;
+    lod_projection_scale = projection_scale;
+}
+
 void Rasterizer::recordCommands(VkCommandBuffer &commandBuffer,
-  uint32_t image_index,
+  uint32_t frame_index,
   Scene *scene,
-  const std::vector<VkDescriptorSet> &descriptorSets)
+  const std::vector<VkDescriptorSet> &descriptorSets,
+  const std::vector<uint32_t> &dynamicOffsets)
 {
     // information about how to begin a render pass (only needed for graphical
     // applications)
@@ -61,59 +94,150 @@ void Rasterizer::recordCommands(VkCommandBuffer &commandBuffer,
 
     render_pass_begin_info.pClearValues = clear_values.data();
     render_pass_begin_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
-    render_pass_begin_info.framebuffer = framebuffer[image_index];
+    render_pass_begin_info.framebuffer = framebuffer[frame_index];
+
+    collectDrawItems(scene);
+
+    // every worker records its range of draws into its own secondary command buffer
+    const std::vector<WorkerCommands> &frame_worker_commands = worker_commands[frame_index];
+    const uint32_t recorded_ranges = parallelRecorder.record(static_cast<uint32_t>(draw_items.size()),
+      MIN_DRAWS_PER_WORKER,
+      [&](uint32_t worker, uint32_t begin, uint32_t end) {
+          recordDraws(frame_worker_commands[worker], frame_index, begin, end, scene, descriptorSets, dynamicOffsets);
+      });
+
+    std::vector<VkCommandBuffer> secondary_command_buffers;
+    secondary_command_buffers.reserve(recorded_ranges);
+    for (uint32_t r = 0; r < recorded_ranges; r++) {
+        secondary_command_buffers.push_back(frame_worker_commands[r].command_buffer);
+    }
 
     // begin render pass
-    vkCmdBeginRenderPass(commandBuffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-    // bind pipeline to be used in render pass
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+    if (!secondary_command_buffers.empty()) {
+        vkCmdExecuteCommands(commandBuffer,
+          static_cast<uint32_t>(secondary_command_buffers.size()),
+          secondary_command_buffers.data());
+    }
+
+    // end render pass
+    vkCmdEndRenderPass(commandBuffer);
+}
 
+void Rasterizer::collectDrawItems(Scene *scene)
+{
+    draw_items.clear();
     for (uint32_t m = 0; m < static_cast<uint32_t>(scene->getModelCount()); m++) {
-        // for GCC doen't allow references on rvalues go like that ...
-        pushConstant.model = scene->getModelMatrix(0);
-        // just "Push" constants to given shader stage directly (no buffer)
-        vkCmdPushConstants(commandBuffer,
-          pipeline_layout,
-          VK_SHADER_STAGE_VERTEX_BIT,// stage to push constants to
-          0,// offset to push constants to update
-          sizeof(PushConstantRasterizer),// size of data being pushed
-          &pushConstant);// using model of current mesh (can be array)
-
-        for (unsigned int k = 0; k < scene->getMeshCount(m); k++) {
-            // list of vertex buffers we want to draw
-            VkBuffer vertex_buffers[] = { scene->getVertexBuffer(m, k) };// buffers to bind
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(commandBuffer,
-              0,
-              1,
-              vertex_buffers,
-              offsets);// command to bind vertex buffer before drawing with them
-
-            // bind mesh index buffer with 0 offset and using the uint32 type
-            vkCmdBindIndexBuffer(commandBuffer, scene->getIndexBuffer(m, k), 0, VK_INDEX_TYPE_UINT32);
-
-            // bind descriptor sets
-            vkCmdBindDescriptorSets(commandBuffer,
-              VK_PIPELINE_BIND_POINT_GRAPHICS,
+        for (uint32_t k = 0; k < scene->getMeshCount(m); k++) {
+            const uint32_t submesh_count = static_cast<uint32_t>(scene->getLods(m, k)[0].submeshes.size());
+            for (uint32_t s = 0; s < submesh_count; s++) draw_items.push_back({ m, k, s });
+        }
+    }
+}
+
+void Rasterizer::recordDraws(const WorkerCommands &commands,
+  uint32_t frame_index,
+  uint32_t begin,
+  uint32_t end,
+  Scene *scene,
+  const std::vector<VkDescriptorSet> &descriptorSets,
+  const std::vector<uint32_t> &dynamicOffsets)
+{
+    // the frame this pool was used for last time has finished
+    VkResult result = vkResetCommandPool(device->getLogicalDevice(), commands.command_pool, 0);
+    ASSERT_VULKAN(result, "Failed to reset a worker command pool!")
+
+    VkCommandBufferInheritanceInfo inheritance_info{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.renderPass = render_pass;
+    inheritance_info.subpass = 0;
+    inheritance_info.framebuffer = framebuffer[frame_index];
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags =
+      VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    VkCommandBuffer commandBuffer = commands.command_buffer;
+    result = vkBeginCommandBuffer(commandBuffer, &begin_info);
+    ASSERT_VULKAN(result, "Failed to start recording a secondary command buffer!")
+
+    // no state is inherited from the primary command buffer; bound once per worker
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+
+    const VkExtent2D &swap_chain_extent = vulkanSwapChain->getSwapChainExtent();
+    VkViewport viewport{ 0.0f, 0.0f, (float)swap_chain_extent.width, (float)swap_chain_extent.height, 0.0f, 1.0f };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    VkRect2D scissor{ { 0, 0 }, swap_chain_extent };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(commandBuffer,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      pipeline_layout,
+      0,
+      static_cast<uint32_t>(descriptorSets.size()),
+      descriptorSets.data(),
+      static_cast<uint32_t>(dynamicOffsets.size()),
+      dynamicOffsets.data());
+
+    // all meshes share the geometry pool's buffers; usually they are bound once per worker
+    VkBuffer bound_vertex_buffer = VK_NULL_HANDLE;
+    VkBuffer bound_index_buffer = VK_NULL_HANDLE;
+    uint32_t pushed_model = UINT32_MAX;
+
+    for (uint32_t d = begin; d < end; d++) {
+        const DrawItem &item = draw_items[d];
+
+        if (item.model != pushed_model) {
+            pushed_model = item.model;
+            // for GCC doen't allow references on rvalues go like that ...
+            PushConstantRasterizer modelPushConstant = pushConstant;
+            modelPushConstant.model = scene->getModelMatrix(0);
+            // just "Push" constants to given shader stage directly (no buffer)
+            vkCmdPushConstants(commandBuffer,
               pipeline_layout,
-              0,
-              static_cast<uint32_t>(descriptorSets.size()),
-              descriptorSets.data(),
-              0,
-              nullptr);
-
-            // execute pipeline
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(scene->getIndexCount(m, k)), 1, 0, 0, 0);
+              VK_SHADER_STAGE_VERTEX_BIT,// stage to push constants to
+              0,// offset to push constants to update
+              sizeof(PushConstantRasterizer),// size of data being pushed
+              &modelPushConstant);// using model of current mesh (can be array)
         }
+
+        Mesh *mesh = scene->getMesh(item.model, item.mesh);
+        if (mesh->getVertexBuffer() != bound_vertex_buffer) {
+            bound_vertex_buffer = mesh->getVertexBuffer();
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &bound_vertex_buffer, offsets);
+        }
+        if (mesh->getIndexBuffer() != bound_index_buffer) {
+            bound_index_buffer = mesh->getIndexBuffer();
+            vkCmdBindIndexBuffer(commandBuffer, bound_index_buffer, 0, VK_INDEX_TYPE_UINT32);
+        }
+
+        // the submesh in the level of detail its distance allows; the first
+        // instance carries the object description index of the level 0
+        // submesh to the shaders (gl_InstanceIndex)
+        const uint32_t level =
+          scene->selectLod(item.model, item.submesh, lod_camera_position, lod_projection_scale);
+        const Submesh &submesh = scene->getLods(item.model, item.mesh)[level].submeshes[item.submesh];
+        if (submesh.index_count == 0) continue;
+        vkCmdDrawIndexed(commandBuffer,
+          submesh.index_count,
+          1,
+          mesh->getFirstIndex() + submesh.first_index,
+          mesh->getVertexOffset(),
+          scene->getObjectDescriptionOffset(item.model) + item.submesh);
     }
 
-    // end render pass
-    vkCmdEndRenderPass(commandBuffer);
+    result = vkEndCommandBuffer(commandBuffer);
+    ASSERT_VULKAN(result, "Failed to stop recording a secondary command buffer!")
 }
 
 void Rasterizer::cleanUp()
 {
+    cleanUpWorkerCommands();
+
     for (auto framebuffer : framebuffer) { vkDestroyFramebuffer(device->getLogicalDevice(), framebuffer, nullptr); }
 
     for (Texture texture : offscreenTextures) { texture.cleanUp(); }
@@ -145,9 +269,9 @@ void Rasterizer::createRenderPass()
 
     // framebuffer data will be stored as an image, but images can be given
     // different layouts to give optimal use for certain operations
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_GENERAL;// image data layout before render pass starts
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;// image data layout after render pass (to
-                                                           // change to)
+    // the render graph transitions the image before and after the pass
+    color_attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     // depth attachment of render pass
     VkAttachmentDescription depth_attachment{};
@@ -184,7 +308,7 @@ void Rasterizer::createRenderPass()
     subpass.pDepthStencilAttachment = &depth_attachment_reference;
 
     // need to determine when layout transitions occur using subpass dependencies
-    std::array<VkSubpassDependency, 1> subpass_dependencies;
+    std::array<VkSubpassDependency, 2> subpass_dependencies;
 
     // conversion from VK_IMAGE_LAYOUT_UNDEFINED to
     // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL transition must happen after ....
@@ -199,6 +323,19 @@ void Rasterizer::createRenderPass()
     subpass_dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     subpass_dependencies[0].dependencyFlags = 0;// VK_DEPENDENCY_BY_REGION_BIT;
 
+    // the depth buffer is shared by all frames in flight: clearing it for this frame
+    // must wait for the depth tests of the frame before
+    subpass_dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    subpass_dependencies[1].srcStageMask =
+      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpass_dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[1].dstSubpass = 0;
+    subpass_dependencies[1].dstStageMask =
+      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpass_dependencies[1].dstAccessMask =
+      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[1].dependencyFlags = 0;
+
     std::array<VkAttachmentDescription, 2> render_pass_attachments = { color_attachment, depth_attachment };
 
     // create info for render pass
@@ -217,7 +354,7 @@ void Rasterizer::createRenderPass()
 
 void Rasterizer::createFramebuffer()
 {
-    framebuffer.resize(vulkanSwapChain->getNumberSwapChainImages());
+    framebuffer.resize(MAX_FRAME_DRAWS);
 
     for (size_t i = 0; i < framebuffer.size(); i++) {
         std::array<VkImageView, 2> attachments = { offscreenTextures[i].getImageView(),
@@ -239,6 +376,46 @@ void Rasterizer::createFramebuffer()
     }
 }
 
+void Rasterizer::createWorkerCommands()
+{
+    QueueFamilyIndices queue_family_indices = device->getQueueFamilies();
+
+    for (std::vector<WorkerCommands> &frame_worker_commands : worker_commands) {
+        frame_worker_commands.resize(parallelRecorder.getWorkerCount());
+        for (WorkerCommands &commands : frame_worker_commands) {
+            VkCommandPoolCreateInfo pool_info{};
+            pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            pool_info.queueFamilyIndex = queue_family_indices.graphics_family;
+
+            VkResult result =
+              vkCreateCommandPool(device->getLogicalDevice(), &pool_info, nullptr, &commands.command_pool);
+            ASSERT_VULKAN(result, "Failed to create a worker command pool!")
+
+            VkCommandBufferAllocateInfo command_buffer_alloc_info{};
+            command_buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            command_buffer_alloc_info.commandPool = commands.command_pool;
+            command_buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            command_buffer_alloc_info.commandBufferCount = 1;
+
+            result = vkAllocateCommandBuffers(
+              device->getLogicalDevice(), &command_buffer_alloc_info, &commands.command_buffer);
+            ASSERT_VULKAN(result, "Failed to allocate a secondary command buffer!")
+        }
+    }
+}
+
+void Rasterizer::cleanUpWorkerCommands()
+{
+    // frees the command buffers as well
+    for (std::vector<WorkerCommands> &frame_worker_commands : worker_commands) {
+        for (WorkerCommands &commands : frame_worker_commands) {
+            vkDestroyCommandPool(device->getLogicalDevice(), commands.command_pool, nullptr);
+        }
+        frame_worker_commands.clear();
+    }
+}
+
 void Rasterizer::createPushConstantRange()
 {
     // define push constant values (no 'create' needed)
@@ -247,13 +424,13 @@ void Rasterizer::createPushConstantRange()
     push_constant_range.size = sizeof(PushConstantRasterizer);
 }
 
-void Rasterizer::createTextures(VkCommandPool &commandPool)
+void Rasterizer::createTextures()
 {
-    offscreenTextures.resize(vulkanSwapChain->getNumberSwapChainImages());
-
-    VkCommandBuffer cmdBuffer = commandBufferManager.beginCommandBuffer(device->getLogicalDevice(), commandPool);
+    // no layout transitions (and no submit to wait for) here: the render graph and the
+    // render pass take the images from VK_IMAGE_LAYOUT_UNDEFINED every frame
+    offscreenTextures.resize(MAX_FRAME_DRAWS);
 
-    for (uint32_t index = 0; index < static_cast<uint32_t>(vulkanSwapChain->getNumberSwapChainImages()); index++) {
+    for (uint32_t index = 0; index < static_cast<uint32_t>(MAX_FRAME_DRAWS); index++) {
         Texture texture{};
         const VkExtent2D &swap_chain_extent = vulkanSwapChain->getSwapChainExtent();
         const VkFormat &swap_chain_image_format = vulkanSwapChain->getSwapChainFormat();
@@ -266,15 +443,11 @@ void Rasterizer::createTextures(VkCommandPool &commandPool)
           VK_IMAGE_TILING_OPTIMAL,
           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT
             | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+          MemoryCategory::RenderTarget);
 
         texture.createImageView(device, swap_chain_image_format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 
-        // --- WE NEED A DIFFERENT LAYOUT FOR USAGE
-        VulkanImage &image = texture.getVulkanImage();
-        image.transitionImageLayout(
-          cmdBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 1, VK_IMAGE_ASPECT_COLOR_BIT);
-
         offscreenTextures[index] = texture;
     }
 
@@ -293,24 +466,12 @@ void Rasterizer::createTextures(VkCommandPool &commandPool)
       depth_format,
       VK_IMAGE_TILING_OPTIMAL,
       VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::RenderTarget);
 
     // depth buffer image view
     // MIP LEVELS: for depth texture we only want 1 level :)
     depthBufferImage.createImageView(device, depth_format, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 1);
-
-    // --- WE NEED A DIFFERENT LAYOUT FOR USAGE
-    VulkanImage &vulkanImage = depthBufferImage.getVulkanImage();
-    vulkanImage.transitionImageLayout(device->getLogicalDevice(),
-      device->getGraphicsQueue(),
-      commandPool,
-      VK_IMAGE_LAYOUT_UNDEFINED,
-      VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-      VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT,
-      1);
-
-    commandBufferManager.endAndSubmitCommandBuffer(
-      device->getLogicalDevice(), commandPool, device->getGraphicsQueue(), cmdBuffer);
 }
 
 void Rasterizer::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts)
@@ -321,8 +482,10 @@ void Rasterizer::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     rasterizer_shader_dir << RELATIVE_RESOURCE_PATH;
     rasterizer_shader_dir << "Shaders/rasterizer/";
 
+    const VertexLayout vertex_layout = sceneConfig::getVertexLayout();
+
     ShaderHelper shaderHelper;
-    shaderHelper.compileShader(rasterizer_shader_dir.str(), "shader.vert");
+    shaderHelper.compileShader(rasterizer_shader_dir.str(), "shader.vert", vertex::getShaderDefines(vertex_layout));
     shaderHelper.compileShader(rasterizer_shader_dir.str(), "shader.frag");
 
     File vertexFile(shaderHelper.getShaderSpvDir(rasterizer_shader_dir.str(), "shader.vert"));
@@ -356,12 +519,13 @@ void Rasterizer::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     // texture coords, normals, etc) is as a whole
     VkVertexInputBindingDescription binding_description{};
     binding_description.binding = 0;
-    binding_description.stride = sizeof(Vertex);
+    binding_description.stride = vertex::getVertexStride(vertex_layout);
     binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;// how to move between data after each
                                                                 // vertex.
 
     // how the data for an attribute is defined within a vertex
-    std::array<VkVertexInputAttributeDescription, 4> attribute_describtions = vertex::getVertexInputAttributeDesc();
+    std::vector<VkVertexInputAttributeDescription> attribute_describtions =
+      vertex::getVertexInputAttributeDesc(vertex_layout);
 
     // CREATE PIPELINE
     // 1.) Vertex input
@@ -378,28 +542,17 @@ void Rasterizer::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     input_assembly.primitiveRestartEnable = VK_FALSE;
 
-    // viewport & scissor
-    // create a viewport info struct
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    const VkExtent2D &swap_chain_extent = vulkanSwapChain->getSwapChainExtent();
-    viewport.width = (float)swap_chain_extent.width;
-    viewport.height = (float)swap_chain_extent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    // create a scissor info struct
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = swap_chain_extent;
-
+    // viewport & scissor are set while recording so a resize does not need a new pipeline
     VkPipelineViewportStateCreateInfo viewport_state_create_info{};
     viewport_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewport_state_create_info.viewportCount = 1;
-    viewport_state_create_info.pViewports = &viewport;
     viewport_state_create_info.scissorCount = 1;
-    viewport_state_create_info.pScissors = &scissor;
+
+    std::array<VkDynamicState, 2> dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamic_state_create_info{};
+    dynamic_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state_create_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+    dynamic_state_create_info.pDynamicStates = dynamic_states.data();
 
     // RASTERIZER
     VkPipelineRasterizationStateCreateInfo rasterizer_create_info{};
@@ -472,7 +625,7 @@ void Rasterizer::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
     graphics_pipeline_create_info.pVertexInputState = &vertex_input_create_info;
     graphics_pipeline_create_info.pInputAssemblyState = &input_assembly;
     graphics_pipeline_create_info.pViewportState = &viewport_state_create_info;
-    graphics_pipeline_create_info.pDynamicState = nullptr;
+    graphics_pipeline_create_info.pDynamicState = &dynamic_state_create_info;
     graphics_pipeline_create_info.pRasterizationState = &rasterizer_create_info;
     graphics_pipeline_create_info.pMultisampleState = &multisample_create_info;
     graphics_pipeline_create_info.pColorBlendState = &color_blending_create_info;
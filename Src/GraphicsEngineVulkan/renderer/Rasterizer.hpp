@@ -1,6 +1,12 @@
 #pragma once
 #include <vulkan/vulkan.h>
 
+#include <array>
+#include <vector>
+
+
+#include "Globals.hpp"
+#include "ParallelRecorder.hpp"
 #include "PushConstantRasterizer.hpp"
 #include "Scene.hpp"
 #include "Texture.hpp"
@@ -14,19 +20,27 @@ class Rasterizer
 
     void init(VulkanDevice *device,
       VulkanSwapChain *vulkanSwapChain,
-      const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts,
-      VkCommandPool &commandPool);
+      const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts);
 
     void shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts);
+    // recreates the size dependent targets for the current swapchain extent; the old
+    // ones go to the deletion queue
+    void resize();
 
+    // one offscreen target per frame in flight; index is the frame, not the swapchain image
     Texture &getOffscreenTexture(uint32_t index);
 
     void setPushConstant(PushConstantRasterizer pushConstant);
+    // camera the levels of detail are chosen for; see lod::getProjectionScale
+    void setLodSelection(glm::vec3 camera_position, float projection_scale);
 
+    // the draws are recorded into secondary command buffers on the recorder's
+    // workers and executed inside the render pass of commandBuffer
     void recordCommands(VkCommandBuffer &commandBuffer,
-      uint32_t image_index,
+      uint32_t frame_index,
       Scene *scene,
-      const std::vector<VkDescriptorSet> &descriptorSets);
+      const std::vector<VkDescriptorSet> &descriptorSets,
+      const std::vector<uint32_t> &dynamicOffsets);
 
     void cleanUp();
 
@@ -36,7 +50,27 @@ class Rasterizer
     VulkanDevice *device{ VK_NULL_HANDLE };
     VulkanSwapChain *vulkanSwapChain{ VK_NULL_HANDLE };
 
-    CommandBufferManager commandBufferManager;
+    // below this many draws a worker costs more to wake than it saves
+    static constexpr uint32_t MIN_DRAWS_PER_WORKER = 256;
+
+    // one submesh of a mesh; its level of detail is chosen while recording
+    struct DrawItem
+    {
+        uint32_t model{ 0 };
+        uint32_t mesh{ 0 };
+        uint32_t submesh{ 0 };
+    };
+    std::vector<DrawItem> draw_items;
+
+    // a command pool may only be used by one thread at a time and is reset once
+    // the frame using it has finished, so every worker has one per frame in flight
+    struct WorkerCommands
+    {
+        VkCommandPool command_pool{ VK_NULL_HANDLE };
+        VkCommandBuffer command_buffer{ VK_NULL_HANDLE };
+    };
+    ParallelRecorder parallelRecorder;
+    std::array<std::vector<WorkerCommands>, MAX_FRAME_DRAWS> worker_commands;
 
     std::vector<VkFramebuffer> framebuffer;
     std::vector<Texture> offscreenTextures;
@@ -45,13 +79,27 @@ class Rasterizer
     VkPushConstantRange push_constant_range{ VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM, 0, 0 };
     PushConstantRasterizer pushConstant{ glm::mat4(1.f) };
 
+    glm::vec3 lod_camera_position{ 0.f };
+    float lod_projection_scale{ 0.f };
+
     VkPipeline graphics_pipeline{ VK_NULL_HANDLE };
     VkPipelineLayout pipeline_layout{ VK_NULL_HANDLE };
     VkRenderPass render_pass{ VK_NULL_HANDLE };
 
-    void createTextures(VkCommandPool &commandPool);
+    void createTextures();
     void createGraphicsPipeline(const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts);
     void createRenderPass();
     void createFramebuffer();
     void createPushConstantRange();
+    void createWorkerCommands();
+    void cleanUpWorkerCommands();
+
+    void collectDrawItems(Scene *scene);
+    void recordDraws(const WorkerCommands &commands,
+      uint32_t frame_index,
+      uint32_t begin,
+      uint32_t end,
+      Scene *scene,
+      const std::vector<VkDescriptorSet> &descriptorSets,
+      const std::vector<uint32_t> &dynamicOffsets);
 };
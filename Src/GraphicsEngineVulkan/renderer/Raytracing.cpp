@@ -7,6 +7,7 @@
 
 #include "File.hpp"
 #include "MemoryHelper.hpp"
+#include "SceneConfig.hpp"
 #include "ShaderHelper.hpp"
 #include "VulkanRendererConfig.hpp"
 #include <Utilities.hpp>
@@ -24,13 +25,29 @@ void Raytracing::init(VulkanDevice *device, const std::vector<VkDescriptorSetLay
 
 void Raytracing::shaderHotReload(const std::vector<VkDescriptorSetLayout> &descriptor_set_layouts)
 {
-    vkDestroyPipeline(device->getLogicalDevice(), graphicsPipeline, nullptr);
+    // frames in flight may still use the old pipeline
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device, old_pipeline = graphicsPipeline, old_layout = pipeline_layout]() {
+        vkDestroyPipeline(logical_device, old_pipeline, nullptr);
+        vkDestroyPipelineLayout(logical_device, old_layout, nullptr);
+    });
     createGraphicsPipeline(descriptor_set_layouts);
+
+    // the shader group handles belong to the new pipeline
+    device->getDeletionQueue().push([raygen = raygenShaderBindingTableBuffer,
+                                      miss = missShaderBindingTableBuffer,
+                                      hit = hitShaderBindingTableBuffer]() mutable {
+        raygen.cleanUp();
+        miss.cleanUp();
+        hit.cleanUp();
+    });
+    createSBT();
 }
 
 void Raytracing::recordCommands(VkCommandBuffer &commandBuffer,
   VulkanSwapChain *vulkanSwapChain,
-  const std::vector<VkDescriptorSet> &descriptorSets)
+  const std::vector<VkDescriptorSet> &descriptorSets,
+  const std::vector<uint32_t> &dynamicOffsets)
 {
     uint32_t handle_size = raytracing_properties.shaderGroupHandleSize;
     uint32_t handle_size_aligned = align_up(handle_size, raytracing_properties.shaderGroupHandleAlignment);
@@ -77,8 +94,8 @@ void Raytracing::recordCommands(VkCommandBuffer &commandBuffer,
       0,
       static_cast<uint32_t>(descriptorSets.size()),
       descriptorSets.data(),
-      0,
-      nullptr);
+      static_cast<uint32_t>(dynamicOffsets.size()),
+      dynamicOffsets.data());
 
     const VkExtent2D &swap_chain_extent = vulkanSwapChain->getSwapChainExtent();
     pvkCmdTraceRaysKHR(commandBuffer,
@@ -132,7 +149,8 @@ void Raytracing::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
 
     ShaderHelper shaderHelper;
     shaderHelper.compileShader(raytracing_shader_dir.str(), raygen_shader);
-    shaderHelper.compileShader(raytracing_shader_dir.str(), chit_shader);
+    shaderHelper.compileShader(
+      raytracing_shader_dir.str(), chit_shader, vertex::getShaderDefines(sceneConfig::getVertexLayout()));
     shaderHelper.compileShader(raytracing_shader_dir.str(), miss_shader);
     shaderHelper.compileShader(raytracing_shader_dir.str(), shadow_shader);
 
@@ -184,6 +202,7 @@ void Raytracing::createGraphicsPipeline(const std::vector<VkDescriptorSetLayout>
 
     enum StageIndices { eRaygen, eMiss, eMiss2, eClosestHit, eShaderGroupCount };
 
+    shader_groups.clear();
     shader_groups.reserve(4);
     VkRayTracingShaderGroupCreateInfoKHR shader_group_create_infos[4];
 
@@ -312,27 +331,28 @@ void Raytracing::createSBT()
     const VkMemoryPropertyFlags memoryUsageFlags =
       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-    raygenShaderBindingTableBuffer.create(device, handle_size, bufferUsageFlags, memoryUsageFlags);
-
-    missShaderBindingTableBuffer.create(device, 2 * handle_size, bufferUsageFlags, memoryUsageFlags);
-
-    hitShaderBindingTableBuffer.create(device, handle_size, bufferUsageFlags, memoryUsageFlags);
-
-    void *mapped_raygen = nullptr;
-    vkMapMemory(device->getLogicalDevice(),
-      raygenShaderBindingTableBuffer.getBufferMemory(),
-      0,
-      VK_WHOLE_SIZE,
-      0,
-      &mapped_raygen);
-
-    void *mapped_miss = nullptr;
-    vkMapMemory(
-      device->getLogicalDevice(), missShaderBindingTableBuffer.getBufferMemory(), 0, VK_WHOLE_SIZE, 0, &mapped_miss);
-
-    void *mapped_rchit = nullptr;
-    vkMapMemory(
-      device->getLogicalDevice(), hitShaderBindingTableBuffer.getBufferMemory(), 0, VK_WHOLE_SIZE, 0, &mapped_rchit);
+    raygenShaderBindingTableBuffer.create(device,
+      handle_size,
+      bufferUsageFlags,
+      memoryUsageFlags,
+      MemoryCategory::Other);
+
+    missShaderBindingTableBuffer.create(device,
+      2 * handle_size,
+      bufferUsageFlags,
+      memoryUsageFlags,
+      MemoryCategory::Other);
+
+    hitShaderBindingTableBuffer.create(device,
+      handle_size,
+      bufferUsageFlags,
+      memoryUsageFlags,
+      MemoryCategory::Other);
+
+    // host visible buffers are persistently mapped by the allocator
+    void *mapped_raygen = raygenShaderBindingTableBuffer.getMappedData();
+    void *mapped_miss = missShaderBindingTableBuffer.getMappedData();
+    void *mapped_rchit = hitShaderBindingTableBuffer.getMappedData();
 
     memcpy(mapped_raygen, handles.data(), handle_size);
     memcpy(mapped_miss, handles.data() + handle_size_aligned, handle_size * 2);
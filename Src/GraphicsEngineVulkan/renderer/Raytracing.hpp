@@ -17,7 +17,8 @@ class Raytracing
 
     void recordCommands(VkCommandBuffer &commandBuffer,
       VulkanSwapChain *vulkanSwapChain,
-      const std::vector<VkDescriptorSet> &descriptorSets);
+      const std::vector<VkDescriptorSet> &descriptorSets,
+      const std::vector<uint32_t> &dynamicOffsets);
 
     void cleanUp();
 
@@ -0,0 +1,539 @@
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+
+#include "Utilities.hpp"
+#include "VulkanDevice.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// what a resource went through so far in the recorded passes
+struct ResourceState
+{
+    VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+    // last write (or layout transition) and the reads since then
+    VkPipelineStageFlags2 write_stages{ VK_PIPELINE_STAGE_2_NONE };
+    VkAccessFlags2 write_access{ VK_ACCESS_2_NONE };
+    VkPipelineStageFlags2 read_stages{ VK_PIPELINE_STAGE_2_NONE };
+    // stages and accesses the last write has been made visible to
+    VkPipelineStageFlags2 visible_stages{ VK_PIPELINE_STAGE_2_NONE };
+    VkAccessFlags2 visible_access{ VK_ACCESS_2_NONE };
+};
+
+// all uses of one resource by one pass
+struct MergedUse
+{
+    RenderGraphAccess access;
+    bool read{ false };
+    bool write{ false };
+};
+
+VkImageCreateInfo imageCreateInfo(const RenderGraphImageDesc &desc)
+{
+    VkImageCreateInfo image_create_info{};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.extent = { desc.extent.width, desc.extent.height, 1 };
+    image_create_info.mipLevels = 1;
+    image_create_info.arrayLayers = 1;
+    image_create_info.format = desc.format;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_create_info.usage = desc.usage;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    return image_create_info;
+}
+
+}// namespace
+
+RenderGraph::RenderGraph() {}
+
+void RenderGraph::init(VulkanDevice *device) { this->device = device; }
+
+void RenderGraph::reset(uint32_t frame_index)
+{
+    this->frame_index = frame_index;
+    passes.clear();
+    resources.clear();
+}
+
+RenderGraph::Handle
+  RenderGraph::importImage(const std::string &name, VkImage image, VkImageAspectFlags aspect, VkImageLayout layout)
+{
+    Resource resource;
+    resource.name = name;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.initial_layout = layout;
+    resource.final_layout = layout;
+    resources.push_back(resource);
+    return static_cast<Handle>(resources.size()) - 1;
+}
+
+RenderGraph::Handle RenderGraph::createImage(const std::string &name, const RenderGraphImageDesc &desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.transient = true;
+    resource.desc = desc;
+    resource.aspect = desc.aspect;
+    resources.push_back(resource);
+    return static_cast<Handle>(resources.size()) - 1;
+}
+
+RenderGraph::Handle RenderGraph::addPass(const std::string &name, ExecuteFunction execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    return static_cast<Handle>(passes.size()) - 1;
+}
+
+void RenderGraph::read(Handle pass, Handle resource, RenderGraphUsage usage)
+{
+    passes[pass].uses.push_back({ resource, usage, false });
+}
+
+void RenderGraph::write(Handle pass, Handle resource, RenderGraphUsage usage)
+{
+    passes[pass].uses.push_back({ resource, usage, true });
+}
+
+void RenderGraph::setOutput(Handle pass) { passes[pass].output = true; }
+
+void RenderGraph::compile()
+{
+    cull();
+    computeLifetimes();
+    planTransientMemory();
+    computeBarriers();
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    for (Pass &pass : passes) {
+        if (pass.culled) continue;
+
+        // all images of the pass in one call
+        if (!pass.barriers.empty()) {
+            VkDependencyInfo dependency_info{};
+            dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(pass.barriers.size());
+            dependency_info.pImageMemoryBarriers = pass.barriers.data();
+            vkCmdPipelineBarrier2(commandBuffer, &dependency_info);
+        }
+
+        if (pass.execute) pass.execute(commandBuffer);
+    }
+}
+
+uint32_t RenderGraph::getBarrierCount() const
+{
+    uint32_t count = 0;
+    for (const Pass &pass : passes) count += static_cast<uint32_t>(pass.barriers.size());
+    return count;
+}
+
+VkDeviceSize RenderGraph::getTransientBytes() const
+{
+    VkDeviceSize bytes = 0;
+    for (const VkMemoryRequirements &slot : slots) bytes += slot.size;
+    return bytes;
+}
+
+VkDeviceSize RenderGraph::getUnaliasedTransientBytes() const
+{
+    VkDeviceSize bytes = 0;
+    for (const Resource &resource : resources) {
+        if (resource.transient && resource.lifetime.isValid()) bytes += resource.requirements.size;
+    }
+    return bytes;
+}
+
+std::vector<uint32_t> RenderGraph::planAliasing(const std::vector<Lifetime> &lifetimes,
+  const std::vector<VkMemoryRequirements> &requirements,
+  std::vector<VkMemoryRequirements> &slots)
+{
+    std::vector<uint32_t> assigned(lifetimes.size(), NO_SLOT);
+    slots.clear();
+    // last pass of the image that occupies a slot at the moment
+    std::vector<uint32_t> slot_last;
+
+    // in order of first use, so a slot is handed on as soon as its image is done
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(lifetimes.size()); i++) {
+        if (lifetimes[i].isValid()) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&lifetimes](uint32_t a, uint32_t b) {
+        return lifetimes[a].first < lifetimes[b].first;
+    });
+
+    for (uint32_t i : order) {
+        const VkMemoryRequirements &needed = requirements[i];
+
+        // the free slot that has to grow the least
+        uint32_t best = NO_SLOT;
+        VkDeviceSize best_growth = 0;
+        for (uint32_t s = 0; s < static_cast<uint32_t>(slots.size()); s++) {
+            if (slot_last[s] >= lifetimes[i].first) continue;
+            if ((slots[s].memoryTypeBits & needed.memoryTypeBits) == 0) continue;
+
+            const VkDeviceSize growth = needed.size > slots[s].size ? needed.size - slots[s].size : 0;
+            if (best == NO_SLOT || growth < best_growth) {
+                best = s;
+                best_growth = growth;
+            }
+        }
+
+        if (best == NO_SLOT) {
+            slots.push_back(needed);
+            slot_last.push_back(lifetimes[i].last);
+            assigned[i] = static_cast<uint32_t>(slots.size()) - 1;
+            continue;
+        }
+
+        VkMemoryRequirements &slot = slots[best];
+        slot.size = std::max(slot.size, needed.size);
+        slot.alignment = std::max(slot.alignment, needed.alignment);
+        slot.memoryTypeBits &= needed.memoryTypeBits;
+        slot_last[best] = lifetimes[i].last;
+        assigned[i] = best;
+    }
+    return assigned;
+}
+
+RenderGraphAccess RenderGraph::getAccess(RenderGraphUsage usage, bool write)
+{
+    switch (usage) {
+    case RenderGraphUsage::ColorAttachment:
+        return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            write ? VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    case RenderGraphUsage::DepthAttachment:
+        return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            write ? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                  : VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+            write ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+                  : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+    case RenderGraphUsage::SampledFragment:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    case RenderGraphUsage::SampledCompute:
+        return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    case RenderGraphUsage::StorageCompute:
+        return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            write ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+            VK_IMAGE_LAYOUT_GENERAL };
+    case RenderGraphUsage::StorageRayTracing:
+        return { VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
+            write ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+            VK_IMAGE_LAYOUT_GENERAL };
+    case RenderGraphUsage::TransferSrc:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            VK_ACCESS_2_TRANSFER_READ_BIT,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+    case RenderGraphUsage::TransferDst:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+    }
+    return {};
+}
+
+void RenderGraph::cleanUp()
+{
+    for (TransientSet &set : transient_sets) releaseTransients(set);
+    reset(0);
+}
+
+RenderGraph::~RenderGraph() {}
+
+void RenderGraph::cull()
+{
+    // walking backwards: a resource is needed if a pass that is kept reads it
+    // before it gets written again
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t p = passes.size(); p-- > 0;) {
+        Pass &pass = passes[p];
+
+        bool keep = pass.output;
+        for (const ResourceUse &use : pass.uses) keep = keep || (use.write && needed[use.resource]);
+        pass.culled = !keep;
+        if (!keep) continue;
+
+        for (const ResourceUse &use : pass.uses) {
+            if (use.write) needed[use.resource] = false;
+        }
+        for (const ResourceUse &use : pass.uses) {
+            if (!use.write) needed[use.resource] = true;
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (Resource &resource : resources) resource.lifetime = Lifetime{};
+
+    for (uint32_t p = 0; p < static_cast<uint32_t>(passes.size()); p++) {
+        if (passes[p].culled) continue;
+        for (const ResourceUse &use : passes[p].uses) {
+            Lifetime &lifetime = resources[use.resource].lifetime;
+            lifetime.first = std::min(lifetime.first, p);
+            lifetime.last = std::max(lifetime.last, p);
+        }
+    }
+}
+
+void RenderGraph::computeBarriers()
+{
+    std::vector<ResourceState> states(resources.size());
+    for (size_t r = 0; r < resources.size(); r++) {
+        states[r].layout = resources[r].transient ? VK_IMAGE_LAYOUT_UNDEFINED : resources[r].initial_layout;
+    }
+    // the image that used the memory of a slot before; its accesses must be done first
+    std::vector<ResourceState> slot_states(slots.size());
+
+    for (uint32_t p = 0; p < static_cast<uint32_t>(passes.size()); p++) {
+        Pass &pass = passes[p];
+        pass.barriers.clear();
+        if (pass.culled) continue;
+
+        std::vector<Handle> order;
+        std::vector<MergedUse> merged(resources.size());
+        for (const ResourceUse &use : pass.uses) {
+            MergedUse &m = merged[use.resource];
+            const RenderGraphAccess access = getAccess(use.usage, use.write);
+            if (!m.read && !m.write) {
+                order.push_back(use.resource);
+                m.access.layout = access.layout;
+            } else if (m.access.layout != access.layout) {
+                spdlog::error("Pass {} uses {} in two layouts!", pass.name, resources[use.resource].name);
+            }
+            m.access.stages |= access.stages;
+            m.access.access |= access.access;
+            m.read = m.read || !use.write;
+            m.write = m.write || use.write;
+        }
+
+        for (Handle r : order) {
+            const MergedUse &use = merged[r];
+            Resource &resource = resources[r];
+            ResourceState &state = states[r];
+
+            VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2 src_access = VK_ACCESS_2_NONE;
+            bool needed = false;
+
+            // a pure write does not keep the old content
+            const bool discard = use.write && !use.read;
+            const bool transition = use.access.layout != state.layout;
+            if (transition) {
+                needed = true;
+                src_stages = state.write_stages | state.read_stages;
+                src_access = state.write_access;
+            } else {
+                const bool visible = (state.visible_stages & use.access.stages) == use.access.stages
+                                     && (state.visible_access & use.access.access) == use.access.access;
+                if (use.read && state.write_stages != VK_PIPELINE_STAGE_2_NONE && !visible) {
+                    needed = true;
+                    src_stages |= state.write_stages;
+                    src_access |= state.write_access;
+                }
+                if (use.write && (state.write_stages | state.read_stages) != VK_PIPELINE_STAGE_2_NONE) {
+                    // write after write, and write after read (execution dependency only)
+                    needed = true;
+                    src_stages |= state.write_stages | state.read_stages;
+                    src_access |= state.write_access;
+                }
+            }
+
+            // first use of aliased memory waits for the image that used it before
+            if (resource.transient && resource.slot != NO_SLOT && p == resource.lifetime.first) {
+                const ResourceState &previous = slot_states[resource.slot];
+                if ((previous.write_stages | previous.read_stages) != VK_PIPELINE_STAGE_2_NONE) {
+                    needed = true;
+                    src_stages |= previous.write_stages | previous.read_stages;
+                    src_access |= previous.write_access;
+                }
+            }
+
+            if (needed) {
+                VkImageMemoryBarrier2 barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = src_stages;
+                barrier.srcAccessMask = src_access;
+                barrier.dstStageMask = use.access.stages;
+                barrier.dstAccessMask = use.access.access;
+                barrier.oldLayout = transition && discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+                barrier.newLayout = use.access.layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = resource.image;
+                barrier.subresourceRange = {
+                    resource.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS
+                };
+                pass.barriers.push_back(barrier);
+            }
+
+            state.layout = use.access.layout;
+            if (use.write) {
+                state.write_stages = use.access.stages;
+                state.write_access = use.access.access;
+                state.read_stages = VK_PIPELINE_STAGE_2_NONE;
+                state.visible_stages = VK_PIPELINE_STAGE_2_NONE;
+                state.visible_access = VK_ACCESS_2_NONE;
+            } else if (transition) {
+                // later stages have to wait for the layout transition
+                state.write_stages = use.access.stages;
+                state.write_access = VK_ACCESS_2_NONE;
+                state.read_stages = use.access.stages;
+                state.visible_stages = use.access.stages;
+                state.visible_access = use.access.access;
+            } else {
+                state.read_stages |= use.access.stages;
+                if (needed) {
+                    state.visible_stages |= use.access.stages;
+                    state.visible_access |= use.access.access;
+                }
+            }
+
+            if (resource.transient && resource.slot != NO_SLOT && p == resource.lifetime.last) {
+                slot_states[resource.slot] = state;
+            }
+        }
+    }
+
+    for (size_t r = 0; r < resources.size(); r++) resources[r].final_layout = states[r].layout;
+}
+
+void RenderGraph::planTransientMemory()
+{
+    slots.clear();
+
+    std::vector<Handle> transients;
+    for (Handle r = 0; r < static_cast<Handle>(resources.size()); r++) {
+        resources[r].slot = NO_SLOT;
+        if (resources[r].transient && resources[r].lifetime.isValid()) transients.push_back(r);
+    }
+    // the memory requirements come from the device
+    if (device == nullptr || transients.empty()) return;
+
+    std::vector<Lifetime> lifetimes;
+    std::vector<VkMemoryRequirements> requirements;
+    for (Handle r : transients) {
+        Resource &resource = resources[r];
+        const VkImageCreateInfo image_create_info = imageCreateInfo(resource.desc);
+
+        VkDeviceImageMemoryRequirements image_requirements{};
+        image_requirements.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+        image_requirements.pCreateInfo = &image_create_info;
+        VkMemoryRequirements2 memory_requirements{};
+        memory_requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        vkGetDeviceImageMemoryRequirements(device->getLogicalDevice(), &image_requirements, &memory_requirements);
+
+        resource.requirements = memory_requirements.memoryRequirements;
+        lifetimes.push_back(resource.lifetime);
+        requirements.push_back(resource.requirements);
+    }
+
+    std::vector<uint32_t> assigned = planAliasing(lifetimes, requirements, slots);
+    for (size_t i = 0; i < transients.size(); i++) resources[transients[i]].slot = assigned[i];
+
+    realizeTransients();
+}
+
+void RenderGraph::realizeTransients()
+{
+    // same images in the same slots as the last time this frame in flight was recorded: keep the memory
+    TransientSet &set = transient_sets[frame_index];
+    std::vector<RealizedImage> &realized_images = set.images;
+    std::vector<VmaAllocation> &realized_slots = set.slots;
+    bool unchanged = realized_slots.size() == slots.size();
+    std::vector<const Resource *> transients;
+    for (const Resource &resource : resources) {
+        if (resource.slot != NO_SLOT) transients.push_back(&resource);
+    }
+    unchanged = unchanged && transients.size() == realized_images.size();
+    for (size_t i = 0; unchanged && i < transients.size(); i++) {
+        const RealizedImage &realized = realized_images[i];
+        unchanged = realized.name == transients[i]->name && realized.desc == transients[i]->desc
+                    && realized.slot == transients[i]->slot;
+    }
+
+    if (!unchanged) {
+        releaseTransients(set);
+
+        const VmaAllocator vmaAllocator = device->getAllocator().getVmaAllocator();
+        for (const VkMemoryRequirements &slot : slots) {
+            VmaAllocationCreateInfo allocation_create_info =
+              Allocator::allocationCreateInfo(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            VmaAllocation allocation = VK_NULL_HANDLE;
+            VkResult result = vmaAllocateMemory(vmaAllocator, &slot, &allocation_create_info, &allocation, nullptr);
+            ASSERT_VULKAN(result, "Failed to allocate transient render target memory!")
+            device->getAllocator().getMemoryBudget().track(MemoryCategory::RenderTarget, slot.size);
+            realized_slots.push_back(allocation);
+        }
+
+        for (const Resource *resource : transients) {
+            RealizedImage realized;
+            realized.name = resource->name;
+            realized.desc = resource->desc;
+            realized.slot = resource->slot;
+
+            const VkImageCreateInfo image_create_info = imageCreateInfo(resource->desc);
+            VkResult result = vkCreateImage(device->getLogicalDevice(), &image_create_info, nullptr, &realized.image);
+            ASSERT_VULKAN(result, "Failed to create a transient image!")
+            result = vmaBindImageMemory(vmaAllocator, realized_slots[resource->slot], realized.image);
+            ASSERT_VULKAN(result, "Failed to bind a transient image to its memory!")
+
+            VkImageViewCreateInfo view_create_info{};
+            view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            view_create_info.image = realized.image;
+            view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            view_create_info.format = resource->desc.format;
+            view_create_info.subresourceRange = { resource->desc.aspect, 0, 1, 0, 1 };
+            result = vkCreateImageView(device->getLogicalDevice(), &view_create_info, nullptr, &realized.view);
+            ASSERT_VULKAN(result, "Failed to create a transient image view!")
+
+            realized_images.push_back(realized);
+        }
+    }
+
+    for (size_t i = 0; i < transients.size(); i++) {
+        Resource &resource = resources[transients[i] - resources.data()];
+        resource.image = realized_images[i].image;
+        resource.view = realized_images[i].view;
+    }
+}
+
+void RenderGraph::releaseTransients(TransientSet &set)
+{
+    if (device == nullptr || (set.images.empty() && set.slots.empty())) return;
+
+    // frames in flight may still render into them
+    VkDevice logical_device = device->getLogicalDevice();
+    VulkanDevice *owner = device;
+    device->getDeletionQueue().push(
+      [logical_device, owner, images = set.images, allocations = set.slots]() {
+          for (const RealizedImage &image : images) {
+              vkDestroyImageView(logical_device, image.view, nullptr);
+              vkDestroyImage(logical_device, image.image, nullptr);
+          }
+          for (VmaAllocation allocation : allocations) {
+              VmaAllocationInfo allocation_info{};
+              vmaGetAllocationInfo(owner->getAllocator().getVmaAllocator(), allocation, &allocation_info);
+              owner->getAllocator().getMemoryBudget().untrack(MemoryCategory::RenderTarget, allocation_info.size);
+              vmaFreeMemory(owner->getAllocator().getVmaAllocator(), allocation);
+          }
+      });
+
+    set.images.clear();
+    set.slots.clear();
+}
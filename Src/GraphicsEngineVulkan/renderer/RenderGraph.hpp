@@ -0,0 +1,191 @@
+#pragma once
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Globals.hpp"
+
+class VulkanDevice;
+
+// how a pass touches an image; decides stages, access and layout of the barriers
+enum class RenderGraphUsage : uint32_t {
+    ColorAttachment,
+    DepthAttachment,
+    SampledFragment,
+    SampledCompute,
+    StorageCompute,
+    StorageRayTracing,
+    TransferSrc,
+    TransferDst
+};
+
+struct RenderGraphAccess
+{
+    VkPipelineStageFlags2 stages{ VK_PIPELINE_STAGE_2_NONE };
+    VkAccessFlags2 access{ VK_ACCESS_2_NONE };
+    VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+};
+
+// an image the graph creates and owns; its memory may be shared with other
+// transient images that are not in use at the same time
+struct RenderGraphImageDesc
+{
+    VkExtent2D extent{ 0, 0 };
+    VkFormat format{ VK_FORMAT_UNDEFINED };
+    VkImageUsageFlags usage{ 0 };
+    VkImageAspectFlags aspect{ VK_IMAGE_ASPECT_COLOR_BIT };
+
+    bool operator==(const RenderGraphImageDesc &other) const
+    {
+        return extent.width == other.extent.width && extent.height == other.extent.height && format == other.format
+               && usage == other.usage && aspect == other.aspect;
+    };
+};
+
+// passes of a frame declare the images they read and write; compile() then
+// - culls passes whose results nobody reads (a write replaces the content of
+//   an image, a pass that keeps parts of it declares a read as well),
+// - computes the barriers in front of every pass from the declared usages,
+//   one vkCmdPipelineBarrier2 per pass covering all its images,
+// - places transient images with disjoint lifetimes into the same memory.
+// the graph is declared anew every frame; the memory of transient images is
+// kept as long as the declarations stay the same. every frame in flight has
+// its own transient images, so one frame never writes what an earlier one
+// still reads; they are reused once the fence of that frame has signalled
+class RenderGraph
+{
+  public:
+    using Handle = uint32_t;
+    using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+    static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    // first and last pass (in declaration order) using a transient image
+    struct Lifetime
+    {
+        uint32_t first{ UINT32_MAX };
+        uint32_t last{ 0 };
+
+        bool isValid() const { return first <= last; };
+    };
+
+    RenderGraph();
+
+    // without a device the graph only compiles, e.g. in tests
+    void init(VulkanDevice *device);
+
+    // forgets passes and resources of the last frame; transient memory is kept.
+    // frame_index is the frame in flight about to be recorded
+    void reset(uint32_t frame_index);
+
+    // layout is the one the image is in when the frame starts
+    Handle importImage(const std::string &name, VkImage image, VkImageAspectFlags aspect, VkImageLayout layout);
+    Handle createImage(const std::string &name, const RenderGraphImageDesc &desc);
+
+    Handle addPass(const std::string &name, ExecuteFunction execute);
+    void read(Handle pass, Handle resource, RenderGraphUsage usage);
+    void write(Handle pass, Handle resource, RenderGraphUsage usage);
+    // the pass has effects outside of the graph (e.g. renders into the swapchain) and is never culled
+    void setOutput(Handle pass);
+
+    void compile();
+    void execute(VkCommandBuffer commandBuffer);
+
+    bool isCulled(Handle pass) const { return passes[pass].culled; };
+    const std::vector<VkImageMemoryBarrier2> &getBarriers(Handle pass) const { return passes[pass].barriers; };
+    uint32_t getBarrierCount() const;
+    // layout the image is left in by the last pass using it
+    VkImageLayout getFinalLayout(Handle resource) const { return resources[resource].final_layout; };
+
+    VkImage getImage(Handle resource) const { return resources[resource].image; };
+    VkImageView getImageView(Handle resource) const { return resources[resource].view; };
+    const Lifetime &getLifetime(Handle resource) const { return resources[resource].lifetime; };
+    // transient images sharing memory have the same slot
+    uint32_t getAliasSlot(Handle resource) const { return resources[resource].slot; };
+    // memory of all transient images with and without aliasing
+    VkDeviceSize getTransientBytes() const;
+    VkDeviceSize getUnaliasedTransientBytes() const;
+
+    // assigns every transient image a memory slot; images share a slot if their lifetimes
+    // do not overlap and a memory type fits both. slots holds the merged requirements
+    static std::vector<uint32_t> planAliasing(const std::vector<Lifetime> &lifetimes,
+      const std::vector<VkMemoryRequirements> &requirements,
+      std::vector<VkMemoryRequirements> &slots);
+
+    static RenderGraphAccess getAccess(RenderGraphUsage usage, bool write);
+
+    void cleanUp();
+
+    ~RenderGraph();
+
+  private:
+    struct ResourceUse
+    {
+        Handle resource{ INVALID_HANDLE };
+        RenderGraphUsage usage{ RenderGraphUsage::ColorAttachment };
+        bool write{ false };
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<ResourceUse> uses;
+        bool output{ false };
+        bool culled{ false };
+        std::vector<VkImageMemoryBarrier2> barriers;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool transient{ false };
+        RenderGraphImageDesc desc;
+        VkImage image{ VK_NULL_HANDLE };
+        VkImageView view{ VK_NULL_HANDLE };
+        VkImageAspectFlags aspect{ VK_IMAGE_ASPECT_COLOR_BIT };
+        VkImageLayout initial_layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        VkImageLayout final_layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        Lifetime lifetime;
+        VkMemoryRequirements requirements{};
+        uint32_t slot{ NO_SLOT };
+    };
+
+    // transient images created for an earlier frame; reused while the plan stays the same
+    struct RealizedImage
+    {
+        std::string name;
+        RenderGraphImageDesc desc;
+        uint32_t slot{ NO_SLOT };
+        VkImage image{ VK_NULL_HANDLE };
+        VkImageView view{ VK_NULL_HANDLE };
+    };
+
+    VulkanDevice *device{ nullptr };
+
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<VkMemoryRequirements> slots;
+
+    struct TransientSet
+    {
+        std::vector<RealizedImage> images;
+        std::vector<VmaAllocation> slots;
+    };
+
+    uint32_t frame_index{ 0 };
+    std::array<TransientSet, MAX_FRAME_DRAWS> transient_sets;
+
+    void cull();
+    void computeLifetimes();
+    void computeBarriers();
+    void planTransientMemory();
+    void realizeTransients();
+    void releaseTransients(TransientSet &set);
+};
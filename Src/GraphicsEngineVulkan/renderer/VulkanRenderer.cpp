@@ -35,10 +35,13 @@
 #include <stb_image.h>
 
 #include <gsl/gsl>
+#include <imgui.h>
 
 #include "File.hpp"
 #include "Globals.hpp"
+#include "MeshLod.hpp"
 #include "PushConstantPost.hpp"
+#include "SceneConfig.hpp"
 #include "ShaderHelper.hpp"
 
 #include "VulkanRendererConfig.hpp"
@@ -62,29 +65,34 @@ VulkanRenderer::VulkanRenderer(Window *window, Scene *scene, GUI *gui, Camera *c
 
         device = std::make_unique<VulkanDevice>(&instance, &surface);
 
-        allocator = Allocator(device->getLogicalDevice(), device->getPhysicalDevice(), instance.getVulkanInstance());
-
         create_command_pool();
 
+        present_mode = sceneConfig::getPresentMode();
+        vulkanSwapChain.setPresentation(present_mode, sceneConfig::getMaxQueuedFrames());
         vulkanSwapChain.initVulkanContext(device.get(), window, surface);
+        framePacer.init(device.get());
+        framePacer.setMaxQueuedFrames(sceneConfig::getMaxQueuedFrames());
         create_uniform_buffers();
-        create_command_buffers();
+        createFrameContexts();
 
         createSynchronization();
 
         createSharedRenderDescriptorSetLayouts();
-        std::vector<VkDescriptorSetLayout> descriptor_set_layouts_rasterizer = { sharedRenderDescriptorSetLayout };
-        rasterizer.init(device.get(), &vulkanSwapChain, descriptor_set_layouts_rasterizer, graphics_command_pool);
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts_rasterizer = { sharedRenderDescriptorSetLayout,
+            textureTableDescriptorSetLayout };
+        rasterizer.init(device.get(), &vulkanSwapChain, descriptor_set_layouts_rasterizer);
         create_post_descriptor_layout();
         std::vector<VkDescriptorSetLayout> descriptor_set_layouts_post = { post_descriptor_set_layout };
         postStage.init(device.get(), &vulkanSwapChain, descriptor_set_layouts_post);
+        renderGraph.init(device.get());
         createDescriptorPoolSharedRenderStages();
         createSharedRenderDescriptorSet();
 
-        updatePostDescriptorSets();
+        for (uint32_t i = 0; i < MAX_FRAME_DRAWS; i++) updatePostDescriptorSet(i);
 
         std::vector<VkDescriptorSetLayout> layouts;
         layouts.push_back(sharedRenderDescriptorSetLayout);
+        layouts.push_back(textureTableDescriptorSetLayout);
         if(device->supportsHardwareAcceleratedRRT()) {
             createRaytracingDescriptorPool();
             createRaytracingDescriptorSetLayouts();
@@ -93,7 +101,19 @@ VulkanRenderer::VulkanRenderer(Window *window, Scene *scene, GUI *gui, Camera *c
             pathTracing.init(device.get(), layouts);
         }
 
-        scene->loadModel(device.get(), graphics_command_pool);
+        uploadManager.init(device.get());
+        uploadManager.setComputeMipGeneration(sceneConfig::getComputeMipGeneration());
+        if (!device->supportsBindlessTextures()) createFallbackTexture();
+        scene->loadModel(device.get(), &uploadManager);
+        // acceleration structure builds read the freshly uploaded geometry
+        uploadManager.waitIdle();
+        spdlog::info("Uploaded scene: {} KiB in {} submission(s)",
+          uploadManager.getUploadedBytes() / 1024,
+          uploadManager.getSubmitCount());
+        spdlog::info("Generated mips of {} texture(s) with {} in {:.3f} ms gpu time",
+          uploadManager.getMipGeneratedImages(),
+          sceneConfig::getComputeMipGeneration() ? "compute" : "blits",
+          uploadManager.getMipGenerationMs());
         updateTexturesInSharedRenderDescriptorSet();
 
         if(device->supportsHardwareAcceleratedRRT()) {
@@ -101,15 +121,21 @@ VulkanRenderer::VulkanRenderer(Window *window, Scene *scene, GUI *gui, Camera *c
         }
 
         create_object_description_buffer();
+        device->getAllocator().logStats();
 
         if(device->supportsHardwareAcceleratedRRT()) {
             createRaytracingDescriptorSets();
-            updateRaytracingDescriptorSets();
+            for (uint32_t i = 0; i < MAX_FRAME_DRAWS; i++) updateRaytracingDescriptorSet(i);
         }
 
         gui->initializeVulkanContext(
           device.get(), instance.getVulkanInstance(), postStage.getRenderPass(), graphics_command_pool);
         gui->setUserSelectionForRRT(device->supportsHardwareAcceleratedRRT());
+
+        GUIRendererSharedVars &guiRendererSharedVars = gui->getGuiRendererSharedVars();
+        guiRendererSharedVars.present_mode = present_mode;
+        guiRendererSharedVars.max_queued_frames = framePacer.getMaxQueuedFrames();
+        guiRendererSharedVars.present_wait = framePacer.usesPresentWait();
 }
 
 void VulkanRenderer::updateUniforms(Scene *scene, Camera *camera, Window *window)
@@ -130,6 +156,10 @@ void VulkanRenderer::updateUniforms(Scene *scene, Camera *camera, Window *window
       1.0f);
 
     sceneUBO.cam_pos = glm::vec4(camera->get_camera_position(), camera->get_fov());
+
+    const float projection_scale = lod::getProjectionScale(glm::radians(camera->get_fov()), (float)window->get_height());
+    rasterizer.setLodSelection(camera->get_camera_position(), projection_scale);
+    scene->requestTextureMips(camera->get_camera_position(), projection_scale);
 }
 
 void VulkanRenderer::updateStateDueToUserInput(GUI *gui)
@@ -140,81 +170,134 @@ void VulkanRenderer::updateStateDueToUserInput(GUI *gui)
         shaderHotReload();
         guiRendererSharedVars.shader_hot_reload_triggered = false;
     }
+
+    // the swapchain picks both up when it is recreated at the start of the next frame
+    if (guiRendererSharedVars.present_mode != present_mode
+        || guiRendererSharedVars.max_queued_frames != framePacer.getMaxQueuedFrames()) {
+        present_mode = guiRendererSharedVars.present_mode;
+        vulkanSwapChain.setPresentation(present_mode, guiRendererSharedVars.max_queued_frames);
+        framePacer.setMaxQueuedFrames(guiRendererSharedVars.max_queued_frames);
+        guiRendererSharedVars.max_queued_frames = framePacer.getMaxQueuedFrames();
+        presentation_changed = true;
+    }
+
+    guiRendererSharedVars.active_present_mode = vulkanSwapChain.getPresentMode();
+    guiRendererSharedVars.input_to_present_ms = static_cast<float>(framePacer.getLatencyMs());
+    guiRendererSharedVars.average_input_to_present_ms = static_cast<float>(framePacer.getAverageLatencyMs());
 }
 
 void VulkanRenderer::finishAllRenderCommands() { vkDeviceWaitIdle(device->getLogicalDevice()); }
 
 void VulkanRenderer::shaderHotReload()
 {
-    // wait until no actions being run on device before destroying
-    vkDeviceWaitIdle(device->getLogicalDevice());
-
-    std::vector<VkDescriptorSetLayout> descriptor_set_layouts = { sharedRenderDescriptorSetLayout };
+    // the stages hand their old pipelines to the deletion queue; frames in flight keep using them
+    std::vector<VkDescriptorSetLayout> descriptor_set_layouts = { sharedRenderDescriptorSetLayout,
+        textureTableDescriptorSetLayout };
     rasterizer.shaderHotReload(descriptor_set_layouts);
 
     std::vector<VkDescriptorSetLayout> descriptor_set_layouts_post = { post_descriptor_set_layout };
     postStage.shaderHotReload(descriptor_set_layouts_post);
 
-    std::vector<VkDescriptorSetLayout> layouts = { sharedRenderDescriptorSetLayout, raytracingDescriptorSetLayout };
+    std::vector<VkDescriptorSetLayout> layouts = {
+        sharedRenderDescriptorSetLayout, textureTableDescriptorSetLayout, raytracingDescriptorSetLayout
+    };
     raytracingStage.shaderHotReload(layouts);
     pathTracing.shaderHotReload(layouts);
 }
 
+void VulkanRenderer::paceFrame()
+{
+    if (framePacer.usesPresentWait()) {
+        framePacer.waitForFrameSlot(vulkanSwapChain.getSwapChain());
+
+    } else {
+        // without present wait a frame finishing on the gpu is the closest to it being on screen
+        // we can observe; wait for the one max_queued_frames back
+        const uint32_t queued_frames = framePacer.getMaxQueuedFrames();
+        const FrameContext &frame = frames[(current_frame + MAX_FRAME_DRAWS - queued_frames) % MAX_FRAME_DRAWS];
+        VkResult result = vkWaitForFences(
+          device->getLogicalDevice(), 1, &frame.in_flight_fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        ASSERT_VULKAN(result, "Failed to wait for a queued frame!")
+    }
+
+    framePacer.markInputSampled();
+}
+
 void VulkanRenderer::drawFrame()
 {
-    // We need to skip one frame
-    // Due to ImGui need to call ImGui::NewFrame() again
-    // if we recreated swapchain
-    if (checkChangedFramebufferSize()) return;
+    // frames in flight keep the old swapchain and targets until the deletion queue
+    // releases them; nothing waits for the gpu here
+    if ((window->framebuffer_size_has_changed() || presentation_changed) && !recreateSwapChain()) {
+        // minimized; try again next frame
+        ImGui::EndFrame();
+        return;
+    }
 
     /*1. Get next available image to draw to and set something to signal when
        we're finished with the image  (a semaphore) wait for given fence to signal
        (open) from last draw before continuing*/
+    FrameContext &frame = frames[current_frame];
     VkResult result = vkWaitForFences(
-      device->getLogicalDevice(), 1, &in_flight_fences[current_frame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+      device->getLogicalDevice(), 1, &frame.in_flight_fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
     ASSERT_VULKAN(result, "Failed to wait for fences!")
+
+    // every frame waits for the one MAX_FRAME_DRAWS before it; all up to that one are done
+    DeletionQueue &deletionQueue = device->getDeletionQueue();
+    deletionQueue.setFrame(submitted_frames);
+    deletionQueue.release(submitted_frames >= MAX_FRAME_DRAWS - 1 ? submitted_frames - (MAX_FRAME_DRAWS - 1) : 0);
+
+    // the swapchain was recreated since this frame context ran last
+    if (frame.render_target_version != render_target_version) {
+        updatePostDescriptorSet(current_frame);
+        if (device->supportsHardwareAcceleratedRRT()) updateRaytracingDescriptorSet(current_frame);
+        frame.render_target_version = render_target_version;
+    }
+
     // -- GET NEXT IMAGE --
     uint32_t image_index;
     result = vkAcquireNextImageKHR(device->getLogicalDevice(),
       vulkanSwapChain.getSwapChain(),
       std::numeric_limits<uint64_t>::max(),
-      image_available[current_frame],
+      frame.image_available,
       VK_NULL_HANDLE,
       &image_index);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        // recreate_swap_chain();
+        // the semaphore is left unsignalled and the fence untouched; the frame is skipped
+        recreateSwapChain();
+        ImGui::EndFrame();
         return;
 
     } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         spdlog::error("Failed to acquire next image!");
     }
 
-    //// check if previous frame is using this image (i.e. there is its fence to
-    /// wait on)
-    if (images_in_flight_fences[image_index] != VK_NULL_HANDLE) {
-        vkWaitForFences(device->getLogicalDevice(), 1, &images_in_flight_fences[image_index], VK_TRUE, UINT64_MAX);
-    }
+    // nothing of this frame context is used by the gpu any more; the swapchain
+    // image itself is free to render to once image_available signals
+    device->getAllocator().updateMemoryBudget();
+    updateTextureTable(frame);
 
-    // mark the image as now being in use by this frame
-    images_in_flight_fences[image_index] = in_flight_fences[current_frame];
+    // everything recorded into the pool last time around is done
+    result = vkResetCommandPool(device->getLogicalDevice(), frame.command_pool, 0);
+    ASSERT_VULKAN(result, "Failed to reset the frame's command pool!")
 
     VkCommandBufferBeginInfo buffer_begin_info{};
     buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     // start recording commands to command buffer
-    result = vkBeginCommandBuffer(command_buffers[image_index], &buffer_begin_info);
+    result = vkBeginCommandBuffer(frame.command_buffer, &buffer_begin_info);
     ASSERT_VULKAN(result, "Failed to start recording a command buffer!")
 
-    update_uniform_buffers(image_index);
+    frameAllocator.beginFrame(current_frame);
+    update_uniform_buffers(frame);
 
     GUIRendererSharedVars &guiRendererSharedVars = gui->getGuiRendererSharedVars();
-    if (guiRendererSharedVars.raytracing) update_raytracing_descriptor_set(image_index);
+    if (guiRendererSharedVars.raytracing) update_raytracing_descriptor_set(frame);
 
-    record_commands(image_index);
+    record_commands(frame, image_index);
 
     // stop recording to command buffer
-    result = vkEndCommandBuffer(command_buffers[image_index]);
+    result = vkEndCommandBuffer(frame.command_buffer);
     ASSERT_VULKAN(result, "Failed to stop recording a command buffer!")
 
     // 2. Submit command buffer to queue for execution, making sure it waits for
@@ -224,7 +307,7 @@ void VulkanRenderer::drawFrame()
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submit_info.waitSemaphoreCount = 1;// number of semaphores to wait on
-    submit_info.pWaitSemaphores = &image_available[current_frame];// list of semaphores to wait on
+    submit_info.pWaitSemaphores = &frame.image_available;// list of semaphores to wait on
 
     VkPipelineStageFlags wait_stages = {
 
@@ -237,42 +320,51 @@ void VulkanRenderer::drawFrame()
     submit_info.pWaitDstStageMask = &wait_stages;// stages to check semaphores at
 
     submit_info.commandBufferCount = 1;// number of command buffers to submit
-    submit_info.pCommandBuffers = &command_buffers[image_index];// command buffer to submit
+    submit_info.pCommandBuffers = &frame.command_buffer;// command buffer to submit
     submit_info.signalSemaphoreCount = 1;// number of semaphores to signal
-    submit_info.pSignalSemaphores = &render_finished[current_frame];// semaphores to signal when command
-                                                                    // buffer finishes
+    // per image: it stays in use until the presentation of that image is done
+    submit_info.pSignalSemaphores = &render_finished[image_index];// semaphores to signal when command
+                                                                  // buffer finishes
 
-    result = vkResetFences(device->getLogicalDevice(), 1, &in_flight_fences[current_frame]);
+    result = vkResetFences(device->getLogicalDevice(), 1, &frame.in_flight_fence);
     ASSERT_VULKAN(result, "Failed to reset fences!")
 
     // submit command buffer to queue
-    result = vkQueueSubmit(device->getGraphicsQueue(), 1, &submit_info, in_flight_fences[current_frame]);
+    result = vkQueueSubmit(device->getGraphicsQueue(), 1, &submit_info, frame.in_flight_fence);
     ASSERT_VULKAN(result, "Failed to submit command buffer to queue!")
+    submitted_frames++;
 
     // 3. Present image to screen when it has signalled finished rendering
     // -- PRESENT RENDERED IMAGE TO SCREEN --
     VkPresentInfoKHR present_info{};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     present_info.waitSemaphoreCount = 1;// number of semaphores to wait on
-    present_info.pWaitSemaphores = &render_finished[current_frame];// semaphores to wait on
+    present_info.pWaitSemaphores = &render_finished[image_index];// semaphores to wait on
     present_info.swapchainCount = 1;// number of swapchains to present to
     const VkSwapchainKHR swapchain = vulkanSwapChain.getSwapChain();
     present_info.pSwapchains = &swapchain;// swapchains to present images to
     present_info.pImageIndices = &image_index;// index of images in swapchain to present
 
+    // lets paceFrame() wait for this frame being on screen
+    VkPresentIdKHR present_id_info{};
+    uint64_t present_id = 0;
+    if (framePacer.usesPresentWait()) {
+        present_id = framePacer.beginPresent();
+        present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        present_id_info.swapchainCount = 1;
+        present_id_info.pPresentIds = &present_id;
+        present_info.pNext = &present_id_info;
+    }
+
     result = vkQueuePresentKHR(device->getPresentationQueue(), &present_info);
+    current_frame = (current_frame + 1) % MAX_FRAME_DRAWS;
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        // recreate_swap_chain();
-        return;
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        recreateSwapChain();
 
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        spdlog::error("Failed to acquire next image!");
+    } else if (result != VK_SUCCESS) {
+        spdlog::error("Failed to submit to present queue!");
     }
-
-    if (result != VK_SUCCESS) { spdlog::error("Failed to submit to present queue!"); }
-
-    current_frame = (current_frame + 1) % MAX_FRAME_DRAWS;
 }
 
 void VulkanRenderer::create_surface()
@@ -313,15 +405,15 @@ void VulkanRenderer::create_post_descriptor_layout()
 
     VkDescriptorPoolSize post_pool_size{};
     post_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    post_pool_size.descriptorCount = static_cast<uint32_t>(1);
+    post_pool_size.descriptorCount = static_cast<uint32_t>(MAX_FRAME_DRAWS);
 
     // list of pool sizes
     std::vector<VkDescriptorPoolSize> descriptor_pool_sizes = { post_pool_size };
 
     VkDescriptorPoolCreateInfo pool_create_info{};
     pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_create_info.maxSets = vulkanSwapChain.getNumberSwapChainImages();// maximum number of descriptor sets
-                                                                          // that can be created from pool
+    pool_create_info.maxSets = MAX_FRAME_DRAWS;// maximum number of descriptor sets
+                                               // that can be created from pool
     pool_create_info.poolSizeCount =
       static_cast<uint32_t>(descriptor_pool_sizes.size());// amount of pool sizes being passed
     pool_create_info.pPoolSizes = descriptor_pool_sizes.data();// pool sizes to create pool with
@@ -330,48 +422,41 @@ void VulkanRenderer::create_post_descriptor_layout()
     result = vkCreateDescriptorPool(device->getLogicalDevice(), &pool_create_info, nullptr, &post_descriptor_pool);
     ASSERT_VULKAN(result, "Failed to create a descriptor pool!")
 
-    // resize descriptor set list so one for every buffer
-    post_descriptor_set.resize(vulkanSwapChain.getNumberSwapChainImages());
-
-    std::vector<VkDescriptorSetLayout> set_layouts(
-      vulkanSwapChain.getNumberSwapChainImages(), post_descriptor_set_layout);
-
-    // descriptor set allocation info
-    VkDescriptorSetAllocateInfo set_alloc_info{};
-    set_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    set_alloc_info.descriptorPool = post_descriptor_pool;// pool to allocate descriptor set from
-    set_alloc_info.descriptorSetCount = vulkanSwapChain.getNumberSwapChainImages();// number of sets to allocate
-    set_alloc_info.pSetLayouts = set_layouts.data();// layouts to use to allocate sets (1:1 relationship)
-
-    // allocate descriptor sets (multiple)
-    result = vkAllocateDescriptorSets(device->getLogicalDevice(), &set_alloc_info, post_descriptor_set.data());
-    ASSERT_VULKAN(result, "Failed to create descriptor sets!")
+    // one set for every frame in flight
+    for (FrameContext &frame : frames) {
+        // descriptor set allocation info
+        VkDescriptorSetAllocateInfo set_alloc_info{};
+        set_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        set_alloc_info.descriptorPool = post_descriptor_pool;// pool to allocate descriptor set from
+        set_alloc_info.descriptorSetCount = 1;// number of sets to allocate
+        set_alloc_info.pSetLayouts = &post_descriptor_set_layout;// layouts to use to allocate sets
+
+        result = vkAllocateDescriptorSets(device->getLogicalDevice(), &set_alloc_info, &frame.post_descriptor_set);
+        ASSERT_VULKAN(result, "Failed to create descriptor sets!")
+    }
 }
 
-void VulkanRenderer::updatePostDescriptorSets()
+void VulkanRenderer::updatePostDescriptorSet(uint32_t frame_index)
 {
-    // update all of descriptor set buffer bindings
-    for (size_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
-        // texture image info
-        VkDescriptorImageInfo image_info{};
-        image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        Texture &renderResult = rasterizer.getOffscreenTexture(i);
-        image_info.imageView = renderResult.getImageView();
-        image_info.sampler = postStage.getOffscreenSampler();
-
-        // descriptor write info
-        VkWriteDescriptorSet descriptor_write{};
-        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_write.dstSet = post_descriptor_set[i];
-        descriptor_write.dstBinding = 0;
-        descriptor_write.dstArrayElement = 0;
-        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptor_write.descriptorCount = 1;
-        descriptor_write.pImageInfo = &image_info;
-
-        // update new descriptor set
-        vkUpdateDescriptorSets(device->getLogicalDevice(), 1, &descriptor_write, 0, nullptr);
-    }
+    // every frame samples its own offscreen image
+    VkDescriptorImageInfo image_info{};
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    Texture &renderResult = rasterizer.getOffscreenTexture(frame_index);
+    image_info.imageView = renderResult.getImageView();
+    image_info.sampler = postStage.getOffscreenSampler();
+
+    // descriptor write info
+    VkWriteDescriptorSet descriptor_write{};
+    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_write.dstSet = frames[frame_index].post_descriptor_set;
+    descriptor_write.dstBinding = 0;
+    descriptor_write.dstArrayElement = 0;
+    descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_write.descriptorCount = 1;
+    descriptor_write.pImageInfo = &image_info;
+
+    // update new descriptor set
+    vkUpdateDescriptorSets(device->getLogicalDevice(), 1, &descriptor_write, 0, nullptr);
 }
 
 void VulkanRenderer::createRaytracingDescriptorPool()
@@ -379,16 +464,16 @@ void VulkanRenderer::createRaytracingDescriptorPool()
     std::array<VkDescriptorPoolSize, 2> descriptor_pool_sizes{};
 
     descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-    descriptor_pool_sizes[0].descriptorCount = 1;
+    descriptor_pool_sizes[0].descriptorCount = MAX_FRAME_DRAWS;
 
     descriptor_pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    descriptor_pool_sizes[1].descriptorCount = 1;
+    descriptor_pool_sizes[1].descriptorCount = MAX_FRAME_DRAWS;
 
     VkDescriptorPoolCreateInfo descriptor_pool_create_info{};
     descriptor_pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptor_pool_create_info.poolSizeCount = static_cast<uint32_t>(descriptor_pool_sizes.size());
     descriptor_pool_create_info.pPoolSizes = descriptor_pool_sizes.data();
-    descriptor_pool_create_info.maxSets = vulkanSwapChain.getNumberSwapChainImages();
+    descriptor_pool_create_info.maxSets = MAX_FRAME_DRAWS;
 
     VkResult result = vkCreateDescriptorPool(
       device->getLogicalDevice(), &descriptor_pool_create_info, nullptr, &raytracingDescriptorPool);
@@ -397,11 +482,12 @@ void VulkanRenderer::createRaytracingDescriptorPool()
 
 void VulkanRenderer::cleanUpSync()
 {
-    for (int i = 0; i < MAX_FRAME_DRAWS; i++) {
-        vkDestroySemaphore(device->getLogicalDevice(), render_finished[i], nullptr);
-        vkDestroySemaphore(device->getLogicalDevice(), image_available[i], nullptr);
-        vkDestroyFence(device->getLogicalDevice(), in_flight_fences[i], nullptr);
+    for (FrameContext &frame : frames) {
+        vkDestroySemaphore(device->getLogicalDevice(), frame.image_available, nullptr);
+        vkDestroyFence(device->getLogicalDevice(), frame.in_flight_fence, nullptr);
     }
+    for (VkSemaphore semaphore : render_finished) vkDestroySemaphore(device->getLogicalDevice(), semaphore, nullptr);
+    render_finished.clear();
 }
 
 void VulkanRenderer::create_object_description_buffer()
@@ -412,12 +498,13 @@ void VulkanRenderer::create_object_description_buffer()
       graphics_command_pool,
       objectDescriptionBuffer,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::Geometry,
       objectDescriptions);
 
     // update the object description set
     // update all of descriptor set buffer bindings
-    for (size_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
+    for (FrameContext &frame : frames) {
         VkDescriptorBufferInfo object_descriptions_buffer_info{};
         // image_info.sampler = VK_DESCRIPTOR_TYPE_SAMPLER;
         object_descriptions_buffer_info.buffer = objectDescriptionBuffer.getBuffer();
@@ -427,7 +514,7 @@ void VulkanRenderer::create_object_description_buffer()
         VkWriteDescriptorSet descriptor_object_descriptions_writer{};
         descriptor_object_descriptions_writer.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptor_object_descriptions_writer.pNext = nullptr;
-        descriptor_object_descriptions_writer.dstSet = sharedRenderDescriptorSet[i];
+        descriptor_object_descriptions_writer.dstSet = frame.shared_render_descriptor_set;
         descriptor_object_descriptions_writer.dstBinding = OBJECT_DESCRIPTION_BINDING;
         descriptor_object_descriptions_writer.dstArrayElement = 0;
         descriptor_object_descriptions_writer.descriptorCount = 1;
@@ -482,82 +569,76 @@ void VulkanRenderer::createRaytracingDescriptorSetLayouts()
 
 void VulkanRenderer::createRaytracingDescriptorSets()
 {
-    // resize descriptor set list so one for every buffer
-    raytracingDescriptorSet.resize(vulkanSwapChain.getNumberSwapChainImages());
-
-    std::vector<VkDescriptorSetLayout> set_layouts(
-      vulkanSwapChain.getNumberSwapChainImages(), raytracingDescriptorSetLayout);
-
-    VkDescriptorSetAllocateInfo descriptor_set_allocate_info{};
-    descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    ;
-    descriptor_set_allocate_info.descriptorPool = raytracingDescriptorPool;
-    descriptor_set_allocate_info.descriptorSetCount = vulkanSwapChain.getNumberSwapChainImages();
-    descriptor_set_allocate_info.pSetLayouts = set_layouts.data();
-
-    VkResult result = vkAllocateDescriptorSets(
-      device->getLogicalDevice(), &descriptor_set_allocate_info, raytracingDescriptorSet.data());
-    ASSERT_VULKAN(result, "Failed to allocate raytracing descriptor set!")
+    // one set for every frame in flight
+    for (FrameContext &frame : frames) {
+        VkDescriptorSetAllocateInfo descriptor_set_allocate_info{};
+        descriptor_set_allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptor_set_allocate_info.descriptorPool = raytracingDescriptorPool;
+        descriptor_set_allocate_info.descriptorSetCount = 1;
+        descriptor_set_allocate_info.pSetLayouts = &raytracingDescriptorSetLayout;
+
+        VkResult result = vkAllocateDescriptorSets(
+          device->getLogicalDevice(), &descriptor_set_allocate_info, &frame.raytracing_descriptor_set);
+        ASSERT_VULKAN(result, "Failed to allocate raytracing descriptor set!")
+    }
 }
 
-void VulkanRenderer::updateRaytracingDescriptorSets()
+void VulkanRenderer::updateRaytracingDescriptorSet(uint32_t frame_index)
 {
-    for (size_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
-        VkWriteDescriptorSetAccelerationStructureKHR descriptor_set_acceleration_structure{};
-        descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-        descriptor_set_acceleration_structure.pNext = nullptr;
-        descriptor_set_acceleration_structure.accelerationStructureCount = 1;
-        VkAccelerationStructureKHR &vulkanTLAS = asManager.getTLAS();
-        descriptor_set_acceleration_structure.pAccelerationStructures = &vulkanTLAS;
-
-        VkWriteDescriptorSet write_descriptor_set_acceleration_structure{};
-        write_descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write_descriptor_set_acceleration_structure.pNext = &descriptor_set_acceleration_structure;
-        write_descriptor_set_acceleration_structure.dstSet = raytracingDescriptorSet[i];
-        write_descriptor_set_acceleration_structure.dstBinding = TLAS_BINDING;
-        write_descriptor_set_acceleration_structure.dstArrayElement = 0;
-        write_descriptor_set_acceleration_structure.descriptorCount = 1;
-        write_descriptor_set_acceleration_structure.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-        write_descriptor_set_acceleration_structure.pImageInfo = nullptr;
-        write_descriptor_set_acceleration_structure.pBufferInfo = nullptr;
-        write_descriptor_set_acceleration_structure.pTexelBufferView = nullptr;
-
-        VkDescriptorImageInfo image_info{};
-        Texture &renderResult = rasterizer.getOffscreenTexture(i);
-        image_info.imageView = renderResult.getImageView();
-        image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-        VkWriteDescriptorSet descriptor_image_writer{};
-        descriptor_image_writer.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_image_writer.pNext = nullptr;
-        descriptor_image_writer.dstSet = raytracingDescriptorSet[i];
-        descriptor_image_writer.dstBinding = OUT_IMAGE_BINDING;
-        descriptor_image_writer.dstArrayElement = 0;
-        descriptor_image_writer.descriptorCount = 1;
-        descriptor_image_writer.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        descriptor_image_writer.pImageInfo = &image_info;
-        descriptor_image_writer.pBufferInfo = nullptr;
-        descriptor_image_writer.pTexelBufferView = nullptr;
-
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets = { write_descriptor_set_acceleration_structure,
-            descriptor_image_writer };
+    VkWriteDescriptorSetAccelerationStructureKHR descriptor_set_acceleration_structure{};
+    descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+    descriptor_set_acceleration_structure.pNext = nullptr;
+    descriptor_set_acceleration_structure.accelerationStructureCount = 1;
+    VkAccelerationStructureKHR &vulkanTLAS = asManager.getTLAS();
+    descriptor_set_acceleration_structure.pAccelerationStructures = &vulkanTLAS;
 
-        // update the descriptor sets with new buffer/binding info
-        vkUpdateDescriptorSets(device->getLogicalDevice(),
-          static_cast<uint32_t>(write_descriptor_sets.size()),
-          write_descriptor_sets.data(),
-          0,
-          nullptr);
-    }
+    VkWriteDescriptorSet write_descriptor_set_acceleration_structure{};
+    write_descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write_descriptor_set_acceleration_structure.pNext = &descriptor_set_acceleration_structure;
+    write_descriptor_set_acceleration_structure.dstSet = frames[frame_index].raytracing_descriptor_set;
+    write_descriptor_set_acceleration_structure.dstBinding = TLAS_BINDING;
+    write_descriptor_set_acceleration_structure.dstArrayElement = 0;
+    write_descriptor_set_acceleration_structure.descriptorCount = 1;
+    write_descriptor_set_acceleration_structure.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+    write_descriptor_set_acceleration_structure.pImageInfo = nullptr;
+    write_descriptor_set_acceleration_structure.pBufferInfo = nullptr;
+    write_descriptor_set_acceleration_structure.pTexelBufferView = nullptr;
+
+    VkDescriptorImageInfo image_info{};
+    Texture &renderResult = rasterizer.getOffscreenTexture(frame_index);
+    image_info.imageView = renderResult.getImageView();
+    image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkWriteDescriptorSet descriptor_image_writer{};
+    descriptor_image_writer.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_image_writer.pNext = nullptr;
+    descriptor_image_writer.dstSet = frames[frame_index].raytracing_descriptor_set;
+    descriptor_image_writer.dstBinding = OUT_IMAGE_BINDING;
+    descriptor_image_writer.dstArrayElement = 0;
+    descriptor_image_writer.descriptorCount = 1;
+    descriptor_image_writer.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    descriptor_image_writer.pImageInfo = &image_info;
+    descriptor_image_writer.pBufferInfo = nullptr;
+    descriptor_image_writer.pTexelBufferView = nullptr;
+
+    std::vector<VkWriteDescriptorSet> write_descriptor_sets = { write_descriptor_set_acceleration_structure,
+        descriptor_image_writer };
+
+    // update the descriptor sets with new buffer/binding info
+    vkUpdateDescriptorSets(device->getLogicalDevice(),
+      static_cast<uint32_t>(write_descriptor_sets.size()),
+      write_descriptor_sets.data(),
+      0,
+      nullptr);
 }
 
 void VulkanRenderer::createSharedRenderDescriptorSetLayouts()
 {
-    std::array<VkDescriptorSetLayoutBinding, 5> descriptor_set_layout_bindings{};
+    std::array<VkDescriptorSetLayoutBinding, 3> descriptor_set_layout_bindings{};
     // UNIFORM VALUES DESCRIPTOR SET LAYOUT
     // globalUBO Binding info
     descriptor_set_layout_bindings[0].binding = globalUBO_BINDING;
-    descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptor_set_layout_bindings[0].descriptorCount = 1;
     descriptor_set_layout_bindings[0].stageFlags =
       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
@@ -565,7 +646,7 @@ void VulkanRenderer::createSharedRenderDescriptorSetLayouts()
 
     // our model matrix which updates every frame for each object
     descriptor_set_layout_bindings[1].binding = sceneUBO_BINDING;
-    descriptor_set_layout_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptor_set_layout_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptor_set_layout_bindings[1].descriptorCount = 1;
     descriptor_set_layout_bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
                                                    | VK_SHADER_STAGE_RAYGEN_BIT_KHR
@@ -580,23 +661,7 @@ void VulkanRenderer::createSharedRenderDescriptorSetLayouts()
     descriptor_set_layout_bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
                                                    | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
 
-    // CREATE TEXTURE SAMPLER DESCRIPTOR SET LAYOUT
-    // texture binding info
-    descriptor_set_layout_bindings[3].binding = SAMPLER_BINDING;
-    descriptor_set_layout_bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-    descriptor_set_layout_bindings[3].descriptorCount = MAX_TEXTURE_COUNT;
-    descriptor_set_layout_bindings[3].stageFlags =
-      VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
-    descriptor_set_layout_bindings[3].pImmutableSamplers = nullptr;
-
-    descriptor_set_layout_bindings[4].binding = TEXTURES_BINDING;
-    descriptor_set_layout_bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    descriptor_set_layout_bindings[4].descriptorCount = MAX_TEXTURE_COUNT;
-    descriptor_set_layout_bindings[4].stageFlags =
-      VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
-    descriptor_set_layout_bindings[4].pImmutableSamplers = nullptr;
-
-    // create descriptor set layout with given bindings
+    // create descriptor set layout with given bindings; dynamic uniform buffers rule out update after bind
     VkDescriptorSetLayoutCreateInfo layout_create_info{};
     layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layout_create_info.bindingCount = static_cast<uint32_t>(descriptor_set_layout_bindings.size());
@@ -606,6 +671,49 @@ void VulkanRenderer::createSharedRenderDescriptorSetLayouts()
     VkResult result = vkCreateDescriptorSetLayout(
       device->getLogicalDevice(), &layout_create_info, nullptr, &sharedRenderDescriptorSetLayout);
     ASSERT_VULKAN(result, "Failed to create descriptor set layout!")
+
+    // CREATE TEXTURE SAMPLER DESCRIPTOR SET LAYOUT
+    std::array<VkDescriptorSetLayoutBinding, 2> texture_table_bindings{};
+    // texture binding info
+    texture_table_bindings[0].binding = TEXTURES_BINDING;
+    texture_table_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    texture_table_bindings[0].descriptorCount = device->getTextureTableCapacity();
+    texture_table_bindings[0].stageFlags =
+      VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
+    texture_table_bindings[0].pImmutableSamplers = nullptr;
+
+    texture_table_bindings[1].binding = SAMPLER_BINDING;
+    texture_table_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    texture_table_bindings[1].descriptorCount = device->getTextureTableCapacity();
+    texture_table_bindings[1].stageFlags =
+      VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT;
+    texture_table_bindings[1].pImmutableSamplers = nullptr;
+
+    // the texture table only has its used slots written and gets new ones
+    // while frames that do not touch them are in flight
+    std::vector<VkDescriptorBindingFlags> binding_flags(texture_table_bindings.size(), 0);
+    if (device->supportsBindlessTextures()) {
+        binding_flags[0] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                           | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        binding_flags[1] = binding_flags[0];
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info{};
+    binding_flags_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    binding_flags_create_info.bindingCount = static_cast<uint32_t>(binding_flags.size());
+    binding_flags_create_info.pBindingFlags = binding_flags.data();
+
+    VkDescriptorSetLayoutCreateInfo texture_table_layout_create_info{};
+    texture_table_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    texture_table_layout_create_info.pNext = &binding_flags_create_info;
+    texture_table_layout_create_info.flags =
+      device->supportsBindlessTextures() ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0;
+    texture_table_layout_create_info.bindingCount = static_cast<uint32_t>(texture_table_bindings.size());
+    texture_table_layout_create_info.pBindings = texture_table_bindings.data();
+
+    result = vkCreateDescriptorSetLayout(
+      device->getLogicalDevice(), &texture_table_layout_create_info, nullptr, &textureTableDescriptorSetLayout);
+    ASSERT_VULKAN(result, "Failed to create the texture table descriptor set layout!")
 }
 
 void VulkanRenderer::create_command_pool()
@@ -644,34 +752,45 @@ void VulkanRenderer::create_command_pool()
 
 void VulkanRenderer::cleanUpCommandPools()
 {
+    CommandBufferManager::releaseCommandPool(device->getLogicalDevice(), graphics_command_pool);
+    CommandBufferManager::releaseCommandPool(device->getLogicalDevice(), compute_command_pool);
     vkDestroyCommandPool(device->getLogicalDevice(), graphics_command_pool, nullptr);
     vkDestroyCommandPool(device->getLogicalDevice(), compute_command_pool, nullptr);
 }
 
-void VulkanRenderer::create_command_buffers()
+void VulkanRenderer::createFrameContexts()
 {
-    // resize command buffer count to have one for each framebuffer
-    command_buffers.resize(vulkanSwapChain.getNumberSwapChainImages());
+    QueueFamilyIndices queue_family_indices = device->getQueueFamilies();
 
-    VkCommandBufferAllocateInfo command_buffer_alloc_info{};
-    command_buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    command_buffer_alloc_info.commandPool = graphics_command_pool;
-    command_buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    for (FrameContext &frame : frames) {
+        // reset as a whole every frame; no need to reset single command buffers
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        pool_info.queueFamilyIndex = queue_family_indices.graphics_family;
 
-    command_buffer_alloc_info.commandBufferCount = static_cast<uint32_t>(command_buffers.size());
+        VkResult result = vkCreateCommandPool(device->getLogicalDevice(), &pool_info, nullptr, &frame.command_pool);
+        ASSERT_VULKAN(result, "Failed to create a frame command pool!")
 
-    VkResult result =
-      vkAllocateCommandBuffers(device->getLogicalDevice(), &command_buffer_alloc_info, command_buffers.data());
-    ASSERT_VULKAN(result, "Failed to allocate command buffers!")
+        VkCommandBufferAllocateInfo command_buffer_alloc_info{};
+        command_buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        command_buffer_alloc_info.commandPool = frame.command_pool;
+        command_buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        command_buffer_alloc_info.commandBufferCount = 1;
+
+        result = vkAllocateCommandBuffers(device->getLogicalDevice(), &command_buffer_alloc_info, &frame.command_buffer);
+        ASSERT_VULKAN(result, "Failed to allocate command buffers!")
+    }
 }
 
-void VulkanRenderer::createSynchronization()
+void VulkanRenderer::cleanUpFrameContexts()
 {
-    image_available.resize(vulkanSwapChain.getNumberSwapChainImages(), VK_NULL_HANDLE);
-    render_finished.resize(vulkanSwapChain.getNumberSwapChainImages(), VK_NULL_HANDLE);
-    in_flight_fences.resize(vulkanSwapChain.getNumberSwapChainImages(), VK_NULL_HANDLE);
-    images_in_flight_fences.resize(vulkanSwapChain.getNumberSwapChainImages(), VK_NULL_HANDLE);
+    // frees the command buffers as well
+    for (FrameContext &frame : frames) vkDestroyCommandPool(device->getLogicalDevice(), frame.command_pool, nullptr);
+}
 
+void VulkanRenderer::createSynchronization()
+{
     // semaphore creation information
     VkSemaphoreCreateInfo semaphore_create_info{};
     semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -681,86 +800,67 @@ void VulkanRenderer::createSynchronization()
     fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (int i = 0; i < MAX_FRAME_DRAWS; i++) {
-        if ((vkCreateSemaphore(device->getLogicalDevice(), &semaphore_create_info, nullptr, &image_available[i])
+    for (FrameContext &frame : frames) {
+        if ((vkCreateSemaphore(device->getLogicalDevice(), &semaphore_create_info, nullptr, &frame.image_available)
               != VK_SUCCESS)
-            || (vkCreateSemaphore(device->getLogicalDevice(), &semaphore_create_info, nullptr, &render_finished[i])
-                != VK_SUCCESS)
-            || (vkCreateFence(device->getLogicalDevice(), &fence_create_info, nullptr, &in_flight_fences[i])
+            || (vkCreateFence(device->getLogicalDevice(), &fence_create_info, nullptr, &frame.in_flight_fence)
                 != VK_SUCCESS)) {
             spdlog::error("Failed to create a semaphore and/or fence!");
         }
     }
+
+    createPresentSemaphores();
 }
 
-void VulkanRenderer::create_uniform_buffers()
+void VulkanRenderer::createPresentSemaphores()
 {
-    // one uniform buffer for each image (and by extension, command buffer)
-    globalUBOBuffer.resize(vulkanSwapChain.getNumberSwapChainImages());
-    sceneUBOBuffer.resize(vulkanSwapChain.getNumberSwapChainImages());
-
-    //// temporary buffer to "stage" vertex data before transfering to GPU
-    // VulkanBuffer	stagingBuffer;
-    std::vector<GlobalUBO> globalUBOdata;
-    globalUBOdata.push_back(globalUBO);
-
-    std::vector<SceneUBO> sceneUBOdata;
-    sceneUBOdata.push_back(sceneUBO);
-
-    // create uniform buffers
-    for (size_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
-        vulkanBufferManager.createBufferAndUploadVectorOnDevice(device.get(),
-          graphics_command_pool,
-          globalUBOBuffer[i],
-          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-          globalUBOdata);
-
-        vulkanBufferManager.createBufferAndUploadVectorOnDevice(device.get(),
-          graphics_command_pool,
-          sceneUBOBuffer[i],
-          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-          sceneUBOdata);
+    VkSemaphoreCreateInfo semaphore_create_info{};
+    semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // a recreated swapchain may have more images; existing semaphores are kept since
+    // a pending presentation might still wait on them
+    while (render_finished.size() < vulkanSwapChain.getNumberSwapChainImages()) {
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        if (vkCreateSemaphore(device->getLogicalDevice(), &semaphore_create_info, nullptr, &semaphore) != VK_SUCCESS) {
+            spdlog::error("Failed to create a semaphore!");
+        }
+        render_finished.push_back(semaphore);
     }
 }
 
+void VulkanRenderer::create_uniform_buffers()
+{
+    // one persistently mapped buffer with a region for each frame in flight
+    frameAllocator.init(device.get(), FRAME_DATA_SIZE, MAX_FRAME_DRAWS);
+}
+
 void VulkanRenderer::createDescriptorPoolSharedRenderStages()
 {
     // CREATE UNIFORM DESCRIPTOR POOL
     // type of descriptors + how many descriptors, not descriptor sets (combined
     // makes the pool size) ViewProjection Pool
     VkDescriptorPoolSize vp_pool_size{};
-    vp_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    vp_pool_size.descriptorCount = static_cast<uint32_t>(globalUBOBuffer.size());
+    vp_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    vp_pool_size.descriptorCount = MAX_FRAME_DRAWS;
 
     // DIRECTION POOL
     VkDescriptorPoolSize directions_pool_size{};
-    directions_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    directions_pool_size.descriptorCount = static_cast<uint32_t>(sceneUBOBuffer.size());
+    directions_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    directions_pool_size.descriptorCount = MAX_FRAME_DRAWS;
 
     VkDescriptorPoolSize object_descriptions_pool_size{};
     object_descriptions_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     object_descriptions_pool_size.descriptorCount = static_cast<uint32_t>(sizeof(ObjectDescription) * MAX_OBJECTS);
 
-    // TEXTURE SAMPLER POOL
-    VkDescriptorPoolSize sampler_pool_size{};
-    sampler_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLER;
-    sampler_pool_size.descriptorCount = MAX_TEXTURE_COUNT;
-
-    VkDescriptorPoolSize sampled_image_pool_size{};
-    sampled_image_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    sampled_image_pool_size.descriptorCount = MAX_TEXTURE_COUNT;
-
     // list of pool sizes
     std::vector<VkDescriptorPoolSize> descriptor_pool_sizes = {
-        vp_pool_size, directions_pool_size, object_descriptions_pool_size, sampler_pool_size, sampled_image_pool_size
+        vp_pool_size, directions_pool_size, object_descriptions_pool_size
     };
 
     VkDescriptorPoolCreateInfo pool_create_info{};
     pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_create_info.maxSets = vulkanSwapChain.getNumberSwapChainImages();// maximum number of descriptor sets
-                                                                          // that can be created from pool
+    pool_create_info.maxSets = MAX_FRAME_DRAWS;// maximum number of descriptor sets
+                                               // that can be created from pool
     pool_create_info.poolSizeCount =
       static_cast<uint32_t>(descriptor_pool_sizes.size());// amount of pool sizes being passed
     pool_create_info.pPoolSizes = descriptor_pool_sizes.data();// pool sizes to create pool with
@@ -769,61 +869,88 @@ void VulkanRenderer::createDescriptorPoolSharedRenderStages()
     VkResult result =
       vkCreateDescriptorPool(device->getLogicalDevice(), &pool_create_info, nullptr, &descriptorPoolSharedRenderStages);
     ASSERT_VULKAN(result, "Failed to create a descriptor pool!")
-}
 
-void VulkanRenderer::createSharedRenderDescriptorSet()
-{
-    // resize descriptor set list so one for every buffer
-    sharedRenderDescriptorSet.resize(vulkanSwapChain.getNumberSwapChainImages());
+    // TEXTURE SAMPLER POOL
+    // one whole texture table per set
+    VkDescriptorPoolSize sampler_pool_size{};
+    sampler_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    sampler_pool_size.descriptorCount = device->getTextureTableCapacity() * MAX_FRAME_DRAWS;
 
-    std::vector<VkDescriptorSetLayout> set_layouts(
-      vulkanSwapChain.getNumberSwapChainImages(), sharedRenderDescriptorSetLayout);
+    VkDescriptorPoolSize sampled_image_pool_size{};
+    sampled_image_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    sampled_image_pool_size.descriptorCount = device->getTextureTableCapacity() * MAX_FRAME_DRAWS;
 
-    // descriptor set allocation info
-    VkDescriptorSetAllocateInfo set_alloc_info{};
-    set_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    set_alloc_info.descriptorPool = descriptorPoolSharedRenderStages;// pool to allocate descriptor set from
-    set_alloc_info.descriptorSetCount = vulkanSwapChain.getNumberSwapChainImages();// number of sets to allocate
-    set_alloc_info.pSetLayouts = set_layouts.data();// layouts to use to allocate sets (1:1 relationship)
+    std::vector<VkDescriptorPoolSize> texture_table_pool_sizes = { sampler_pool_size, sampled_image_pool_size };
 
-    // allocate descriptor sets (multiple)
-    VkResult result =
-      vkAllocateDescriptorSets(device->getLogicalDevice(), &set_alloc_info, sharedRenderDescriptorSet.data());
-    ASSERT_VULKAN(result, "Failed to create descriptor sets!")
+    VkDescriptorPoolCreateInfo texture_table_pool_create_info{};
+    texture_table_pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    texture_table_pool_create_info.flags =
+      device->supportsBindlessTextures() ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0;
+    texture_table_pool_create_info.maxSets = MAX_FRAME_DRAWS;
+    texture_table_pool_create_info.poolSizeCount = static_cast<uint32_t>(texture_table_pool_sizes.size());
+    texture_table_pool_create_info.pPoolSizes = texture_table_pool_sizes.data();
 
+    result = vkCreateDescriptorPool(
+      device->getLogicalDevice(), &texture_table_pool_create_info, nullptr, &textureTableDescriptorPool);
+    ASSERT_VULKAN(result, "Failed to create the texture table descriptor pool!")
+}
+
+void VulkanRenderer::createSharedRenderDescriptorSet()
+{
     // update all of descriptor set buffer bindings
-    for (size_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
+    for (FrameContext &frame : frames) {
+        // descriptor set allocation info
+        VkDescriptorSetAllocateInfo set_alloc_info{};
+        set_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        set_alloc_info.descriptorPool = descriptorPoolSharedRenderStages;// pool to allocate descriptor set from
+        set_alloc_info.descriptorSetCount = 1;// number of sets to allocate
+        set_alloc_info.pSetLayouts = &sharedRenderDescriptorSetLayout;// layouts to use to allocate sets
+
+        VkResult result =
+          vkAllocateDescriptorSets(device->getLogicalDevice(), &set_alloc_info, &frame.shared_render_descriptor_set);
+        ASSERT_VULKAN(result, "Failed to create descriptor sets!")
+
+        VkDescriptorSetAllocateInfo texture_table_alloc_info{};
+        texture_table_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        texture_table_alloc_info.descriptorPool = textureTableDescriptorPool;
+        texture_table_alloc_info.descriptorSetCount = 1;
+        texture_table_alloc_info.pSetLayouts = &textureTableDescriptorSetLayout;
+
+        result = vkAllocateDescriptorSets(
+          device->getLogicalDevice(), &texture_table_alloc_info, &frame.texture_table_descriptor_set);
+        ASSERT_VULKAN(result, "Failed to create the texture table descriptor sets!")
+
         // VIEW PROJECTION DESCRIPTOR
         // buffer info and data offset info
         VkDescriptorBufferInfo globalUBO_buffer_info{};
-        globalUBO_buffer_info.buffer = globalUBOBuffer[i].getBuffer();// buffer to get data from
-        globalUBO_buffer_info.offset = 0;// position of start of data
+        globalUBO_buffer_info.buffer = frameAllocator.getBuffer();// buffer to get data from
+        globalUBO_buffer_info.offset = 0;// position of start of data; the dynamic offset is added on bind
         globalUBO_buffer_info.range = sizeof(globalUBO);// size of data
 
         // data about connection between binding and buffer
         VkWriteDescriptorSet globalUBO_set_write{};
         globalUBO_set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        globalUBO_set_write.dstSet = sharedRenderDescriptorSet[i];// descriptor set to update
+        globalUBO_set_write.dstSet = frame.shared_render_descriptor_set;// descriptor set to update
         globalUBO_set_write.dstBinding = 0;// binding to update (matches with binding on layout/shader)
         globalUBO_set_write.dstArrayElement = 0;// index in array to update
-        globalUBO_set_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;// type of descriptor
+        globalUBO_set_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;// type of descriptor
         globalUBO_set_write.descriptorCount = 1;// amount to update
         globalUBO_set_write.pBufferInfo = &globalUBO_buffer_info;// information about buffer data to bind
 
         // VIEW PROJECTION DESCRIPTOR
         // buffer info and data offset info
         VkDescriptorBufferInfo sceneUBO_buffer_info{};
-        sceneUBO_buffer_info.buffer = sceneUBOBuffer[i].getBuffer();// buffer to get data from
-        sceneUBO_buffer_info.offset = 0;// position of start of data
+        sceneUBO_buffer_info.buffer = frameAllocator.getBuffer();// buffer to get data from
+        sceneUBO_buffer_info.offset = 0;// position of start of data; the dynamic offset is added on bind
         sceneUBO_buffer_info.range = sizeof(sceneUBO);// size of data
 
         // data about connection between binding and buffer
         VkWriteDescriptorSet sceneUBO_set_write{};
         sceneUBO_set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        sceneUBO_set_write.dstSet = sharedRenderDescriptorSet[i];// descriptor set to update
+        sceneUBO_set_write.dstSet = frame.shared_render_descriptor_set;// descriptor set to update
         sceneUBO_set_write.dstBinding = 1;// binding to update (matches with binding on layout/shader)
         sceneUBO_set_write.dstArrayElement = 0;// index in array to update
-        sceneUBO_set_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;// type of descriptor
+        sceneUBO_set_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;// type of descriptor
         sceneUBO_set_write.descriptorCount = 1;// amount to update
         sceneUBO_set_write.pBufferInfo = &sceneUBO_buffer_info;// information about buffer data to bind
 
@@ -840,165 +967,151 @@ void VulkanRenderer::createSharedRenderDescriptorSet()
 
 void VulkanRenderer::updateTexturesInSharedRenderDescriptorSet()
 {
-    std::vector<Texture> &modelTextures = scene->getTextures(0);
-    std::vector<VkDescriptorImageInfo> image_info_textures;
-    image_info_textures.resize(scene->getTextureCount(0));
-    for (uint32_t i = 0; i < scene->getTextureCount(0); i++) {
+    queueTextureTableWrites();
+    for (FrameContext &frame : frames) {
+        // the whole table has to be valid before the first bind, not only the filled slots
+        if (!device->supportsBindlessTextures()) writeFallbackTextureTable(frame);
+        writeTextureTable(frame);
+    }
+}
+
+void VulkanRenderer::queueTextureTableWrites()
+{
+    // only the slots filled or replaced since the last call; the rest of the table stays as written
+    std::vector<uint32_t> slots = scene->getTextureCache().takePendingSlots();
+    for (FrameContext &frame : frames) {
+        frame.texture_slots_to_write.insert(frame.texture_slots_to_write.end(), slots.begin(), slots.end());
+    }
+}
+
+void VulkanRenderer::writeTextureTable(FrameContext &frame)
+{
+    TextureCache &textureCache = scene->getTextureCache();
+    std::vector<uint32_t> &slots = frame.texture_slots_to_write;
+    frame.texture_table_version = textureCache.getTableVersion();
+    if (slots.empty()) return;
+
+    std::vector<VkDescriptorImageInfo> image_info_textures(slots.size());
+    std::vector<VkDescriptorImageInfo> image_info_texture_sampler(slots.size());
+    std::vector<VkWriteDescriptorSet> write_descriptor_sets;
+    write_descriptor_sets.reserve(2 * slots.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        TextureCache::TableSlot table_slot = textureCache.getTableSlot(slots[i]);
+        if (table_slot.image_view == VK_NULL_HANDLE) {
+            // freed; nothing samples it any more, but without partially bound
+            // descriptors it must not keep pointing at the destroyed view
+            if (device->supportsBindlessTextures()) continue;
+            table_slot = { fallbackTexture.getImageView(), fallbackSampler };
+        }
         image_info_textures[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        image_info_textures[i].imageView = modelTextures[i].getImageView();
+        image_info_textures[i].imageView = table_slot.image_view;
         image_info_textures[i].sampler = nullptr;
-    }
 
-    std::vector<VkSampler> &modelTextureSampler = scene->getTextureSampler(0);
-    std::vector<VkDescriptorImageInfo> image_info_texture_sampler;
-    image_info_texture_sampler.resize(scene->getTextureCount(0));
-    for (uint32_t i = 0; i < scene->getTextureCount(0); i++) {
         image_info_texture_sampler[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         image_info_texture_sampler[i].imageView = nullptr;
-        image_info_texture_sampler[i].sampler = modelTextureSampler[i];
-    }
+        image_info_texture_sampler[i].sampler = table_slot.sampler;
 
-    for (uint32_t i = 0; i < vulkanSwapChain.getNumberSwapChainImages(); i++) {
         // descriptor write info
         VkWriteDescriptorSet descriptor_write{};
         descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_write.dstSet = sharedRenderDescriptorSet[i];
+        descriptor_write.dstSet = frame.texture_table_descriptor_set;
         descriptor_write.dstBinding = TEXTURES_BINDING;
-        descriptor_write.dstArrayElement = 0;
+        descriptor_write.dstArrayElement = slots[i];
         descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        descriptor_write.descriptorCount = static_cast<uint32_t>(image_info_textures.size());
-        descriptor_write.pImageInfo = image_info_textures.data();
-
-        /*VkDescriptorImageInfo sampler_info;
-                    sampler_info.imageView = nullptr;
-                    sampler_info.sampler = texture_sampler;*/
+        descriptor_write.descriptorCount = 1;
+        descriptor_write.pImageInfo = &image_info_textures[i];
+        write_descriptor_sets.push_back(descriptor_write);
 
-        // descriptor write info
         VkWriteDescriptorSet descriptor_write_sampler{};
         descriptor_write_sampler.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_write_sampler.dstSet = sharedRenderDescriptorSet[i];
+        descriptor_write_sampler.dstSet = frame.texture_table_descriptor_set;
         descriptor_write_sampler.dstBinding = SAMPLER_BINDING;
-        descriptor_write_sampler.dstArrayElement = 0;
+        descriptor_write_sampler.dstArrayElement = slots[i];
         descriptor_write_sampler.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-        descriptor_write_sampler.descriptorCount = static_cast<uint32_t>(image_info_texture_sampler.size());
-        descriptor_write_sampler.pImageInfo = image_info_texture_sampler.data();
-
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets = { descriptor_write, descriptor_write_sampler };
-
-        // update new descriptor set
-        vkUpdateDescriptorSets(device->getLogicalDevice(),
-          static_cast<uint32_t>(write_descriptor_sets.size()),
-          write_descriptor_sets.data(),
-          0,
-          nullptr);
+        descriptor_write_sampler.descriptorCount = 1;
+        descriptor_write_sampler.pImageInfo = &image_info_texture_sampler[i];
+        write_descriptor_sets.push_back(descriptor_write_sampler);
     }
+
+    // with update after bind this is fine while frames using other slots are in flight
+    vkUpdateDescriptorSets(device->getLogicalDevice(),
+      static_cast<uint32_t>(write_descriptor_sets.size()),
+      write_descriptor_sets.data(),
+      0,
+      nullptr);
+    slots.clear();
 }
 
-void VulkanRenderer::cleanUpUBOs()
+void VulkanRenderer::createFallbackTexture()
 {
-    for (VulkanBuffer vulkanBuffer : globalUBOBuffer) { vulkanBuffer.cleanUp(); }
+    // uploaded together with the scene
+    const stbi_uc magenta[4] = { 255, 0, 255, 255 };
+    fallbackTexture.createFromPixels(device.get(), &uploadManager, magenta, 1, 1);
 
-    for (VulkanBuffer vulkanBuffer : sceneUBOBuffer) { vulkanBuffer.cleanUp(); }
+    VkSamplerCreateInfo sampler_create_info = TextureCache::getTextureSamplerInfo();
+    VkResult result = vkCreateSampler(device->getLogicalDevice(), &sampler_create_info, nullptr, &fallbackSampler);
+    ASSERT_VULKAN(result, "Failed to create the fallback texture sampler!")
 }
 
-void VulkanRenderer::update_uniform_buffers(uint32_t image_index)
+void VulkanRenderer::writeFallbackTextureTable(FrameContext &frame)
 {
-    auto usage_stage_flags = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR
-                             | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
-    VkBufferMemoryBarrier before_barrier_uvp{};
-    before_barrier_uvp.pNext = nullptr;
-    before_barrier_uvp.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    before_barrier_uvp.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    before_barrier_uvp.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    before_barrier_uvp.buffer = globalUBOBuffer[image_index].getBuffer();
-    before_barrier_uvp.offset = 0;
-    before_barrier_uvp.size = sizeof(globalUBO);
-    before_barrier_uvp.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    before_barrier_uvp.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-    VkBufferMemoryBarrier before_barrier_directions{};
-    before_barrier_directions.pNext = nullptr;
-    before_barrier_directions.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    before_barrier_directions.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    before_barrier_directions.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    before_barrier_directions.buffer = globalUBOBuffer[image_index].getBuffer();
-    before_barrier_directions.offset = 0;
-    before_barrier_directions.size = sizeof(sceneUBO);
-    before_barrier_directions.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    before_barrier_directions.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-    vkCmdPipelineBarrier(command_buffers[image_index],
-      usage_stage_flags,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      0,
-      0,
-      nullptr,
-      1,
-      &before_barrier_uvp,
-      0,
-      nullptr);
-    vkCmdPipelineBarrier(command_buffers[image_index],
-      usage_stage_flags,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      0,
-      0,
-      nullptr,
-      1,
-      &before_barrier_directions,
-      0,
-      nullptr);
+    const uint32_t table_capacity = device->getTextureTableCapacity();
+
+    VkDescriptorImageInfo image_info_texture{};
+    image_info_texture.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_info_texture.imageView = fallbackTexture.getImageView();
+    VkDescriptorImageInfo image_info_sampler{};
+    image_info_sampler.sampler = fallbackSampler;
+    std::vector<VkDescriptorImageInfo> image_info_textures(table_capacity, image_info_texture);
+    std::vector<VkDescriptorImageInfo> image_info_texture_sampler(table_capacity, image_info_sampler);
+
+    // one write per binding covers all of its array elements
+    std::array<VkWriteDescriptorSet, 2> write_descriptor_sets{};
+    write_descriptor_sets[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write_descriptor_sets[0].dstSet = frame.texture_table_descriptor_set;
+    write_descriptor_sets[0].dstBinding = TEXTURES_BINDING;
+    write_descriptor_sets[0].dstArrayElement = 0;
+    write_descriptor_sets[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    write_descriptor_sets[0].descriptorCount = table_capacity;
+    write_descriptor_sets[0].pImageInfo = image_info_textures.data();
+
+    write_descriptor_sets[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write_descriptor_sets[1].dstSet = frame.texture_table_descriptor_set;
+    write_descriptor_sets[1].dstBinding = SAMPLER_BINDING;
+    write_descriptor_sets[1].dstArrayElement = 0;
+    write_descriptor_sets[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    write_descriptor_sets[1].descriptorCount = table_capacity;
+    write_descriptor_sets[1].pImageInfo = image_info_texture_sampler.data();
 
-    vkCmdUpdateBuffer(
-      command_buffers[image_index], globalUBOBuffer[image_index].getBuffer(), 0, sizeof(GlobalUBO), &globalUBO);
-    vkCmdUpdateBuffer(
-      command_buffers[image_index], sceneUBOBuffer[image_index].getBuffer(), 0, sizeof(SceneUBO), &sceneUBO);
-
-    VkBufferMemoryBarrier after_barrier_uvp{};
-    after_barrier_uvp.pNext = nullptr;
-    after_barrier_uvp.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    after_barrier_uvp.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    after_barrier_uvp.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    after_barrier_uvp.buffer = globalUBOBuffer[image_index].getBuffer();
-    after_barrier_uvp.offset = 0;
-    after_barrier_uvp.size = sizeof(GlobalUBO);
-    after_barrier_uvp.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    after_barrier_uvp.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-    VkBufferMemoryBarrier after_barrier_directions{};
-    after_barrier_directions.pNext = nullptr;
-    after_barrier_directions.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    after_barrier_directions.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    after_barrier_directions.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    after_barrier_directions.buffer = globalUBOBuffer[image_index].getBuffer();
-    after_barrier_directions.offset = 0;
-    after_barrier_directions.size = sizeof(SceneUBO);
-    after_barrier_directions.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    after_barrier_directions.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-    vkCmdPipelineBarrier(command_buffers[image_index],
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      usage_stage_flags,
-      0,
-      0,
-      nullptr,
-      1,
-      &after_barrier_uvp,
-      0,
-      nullptr);
-    vkCmdPipelineBarrier(command_buffers[image_index],
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      usage_stage_flags,
-      0,
-      0,
-      nullptr,
-      1,
-      &after_barrier_directions,
+    vkUpdateDescriptorSets(device->getLogicalDevice(),
+      static_cast<uint32_t>(write_descriptor_sets.size()),
+      write_descriptor_sets.data(),
       0,
       nullptr);
 }
 
-void VulkanRenderer::update_raytracing_descriptor_set(uint32_t image_index)
+void VulkanRenderer::updateTextureTable(FrameContext &frame)
+{
+    // old images may go once every set has been written past their replacement
+    uint64_t visible_table_version = frame.texture_table_version;
+    for (const FrameContext &other : frames) {
+        visible_table_version = std::min(visible_table_version, other.texture_table_version);
+    }
+    scene->getTextureStreamer().update(visible_table_version);
+
+    queueTextureTableWrites();
+    writeTextureTable(frame);
+}
+
+void VulkanRenderer::cleanUpUBOs() { frameAllocator.cleanUp(); }
+
+void VulkanRenderer::update_uniform_buffers(FrameContext &frame)
+{
+    // the region of current_frame is no longer read by the gpu; a plain write is all it takes
+    frame.ubo_dynamic_offsets = { frameAllocator.push(globalUBO), frameAllocator.push(sceneUBO) };
+}
+
+void VulkanRenderer::update_raytracing_descriptor_set(FrameContext &frame)
 {
     VkWriteDescriptorSetAccelerationStructureKHR descriptor_set_acceleration_structure{};
     descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
@@ -1010,7 +1123,7 @@ void VulkanRenderer::update_raytracing_descriptor_set(uint32_t image_index)
     VkWriteDescriptorSet write_descriptor_set_acceleration_structure{};
     write_descriptor_set_acceleration_structure.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     write_descriptor_set_acceleration_structure.pNext = &descriptor_set_acceleration_structure;
-    write_descriptor_set_acceleration_structure.dstSet = raytracingDescriptorSet[image_index];
+    write_descriptor_set_acceleration_structure.dstSet = frame.raytracing_descriptor_set;
     write_descriptor_set_acceleration_structure.dstBinding = TLAS_BINDING;
     write_descriptor_set_acceleration_structure.dstArrayElement = 0;
     write_descriptor_set_acceleration_structure.descriptorCount = 1;
@@ -1026,7 +1139,7 @@ void VulkanRenderer::update_raytracing_descriptor_set(uint32_t image_index)
 
     VkWriteDescriptorSet object_description_buffer_write{};
     object_description_buffer_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    object_description_buffer_write.dstSet = sharedRenderDescriptorSet[image_index];
+    object_description_buffer_write.dstSet = frame.shared_render_descriptor_set;
     object_description_buffer_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     object_description_buffer_write.dstBinding = OBJECT_DESCRIPTION_BINDING;
     object_description_buffer_write.pBufferInfo = &object_description_buffer_info;
@@ -1042,79 +1155,78 @@ void VulkanRenderer::update_raytracing_descriptor_set(uint32_t image_index)
       nullptr);
 }
 
-void VulkanRenderer::record_commands(uint32_t image_index)
+void VulkanRenderer::record_commands(FrameContext &frame, uint32_t image_index)
 {
-    Texture &renderResult = rasterizer.getOffscreenTexture(image_index);
-    VulkanImage &vulkanImage = renderResult.getVulkanImage();
+    Texture &renderResult = rasterizer.getOffscreenTexture(current_frame);
+
+    // nothing of the last use of this frame's image is kept; the frame fence covers it
+    renderGraph.reset(current_frame);
+    RenderGraph::Handle offscreen = renderGraph.importImage(
+      "offscreen", renderResult.getVulkanImage().getImage(), VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    // every stage declares the offscreen image it fills; the graph culls the ones
+    // whose result is overwritten before post reads it
+    RenderGraph::Handle raster_pass = renderGraph.addPass("rasterizer", [this, &frame](VkCommandBuffer commandBuffer) {
+        std::vector<VkDescriptorSet> descriptorSets = { frame.shared_render_descriptor_set,
+            frame.texture_table_descriptor_set };
+        rasterizer.recordCommands(commandBuffer, current_frame, scene, descriptorSets, frame.ubo_dynamic_offsets);
+    });
+    renderGraph.write(raster_pass, offscreen, RenderGraphUsage::ColorAttachment);
 
     GUIRendererSharedVars &guiRendererSharedVars = gui->getGuiRendererSharedVars();
     if (guiRendererSharedVars.raytracing) {
-        std::vector<VkDescriptorSet> sets = { sharedRenderDescriptorSet[image_index],
-            raytracingDescriptorSet[image_index] };
-        raytracingStage.recordCommands(command_buffers[image_index], &vulkanSwapChain, sets);
+        RenderGraph::Handle raytracing_pass =
+          renderGraph.addPass("raytracing", [this, &frame](VkCommandBuffer commandBuffer) {
+              std::vector<VkDescriptorSet> sets = { frame.shared_render_descriptor_set,
+                  frame.texture_table_descriptor_set,
+                  frame.raytracing_descriptor_set };
+              raytracingStage.recordCommands(commandBuffer, &vulkanSwapChain, sets, frame.ubo_dynamic_offsets);
+          });
+        renderGraph.write(raytracing_pass, offscreen, RenderGraphUsage::StorageRayTracing);
 
     } else if (guiRendererSharedVars.pathTracing) {
-        std::vector<VkDescriptorSet> sets = { sharedRenderDescriptorSet[image_index],
-            raytracingDescriptorSet[image_index] };
-
-        pathTracing.recordCommands(command_buffers[image_index], image_index, vulkanImage, &vulkanSwapChain, sets);
-
-    } else {
-        std::vector<VkDescriptorSet> descriptorSets = { sharedRenderDescriptorSet[image_index] };
-
-        rasterizer.recordCommands(command_buffers[image_index], image_index, scene, descriptorSets);
+        RenderGraph::Handle path_tracing_pass =
+          renderGraph.addPass("path tracing", [this, &frame](VkCommandBuffer commandBuffer) {
+              std::vector<VkDescriptorSet> sets = { frame.shared_render_descriptor_set,
+                  frame.texture_table_descriptor_set,
+                  frame.raytracing_descriptor_set };
+              pathTracing.recordCommands(
+                commandBuffer, current_frame, &vulkanSwapChain, sets, frame.ubo_dynamic_offsets);
+          });
+        renderGraph.write(path_tracing_pass, offscreen, RenderGraphUsage::StorageCompute);
     }
 
-    vulkanImage.transitionImageLayout(command_buffers[image_index],
-      VK_IMAGE_LAYOUT_GENERAL,
-      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-      1,
-      VK_IMAGE_ASPECT_COLOR_BIT);
-
-    std::vector<VkDescriptorSet> descriptorSets = { post_descriptor_set[image_index] };
-    postStage.recordCommands(command_buffers[image_index], image_index, descriptorSets);
-
-    vulkanImage.transitionImageLayout(command_buffers[image_index],
-      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-      VK_IMAGE_LAYOUT_GENERAL,
-      1,
-      VK_IMAGE_ASPECT_COLOR_BIT);
+    // the only pass that touches the swapchain image
+    RenderGraph::Handle post_pass =
+      renderGraph.addPass("post", [this, &frame, image_index](VkCommandBuffer commandBuffer) {
+          std::vector<VkDescriptorSet> descriptorSets = { frame.post_descriptor_set };
+          postStage.recordCommands(commandBuffer, image_index, descriptorSets);
+      });
+    renderGraph.read(post_pass, offscreen, RenderGraphUsage::SampledFragment);
+    renderGraph.setOutput(post_pass);
+
+    renderGraph.compile();
+    renderGraph.execute(frame.command_buffer);
 }
 
-bool VulkanRenderer::checkChangedFramebufferSize()
+bool VulkanRenderer::recreateSwapChain()
 {
-    if (window->framebuffer_size_has_changed()) {
-        vkDeviceWaitIdle(device->getLogicalDevice());
-        vkQueueWaitIdle(device->getGraphicsQueue());
-
-        vulkanSwapChain.cleanUp();
-        vulkanSwapChain.initVulkanContext(device.get(), window, surface);
-
-        std::vector<VkDescriptorSetLayout> descriptor_set_layouts = { sharedRenderDescriptorSetLayout };
-        rasterizer.cleanUp();
-        rasterizer.init(device.get(), &vulkanSwapChain, descriptor_set_layouts, graphics_command_pool);
-
-        // all post
-        std::vector<VkDescriptorSetLayout> descriptorSets = { post_descriptor_set_layout };
-        postStage.cleanUp();
-        postStage.init(device.get(), &vulkanSwapChain, descriptorSets);
-
-        gui->cleanUp();
-        gui->initializeVulkanContext(
-          device.get(), instance.getVulkanInstance(), postStage.getRenderPass(), graphics_command_pool);
-
-        current_frame = 0;
-
-        updatePostDescriptorSets();
-        if(device->supportsHardwareAcceleratedRRT()) {
-            updateRaytracingDescriptorSets();
-        }
-        window->reset_framebuffer_has_changed();
-
-        return true;
-    }
-
-    return false;
+    // the old swapchain is handed over to the new one and, like every target that
+    // depends on its size, destroyed once the frames in flight using it are done
+    if (!vulkanSwapChain.recreate(surface)) return false;
+    createPresentSemaphores();
+    framePacer.resetSwapchain();
+
+    // render passes (formats) and pipelines (dynamic viewport) stay
+    rasterizer.resize();
+    postStage.resize();
+
+    // frame contexts rewrite their descriptors once they are free
+    render_target_version++;
+    window->reset_framebuffer_has_changed();
+    presentation_changed = false;
+
+    return true;
 }
 
 void VulkanRenderer::cleanUp()
@@ -1125,6 +1237,7 @@ void VulkanRenderer::cleanUp()
     raytracingStage.cleanUp();
     postStage.cleanUp();
     pathTracing.cleanUp();
+    renderGraph.cleanUp();
 
     objectDescriptionBuffer.cleanUp();
     asManager.cleanUp();
@@ -1132,22 +1245,28 @@ void VulkanRenderer::cleanUp()
     vkDestroyDescriptorSetLayout(device->getLogicalDevice(), raytracingDescriptorSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(device->getLogicalDevice(), post_descriptor_set_layout, nullptr);
     vkDestroyDescriptorSetLayout(device->getLogicalDevice(), sharedRenderDescriptorSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device->getLogicalDevice(), textureTableDescriptorSetLayout, nullptr);
     vkDestroyDescriptorPool(device->getLogicalDevice(), post_descriptor_pool, nullptr);
     vkDestroyDescriptorPool(device->getLogicalDevice(), descriptorPoolSharedRenderStages, nullptr);
+    vkDestroyDescriptorPool(device->getLogicalDevice(), textureTableDescriptorPool, nullptr);
     vkDestroyDescriptorPool(device->getLogicalDevice(), raytracingDescriptorPool, nullptr);
 
-    vkFreeCommandBuffers(device->getLogicalDevice(),
-      graphics_command_pool,
-      static_cast<uint32_t>(command_buffers.size()),
-      command_buffers.data());
+    if (!device->supportsBindlessTextures()) {
+        vkDestroySampler(device->getLogicalDevice(), fallbackSampler, nullptr);
+        fallbackTexture.cleanUp();
+    }
 
+    cleanUpFrameContexts();
     cleanUpCommandPools();
+    uploadManager.cleanUp();
 
     cleanUpSync();
 
+    // finishAllRenderCommands() left the device idle; retired swapchains still in the queue
+    // must be gone before their surface is
+    device->getDeletionQueue().flush();
     vulkanSwapChain.cleanUp();
     vkDestroySurfaceKHR(instance.getVulkanInstance(), surface, nullptr);
-    allocator.cleanUp();
     device->cleanUp();
     debug::freeDebugCallback(instance.getVulkanInstance());
     instance.cleanUp();
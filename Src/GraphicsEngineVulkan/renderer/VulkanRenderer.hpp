@@ -1,8 +1,9 @@
 #pragma once
 
 #include "ASManager.hpp"
-#include "Allocator.hpp"
 #include "CommandBufferManager.hpp"
+#include "FrameContext.hpp"
+#include "FramePacer.hpp"
 #include "GUI.hpp"
 #include "GlobalUBO.hpp"
 #include "PathTracing.hpp"
@@ -10,30 +11,39 @@
 
 #include "Rasterizer.hpp"
 #include "Raytracing.hpp"
+#include "RenderGraph.hpp"
 #include "Scene.hpp"
 #include "SceneUBO.hpp"
 #include "Texture.hpp"
 
 #include "Camera.hpp"
+#include "Globals.hpp"
 #include "VulkanBuffer.hpp"
 #include "VulkanBufferManager.hpp"
 #include "VulkanDevice.hpp"
+#include "VulkanFrameAllocator.hpp"
 #include "VulkanInstance.hpp"
 #include "VulkanSwapChain.hpp"
+#include "VulkanUploadManager.hpp"
 #include "Window.hpp"
 
+#include <array>
+
 class VulkanRenderer
 {
   public:
     VulkanRenderer(Window *window, Scene *scene, GUI *gui, Camera *camera);
 
+    // blocks until the queue of frames waiting for presentation has room; call right
+    // before polling input so the next frame is built from the latest input
+    void paceFrame();
     void drawFrame();
 
     void updateUniforms(Scene *scene, Camera *camera, Window *window);
 
     void updateStateDueToUserInput(GUI *gui);
     void finishAllRenderCommands();
-    void update_raytracing_descriptor_set(uint32_t image_index);
+    void update_raytracing_descriptor_set(FrameContext &frame);
 
     void cleanUp();
 
@@ -44,6 +54,7 @@ class VulkanRenderer
 
     // helper class for managing our buffers
     VulkanBufferManager vulkanBufferManager;
+    VulkanUploadManager uploadManager;
 
     // Vulkan instance, stores all per-application states
     VulkanInstance instance;
@@ -62,41 +73,46 @@ class VulkanRenderer
     GUI *gui;
 
     // -- pools
-    void record_commands(uint32_t image_index);
+    // records frame's passes; only the post pass renders into the swapchain image
+    void record_commands(FrameContext &frame, uint32_t image_index);
     void create_command_pool();
     void cleanUpCommandPools();
     VkCommandPool graphics_command_pool;
     VkCommandPool compute_command_pool;
 
-    // uniform buffers
+    // uniform buffers; written into the region of the current frame in flight
+    // and bound with the dynamic offsets of the globalUBO and sceneUBO bindings
+    static constexpr VkDeviceSize FRAME_DATA_SIZE = 64 * 1024;
     GlobalUBO globalUBO;
-    std::vector<VulkanBuffer> globalUBOBuffer;
     SceneUBO sceneUBO;
-    std::vector<VulkanBuffer> sceneUBOBuffer;
+    VulkanFrameAllocator frameAllocator;
     void create_uniform_buffers();
-    void update_uniform_buffers(uint32_t image_index);
+    void update_uniform_buffers(FrameContext &frame);
     void cleanUpUBOs();
 
-    std::vector<VkCommandBuffer> command_buffers;
     CommandBufferManager commandBufferManager;
-    void create_command_buffers();
+
+    // one per frame in flight, independent of the number of swapchain images
+    std::array<FrameContext, MAX_FRAME_DRAWS> frames;
+    void createFrameContexts();
+    void cleanUpFrameContexts();
 
     Raytracing raytracingStage;
     Rasterizer rasterizer;
     PathTracing pathTracing;
     PostStage postStage;
-
-    // new era of memory management for my project
-    // for now on integrate vma
-    Allocator allocator;
+    // declared anew in every record_commands(); places the barriers between the stages
+    RenderGraph renderGraph;
 
     // -- synchronization
     uint32_t current_frame{ 0 };
-    std::vector<VkSemaphore> image_available;
+    FramePacer framePacer;
+    // frames submitted so far; the deletion queue counts in these
+    uint64_t submitted_frames{ 0 };
+    // per swapchain image: presentation of the image waits on it
     std::vector<VkSemaphore> render_finished;
-    std::vector<VkFence> in_flight_fences;
-    std::vector<VkFence> images_in_flight_fences;
     void createSynchronization();
+    void createPresentSemaphores();
     void cleanUpSync();
 
     ASManager asManager;
@@ -106,25 +122,44 @@ class VulkanRenderer
     VkDescriptorPool descriptorPoolSharedRenderStages;
     void createDescriptorPoolSharedRenderStages();
     VkDescriptorSetLayout sharedRenderDescriptorSetLayout;
+    // kept apart from the set with the dynamic uniform buffers, which must not be update after bind
+    VkDescriptorPool textureTableDescriptorPool{ VK_NULL_HANDLE };
+    VkDescriptorSetLayout textureTableDescriptorSetLayout{ VK_NULL_HANDLE };
+    // without partially bound descriptors every slot of the texture table must
+    // be valid; the unused ones show this 1x1 magenta texture
+    Texture fallbackTexture;
+    VkSampler fallbackSampler{ VK_NULL_HANDLE };
     void createSharedRenderDescriptorSetLayouts();
-    std::vector<VkDescriptorSet> sharedRenderDescriptorSet;
     void createSharedRenderDescriptorSet();
+    // writes all changed texture table slots into every set; only while no frame is in flight
     void updateTexturesInSharedRenderDescriptorSet();
+    void queueTextureTableWrites();
+    void writeTextureTable(FrameContext &frame);
+    void createFallbackTexture();
+    // points every slot of the texture table of frame at the fallback texture
+    void writeFallbackTextureTable(FrameContext &frame);
+    // streams texture mips and publishes the finished ones to the set of frame
+    void updateTextureTable(FrameContext &frame);
 
     VkDescriptorPool post_descriptor_pool{ VK_NULL_HANDLE };
     VkDescriptorSetLayout post_descriptor_set_layout{ VK_NULL_HANDLE };
-    std::vector<VkDescriptorSet> post_descriptor_set;
     void create_post_descriptor_layout();
-    void updatePostDescriptorSets();
+    void updatePostDescriptorSet(uint32_t frame_index);
 
     VkDescriptorPool raytracingDescriptorPool{ VK_NULL_HANDLE };
-    std::vector<VkDescriptorSet> raytracingDescriptorSet;
     VkDescriptorSetLayout raytracingDescriptorSetLayout{ VK_NULL_HANDLE };
 
     void createRaytracingDescriptorSetLayouts();
     void createRaytracingDescriptorSets();
-    void updateRaytracingDescriptorSets();
+    void updateRaytracingDescriptorSet(uint32_t frame_index);
     void createRaytracingDescriptorPool();
 
-    bool checkChangedFramebufferSize();
+    // counts swapchain recreations; see FrameContext::render_target_version
+    uint64_t render_target_version{ 0 };
+    // requested in the gui; the swapchain falls back to FIFO if the surface lacks it
+    VkPresentModeKHR present_mode{ VK_PRESENT_MODE_FIFO_KHR };
+    // present mode or number of queued frames changed in the gui
+    bool presentation_changed{ false };
+    // false while the window is minimized
+    bool recreateSwapChain();
 };
@@ -25,23 +25,26 @@ void ASManager::createBLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
     for (uint32_t model_index = 0; model_index < static_cast<uint32_t>(scene->getModelCount()); model_index++) {
         std::shared_ptr<Model> mesh_model = scene->get_model_list()[model_index];
         // blas_input.emplace_back();
-        blas_input[model_index].as_geometry.reserve(mesh_model->getMeshCount());
-        blas_input[model_index].as_build_offset_info.reserve(mesh_model->getMeshCount());
-
+        // one geometry per submesh; gl_GeometryIndexEXT then matches the
+        // submesh order of the object descriptions
         for (size_t mesh_index = 0; mesh_index < mesh_model->getMeshCount(); mesh_index++) {
-            VkAccelerationStructureGeometryKHR acceleration_structure_geometry{};
-            VkAccelerationStructureBuildRangeInfoKHR acceleration_structure_build_range_info{};
-
-            objectToVkGeometryKHR(device,
-              mesh_model->getMesh(mesh_index),
-              acceleration_structure_geometry,
-              acceleration_structure_build_range_info);
-            // this only specifies the acceleration structure
-            // we are building it in the end for the whole model with the build
-            // command
-
-            blas_input[model_index].as_geometry.push_back(acceleration_structure_geometry);
-            blas_input[model_index].as_build_offset_info.push_back(acceleration_structure_build_range_info);
+            Mesh *mesh = mesh_model->getMesh(mesh_index);
+            for (const Submesh &submesh : mesh->getSubmeshes()) {
+                VkAccelerationStructureGeometryKHR acceleration_structure_geometry{};
+                VkAccelerationStructureBuildRangeInfoKHR acceleration_structure_build_range_info{};
+
+                objectToVkGeometryKHR(device,
+                  mesh,
+                  submesh,
+                  acceleration_structure_geometry,
+                  acceleration_structure_build_range_info);
+                // this only specifies the acceleration structure
+                // we are building it in the end for the whole model with the build
+                // command
+
+                blas_input[model_index].as_geometry.push_back(acceleration_structure_geometry);
+                blas_input[model_index].as_build_offset_info.push_back(acceleration_structure_build_range_info);
+            }
         }
     }
 
@@ -67,7 +70,8 @@ void ASManager::createBLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
     scratchBuffer.create(device,
       max_scratch_size,
       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::AccelerationStructure);
 
     VkBufferDeviceAddressInfo scratch_buffer_device_address_info{};
     scratch_buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -156,7 +160,8 @@ void ASManager::createTLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
 
         VkAccelerationStructureInstanceKHR geometry_instance{};
         geometry_instance.transform = out_matrix;
-        geometry_instance.instanceCustomIndex = model_index;// gl_InstanceCustomIndexEXT
+        geometry_instance.instanceCustomIndex =
+          scene->getObjectDescriptionOffset(static_cast<int>(model_index));// gl_InstanceCustomIndexEXT
         geometry_instance.mask = 0xFF;
         geometry_instance.instanceShaderBindingTableRecordOffset = 0;
         geometry_instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
@@ -175,7 +180,8 @@ void ASManager::createTLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
       geometryInstanceBuffer,
       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR
         | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::AccelerationStructure,
       tlas_instances);
 
     VkBufferDeviceAddressInfo geometry_instance_buffer_device_address_info{};
@@ -246,7 +252,8 @@ void ASManager::createTLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
       acceleration_structure_build_sizes_info.accelerationStructureSize,
       VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
         | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::AccelerationStructure);
 
     VkAccelerationStructureCreateInfoKHR acceleration_structure_create_info{};
     acceleration_structure_create_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
@@ -266,7 +273,8 @@ void ASManager::createTLAS(VulkanDevice *device, VkCommandPool commandPool, Scen
     scratchBuffer.create(device,
       acceleration_structure_build_sizes_info.buildScratchSize,
       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::AccelerationStructure);
 
     VkBufferDeviceAddressInfo scratch_buffer_device_address_info{};
     scratch_buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -339,7 +347,8 @@ void ASManager::createSingleBlas(VulkanDevice *device,
       build_as_structure.size_info.accelerationStructureSize,
       VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
         | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::AccelerationStructure);
 
     acceleration_structure_create_info.buffer = blasVulkanBuffer.getBuffer();
     VkAccelerationStructureKHR &blas_as = build_as_structure.single_blas.vulkanAS;
@@ -391,34 +400,15 @@ void ASManager::createAccelerationStructureInfosBLAS(VulkanDevice *device,
 
 void ASManager::objectToVkGeometryKHR(VulkanDevice *device,
   Mesh *mesh,
+  const Submesh &submesh,
   VkAccelerationStructureGeometryKHR &acceleration_structure_geometry,
   VkAccelerationStructureBuildRangeInfoKHR &acceleration_structure_build_range_info)
 {
-    // LOAD ALL NECESSARY FUNCTIONS STRAIGHT IN THE BEGINNING
-    // all functionality from extensions has to be loaded in the beginning
-    // we need a reference to the device location of our geometry laying on the
-    // graphics card we already uploaded objects and created vertex and index
-    // buffers respectively
-    PFN_vkGetBufferDeviceAddressKHR pvkGetBufferDeviceAddressKHR =
-      (PFN_vkGetBufferDeviceAddressKHR)vkGetDeviceProcAddr(device->getLogicalDevice(), "vkGetBufferDeviceAddress");
-
     // all starts with the address of our vertex and index data we already
-    // uploaded in buffers earlier when loading the meshes/models
-    VkBufferDeviceAddressInfo vertex_buffer_device_address_info{};
-    vertex_buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-    vertex_buffer_device_address_info.buffer = mesh->getVertexBuffer();
-    vertex_buffer_device_address_info.pNext = nullptr;
-
-    VkBufferDeviceAddressInfo index_buffer_device_address_info{};
-    index_buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-    index_buffer_device_address_info.buffer = mesh->getIndexBuffer();
-    index_buffer_device_address_info.pNext = nullptr;
-
-    // receiving address to move on
-    VkDeviceAddress vertex_buffer_address =
-      pvkGetBufferDeviceAddressKHR(device->getLogicalDevice(), &vertex_buffer_device_address_info);
-    VkDeviceAddress index_buffer_address =
-      pvkGetBufferDeviceAddressKHR(device->getLogicalDevice(), &index_buffer_device_address_info);
+    // uploaded earlier when loading the meshes/models; the mesh's ranges of
+    // the geometry pool start right there
+    VkDeviceAddress vertex_buffer_address = mesh->getVertexAddress();
+    VkDeviceAddress index_buffer_address = mesh->getIndexAddress();
 
     // convert to const address for further processing
     VkDeviceOrHostAddressConstKHR vertex_device_or_host_address_const{};
@@ -430,9 +420,10 @@ void ASManager::objectToVkGeometryKHR(VulkanDevice *device,
     VkAccelerationStructureGeometryTrianglesDataKHR acceleration_structure_triangles_data{};
     acceleration_structure_triangles_data.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
     acceleration_structure_triangles_data.pNext = nullptr;
-    acceleration_structure_triangles_data.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+    // quantized meshes are built in their unit cube; the instance transform dequantizes
+    acceleration_structure_triangles_data.vertexFormat = vertex::getPositionFormat(mesh->getVertexLayout());
     acceleration_structure_triangles_data.vertexData = vertex_device_or_host_address_const;
-    acceleration_structure_triangles_data.vertexStride = sizeof(Vertex);
+    acceleration_structure_triangles_data.vertexStride = vertex::getVertexStride(mesh->getVertexLayout());
     acceleration_structure_triangles_data.maxVertex = mesh->getVertexCount();
     acceleration_structure_triangles_data.indexType = VK_INDEX_TYPE_UINT32;
     acceleration_structure_triangles_data.indexData = index_device_or_host_address_const;
@@ -446,14 +437,13 @@ void ASManager::objectToVkGeometryKHR(VulkanDevice *device,
     acceleration_structure_geometry.pNext = nullptr;
     acceleration_structure_geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
     acceleration_structure_geometry.geometry = acceleration_structure_geometry_data;
-    acceleration_structure_geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+    // see through materials are left to any hit processing
+    acceleration_structure_geometry.flags = submesh.opaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0;
 
-    // we have triangles so divide the number of vertices with 3!!
-    // for our simple case a no brainer
-    // take entire data to build BLAS
-    // number of indices is truly the stick point here
-    acceleration_structure_build_range_info.primitiveCount = mesh->getIndexCount() / 3;
-    acceleration_structure_build_range_info.primitiveOffset = 0;
+    // all submeshes share the index buffer; the range picks the submesh's
+    // triangles and gl_PrimitiveID counts from its first triangle
+    acceleration_structure_build_range_info.primitiveCount = submesh.index_count / 3;
+    acceleration_structure_build_range_info.primitiveOffset = submesh.first_index * sizeof(uint32_t);
     acceleration_structure_build_range_info.firstVertex = 0;
     acceleration_structure_build_range_info.transformOffset = 0;
 }
@@ -59,6 +59,7 @@ class ASManager
 
     void objectToVkGeometryKHR(VulkanDevice *device,
       Mesh *mesh,
+      const Submesh &submesh,
       VkAccelerationStructureGeometryKHR &acceleration_structure_geometry,
       VkAccelerationStructureBuildRangeInfoKHR &acceleration_structure_build_range_info);
 };
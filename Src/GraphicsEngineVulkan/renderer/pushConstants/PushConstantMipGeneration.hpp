@@ -0,0 +1,28 @@
+// this little "hack" is needed for using it on the
+// CPU side as well for the GPU side :)
+// inspired by the NVDIDIA tutorial:
+// https://nvpro-samples.github.io/vk_raytracing_tutorial_KHR/
+
+#ifdef __cplusplus
+#pragma once
+#include <glm/glm.hpp>
+// GLSL Type
+using vec2 = glm::vec2;
+using vec3 = glm::vec3;
+using vec4 = glm::vec4;
+using mat4 = glm::mat4;
+using uint = unsigned int;
+#endif
+
+// level 0 of at most 4096x4096 texels
+#define MIP_GENERATION_MAX_LEVELS 13
+
+struct PushConstantMipGeneration
+{
+    uint width;
+    uint height;
+    uint mip_levels;
+    uint workgroup_count;
+    // atomic counter of this dispatch
+    uint counter_slot;
+};
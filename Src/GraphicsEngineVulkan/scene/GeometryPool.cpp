@@ -0,0 +1,119 @@
+#include "GeometryPool.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "spdlog/spdlog.h"
+
+GeometryPool::GeometryPool() {}
+
+void GeometryPool::init(VulkanDevice *device, VulkanUploadManager *uploadManager)
+{
+    this->device = device;
+    this->uploadManager = uploadManager;
+}
+
+GeometryPool::Range GeometryPool::allocate(Kind kind, const void *data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    Range range;
+    range.kind = kind;
+    range.size = size;
+    if (size == 0) return range;
+
+    // a stride of e.g. 20 bytes and 16 byte addresses need an alignment of 80
+    alignment = std::lcm(std::max(alignment, VkDeviceSize{ 1 }), MIN_ALIGNMENT);
+
+    std::vector<Block> &kind_blocks = blocks[index(kind)];
+    for (uint32_t block = 0; block < static_cast<uint32_t>(kind_blocks.size()); block++) {
+        if (kind_blocks[block].ranges.allocate(size, alignment, range.offset)) {
+            range.block = block;
+            break;
+        }
+    }
+
+    if (!range.isValid()) {
+        createBlock(kind, std::max(getBlockSize(kind), size));
+        if (!kind_blocks.back().ranges.allocate(size, alignment, range.offset)) {
+            spdlog::error("Failed to allocate {} KiB of geometry!", size / 1024);
+            return range;
+        }
+        range.block = static_cast<uint32_t>(kind_blocks.size()) - 1;
+    }
+
+    uploadManager->uploadBuffer(kind_blocks[range.block].buffer, data, size, range.offset);
+    return range;
+}
+
+void GeometryPool::free(Range &range)
+{
+    if (!range.isValid()) return;
+    blocks[index(range.kind)][range.block].ranges.free(range.offset, range.size);
+    range = Range{};
+}
+
+VkDeviceAddress GeometryPool::getAddress(const Range &range) const
+{
+    if (!range.isValid()) return 0;
+    return blocks[index(range.kind)][range.block].address + range.offset;
+}
+
+VkDeviceSize GeometryPool::getUsedBytes(Kind kind) const
+{
+    VkDeviceSize used = 0;
+    for (const Block &block : blocks[index(kind)]) used += block.ranges.getUsed();
+    return used;
+}
+
+VkDeviceSize GeometryPool::getBlockSize(Kind kind)
+{
+    switch (kind) {
+    case Kind::Vertex:
+        return 64 * 1024 * 1024;
+    case Kind::Index:
+        return 32 * 1024 * 1024;
+    default:
+        return 1024 * 1024;
+    }
+}
+
+void GeometryPool::cleanUp()
+{
+    for (std::vector<Block> &kind_blocks : blocks) {
+        for (Block &block : kind_blocks) block.buffer.cleanUp();
+        kind_blocks.clear();
+    }
+}
+
+GeometryPool::~GeometryPool() {}
+
+VkBufferUsageFlags GeometryPool::getUsage(Kind kind)
+{
+    // everything is read through device addresses by the ray tracing and path tracing shaders
+    const VkBufferUsageFlags usage =
+      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    switch (kind) {
+    case Kind::Vertex:
+        return usage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+               | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    case Kind::Index:
+        return usage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+               | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    default:
+        return usage;
+    }
+}
+
+void GeometryPool::createBlock(Kind kind, VkDeviceSize size)
+{
+    Block block;
+    block.buffer.create(device, size, getUsage(kind), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Geometry);
+    block.ranges.init(size);
+
+    VkBufferDeviceAddressInfo address_info{};
+    address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    address_info.buffer = block.buffer.getBuffer();
+    block.address = vkGetBufferDeviceAddress(device->getLogicalDevice(), &address_info);
+
+    blocks[index(kind)].push_back(block);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "RangeAllocator.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanUploadManager.hpp"
+
+// vertices, indices and materials of all meshes in a few large buffers
+// instead of a set of buffers per mesh. every kind of data lives in blocks
+// that are sub-allocated with a RangeAllocator; a new block is only created
+// once the existing ones are full (as large as needed for meshes that do not
+// fit a regular block). a scene thus usually has one vertex and one index
+// buffer the rasterizer binds once and draws from with offsets
+class GeometryPool
+{
+  public:
+    enum class Kind : uint32_t { Vertex, Index, Material, Count };
+
+    struct Range
+    {
+        Kind kind{ Kind::Vertex };
+        uint32_t block{ INVALID_BLOCK };
+        VkDeviceSize offset{ 0 };
+        VkDeviceSize size{ 0 };
+
+        bool isValid() const { return block != INVALID_BLOCK; };
+    };
+
+    static constexpr uint32_t INVALID_BLOCK = UINT32_MAX;
+    // buffer_reference blocks in the shaders assume 16 byte aligned addresses
+    static constexpr VkDeviceSize MIN_ALIGNMENT = 16;
+
+    GeometryPool();
+
+    void init(VulkanDevice *device, VulkanUploadManager *uploadManager);
+
+    // allocates a range of size bytes and records the upload of data into it;
+    // alignment in bytes, e.g. the vertex stride so draws can offset by vertices
+    Range allocate(Kind kind, const void *data, VkDeviceSize size, VkDeviceSize alignment = MIN_ALIGNMENT);
+    // the range must not be in use by the gpu any more
+    void free(Range &range);
+
+    VkBuffer getBuffer(Kind kind, uint32_t block) { return blocks[index(kind)][block].buffer.getBuffer(); };
+    VkBuffer getBuffer(const Range &range)
+    {
+        return range.isValid() ? getBuffer(range.kind, range.block) : VK_NULL_HANDLE;
+    };
+    VkDeviceAddress getAddress(const Range &range) const;
+    uint32_t getBlockCount(Kind kind) const { return static_cast<uint32_t>(blocks[index(kind)].size()); };
+    VkDeviceSize getUsedBytes(Kind kind) const;
+
+    static VkDeviceSize getBlockSize(Kind kind);
+
+    void cleanUp();
+
+    ~GeometryPool();
+
+  private:
+    struct Block
+    {
+        VulkanBuffer buffer;
+        RangeAllocator ranges;
+        VkDeviceAddress address{ 0 };
+    };
+
+    VulkanDevice *device{ VK_NULL_HANDLE };
+    VulkanUploadManager *uploadManager{ nullptr };
+
+    std::array<std::vector<Block>, static_cast<size_t>(Kind::Count)> blocks;
+
+    static size_t index(Kind kind) { return static_cast<size_t>(kind); };
+    static VkBufferUsageFlags getUsage(Kind kind);
+    void createBlock(Kind kind, VkDeviceSize size);
+};
@@ -1,6 +1,9 @@
 #include "Mesh.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <limits>
 #include <memory>
 
 #include "Utilities.hpp"
@@ -10,20 +13,20 @@ Mesh::Mesh() {}
 
 void Mesh::cleanUp()
 {
-    vertexBuffer.cleanUp();
-    indexBuffer.cleanUp();
-    objectDescriptionBuffer.cleanUp();
-    materialIdsBuffer.cleanUp();
-    materialsBuffer.cleanUp();
+    if (geometryPool == nullptr) return;
+    geometryPool->free(vertexRange);
+    geometryPool->free(indexRange);
+    geometryPool->free(materialRange);
 }
 
 Mesh::Mesh(VulkanDevice *device,
-  VkQueue transfer_queue,
-  VkCommandPool transfer_command_pool,
-  std::vector<Vertex> &vertices,
-  std::vector<uint32_t> &indices,
-  std::vector<unsigned int> &materialIndex,
-  std::vector<ObjMaterial> &materials)
+  GeometryPool *geometryPool,
+  std::span<const Vertex> vertices,
+  std::span<const uint32_t> indices,
+  std::span<const Submesh> submeshes,
+  std::span<const MeshLod> lods,
+  std::span<const ObjMaterial> materials,
+  VertexLayout vertexLayout)
 {
     // glm uses column major matrices so transpose it for Vulkan want row major
     // here
@@ -33,90 +36,165 @@ Mesh::Mesh(VulkanDevice *device,
 
     index_count = static_cast<uint32_t>(indices.size());
     vertex_count = static_cast<uint32_t>(vertices.size());
+    vertex_layout = vertexLayout;
     this->device = device;
-    object_description = ObjectDescription{};
-    createVertexBuffer(transfer_queue, transfer_command_pool, vertices);
-    createIndexBuffer(transfer_queue, transfer_command_pool, indices);
-    createMaterialIDBuffer(transfer_queue, transfer_command_pool, materialIndex);
-    createMaterialBuffer(transfer_queue, transfer_command_pool, materials);
-
-    VkBufferDeviceAddressInfo vertex_info{};
-    vertex_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
-    vertex_info.buffer = vertexBuffer.getBuffer();
-
-    VkBufferDeviceAddressInfo index_info{};
-    index_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
-    index_info.buffer = indexBuffer.getBuffer();
-
-    VkBufferDeviceAddressInfo material_index_info{};
-    material_index_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
-    material_index_info.buffer = materialIdsBuffer.getBuffer();
-
-    VkBufferDeviceAddressInfo material_info{};
-    material_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
-    material_info.buffer = materialsBuffer.getBuffer();
-
-    object_description.index_address = vkGetBufferDeviceAddress(device->getLogicalDevice(), &index_info);
-    object_description.vertex_address = vkGetBufferDeviceAddress(device->getLogicalDevice(), &vertex_info);
-    object_description.material_index_address =
-      vkGetBufferDeviceAddress(device->getLogicalDevice(), &material_index_info);
-    object_description.material_address = vkGetBufferDeviceAddress(device->getLogicalDevice(), &material_info);
+    this->geometryPool = geometryPool;
+    this->submeshes.assign(submeshes.begin(), submeshes.end());
+    this->lods.clear();
+    this->lods.push_back({ 0.f, this->submeshes });
+    this->lods.insert(this->lods.end(), lods.begin(), lods.end());
+    computeSubmeshBounds(vertices, indices);
+    // the copies are only recorded here; they land in the upload manager's
+    // current batch and are submitted together with the rest of the model
+    switch (vertex_layout) {
+    case VertexLayout::Compact:
+        createCompactVertexBuffer(vertices);
+        break;
+    case VertexLayout::Quantized:
+        createQuantizedVertexBuffer(vertices);
+        break;
+    default:
+        createVertexBuffer(vertices);
+        break;
+    }
+    createIndexBuffer(indices);
+    createMaterialBuffer(materials);
+
+    const VkDeviceAddress vertex_address = geometryPool->getAddress(vertexRange);
+    const VkDeviceAddress index_address = geometryPool->getAddress(indexRange);
+    const VkDeviceAddress material_address = geometryPool->getAddress(materialRange);
+
+    // the shaders address index and material relative to the submesh, so
+    // neither a per face material id nor a first index is needed on the gpu
+    object_descriptions.clear();
+    object_descriptions.reserve(this->submeshes.size());
+    for (const Submesh &submesh : this->submeshes) {
+        ObjectDescription object_description{};
+        object_description.vertex_address = vertex_address;
+        object_description.index_address = index_address + sizeof(uint32_t) * submesh.first_index;
+        object_description.material_address = material_address + sizeof(ObjMaterial) * submesh.material_id;
+        object_descriptions.push_back(object_description);
+    }
 
     model = glm::mat4(1.0f);
 }
 
 void Mesh::setModel(glm::mat4 new_model) { model = new_model; }
 
+int32_t Mesh::getVertexOffset()
+{
+    // the pool aligns vertex ranges to the stride
+    return static_cast<int32_t>(vertexRange.offset / vertex::getVertexStride(vertex_layout));
+}
+
+uint32_t Mesh::selectLod(size_t submesh,
+  const glm::mat4 &transform,
+  glm::vec3 camera_position,
+  float projection_scale,
+  float max_pixel_error)
+{
+    // errors and bounds scale with the largest axis of the transform
+    const float scale = std::max({ glm::length(glm::vec3(transform[0])),
+      glm::length(glm::vec3(transform[1])),
+      glm::length(glm::vec3(transform[2])) });
+
+    const glm::vec4 &bounds = submesh_bounds[submesh];
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(bounds), 1.0f));
+    const float distance = glm::length(camera_position - center) - bounds.w * scale;
+
+    return lod::select(lods, scale, distance, projection_scale, max_pixel_error);
+}
+
+float Mesh::getProjectedSize(size_t submesh,
+  const glm::mat4 &transform,
+  glm::vec3 camera_position,
+  float projection_scale)
+{
+    const float scale = std::max({ glm::length(glm::vec3(transform[0])),
+      glm::length(glm::vec3(transform[1])),
+      glm::length(glm::vec3(transform[2])) });
+
+    const glm::vec4 &bounds = submesh_bounds[submesh];
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(bounds), 1.0f));
+    const float distance = glm::length(camera_position - center) - bounds.w * scale;
+
+    return lod::getProjectedError(2.0f * bounds.w * scale, distance, projection_scale);
+}
+
+void Mesh::computeSubmeshBounds(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+{
+    // box center and the farthest vertex from it; not minimal but cheap
+    submesh_bounds.clear();
+    submesh_bounds.reserve(submeshes.size());
+    for (const Submesh &submesh : submeshes) {
+        glm::vec3 min_bound(std::numeric_limits<float>::max());
+        glm::vec3 max_bound(std::numeric_limits<float>::lowest());
+        for (uint32_t i = submesh.first_index; i < submesh.first_index + submesh.index_count; i++) {
+            min_bound = glm::min(min_bound, vertices[indices[i]].pos);
+            max_bound = glm::max(max_bound, vertices[indices[i]].pos);
+        }
+        if (submesh.index_count == 0) min_bound = max_bound = glm::vec3(0.f);
+
+        const glm::vec3 center = (min_bound + max_bound) * 0.5f;
+        float radius = 0.f;
+        for (uint32_t i = submesh.first_index; i < submesh.first_index + submesh.index_count; i++) {
+            radius = std::max(radius, glm::length(vertices[indices[i]].pos - center));
+        }
+        submesh_bounds.emplace_back(center, radius);
+    }
+}
+
 Mesh::~Mesh() {}
 
-void Mesh::createVertexBuffer(VkQueue transfer_queue,
-  VkCommandPool transfer_command_pool,
-  std::vector<Vertex> &vertices)
+void Mesh::createVertexBuffer(std::span<const Vertex> vertices)
 {
-    vulkanBufferManager.createBufferAndUploadVectorOnDevice(device,
-      transfer_command_pool,
-      vertexBuffer,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
-        | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
-      vertices);
+    vertexRange = geometryPool->allocate(
+      GeometryPool::Kind::Vertex, vertices.data(), vertices.size_bytes(), vertex::getVertexStride(vertex_layout));
+}
+
+void Mesh::createCompactVertexBuffer(std::span<const Vertex> vertices)
+{
+    std::vector<CompactVertex> compact_vertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) compact_vertices[i] = vertex::compact(vertices[i]);
+
+    vertexRange = geometryPool->allocate(GeometryPool::Kind::Vertex,
+      compact_vertices.data(),
+      sizeof(CompactVertex) * compact_vertices.size(),
+      vertex::getVertexStride(vertex_layout));
 }
 
-void Mesh::createIndexBuffer(VkQueue transfer_queue,
-  VkCommandPool transfer_command_pool,
-  std::vector<uint32_t> &indices)
+void Mesh::createQuantizedVertexBuffer(std::span<const Vertex> vertices)
 {
-    vulkanBufferManager.createBufferAndUploadVectorOnDevice(device,
-      transfer_command_pool,
-      indexBuffer,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
-        | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
-      indices);
+    // one uniform scale for all axes keeps the dequantization a similarity
+    // transform, so normals need no extra treatment
+    glm::vec3 min_bound(std::numeric_limits<float>::max());
+    glm::vec3 max_bound(std::numeric_limits<float>::lowest());
+    for (const Vertex &v : vertices) {
+        min_bound = glm::min(min_bound, v.pos);
+        max_bound = glm::max(max_bound, v.pos);
+    }
+    glm::vec3 center = vertices.empty() ? glm::vec3(0.f) : (min_bound + max_bound) * 0.5f;
+    glm::vec3 half_extent = vertices.empty() ? glm::vec3(0.f) : (max_bound - min_bound) * 0.5f;
+    float scale = std::max({ half_extent.x, half_extent.y, half_extent.z });
+    if (scale <= 0.f) scale = 1.f;
+
+    dequantization = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale));
+
+    std::vector<QuantizedVertex> quantized_vertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) quantized_vertices[i] = vertex::quantize(vertices[i], center, scale);
+
+    vertexRange = geometryPool->allocate(GeometryPool::Kind::Vertex,
+      quantized_vertices.data(),
+      sizeof(QuantizedVertex) * quantized_vertices.size(),
+      vertex::getVertexStride(vertex_layout));
 }
 
-void Mesh::createMaterialIDBuffer(VkQueue transfer_queue,
-  VkCommandPool transfer_command_pool,
-  std::vector<unsigned int> &materialIndex)
+void Mesh::createIndexBuffer(std::span<const uint32_t> indices)
 {
-    vulkanBufferManager.createBufferAndUploadVectorOnDevice(device,
-      transfer_command_pool,
-      materialIdsBuffer,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
-        | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
-      materialIndex);
+    indexRange = geometryPool->allocate(GeometryPool::Kind::Index, indices.data(), indices.size_bytes());
 }
 
-void Mesh::createMaterialBuffer(VkQueue transfer_queue,
-  VkCommandPool transfer_command_pool,
-  std::vector<ObjMaterial> &materials)
+void Mesh::createMaterialBuffer(std::span<const ObjMaterial> materials)
 {
-    vulkanBufferManager.createBufferAndUploadVectorOnDevice(device,
-      transfer_command_pool,
-      materialsBuffer,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
-        | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
-      materials);
+    materialRange = geometryPool->allocate(GeometryPool::Kind::Material, materials.data(), materials.size_bytes());
 }
@@ -1,70 +1,97 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <span>
 #include <vector>
 
+#include "GeometryPool.hpp"
+#include "MeshLod.hpp"
 #include "ObjMaterial.hpp"
 #include "ObjectDescription.hpp"
+#include "Submesh.hpp"
 #include "Vertex.hpp"
-#include "VulkanBufferManager.hpp"
 
 // this a simple Mesh without mesh generation
 class Mesh
 {
   public:
+    // vertices, indices and materials are sub-allocated from geometryPool
     Mesh(VulkanDevice *device,
-      VkQueue transfer_queue,
-      VkCommandPool transfer_command_pool,
-      std::vector<Vertex> &vertices,
-      std::vector<uint32_t> &indices,
-      std::vector<unsigned int> &materialIndex,
-      std::vector<ObjMaterial> &materials);
+      GeometryPool *geometryPool,
+      std::span<const Vertex> vertices,
+      std::span<const uint32_t> indices,
+      std::span<const Submesh> submeshes,
+      std::span<const MeshLod> lods,
+      std::span<const ObjMaterial> materials,
+      VertexLayout vertexLayout);
 
     Mesh();
 
     void cleanUp();
 
-    ObjectDescription &getObjectDescription() { return object_description; };
+    // one per submesh, in submesh order
+    std::vector<ObjectDescription> &getObjectDescriptions() { return object_descriptions; };
+    std::vector<Submesh> &getSubmeshes() { return submeshes; };
+    // level 0 (the submeshes, error 0) followed by the simplified levels
+    std::vector<MeshLod> &getLods() { return lods; };
+    // level of the submesh for a camera; transform is the model matrix without dequantization
+    uint32_t selectLod(size_t submesh,
+      const glm::mat4 &transform,
+      glm::vec3 camera_position,
+      float projection_scale,
+      float max_pixel_error);
+    // diameter in pixels of the submesh bounds for a camera; same transform as selectLod()
+    float getProjectedSize(size_t submesh, const glm::mat4 &transform, glm::vec3 camera_position, float projection_scale);
     glm::mat4 getModel() { return model; };
     uint32_t getVertexCount() { return vertex_count; };
+    // all levels of detail; level 0 alone is the sum over the submeshes
     uint32_t getIndexCount() { return index_count; };
-    VkBuffer &getVertexBuffer() { return vertexBuffer.getBuffer(); };
-    VkBuffer &getMaterialIDBuffer() { return materialIdsBuffer.getBuffer(); };
-    VkBuffer &getIndexBuffer() { return indexBuffer.getBuffer(); };
+    VertexLayout getVertexLayout() { return vertex_layout; };
+    // maps the quantized object space back to model space; identity for float positions
+    glm::mat4 getDequantization() { return dequantization; };
+    // shared pool buffers; draws offset into them with getVertexOffset() and getFirstIndex()
+    VkBuffer getVertexBuffer() { return geometryPool->getBuffer(vertexRange); };
+    VkBuffer getIndexBuffer() { return geometryPool->getBuffer(indexRange); };
+    // in vertices, as vkCmdDrawIndexed's vertexOffset
+    int32_t getVertexOffset();
+    // in indices; the submeshes' first indices are relative to it
+    uint32_t getFirstIndex() { return static_cast<uint32_t>(indexRange.offset / sizeof(uint32_t)); };
+    const GeometryPool::Range &getVertexRange() { return vertexRange; };
+    const GeometryPool::Range &getIndexRange() { return indexRange; };
+    VkDeviceAddress getVertexAddress() { return geometryPool->getAddress(vertexRange); };
+    VkDeviceAddress getIndexAddress() { return geometryPool->getAddress(indexRange); };
 
     void setModel(glm::mat4 new_model);
 
     ~Mesh();
 
   private:
-    VulkanBufferManager vulkanBufferManager;
+    std::vector<Submesh> submeshes;
+    std::vector<ObjectDescription> object_descriptions;
+    std::vector<MeshLod> lods;
+    // bounding sphere (center, radius) of every submesh in model space
+    std::vector<glm::vec4> submesh_bounds;
 
-    ObjectDescription object_description{ static_cast<uint64_t>(-1),
-        static_cast<uint64_t>(-1),
-        static_cast<uint64_t>(-1),
-        static_cast<uint64_t>(-1) };
-
-    VulkanBuffer vertexBuffer;
-    VulkanBuffer indexBuffer;
-    VulkanBuffer objectDescriptionBuffer;
-    VulkanBuffer materialIdsBuffer;
-    VulkanBuffer materialsBuffer;
+    GeometryPool *geometryPool{ nullptr };
+    GeometryPool::Range vertexRange;
+    GeometryPool::Range indexRange;
+    GeometryPool::Range materialRange;
 
     glm::mat4 model;
+    glm::mat4 dequantization{ 1.0f };
+    VertexLayout vertex_layout{ VertexLayout::Full };
 
     uint32_t vertex_count{ static_cast<uint32_t>(-1) };
     uint32_t index_count{ static_cast<uint32_t>(-1) };
 
     VulkanDevice *device{ VK_NULL_HANDLE };
 
-    void createVertexBuffer(VkQueue transfer_queue, VkCommandPool transfer_command_pool, std::vector<Vertex> &vertices);
+    void createVertexBuffer(std::span<const Vertex> vertices);
+    void createCompactVertexBuffer(std::span<const Vertex> vertices);
+    void createQuantizedVertexBuffer(std::span<const Vertex> vertices);
 
-    void createIndexBuffer(VkQueue transfer_queue, VkCommandPool transfer_command_pool, std::vector<uint32_t> &indices);
+    void computeSubmeshBounds(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
 
-    void createMaterialIDBuffer(VkQueue transfer_queue,
-      VkCommandPool transfer_command_pool,
-      std::vector<unsigned int> &materialIndex);
+    void createIndexBuffer(std::span<const uint32_t> indices);
 
-    void createMaterialBuffer(VkQueue transfer_queue,
-      VkCommandPool transfer_command_pool,
-      std::vector<ObjMaterial> &materials);
+    void createMaterialBuffer(std::span<const ObjMaterial> materials);
 };
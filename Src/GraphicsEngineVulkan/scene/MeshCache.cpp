@@ -0,0 +1,318 @@
+#include "MeshCache.hpp"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "File.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+uint64_t alignUp(uint64_t value) { return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1); }
+
+int64_t lastWriteTime(const std::string &file, std::error_code &error)
+{
+    return static_cast<int64_t>(std::filesystem::last_write_time(file, error).time_since_epoch().count());
+}
+
+// paths are stored relative to the model directory so the cache
+// stays valid if the whole resource folder is moved
+bool makeRelative(const std::string &base_dir, const std::string &path, std::string &relative)
+{
+    if (path.size() <= base_dir.size() || path.compare(0, base_dir.size(), base_dir) != 0) return false;
+    if (path[base_dir.size()] != '/' && path[base_dir.size()] != '\\') return false;
+    relative = path.substr(base_dir.size() + 1);
+    return true;
+}
+
+void appendBytes(std::vector<char> &out, const void *data, size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+void appendString(std::vector<char> &out, const std::string &string)
+{
+    uint32_t length = static_cast<uint32_t>(string.size());
+    appendBytes(out, &length, sizeof(length));
+    appendBytes(out, string.data(), string.size());
+}
+
+// bounds checked reader over the string section
+struct Reader
+{
+    const char *current;
+    const char *end;
+
+    bool read(void *dst, size_t size)
+    {
+        if (static_cast<size_t>(end - current) < size) return false;
+        std::memcpy(dst, current, size);
+        current += size;
+        return true;
+    }
+
+    bool readString(std::string &string)
+    {
+        uint32_t length = 0;
+        if (!read(&length, sizeof(length)) || static_cast<size_t>(end - current) < length) return false;
+        string.assign(current, length);
+        current += length;
+        return true;
+    }
+};
+
+}// namespace
+
+std::string MeshCache::getCacheFile(const std::string &modelFile) { return modelFile + ".meshcache"; }
+
+uint64_t MeshCache::hashContent(const char *data, size_t size)
+{
+    // xxhash64 style single lane: 8 bytes per step, good enough
+    // to detect edits and much faster than hashing byte wise
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+
+    uint64_t hash = PRIME_3 + static_cast<uint64_t>(size);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= std::rotl(word * PRIME_2, 31) * PRIME_1;
+        hash = std::rotl(hash, 27) * PRIME_1 + PRIME_3;
+    }
+    for (; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]) * PRIME_3;
+        hash = std::rotl(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+bool MeshCache::write(const std::string &modelFile, const CookInput &input)
+{
+    File model_file(modelFile);
+    const std::string base_dir = model_file.getBaseDir();
+
+    std::vector<char> strings;
+    for (const std::string &source_file : input.sources) {
+        std::string relative;
+        if (!makeRelative(base_dir, source_file, relative)) {
+            spdlog::warn("Mesh cache: {} is outside of {}, not caching", source_file, base_dir);
+            return false;
+        }
+
+        MappedFile source_mapping(source_file);
+        std::error_code error;
+        Source source{};
+        source.size = source_mapping.size();
+        source.mtime = lastWriteTime(source_file, error);
+        if (!source_mapping.isOpen() || error) return false;
+        source.hash = hashContent(source_mapping.data(), source_mapping.size());
+
+        appendBytes(strings, &source, sizeof(source));
+        appendString(strings, relative);
+    }
+    for (const std::string &texture : input.textures) {
+        std::string relative;
+        if (!texture.empty() && !makeRelative(base_dir, texture, relative)) {
+            spdlog::warn("Mesh cache: {} is outside of {}, not caching", texture, base_dir);
+            return false;
+        }
+        appendString(strings, relative);
+    }
+
+    // lods are stored flat: one error per level, then the ranges level by level
+    const uint32_t lod_submesh_count = input.lods.empty() ? 0 : static_cast<uint32_t>(input.lods[0].submeshes.size());
+    std::vector<float> lod_errors;
+    std::vector<Submesh> lod_submeshes;
+    for (const MeshLod &lod : input.lods) {
+        if (lod.submeshes.size() != lod_submesh_count) return false;
+        lod_errors.push_back(lod.error);
+        lod_submeshes.insert(lod_submeshes.end(), lod.submeshes.begin(), lod.submeshes.end());
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.vertex_stride = sizeof(Vertex);
+    header.material_stride = sizeof(ObjMaterial);
+    header.source_count = static_cast<uint32_t>(input.sources.size());
+    header.texture_count = static_cast<uint32_t>(input.textures.size());
+    header.lod_count = static_cast<uint32_t>(input.lods.size());
+    header.lod_submesh_count = lod_submesh_count;
+    header.submesh_stride = sizeof(Submesh);
+    header.vertex_count = input.vertices.size();
+    header.index_count = input.indices.size();
+    header.face_count = input.materialIndex.size();
+    header.material_count = input.materials.size();
+    header.vertex_offset = alignUp(sizeof(Header));
+    header.index_offset = alignUp(header.vertex_offset + input.vertices.size_bytes());
+    header.material_index_offset = alignUp(header.index_offset + input.indices.size_bytes());
+    header.material_offset = alignUp(header.material_index_offset + input.materialIndex.size_bytes());
+    header.lod_error_offset = alignUp(header.material_offset + input.materials.size_bytes());
+    header.lod_submesh_offset = alignUp(header.lod_error_offset + lod_errors.size() * sizeof(float));
+    header.string_offset = alignUp(header.lod_submesh_offset + lod_submeshes.size() * sizeof(Submesh));
+    header.file_size = header.string_offset + strings.size();
+
+    std::vector<char> image(header.file_size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!input.vertices.empty())
+        std::memcpy(image.data() + header.vertex_offset, input.vertices.data(), input.vertices.size_bytes());
+    if (!input.indices.empty())
+        std::memcpy(image.data() + header.index_offset, input.indices.data(), input.indices.size_bytes());
+    if (!input.materialIndex.empty())
+        std::memcpy(
+          image.data() + header.material_index_offset, input.materialIndex.data(), input.materialIndex.size_bytes());
+    if (!input.materials.empty())
+        std::memcpy(image.data() + header.material_offset, input.materials.data(), input.materials.size_bytes());
+    if (!lod_errors.empty())
+        std::memcpy(image.data() + header.lod_error_offset, lod_errors.data(), lod_errors.size() * sizeof(float));
+    if (!lod_submeshes.empty())
+        std::memcpy(
+          image.data() + header.lod_submesh_offset, lod_submeshes.data(), lod_submeshes.size() * sizeof(Submesh));
+    if (!strings.empty()) std::memcpy(image.data() + header.string_offset, strings.data(), strings.size());
+
+    // write next to the final file and rename, so a crash never leaves a
+    // half written cache that would pass the header checks
+    const std::string cache_file = getCacheFile(modelFile);
+    const std::string temp_file = cache_file + ".tmp";
+    {
+        std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            spdlog::warn("Mesh cache: could not write {}", temp_file);
+            return false;
+        }
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(temp_file);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_file, cache_file, error);
+    if (error) {
+        spdlog::warn("Mesh cache: could not move {} into place: {}", cache_file, error.message());
+        std::filesystem::remove(temp_file, error);
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshCache::open(const std::string &modelFile)
+{
+    mapping.reset();
+    vertices = {};
+    indices = {};
+    materialIndex = {};
+    materials = {};
+    textures.clear();
+    lods.clear();
+
+    const std::string cache_file = getCacheFile(modelFile);
+    std::error_code error;
+    if (!std::filesystem::exists(cache_file, error)) return false;
+
+    mapping = std::make_unique<MappedFile>(cache_file);
+    const char *data = mapping->data();
+    const size_t size = mapping->size();
+
+    Header header{};
+    if (data == nullptr || size < sizeof(Header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.magic != MAGIC || header.version != VERSION || header.vertex_stride != sizeof(Vertex)
+        || header.material_stride != sizeof(ObjMaterial) || header.submesh_stride != sizeof(Submesh)
+        || header.file_size != size) {
+        spdlog::info("Mesh cache: {} has an outdated format", cache_file);
+        return false;
+    }
+
+    // every section has to lie in front of the next one
+    if (header.vertex_count > size || header.index_count > size || header.face_count > size
+        || header.material_count > size || header.lod_count > size || header.lod_submesh_count > size
+        || header.vertex_offset < sizeof(Header)
+        || header.index_offset < header.vertex_offset + header.vertex_count * sizeof(Vertex)
+        || header.material_index_offset < header.index_offset + header.index_count * sizeof(uint32_t)
+        || header.material_offset < header.material_index_offset + header.face_count * sizeof(unsigned int)
+        || header.lod_error_offset < header.material_offset + header.material_count * sizeof(ObjMaterial)
+        || header.lod_submesh_offset < header.lod_error_offset + header.lod_count * sizeof(float)
+        || header.string_offset
+             < header.lod_submesh_offset + uint64_t(header.lod_count) * header.lod_submesh_count * sizeof(Submesh)
+        || header.string_offset > size) {
+        spdlog::warn("Mesh cache: {} is corrupt", cache_file);
+        return false;
+    }
+
+    File model_file(modelFile);
+    const std::string base_dir = model_file.getBaseDir();
+
+    Reader reader{ data + header.string_offset, data + size };
+    for (uint32_t i = 0; i < header.source_count; i++) {
+        Source source{};
+        std::string relative;
+        if (!reader.read(&source, sizeof(source)) || !reader.readString(relative)) return false;
+        if (!sourceUpToDate(base_dir + "/" + relative, source)) {
+            spdlog::info("Mesh cache: {} changed, rebuilding {}", relative, cache_file);
+            return false;
+        }
+    }
+
+    textures.reserve(header.texture_count);
+    for (uint32_t i = 0; i < header.texture_count; i++) {
+        std::string relative;
+        if (!reader.readString(relative)) return false;
+        textures.push_back(relative.empty() ? "" : base_dir + "/" + relative);
+    }
+
+    vertices = { reinterpret_cast<const Vertex *>(data + header.vertex_offset), header.vertex_count };
+    indices = { reinterpret_cast<const uint32_t *>(data + header.index_offset), header.index_count };
+    materialIndex = { reinterpret_cast<const unsigned int *>(data + header.material_index_offset), header.face_count };
+    materials = { reinterpret_cast<const ObjMaterial *>(data + header.material_offset), header.material_count };
+
+    const float *lod_errors = reinterpret_cast<const float *>(data + header.lod_error_offset);
+    const Submesh *lod_submeshes = reinterpret_cast<const Submesh *>(data + header.lod_submesh_offset);
+    lods.resize(header.lod_count);
+    for (uint32_t l = 0; l < header.lod_count; l++) {
+        lods[l].error = lod_errors[l];
+        lods[l].submeshes.assign(
+          lod_submeshes + l * header.lod_submesh_count, lod_submeshes + (l + 1) * header.lod_submesh_count);
+        for (const Submesh &submesh : lods[l].submeshes) {
+            if (uint64_t(submesh.first_index) + submesh.index_count > header.index_count) {
+                spdlog::warn("Mesh cache: {} is corrupt", cache_file);
+                lods.clear();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool MeshCache::sourceUpToDate(const std::string &file, const Source &source)
+{
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(file, error);
+    if (error || size != source.size) return false;
+
+    // unchanged timestamp: trust it without touching the content
+    const int64_t mtime = lastWriteTime(file, error);
+    if (!error && mtime == source.mtime) return true;
+
+    // touched (e.g. by a checkout) but maybe not modified
+    MappedFile source_mapping(file);
+    return source_mapping.isOpen() && hashContent(source_mapping.data(), source_mapping.size()) == source.hash;
+}
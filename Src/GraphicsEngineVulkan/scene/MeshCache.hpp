@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "MeshLod.hpp"
+#include "ObjMaterial.hpp"
+#include "Vertex.hpp"
+
+// versioned binary image of a loaded model ("cooked mesh"): final vertices,
+// indices (level 0 followed by the levels of detail), per face material ids
+// of level 0, materials, lod ranges and texture paths. all arrays are
+// 64 byte aligned inside the file so they can be handed to the staging ring
+// straight out of the mapping. the cache remembers size, mtime and content
+// hash of every source file (.obj + .mtl) and is rebuilt if one of them changed
+class MeshCache
+{
+  public:
+    static constexpr uint64_t MAGIC = 0x48534d4b4f4f4347ull;// "GCOOKMSH"
+    // bump whenever the layout or the loader output changes
+    static constexpr uint32_t VERSION = 5;
+
+    // sources/textures are absolute paths below the model's directory
+    struct CookInput
+    {
+        std::span<const Vertex> vertices;
+        std::span<const uint32_t> indices;
+        std::span<const unsigned int> materialIndex;
+        std::span<const ObjMaterial> materials;
+        std::span<const std::string> textures;
+        std::span<const std::string> sources;
+        // levels 1.., all with the same number of submeshes
+        std::span<const MeshLod> lods;
+    };
+
+    static std::string getCacheFile(const std::string &modelFile);
+    static uint64_t hashContent(const char *data, size_t size);
+
+    // returns false (and leaves no partial file behind) if writing fails
+    static bool write(const std::string &modelFile, const CookInput &input);
+
+    // maps the cache of modelFile; false if missing, corrupt or stale
+    bool open(const std::string &modelFile);
+
+    std::span<const Vertex> getVertices() const { return vertices; };
+    std::span<const uint32_t> getIndices() const { return indices; };
+    std::span<const unsigned int> getMaterialIndex() const { return materialIndex; };
+    std::span<const ObjMaterial> getMaterials() const { return materials; };
+    const std::vector<std::string> &getTextures() const { return textures; };
+    const std::vector<MeshLod> &getLods() const { return lods; };
+
+  private:
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t vertex_stride;
+        uint32_t material_stride;
+        uint32_t source_count;
+        uint32_t texture_count;
+        uint32_t lod_count;
+        uint32_t lod_submesh_count;
+        uint32_t submesh_stride;
+        uint64_t file_size;
+        uint64_t vertex_count;
+        uint64_t index_count;
+        uint64_t face_count;
+        uint64_t material_count;
+        uint64_t vertex_offset;
+        uint64_t index_offset;
+        uint64_t material_index_offset;
+        uint64_t material_offset;
+        uint64_t lod_error_offset;
+        uint64_t lod_submesh_offset;
+        uint64_t string_offset;
+    };
+
+    struct Source
+    {
+        uint64_t size;
+        int64_t mtime;
+        uint64_t hash;
+    };
+
+    std::unique_ptr<MappedFile> mapping;
+
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const unsigned int> materialIndex;
+    std::span<const ObjMaterial> materials;
+    std::vector<std::string> textures;
+    std::vector<MeshLod> lods;
+
+    static bool sourceUpToDate(const std::string &file, const Source &source);
+};
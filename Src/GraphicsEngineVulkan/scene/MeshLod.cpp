@@ -0,0 +1,34 @@
+#include "MeshLod.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lod {
+
+float getProjectionScale(float fov_y, float viewport_height)
+{
+    return viewport_height / (2.f * std::tan(fov_y * 0.5f));
+}
+
+float getProjectedError(float error, float distance, float projection_scale)
+{
+    // inside the bounds everything is as close as it gets
+    return error / std::max(distance, 1e-4f) * projection_scale;
+}
+
+uint32_t select(std::span<const MeshLod> lods,
+  float error_scale,
+  float distance,
+  float projection_scale,
+  float max_pixel_error)
+{
+    // errors grow with the level, so the first one that is too coarse ends the search
+    uint32_t level = 0;
+    for (uint32_t l = 1; l < static_cast<uint32_t>(lods.size()); l++) {
+        if (getProjectedError(lods[l].error * error_scale, distance, projection_scale) > max_pixel_error) break;
+        level = l;
+    }
+    return level;
+}
+
+}// namespace lod
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Submesh.hpp"
+
+// level of detail of a Mesh: ranges of the shared index buffer over the
+// shared vertex buffer, one per level 0 submesh and in the same order, so
+// material and object description are the ones of the level 0 submesh
+struct MeshLod
+{
+    // largest object space distance of the level to the full resolution surface
+    float error;
+    std::vector<Submesh> submeshes;
+};
+
+namespace lod {
+
+// pixels covered by one unit at distance one: viewport height / (2 tan(fov_y / 2))
+float getProjectionScale(float fov_y, float viewport_height);
+
+// size in pixels of an object space error seen from distance
+float getProjectedError(float error, float distance, float projection_scale);
+
+// coarsest level whose projected error stays within max_pixel_error; the
+// errors are scaled by error_scale (largest scale of the model matrix)
+uint32_t select(std::span<const MeshLod> lods,
+  float error_scale,
+  float distance,
+  float projection_scale,
+  float max_pixel_error);
+
+}// namespace lod
@@ -0,0 +1,305 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+// per vertex list of adjacent triangles in one flat array (csr layout)
+struct Adjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> live;
+
+    Adjacency(std::span<const uint32_t> indices, size_t vertex_count)
+      : offsets(vertex_count + 1, 0), triangles(indices.size()), live(vertex_count, 0)
+    {
+        for (uint32_t index : indices) live[index]++;
+        for (size_t v = 0; v < vertex_count; v++) offsets[v + 1] = offsets[v] + live[v];
+
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+};
+
+}// namespace
+
+size_t MeshOptimizer::countCacheMisses(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size)
+{
+    // a vertex is in the fifo if fewer than cache_size misses happened since it got in
+    std::vector<size_t> entered(vertex_count, 0);
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (entered[index] == 0 || misses - entered[index] >= cache_size) {
+            misses++;
+            entered[index] = misses;
+        }
+    }
+    return misses;
+}
+
+float MeshOptimizer::computeACMR(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size)
+{
+    if (indices.size() < 3) return 0.f;
+    return float(countCacheMisses(indices, vertex_count, cache_size)) / float(indices.size() / 3);
+}
+
+float MeshOptimizer::computeATVR(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size)
+{
+    if (vertex_count == 0) return 0.f;
+    return float(countCacheMisses(indices, vertex_count, cache_size)) / float(vertex_count);
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(std::span<const uint32_t> indices,
+  size_t vertex_count,
+  uint32_t cache_size,
+  std::vector<uint32_t> &cluster_starts)
+{
+    const size_t triangle_count = indices.size() / 3;
+
+    std::vector<uint32_t> order;
+    order.reserve(triangle_count);
+    cluster_starts.clear();
+    if (triangle_count == 0) return order;
+
+    Adjacency adjacency(indices, vertex_count);
+    std::vector<uint32_t> &live = adjacency.live;
+
+    std::vector<uint32_t> cache_time(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32_t> dead_end;
+    dead_end.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    candidates.reserve(64);
+
+    // time starts above cache_size so nothing counts as cached in the beginning
+    uint32_t time = cache_size + 1;
+    uint32_t cursor = 0;
+    uint32_t fanning = indices[0];
+
+    // a new cluster begins whenever the next fanning vertex is not in the cache
+    // any more; that is where tipsify's order is free to jump across the mesh
+    cluster_starts.push_back(0);
+
+    while (fanning != NONE) {
+        candidates.clear();
+
+        // emit all remaining triangles around the fanning vertex
+        for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; a++) {
+            const uint32_t triangle = adjacency.triangles[a];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+            order.push_back(triangle);
+
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                const uint32_t v = indices[3 * triangle + corner];
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cache_time[v] > cache_size) cache_time[v] = time++;
+            }
+        }
+
+        // best candidate: in cache after its remaining triangles are emitted and oldest
+        uint32_t next = NONE;
+        uint32_t best_priority = 0;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            uint32_t priority = 0;
+            if (time - cache_time[v] + 2 * live[v] <= cache_size) priority = time - cache_time[v];
+            if (next == NONE || priority > best_priority) {
+                best_priority = priority;
+                next = v;
+            }
+        }
+
+        if (next == NONE) {
+            // dead end: go back along the recently used vertices ...
+            while (!dead_end.empty() && next == NONE) {
+                const uint32_t v = dead_end.back();
+                dead_end.pop_back();
+                if (live[v] > 0) next = v;
+            }
+            // ... or continue with the next vertex in input order
+            while (next == NONE && cursor < vertex_count) {
+                if (live[cursor] > 0) next = cursor;
+                cursor++;
+            }
+        }
+
+        if (next != NONE && time - cache_time[next] > cache_size && order.size() < triangle_count) {
+            cluster_starts.push_back(static_cast<uint32_t>(order.size()));
+        }
+        fanning = next;
+    }
+
+    return order;
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeOverdraw(std::span<const uint32_t> indices,
+  std::span<const Vertex> vertices,
+  std::span<const uint32_t> triangle_order,
+  std::span<const uint32_t> cluster_starts)
+{
+    const size_t cluster_count = cluster_starts.size();
+    if (cluster_count <= 1) return std::vector<uint32_t>(triangle_order.begin(), triangle_order.end());
+
+    // area weighted centroid of the whole mesh
+    glm::vec3 mesh_centroid(0.f);
+    float mesh_area = 0.f;
+
+    std::vector<glm::vec3> cluster_centroid(cluster_count, glm::vec3(0.f));
+    std::vector<glm::vec3> cluster_normal(cluster_count, glm::vec3(0.f));
+    std::vector<float> cluster_area(cluster_count, 0.f);
+
+    for (size_t c = 0; c < cluster_count; c++) {
+        const size_t begin = cluster_starts[c];
+        const size_t end = c + 1 < cluster_count ? cluster_starts[c + 1] : triangle_order.size();
+        for (size_t t = begin; t < end; t++) {
+            const uint32_t triangle = triangle_order[t];
+            const glm::vec3 &p0 = vertices[indices[3 * triangle + 0]].pos;
+            const glm::vec3 &p1 = vertices[indices[3 * triangle + 1]].pos;
+            const glm::vec3 &p2 = vertices[indices[3 * triangle + 2]].pos;
+
+            // the cross product length is twice the area, which cancels out
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(n);
+            glm::vec3 centroid = (p0 + p1 + p2) / 3.f;
+
+            cluster_centroid[c] += centroid * area;
+            cluster_normal[c] += n;
+            cluster_area[c] += area;
+        }
+        mesh_centroid += cluster_centroid[c];
+        mesh_area += cluster_area[c];
+    }
+    if (mesh_area > 0.f) mesh_centroid /= mesh_area;
+
+    // clusters facing away from the mesh center occlude the others from most
+    // view points (sander et al.), so they get drawn first
+    std::vector<float> sort_key(cluster_count, 0.f);
+    for (size_t c = 0; c < cluster_count; c++) {
+        if (cluster_area[c] <= 0.f) continue;
+        glm::vec3 centroid = cluster_centroid[c] / cluster_area[c];
+        float normal_length = glm::length(cluster_normal[c]);
+        if (normal_length > 0.f) sort_key[c] = glm::dot(centroid - mesh_centroid, cluster_normal[c] / normal_length);
+    }
+
+    std::vector<uint32_t> clusters(cluster_count);
+    std::iota(clusters.begin(), clusters.end(), 0u);
+    std::stable_sort(clusters.begin(), clusters.end(), [&](uint32_t a, uint32_t b) { return sort_key[a] > sort_key[b]; });
+
+    std::vector<uint32_t> order;
+    order.reserve(triangle_order.size());
+    for (uint32_t c : clusters) {
+        const size_t begin = cluster_starts[c];
+        const size_t end = c + 1 < cluster_count ? cluster_starts[c + 1] : triangle_order.size();
+        order.insert(order.end(), triangle_order.begin() + begin, triangle_order.begin() + end);
+    }
+    return order;
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    // renumber in order of first use; unreferenced vertices are dropped
+    std::vector<uint32_t> remap(vertices.size(), NONE);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t &index : indices) {
+        if (remap[index] == NONE) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+}
+
+MeshOptimizerStats MeshOptimizer::optimize(std::vector<Vertex> &vertices,
+  std::vector<uint32_t> &indices,
+  std::vector<unsigned int> &materialIndex)
+{
+    MeshOptimizerStats stats;
+    stats.acmr_before = computeACMR(indices, vertices.size(), CACHE_SIZE);
+    stats.atvr_before = computeATVR(indices, vertices.size(), CACHE_SIZE);
+
+    const size_t triangle_count = indices.size() / 3;
+    const bool per_triangle_materials = materialIndex.size() == triangle_count;
+
+    // every material becomes one contiguous range (a submesh); the ranges
+    // are sorted by material id and each one is optimized on its own
+    std::vector<uint32_t> grouped(triangle_count);
+    std::iota(grouped.begin(), grouped.end(), 0u);
+    if (per_triangle_materials) {
+        std::stable_sort(grouped.begin(), grouped.end(), [&](uint32_t a, uint32_t b) {
+            return materialIndex[a] < materialIndex[b];
+        });
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(triangle_count);
+    std::vector<uint32_t> local_id(vertices.size(), NONE);
+    std::vector<uint32_t> group_indices;
+    std::vector<Vertex> group_vertices;
+    std::vector<uint32_t> cluster_starts;
+
+    for (size_t begin = 0; begin < triangle_count;) {
+        size_t end = begin + 1;
+        if (per_triangle_materials) {
+            while (end < triangle_count && materialIndex[grouped[end]] == materialIndex[grouped[begin]]) end++;
+        } else {
+            end = triangle_count;
+        }
+
+        // group local vertex numbering keeps the per group work proportional to its size
+        group_indices.clear();
+        group_vertices.clear();
+        for (size_t t = begin; t < end; t++) {
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                const uint32_t index = indices[3 * grouped[t] + corner];
+                if (local_id[index] == NONE) {
+                    local_id[index] = static_cast<uint32_t>(group_vertices.size());
+                    group_vertices.push_back(vertices[index]);
+                }
+                group_indices.push_back(local_id[index]);
+            }
+        }
+        for (size_t t = begin; t < end; t++) {
+            for (uint32_t corner = 0; corner < 3; corner++) local_id[indices[3 * grouped[t] + corner]] = NONE;
+        }
+
+        std::vector<uint32_t> group_order =
+          optimizeVertexCache(group_indices, group_vertices.size(), CACHE_SIZE, cluster_starts);
+        group_order = optimizeOverdraw(group_indices, group_vertices, group_order, cluster_starts);
+        stats.cluster_count += static_cast<uint32_t>(cluster_starts.size());
+
+        for (uint32_t local_triangle : group_order) order.push_back(grouped[begin + local_triangle]);
+        begin = end;
+    }
+
+    std::vector<uint32_t> reordered_indices(order.size() * 3);
+    std::vector<unsigned int> reordered_material_index;
+    if (per_triangle_materials) reordered_material_index.resize(order.size());
+
+    for (size_t t = 0; t < order.size(); t++) {
+        const uint32_t triangle = order[t];
+        reordered_indices[3 * t + 0] = indices[3 * triangle + 0];
+        reordered_indices[3 * t + 1] = indices[3 * triangle + 1];
+        reordered_indices[3 * t + 2] = indices[3 * triangle + 2];
+        if (per_triangle_materials) reordered_material_index[t] = materialIndex[triangle];
+    }
+
+    indices = std::move(reordered_indices);
+    if (per_triangle_materials) materialIndex = std::move(reordered_material_index);
+
+    optimizeVertexFetch(vertices, indices);
+
+    stats.acmr_after = computeACMR(indices, vertices.size(), CACHE_SIZE);
+    stats.atvr_after = computeATVR(indices, vertices.size(), CACHE_SIZE);
+    return stats;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Vertex.hpp"
+
+struct MeshOptimizerStats
+{
+    // average cache miss ratio: transformed vertices per triangle (0.5 .. 3)
+    float acmr_before{ 0.f };
+    float acmr_after{ 0.f };
+    // average transform to vertex ratio: transformed vertices per vertex (>= 1)
+    float atvr_before{ 0.f };
+    float atvr_after{ 0.f };
+    uint32_t cluster_count{ 0 };
+};
+
+// reorders a triangle list for the gpu after loading:
+//  0. material: triangles are grouped into one range per material id, in
+//     ascending order; steps 1 and 2 run inside every range
+//  1. vertex cache: tipsify (Sander et al. 2007) triangle order
+//  2. overdraw: the tipsify clusters are sorted outside facing first
+//  3. vertex fetch: vertices are renumbered in order of first use
+// the per triangle material ids travel with their triangles
+class MeshOptimizer
+{
+  public:
+    // fifo size used for the tipsify target and for the statistics
+    static constexpr uint32_t CACHE_SIZE = 16;
+
+    static MeshOptimizerStats optimize(std::vector<Vertex> &vertices,
+      std::vector<uint32_t> &indices,
+      std::vector<unsigned int> &materialIndex);
+
+    // returns the new triangle order; cluster_starts receives the first
+    // triangle (position in the new order) of every cluster
+    static std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices,
+      size_t vertex_count,
+      uint32_t cache_size,
+      std::vector<uint32_t> &cluster_starts);
+
+    // sorts clusters of an already cache optimized triangle order
+    static std::vector<uint32_t> optimizeOverdraw(std::span<const uint32_t> indices,
+      std::span<const Vertex> vertices,
+      std::span<const uint32_t> triangle_order,
+      std::span<const uint32_t> cluster_starts);
+
+    static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+    static float computeACMR(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size);
+    static float computeATVR(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size);
+
+  private:
+    static size_t countCacheMisses(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size);
+};
@@ -0,0 +1,393 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+// weights of the attribute change against the squared distance (unit extent)
+constexpr float NORMAL_WEIGHT = 0.25f;
+constexpr float TEXCOORD_WEIGHT = 0.5f;
+// planes perpendicular to open borders keep them from shrinking
+constexpr float BORDER_WEIGHT = 10.f;
+
+enum class VertexKind : uint8_t {
+    // interior vertex, may collapse onto any neighbour
+    Manifold,
+    // on exactly one border loop, may only slide along it
+    Border,
+    // seam, corner of several borders or isolated: never moves
+    Locked,
+};
+
+// symmetric 4x4 matrix of a sum of squared plane distances; w is the area
+struct Quadric
+{
+    float a00{ 0.f }, a11{ 0.f }, a22{ 0.f }, a01{ 0.f }, a02{ 0.f }, a12{ 0.f };
+    float b0{ 0.f }, b1{ 0.f }, b2{ 0.f };
+    float c{ 0.f };
+    float w{ 0.f };
+
+    void addPlane(glm::vec3 n, float d, float weight)
+    {
+        a00 += weight * n.x * n.x;
+        a11 += weight * n.y * n.y;
+        a22 += weight * n.z * n.z;
+        a01 += weight * n.x * n.y;
+        a02 += weight * n.x * n.z;
+        a12 += weight * n.y * n.z;
+        b0 += weight * n.x * d;
+        b1 += weight * n.y * d;
+        b2 += weight * n.z * d;
+        c += weight * d * d;
+    }
+
+    void add(const Quadric &q)
+    {
+        a00 += q.a00;
+        a11 += q.a11;
+        a22 += q.a22;
+        a01 += q.a01;
+        a02 += q.a02;
+        a12 += q.a12;
+        b0 += q.b0;
+        b1 += q.b1;
+        b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    float evaluate(glm::vec3 p) const
+    {
+        float r = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z;
+        r += 2.f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z);
+        r += 2.f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        // the sum cancels badly close to the planes
+        return std::max(r, 0.f);
+    }
+};
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    float cost;
+};
+
+// per vertex list of adjacent triangles in one flat array (csr layout)
+struct Adjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    void build(std::span<const uint32_t> indices, size_t vertex_count)
+    {
+        offsets.assign(vertex_count + 1, 0);
+        triangles.resize(indices.size());
+        for (uint32_t index : indices) offsets[index + 1]++;
+        for (size_t v = 0; v < vertex_count; v++) offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+};
+
+void computeBounds(std::span<const Vertex> vertices, glm::vec3 &min_bound, glm::vec3 &max_bound)
+{
+    min_bound = glm::vec3(std::numeric_limits<float>::max());
+    max_bound = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const Vertex &v : vertices) {
+        min_bound = glm::min(min_bound, v.pos);
+        max_bound = glm::max(max_bound, v.pos);
+    }
+    if (vertices.empty()) min_bound = max_bound = glm::vec3(0.f);
+}
+
+}// namespace
+
+float MeshSimplifier::computeExtent(std::span<const Vertex> vertices)
+{
+    glm::vec3 min_bound, max_bound;
+    computeBounds(vertices, min_bound, max_bound);
+    glm::vec3 size = max_bound - min_bound;
+    return std::max({ size.x, size.y, size.z });
+}
+
+float MeshSimplifier::simplify(std::span<const Vertex> vertices,
+  std::vector<uint32_t> &indices,
+  std::vector<uint32_t> &groups,
+  size_t target_index_count,
+  float target_error)
+{
+    const size_t vertex_count = vertices.size();
+    const bool grouped = groups.size() == indices.size() / 3;
+
+    // work in the unit box so errors are relative to the extent
+    glm::vec3 min_bound, max_bound;
+    computeBounds(vertices, min_bound, max_bound);
+    const float extent = computeExtent(vertices);
+    const float scale = extent > 0.f ? 1.f / extent : 1.f;
+
+    std::vector<glm::vec3> positions(vertex_count);
+    std::vector<glm::vec3> normals(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        positions[v] = (vertices[v].pos - min_bound) * scale;
+        float length = glm::length(vertices[v].normal);
+        normals[v] = length > 0.f ? vertices[v].normal / length : vertices[v].normal;
+    }
+
+    // a position used by more than one vertex is a seam of normals or uvs
+    std::vector<bool> seam(vertex_count, false);
+    {
+        std::vector<uint32_t> sorted(vertex_count);
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+            const glm::vec3 &pa = vertices[a].pos;
+            const glm::vec3 &pb = vertices[b].pos;
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            return pa.z < pb.z;
+        });
+        for (size_t i = 1; i < vertex_count; i++) {
+            if (vertices[sorted[i]].pos == vertices[sorted[i - 1]].pos) seam[sorted[i]] = seam[sorted[i - 1]] = true;
+        }
+    }
+
+    Adjacency adjacency;
+    std::vector<bool> border_edge;
+    std::vector<VertexKind> kind(vertex_count);
+
+    // half edge a -> b of triangle t is a border if no triangle of the same
+    // group runs b -> a
+    auto findBorders = [&]() {
+        adjacency.build(indices, vertex_count);
+        border_edge.assign(indices.size(), true);
+        for (size_t t = 0; t < indices.size() / 3; t++) {
+            for (uint32_t k = 0; k < 3; k++) {
+                const uint32_t a = indices[3 * t + k];
+                const uint32_t b = indices[3 * t + (k + 1) % 3];
+                for (uint32_t i = adjacency.offsets[b]; i < adjacency.offsets[b + 1] && border_edge[3 * t + k]; i++) {
+                    const uint32_t other = adjacency.triangles[i];
+                    if (grouped && groups[other] != groups[t]) continue;
+                    for (uint32_t j = 0; j < 3; j++) {
+                        if (indices[3 * other + j] == b && indices[3 * other + (j + 1) % 3] == a) {
+                            border_edge[3 * t + k] = false;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<uint32_t> border_count(vertex_count, 0);
+        for (size_t i = 0; i < indices.size(); i++) {
+            if (!border_edge[i]) continue;
+            border_count[indices[i]]++;
+            border_count[indices[i - i % 3 + (i + 1) % 3]]++;
+        }
+        for (size_t v = 0; v < vertex_count; v++) {
+            if (seam[v] || (border_count[v] != 0 && border_count[v] != 2)) kind[v] = VertexKind::Locked;
+            else kind[v] = border_count[v] == 0 ? VertexKind::Manifold : VertexKind::Border;
+        }
+    };
+    findBorders();
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t t = 0; t < indices.size() / 3; t++) {
+        const glm::vec3 &p0 = positions[indices[3 * t + 0]];
+        const glm::vec3 &p1 = positions[indices[3 * t + 1]];
+        const glm::vec3 &p2 = positions[indices[3 * t + 2]];
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(n);
+        if (length <= 0.f) continue;
+        n /= length;
+        const float area = 0.5f * length;
+
+        for (uint32_t k = 0; k < 3; k++) {
+            Quadric &q = quadrics[indices[3 * t + k]];
+            q.addPlane(n, -glm::dot(n, p0), area);
+            q.w += area;
+        }
+
+        for (uint32_t k = 0; k < 3; k++) {
+            if (!border_edge[3 * t + k]) continue;
+            const uint32_t a = indices[3 * t + k];
+            const uint32_t b = indices[3 * t + (k + 1) % 3];
+            const glm::vec3 edge = positions[b] - positions[a];
+            const glm::vec3 side = glm::cross(edge, n);
+            const float side_length = glm::length(side);
+            if (side_length <= 0.f) continue;
+            const glm::vec3 side_normal = side / side_length;
+            const float weight = BORDER_WEIGHT * glm::dot(edge, edge);
+            quadrics[a].addPlane(side_normal, -glm::dot(side_normal, positions[a]), weight);
+            quadrics[b].addPlane(side_normal, -glm::dot(side_normal, positions[a]), weight);
+        }
+    }
+
+    auto collapseCost = [&](uint32_t from, uint32_t to) {
+        const Quadric &q = quadrics[from];
+        const glm::vec3 dn = normals[from] - normals[to];
+        const glm::vec2 dt = vertices[from].texture_coords - vertices[to].texture_coords;
+        const float attribute = NORMAL_WEIGHT * NORMAL_WEIGHT * glm::dot(dn, dn)
+                                + TEXCOORD_WEIGHT * TEXCOORD_WEIGHT * glm::dot(dt, dt);
+        if (q.w <= 0.f) return q.evaluate(positions[to]) + attribute;
+        return q.evaluate(positions[to]) / q.w + attribute;
+    };
+
+    auto allowed = [&](uint32_t from, uint32_t to, bool border) {
+        if (kind[from] == VertexKind::Locked) return false;
+        if (kind[from] == VertexKind::Border) return border && kind[to] != VertexKind::Manifold;
+        return !border;
+    };
+
+    // counts the triangles the collapse removes; false if another one flips over
+    auto keepsOrientation = [&](uint32_t from, uint32_t to, size_t &removed) {
+        removed = 0;
+        for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++) {
+            const uint32_t t = adjacency.triangles[i];
+            const uint32_t i0 = indices[3 * t + 0];
+            const uint32_t i1 = indices[3 * t + 1];
+            const uint32_t i2 = indices[3 * t + 2];
+            if (i0 == to || i1 == to || i2 == to) {
+                removed++;
+                continue;
+            }
+            const glm::vec3 n_old = glm::cross(positions[i1] - positions[i0], positions[i2] - positions[i0]);
+            const glm::vec3 &q0 = positions[i0 == from ? to : i0];
+            const glm::vec3 &q1 = positions[i1 == from ? to : i1];
+            const glm::vec3 &q2 = positions[i2 == from ? to : i2];
+            const glm::vec3 n_new = glm::cross(q1 - q0, q2 - q0);
+            // turning by more than ~75 degrees (or collapsing to a line) folds the surface
+            if (glm::dot(n_old, n_new) <= 0.25f * glm::length(n_old) * glm::length(n_new)) return false;
+        }
+        return true;
+    };
+
+    const float max_cost = target_error * target_error;
+    float result_cost = 0.f;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<bool> locked(vertex_count);
+
+    for (bool first_pass = true; indices.size() > target_index_count; first_pass = false) {
+        if (!first_pass) findBorders();
+
+        // cheapest allowed direction of every edge; interior edges show up twice
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i++) {
+            const uint32_t a = indices[i];
+            const uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+            const bool border = border_edge[i];
+            if (!border && a > b) continue;
+
+            Collapse best{ NONE, NONE, std::numeric_limits<float>::max() };
+            if (allowed(a, b, border)) best = { a, b, collapseCost(a, b) };
+            if (allowed(b, a, border)) {
+                const float cost = collapseCost(b, a);
+                if (cost < best.cost) best = { b, a, cost };
+            }
+            if (best.from != NONE && best.cost <= max_cost) collapses.push_back(best);
+        }
+        if (collapses.empty()) break;
+        std::sort(
+          collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+        // a collapse changes the triangles around its source, so their corners
+        // wait for the next pass where the costs are up to date again
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(locked.begin(), locked.end(), false);
+        const size_t target_triangles = target_index_count / 3;
+        size_t triangle_count = indices.size() / 3;
+        size_t applied = 0;
+
+        for (const Collapse &collapse : collapses) {
+            if (triangle_count <= target_triangles) break;
+            if (locked[collapse.from] || locked[collapse.to]) continue;
+
+            size_t removed = 0;
+            if (!keepsOrientation(collapse.from, collapse.to, removed)) continue;
+
+            for (uint32_t i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; i++) {
+                const uint32_t t = adjacency.triangles[i];
+                for (uint32_t k = 0; k < 3; k++) locked[indices[3 * t + k]] = true;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            result_cost = std::max(result_cost, collapse.cost);
+            triangle_count -= std::min(removed, triangle_count);
+            applied++;
+        }
+        if (applied == 0) break;
+
+        // drop the triangles that lost an edge, keep the order of the rest
+        size_t write = 0;
+        for (size_t t = 0; t < indices.size() / 3; t++) {
+            const uint32_t i0 = remap[indices[3 * t + 0]];
+            const uint32_t i1 = remap[indices[3 * t + 1]];
+            const uint32_t i2 = remap[indices[3 * t + 2]];
+            if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+            indices[3 * write + 0] = i0;
+            indices[3 * write + 1] = i1;
+            indices[3 * write + 2] = i2;
+            if (grouped) groups[write] = groups[t];
+            write++;
+        }
+        indices.resize(3 * write);
+        if (grouped) groups.resize(write);
+    }
+
+    return std::sqrt(result_cost);
+}
+
+std::vector<MeshLod> MeshSimplifier::buildLods(std::span<const Vertex> vertices,
+  std::vector<uint32_t> &indices,
+  std::span<const Submesh> submeshes)
+{
+    std::vector<MeshLod> lods;
+
+    // every level starts from the one above; the group of a triangle is its submesh
+    std::vector<uint32_t> level_indices;
+    std::vector<uint32_t> level_groups;
+    for (uint32_t s = 0; s < static_cast<uint32_t>(submeshes.size()); s++) {
+        const Submesh &submesh = submeshes[s];
+        level_indices.insert(level_indices.end(),
+          indices.begin() + submesh.first_index,
+          indices.begin() + submesh.first_index + submesh.index_count);
+        level_groups.insert(level_groups.end(), submesh.index_count / 3, s);
+    }
+
+    // the error of a level is bounded by the sum of the errors of all steps to it
+    const float extent = computeExtent(vertices);
+    float error = 0.f;
+
+    for (uint32_t level = 1; level <= MAX_LOD_LEVELS && error < MAX_LOD_ERROR; level++) {
+        const size_t previous_count = level_indices.size();
+        const size_t target_count = static_cast<size_t>(float(previous_count / 3) * LOD_REDUCTION) * 3;
+        error += simplify(vertices, level_indices, level_groups, target_count, MAX_LOD_ERROR - error);
+
+        // stuck on seams and borders or at the error bound
+        if (level_indices.empty() || level_indices.size() * 10 > previous_count * 9) break;
+
+        MeshLod lod{ error * extent, std::vector<Submesh>(submeshes.begin(), submeshes.end()) };
+        for (Submesh &submesh : lod.submeshes) submesh.index_count = 0;
+        for (uint32_t group : level_groups) lod.submeshes[group].index_count += 3;
+
+        // the groups are still sorted, so each submesh stays one range
+        uint32_t first_index = static_cast<uint32_t>(indices.size());
+        for (Submesh &submesh : lod.submeshes) {
+            submesh.first_index = first_index;
+            first_index += submesh.index_count;
+        }
+        indices.insert(indices.end(), level_indices.begin(), level_indices.end());
+
+        lods.push_back(std::move(lod));
+    }
+
+    return lods;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "MeshLod.hpp"
+#include "Submesh.hpp"
+#include "Vertex.hpp"
+
+// quadric error edge collapse (Garland and Heckbert 1997) on a triangle list.
+// every collapse moves a vertex onto one of its neighbours, so all levels of
+// detail index the vertex buffer of the full mesh. the cost of a collapse is
+// the area weighted quadric of the removed vertex plus the change of normal
+// and texture coordinates it causes.
+// vertices with more than one attribute set (uv/normal seams) never move;
+// open borders and edges between triangle groups (submeshes) only collapse
+// along themselves
+class MeshSimplifier
+{
+  public:
+    // extra levels built below level 0
+    static constexpr uint32_t MAX_LOD_LEVELS = 4;
+    // triangle count of a level relative to the one above
+    static constexpr float LOD_REDUCTION = 0.5f;
+    // relative to the mesh extent; coarser levels are not worth it
+    static constexpr float MAX_LOD_ERROR = 0.05f;
+
+    // removes triangles until indices has at most target_index_count entries or
+    // the next collapse would exceed target_error (relative to the mesh extent).
+    // surviving triangles keep their order and their entry in groups (may be
+    // empty). returns the reached error relative to the mesh extent
+    static float simplify(std::span<const Vertex> vertices,
+      std::vector<uint32_t> &indices,
+      std::vector<uint32_t> &groups,
+      size_t target_index_count,
+      float target_error);
+
+    // levels 1.. for the level 0 given by submeshes; their indices are appended
+    // to indices and every level has one (maybe empty) range per submesh
+    static std::vector<MeshLod> buildLods(std::span<const Vertex> vertices,
+      std::vector<uint32_t> &indices,
+      std::span<const Submesh> submeshes);
+
+    // largest side of the bounding box
+    static float computeExtent(std::span<const Vertex> vertices);
+};
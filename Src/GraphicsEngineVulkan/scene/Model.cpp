@@ -4,38 +4,56 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "spdlog/spdlog.h"
+
 Model::Model() {}
 
-Model::Model(VulkanDevice *device) { this->device = device; }
+Model::Model(VulkanDevice *device, TextureCache *textureCache, GeometryPool *geometryPool)
+{
+    this->device = device;
+    this->textureCache = textureCache;
+    this->geometryPool = geometryPool;
+}
 
 void Model::cleanUp()
 {
-    for (Texture texture : modelTextures) { texture.cleanUp(); }
-
-    for (VkSampler texture_sampler : modelTextureSamplers) {
-        vkDestroySampler(device->getLogicalDevice(), texture_sampler, nullptr);
-    }
+    for (const TextureCache::Key &key : textureKeys) { textureCache->releaseTexture(key); }
+    textureKeys.clear();
+    textureSlots.clear();
 
     mesh.cleanUp();
 }
 
 void Model::add_new_mesh(VulkanDevice *device,
-  VkQueue transfer_queue,
-  VkCommandPool command_pool,
-  std::vector<Vertex> &vertices,
-  std::vector<unsigned int> &indices,
-  std::vector<unsigned int> &materialIndex,
-  std::vector<ObjMaterial> &materials)
+  std::span<const Vertex> vertices,
+  std::span<const uint32_t> indices,
+  std::span<const Submesh> submeshes,
+  std::span<const MeshLod> lods,
+  std::span<const ObjMaterial> materials,
+  VertexLayout vertexLayout)
 {
-    this->mesh = Mesh(device, transfer_queue, command_pool, vertices, indices, materialIndex, materials);
+    this->mesh = Mesh(device, geometryPool, vertices, indices, submeshes, lods, materials, vertexLayout);
+
+    // the materials already index the texture table
+    submeshTextureSlots.clear();
+    for (const Submesh &submesh : submeshes) {
+        submeshTextureSlots.push_back(static_cast<uint32_t>(materials[submesh.material_id].textureID));
+    }
 }
 
 void Model::set_model(glm::mat4 model) { this->model = model; }
 
-void Model::addTexture(Texture newTexture)
+void Model::addTexture(const TextureCache::Key &key)
 {
-    modelTextures.push_back(newTexture);
-    addSampler(newTexture);
+    Texture texture;
+    uint32_t slot = 0;
+    if (!textureCache->acquireTexture(key, texture, slot)) {
+        spdlog::error("Texture " + key.path + " is not in the texture cache!");
+        return;
+    }
+
+    textureKeys.push_back(key);
+    textureSlots.push_back(slot);
 }
 
 uint32_t Model::getPrimitiveCount()
@@ -49,33 +67,10 @@ uint32_t Model::getPrimitiveCount()
       }
 
       return number_of_indices / 3;*/
-    return mesh.getIndexCount() / 3;
+    // level 0 only; the index buffer also holds the coarser levels
+    uint32_t number_of_indices = 0;
+    for (const Submesh &submesh : mesh.getSubmeshes()) number_of_indices += submesh.index_count;
+    return number_of_indices / 3;
 }
 
 Model::~Model() {}
-
-void Model::addSampler(Texture newTexture)
-{
-    VkSampler newSampler;
-    // sampler create info
-    VkSamplerCreateInfo sampler_create_info{};
-    sampler_create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    sampler_create_info.magFilter = VK_FILTER_LINEAR;
-    sampler_create_info.minFilter = VK_FILTER_LINEAR;
-    sampler_create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
-    sampler_create_info.unnormalizedCoordinates = VK_FALSE;
-    sampler_create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    sampler_create_info.mipLodBias = 0.0f;
-    sampler_create_info.minLod = 0.0f;
-    sampler_create_info.maxLod = newTexture.getMipLevel();
-    sampler_create_info.anisotropyEnable = VK_TRUE;
-    sampler_create_info.maxAnisotropy = 16;// max anisotropy sample level
-
-    VkResult result = vkCreateSampler(device->getLogicalDevice(), &sampler_create_info, nullptr, &newSampler);
-    ASSERT_VULKAN(result, "Failed to create a texture sampler!")
-
-    modelTextureSamplers.push_back(newSampler);
-}
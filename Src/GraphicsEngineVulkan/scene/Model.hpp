@@ -1,53 +1,72 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "Mesh.hpp"
 #include "Texture.hpp"
+#include "TextureCache.hpp"
 
 class Model
 {
   public:
     Model();
-    Model(VulkanDevice *device);
+    // textures are shared through textureCache, geometry lives in geometryPool;
+    // both have to outlive the model
+    Model(VulkanDevice *device, TextureCache *textureCache, GeometryPool *geometryPool);
 
     void cleanUp();
 
     void add_new_mesh(VulkanDevice *device,
-      VkQueue transfer_queue,
-      VkCommandPool command_pool,
-      std::vector<Vertex> &vertices,
-      std::vector<unsigned int> &indices,
-      std::vector<unsigned int> &materialIndex,
-      std::vector<ObjMaterial> &materials);
-
-    uint32_t getTextureCount() { return static_cast<uint32_t>(modelTextures.size()); };
-    std::vector<Texture> &getTextures() { return modelTextures; }
-    std::vector<VkSampler> &getTextureSamplers() { return modelTextureSamplers; }
+      std::span<const Vertex> vertices,
+      std::span<const uint32_t> indices,
+      std::span<const Submesh> submeshes,
+      std::span<const MeshLod> lods,
+      std::span<const ObjMaterial> materials,
+      VertexLayout vertexLayout);
+
+    uint32_t getTextureCount() { return static_cast<uint32_t>(textureKeys.size()); };
+    // index of the model's i-th texture into the scene wide texture table
+    uint32_t getTextureSlot(uint32_t i) { return textureSlots[i]; };
+    // table slot of the texture a submesh samples; only valid if the model has textures
+    uint32_t getSubmeshTextureSlot(size_t submesh) { return submeshTextureSlots[submesh]; };
     std::vector<std::string> getTextureList() { return texture_list; };
+    // one mesh with shared vertex/index buffers, split into per material submeshes
     uint32_t getMeshCount() { return 1; };
     Mesh *getMesh(size_t index) { return &mesh; };
-    glm::mat4 getModel() { return model; };
+    // includes the dequantization of the mesh; quantized meshes live in a unit cube
+    glm::mat4 getModel() { return model * mesh.getDequantization(); };
     uint32_t getCustomInstanceIndex() { return mesh_model_index; };
     uint32_t getPrimitiveCount();
-    ObjectDescription getObjectDescription() { return mesh.getObjectDescription(); };
+    // the lod errors live in the space of the unquantized mesh
+    uint32_t selectLod(size_t submesh, glm::vec3 camera_position, float projection_scale, float max_pixel_error)
+    {
+        return mesh.selectLod(submesh, model, camera_position, projection_scale, max_pixel_error);
+    };
+    float getProjectedSize(size_t submesh, glm::vec3 camera_position, float projection_scale)
+    {
+        return mesh.getProjectedSize(submesh, model, camera_position, projection_scale);
+    };
+    std::vector<ObjectDescription> &getObjectDescriptions() { return mesh.getObjectDescriptions(); };
 
     void set_model(glm::mat4 model);
-    void addTexture(Texture newTexture);
+    // takes a reference on the cached texture of key
+    void addTexture(const TextureCache::Key &key);
 
     ~Model();
 
   private:
     VulkanDevice *device{ VK_NULL_HANDLE };
-
-    void addSampler(Texture newTexture);
+    TextureCache *textureCache{ nullptr };
+    GeometryPool *geometryPool{ nullptr };
 
     uint32_t mesh_model_index{ static_cast<uint32_t>(-1) };
     Mesh mesh;
     glm::mat4 model;
 
     std::vector<std::string> texture_list;
-    std::vector<Texture> modelTextures;
-    std::vector<VkSampler> modelTextureSamplers;
+    std::vector<TextureCache::Key> textureKeys;
+    std::vector<uint32_t> textureSlots;
+    std::vector<uint32_t> submeshTextureSlots;
 };
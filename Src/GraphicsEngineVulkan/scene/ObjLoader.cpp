@@ -3,61 +3,25 @@
 #include <tiny_obj_loader.h>
 
 #include "File.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "TextureDecoder.hpp"
+#include "VertexWelder.hpp"
+#include "spdlog/spdlog.h"
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <unordered_map>
 
-ObjLoader::ObjLoader(VulkanDevice *device, VkQueue transfer_queue, VkCommandPool command_pool)
-{
-    this->device = device;
-    this->transfer_queue = transfer_queue;
-    this->command_pool = command_pool;
-}
-
-std::shared_ptr<Model> ObjLoader::loadModel(const std::string &modelFile)
-{
-    // the model we want to load
-    std::shared_ptr<Model> new_model = std::make_shared<Model>(device);
-
-    // first load txtures from model
-    std::vector<std::string> textureNames = loadTexturesAndMaterials(modelFile);
-    std::vector<int> matToTex(textureNames.size());
-
-    // now that we have the names lets create the vulkan side of textures
-    for (size_t i = 0; i < textureNames.size(); i++) {
-        // If material had no texture, set '0' to indicate no texture, texture 0
-        // will be reserved for a default texture
-        if (!textureNames[i].empty()) {
-            // Otherwise, create texture and set value to index of new texture
-            Texture texture;
-            texture.createFromFile(device, command_pool, textureNames[i]);
-            new_model->addTexture(texture);
-            matToTex[i] = new_model->getTextureCount();
-
-        } else {
-            matToTex[i] = 0;
-        }
-    }
-
-    loadVertices(modelFile);
-
-    new_model->add_new_mesh(device, transfer_queue, command_pool, vertices, indices, materialIndex, this->materials);
-
-    return new_model;
-}
+namespace {
 
-std::vector<std::string> ObjLoader::loadTexturesAndMaterials(const std::string &modelFile)
+void appendMaterials(const std::vector<tinyobj::material_t> &tol_materials,
+  const std::string &modelFile,
+  std::vector<ObjMaterial> &materials,
+  std::vector<std::string> &textures)
 {
-    tinyobj::ObjReaderConfig reader_config;
-    tinyobj::ObjReader reader;
-
-    if (!reader.ParseFromFile(modelFile, reader_config)) {
-        if (!reader.Error().empty()) { std::cerr << "TinyObjReader: " << reader.Error(); }
-        exit(EXIT_FAILURE);
-    }
-
-    if (!reader.Warning().empty()) { std::cout << "TinyObjReader: " << reader.Warning(); }
-
-    auto &tol_materials = reader.GetMaterials();
     textures.reserve(tol_materials.size());
 
     int texture_id = 0;
@@ -94,7 +58,276 @@ std::vector<std::string> ObjLoader::loadTexturesAndMaterials(const std::string &
     }
 
     // for the case no .mtl file is given place some random standard material ...
-    if (tol_materials.empty()) { materials.emplace_back(ObjMaterial()); }
+    if (tol_materials.empty()) {
+        ObjMaterial material{};
+        material.dissolve = 1.f;
+        materials.push_back(material);
+    }
+}
+
+}// namespace
+
+ObjLoader::ObjLoader(VulkanDevice *device,
+  VulkanUploadManager *uploadManager,
+  GeometryPool *geometryPool,
+  TextureCache *textureCache,
+  TextureStreamer *textureStreamer)
+{
+    this->device = device;
+    this->uploadManager = uploadManager;
+    this->geometryPool = geometryPool;
+    this->textureCache = textureCache;
+    this->textureStreamer = textureStreamer;
+}
+
+std::shared_ptr<Model> ObjLoader::loadModel(const std::string &modelFile, VertexLayout vertexLayout)
+{
+    // the model we want to load
+    std::shared_ptr<Model> new_model = std::make_shared<Model>(device, textureCache, geometryPool);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // prefer the cooked mesh; on a miss parse the obj and cook it for next time
+    MeshCache cache;
+    std::span<const Vertex> mesh_vertices;
+    std::span<const uint32_t> mesh_indices;
+    std::span<const unsigned int> mesh_material_index;
+    std::span<const ObjMaterial> mesh_materials;
+    std::vector<Submesh> submeshes;
+    std::vector<MeshLod> lods;
+    const bool cache_hit = cache.open(modelFile);
+    if (cache_hit) {
+        clear();
+        textures = cache.getTextures();
+        mesh_vertices = cache.getVertices();
+        mesh_indices = cache.getIndices();
+        mesh_material_index = cache.getMaterialIndex();
+        mesh_materials = cache.getMaterials();
+        // the optimizer left every material in one contiguous range
+        submeshes = buildSubmeshes(mesh_material_index, mesh_materials);
+        lods = cache.getLods();
+    } else {
+        loadGeometry(modelFile);
+        optimizeGeometry(modelFile);
+        submeshes = buildSubmeshes(materialIndex, materials);
+        lods = buildLods(modelFile, submeshes);
+        MeshCache::write(modelFile, { vertices, indices, materialIndex, materials, textures, sourceFiles, lods });
+        mesh_vertices = vertices;
+        mesh_indices = indices;
+        mesh_materials = materials;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    spdlog::info("Loaded {} {} in {:.2f} ms",
+      modelFile,
+      cache_hit ? "from mesh cache" : "from obj",
+      std::chrono::duration<double, std::milli>(end - start).count());
+
+    loadTextures(new_model.get());
+
+    // the shaders index the scene wide texture table; the cached materials keep the model local ids
+    std::vector<ObjMaterial> table_materials(mesh_materials.begin(), mesh_materials.end());
+    if (new_model->getTextureCount() > 0) {
+        for (ObjMaterial &material : table_materials) {
+            material.textureID = static_cast<int>(new_model->getTextureSlot(static_cast<uint32_t>(material.textureID)));
+        }
+    }
+
+    spdlog::info("Split {} into {} submeshes with {} levels of detail", modelFile, submeshes.size(), lods.size() + 1);
+
+    // the cached arrays get copied into staging right from the mapping
+    new_model->add_new_mesh(device, mesh_vertices, mesh_indices, submeshes, lods, table_materials, vertexLayout);
+
+    return new_model;
+}
+
+void ObjLoader::loadGeometry(const std::string &modelFile)
+{
+    clear();
+
+    ObjParser parser;
+    ObjParseResult parsed;
+    if (!parser.parse(modelFile, parsed)) {
+        std::cerr << "ObjParser: failed to load " << modelFile << "\n";
+        exit(EXIT_FAILURE);
+    }
+    sourceFiles.push_back(modelFile);
+
+    std::vector<int> slotToMaterial = loadMaterialLibrary(modelFile, parsed);
+    buildVertices(parsed, slotToMaterial);
+}
+
+void ObjLoader::loadTextures(Model *model)
+{
+    // the texture ids of the materials count up over the materials with a
+    // texture, so the model has to get the textures in exactly that order
+    std::vector<TextureCache::Key> keys;
+    for (const std::string &texture : textures) {
+        if (!texture.empty()) keys.push_back(textureCache->makeKey(texture));
+    }
+    if (keys.empty()) return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // only decode what neither the cache nor an earlier material of this model has;
+    // unreadable files (no content hash) can only be matched by path
+    std::vector<std::string> files;
+    std::vector<size_t> file_keys;
+    std::unordered_map<uint64_t, size_t> loading_by_content;
+    std::unordered_map<std::string, size_t> loading_by_path;
+    for (size_t k = 0; k < keys.size(); k++) {
+        if (textureCache->contains(keys[k]) || loading_by_path.count(keys[k].path)
+            || (keys[k].content_hash != 0 && loading_by_content.count(keys[k].content_hash))) {
+            continue;
+        }
+        loading_by_path.emplace(keys[k].path, files.size());
+        if (keys[k].content_hash != 0) loading_by_content.emplace(keys[k].content_hash, files.size());
+        files.push_back(keys[k].path);
+        file_keys.push_back(k);
+    }
+
+    // decode on all cores, upload on this thread in the order decoding finishes;
+    // block compressed ktx2 files replace the decoded pixels if the device can sample them.
+    // streamed ones only get their mip tail for now
+    const bool cook = device->supportsTextureCompressionBC();
+    const bool stream = cook && textureStreamer != nullptr;
+    TextureDecoder decoder(files, 0, cook);
+    double decode_ms = 0.0;
+    uint64_t cooked_bytes = 0;
+    uint64_t uncompressed_bytes = 0;
+    uint32_t cache_hits = 0;
+    const stbi_uc missing_pixel[4] = { 255, 0, 255, 255 };
+    DecodedTexture decoded;
+    while (decoder.next(decoded)) {
+        Texture created;
+        uint32_t first_level = 0;
+        if (!decoded.cooked.levels.empty()) {
+            if (stream) first_level = TextureStreamer::getTailLevel(decoded.cooked);
+            created.createFromCooked(device, uploadManager, decoded.cooked, first_level);
+            cooked_bytes += decoded.cooked.getLevelBytes();
+        } else if (decoded.pixels) {
+            created.createFromPixels(device, uploadManager, decoded.pixels.get(), decoded.width, decoded.height);
+        } else {
+            created.createFromPixels(device, uploadManager, missing_pixel, 1, 1);
+        }
+        const uint32_t slot = textureCache->insertTexture(
+          keys[file_keys[decoded.index]], created, textureCache->acquireSampler(TextureCache::getTextureSamplerInfo()));
+        if (stream && !decoded.cooked.levels.empty()) {
+            textureStreamer->add(slot, decoder.getFile(decoded.index), std::move(decoded.cooked), first_level);
+        }
+
+        // rgba8 with a full mip chain
+        uncompressed_bytes += static_cast<uint64_t>(decoded.width) * decoded.height * 4 * 4 / 3;
+        if (decoded.cache_hit) cache_hits++;
+        decode_ms += decoded.decode_ms;
+        spdlog::info("{} {} ({}x{}) in {:.2f} ms",
+          decoded.cache_hit ? "Loaded cooked" : (cook ? "Cooked" : "Decoded"),
+          decoder.getFile(decoded.index),
+          decoded.width,
+          decoded.height,
+          decoded.decode_ms);
+    }
+
+    for (const TextureCache::Key &key : keys) model->addTexture(key);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    spdlog::info("Loaded {} textures on {} threads in {:.2f} ms ({:.2f} ms of decoding), {} shared",
+      files.size(),
+      decoder.getThreadCount(),
+      std::chrono::duration<double, std::milli>(end - start).count(),
+      decode_ms,
+      keys.size() - files.size());
+    if (cook) {
+        spdlog::info("Texture cache: {} of {} textures up to date, {:.1f} MiB block compressed ({:.1f} MiB as rgba8)",
+          cache_hits,
+          files.size(),
+          cooked_bytes / (1024.0 * 1024.0),
+          uncompressed_bytes / (1024.0 * 1024.0));
+    }
+}
+
+std::vector<Submesh> ObjLoader::buildSubmeshes(std::span<const unsigned int> materialIndex,
+  std::span<const ObjMaterial> materials)
+{
+    std::vector<Submesh> submeshes;
+    for (size_t triangle = 0; triangle < materialIndex.size();) {
+        size_t end = triangle + 1;
+        while (end < materialIndex.size() && materialIndex[end] == materialIndex[triangle]) end++;
+
+        Submesh submesh{};
+        submesh.first_index = static_cast<uint32_t>(3 * triangle);
+        submesh.index_count = static_cast<uint32_t>(3 * (end - triangle));
+        submesh.material_id = materialIndex[triangle] < materials.size() ? materialIndex[triangle] : 0;
+        submesh.opaque = materials.empty() || materials[submesh.material_id].dissolve >= 1.f;
+        submeshes.push_back(submesh);
+
+        triangle = end;
+    }
+    return submeshes;
+}
+
+void ObjLoader::optimizeGeometry(const std::string &modelFile)
+{
+    MeshOptimizerStats stats = MeshOptimizer::optimize(vertices, indices, materialIndex);
+    spdlog::info("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} ({} clusters)",
+      modelFile,
+      stats.acmr_before,
+      stats.acmr_after,
+      stats.atvr_before,
+      stats.atvr_after,
+      stats.cluster_count);
+}
+
+std::vector<MeshLod> ObjLoader::buildLods(const std::string &modelFile, std::span<const Submesh> submeshes)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<MeshLod> lods = MeshSimplifier::buildLods(vertices, indices, submeshes);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    for (size_t l = 0; l < lods.size(); l++) {
+        uint32_t index_count = 0;
+        for (const Submesh &submesh : lods[l].submeshes) index_count += submesh.index_count;
+        spdlog::info(
+          "Simplified {}: level {} has {} triangles, error {:.4g}", modelFile, l + 1, index_count / 3, lods[l].error);
+    }
+    spdlog::info("Built {} levels of detail for {} in {:.2f} ms",
+      lods.size(),
+      modelFile,
+      std::chrono::duration<double, std::milli>(end - start).count());
+
+    return lods;
+}
+
+void ObjLoader::loadGeometryTinyObj(const std::string &modelFile)
+{
+    clear();
+    loadTexturesAndMaterials(modelFile);
+    loadVertices(modelFile);
+}
+
+void ObjLoader::clear()
+{
+    vertices.clear();
+    indices.clear();
+    materials.clear();
+    materialIndex.clear();
+    textures.clear();
+    sourceFiles.clear();
+}
+
+std::vector<std::string> ObjLoader::loadTexturesAndMaterials(const std::string &modelFile)
+{
+    tinyobj::ObjReaderConfig reader_config;
+    tinyobj::ObjReader reader;
+
+    if (!reader.ParseFromFile(modelFile, reader_config)) {
+        if (!reader.Error().empty()) { std::cerr << "TinyObjReader: " << reader.Error(); }
+        exit(EXIT_FAILURE);
+    }
+
+    if (!reader.Warning().empty()) { std::cout << "TinyObjReader: " << reader.Warning(); }
+
+    appendMaterials(reader.GetMaterials(), modelFile, materials, textures);
 
     return textures;
 }
@@ -169,12 +402,10 @@ void ObjLoader::loadVertices(const std::string &fileName)
 
                 Vertex vert{ pos, normals, color, tex_coords };
 
-                if (vertices_map.count(vert) == 0) {
-                    vertices_map[vert] = vertices.size();
-                    vertices.push_back(vert);
-                }
+                auto [entry, inserted] = vertices_map.try_emplace(vert, static_cast<uint32_t>(vertices.size()));
+                if (inserted) vertices.push_back(vert);
 
-                indices.push_back(vertices_map[vert]);
+                indices.push_back(entry->second);
             }
 
             index_offset += fv;
@@ -186,16 +417,106 @@ void ObjLoader::loadVertices(const std::string &fileName)
     }
 
     // precompute normals if no provided
-    if (attrib.normals.empty()) {
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            Vertex &v0 = vertices[indices[i + 0]];
-            Vertex &v1 = vertices[indices[i + 1]];
-            Vertex &v2 = vertices[indices[i + 2]];
-
-            glm::vec3 n = glm::normalize(glm::cross((v1.pos - v0.pos), (v2.pos - v0.pos)));
-            v0.normal = n;
-            v1.normal = n;
-            v2.normal = n;
+    if (attrib.normals.empty()) { computeFaceNormals(); }
+}
+
+std::vector<int> ObjLoader::loadMaterialLibrary(const std::string &modelFile, const ObjParseResult &parsed)
+{
+    std::map<std::string, int> material_map;
+    std::vector<tinyobj::material_t> tol_materials;
+
+    // like tinyobj: the first library that can be opened wins
+    File model_file(modelFile);
+    for (const std::string &library : parsed.material_libraries) {
+        const std::string library_file = model_file.getBaseDir() + "/" + library;
+        std::ifstream material_stream(library_file);
+        if (!material_stream.is_open()) continue;
+        sourceFiles.push_back(library_file);
+
+        std::string warning;
+        std::string error;
+        tinyobj::LoadMtl(&material_map, &tol_materials, &material_stream, &warning, &error);
+        if (!warning.empty()) { std::cout << "TinyObjReader: " << warning; }
+        if (!error.empty()) { std::cerr << "TinyObjReader: " << error; }
+        break;
+    }
+
+    appendMaterials(tol_materials, modelFile, materials, textures);
+
+    // unknown material names end up as -1, same as with tinyobj
+    std::vector<int> slotToMaterial(parsed.material_names.size(), -1);
+    for (size_t slot = 0; slot < parsed.material_names.size(); slot++) {
+        auto material = material_map.find(parsed.material_names[slot]);
+        if (material != material_map.end()) slotToMaterial[slot] = material->second;
+    }
+
+    return slotToMaterial;
+}
+
+void ObjLoader::buildVertices(const ObjParseResult &parsed, const std::vector<int> &slotToMaterial)
+{
+    std::vector<Vertex> corners;
+    corners.reserve(parsed.indices.size());
+    materialIndex.reserve(parsed.material_slots.size());
+
+    for (size_t i = 0; i < parsed.indices.size(); i++) {
+        const ObjIndex &idx = parsed.indices[i];
+        const size_t vertex_index = static_cast<size_t>(idx.vertex_index);
+
+        glm::vec3 pos = { parsed.positions[3 * vertex_index + 0],
+            parsed.positions[3 * vertex_index + 1],
+            parsed.positions[3 * vertex_index + 2] };
+
+        glm::vec3 normals(0.0f);
+        if (idx.normal_index >= 0 && !parsed.normals.empty()) {
+            const size_t normal_index = static_cast<size_t>(idx.normal_index);
+            normals = glm::vec3(parsed.normals[3 * normal_index + 0],
+              parsed.normals[3 * normal_index + 1],
+              parsed.normals[3 * normal_index + 2]);
+        }
+
+        glm::vec3 color(-1.f);
+        if (!parsed.colors.empty()) {
+            color = glm::vec3(parsed.colors[3 * vertex_index + 0],
+              parsed.colors[3 * vertex_index + 1],
+              parsed.colors[3 * vertex_index + 2]);
+        }
+
+        glm::vec2 tex_coords(0.0f);
+        if (idx.texcoord_index >= 0 && !parsed.texcoords.empty()) {
+            const size_t texcoord_index = static_cast<size_t>(idx.texcoord_index);
+            // flip y coordinate !!
+            tex_coords = glm::vec2(parsed.texcoords[2 * texcoord_index + 0], 1.f - parsed.texcoords[2 * texcoord_index + 1]);
         }
+
+        corners.emplace_back(pos, normals, color, tex_coords);
+    }
+
+    WeldStats stats = VertexWelder::weld(corners, vertices, indices, 0);
+    spdlog::info("Welded {} corners into {} vertices (ratio {:.2f}) at {:.1f} M vertices/s",
+      stats.input_count,
+      stats.unique_count,
+      stats.weldRatio(),
+      stats.verticesPerSecond() / 1e6);
+
+    // per-face material; faces are triangles at this point
+    for (int slot : parsed.material_slots) {
+        materialIndex.push_back(static_cast<unsigned int>(slot >= 0 ? slotToMaterial[slot] : -1));
+    }
+
+    if (parsed.normals.empty()) { computeFaceNormals(); }
+}
+
+void ObjLoader::computeFaceNormals()
+{
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        Vertex &v0 = vertices[indices[i + 0]];
+        Vertex &v1 = vertices[indices[i + 1]];
+        Vertex &v2 = vertices[indices[i + 2]];
+
+        glm::vec3 n = glm::normalize(glm::cross((v1.pos - v0.pos), (v2.pos - v0.pos)));
+        v0.normal = n;
+        v1.normal = n;
+        v2.normal = n;
     }
 }
@@ -2,29 +2,77 @@
 #include <vulkan/vulkan.h>
 
 #include <memory>
+#include <span>
 
+#include "MeshLod.hpp"
+#include "GeometryPool.hpp"
 #include "Model.hpp"
 #include "ObjMaterial.hpp"
+#include "ObjParser.hpp"
+#include "Submesh.hpp"
+#include "TextureCache.hpp"
+#include "TextureStreamer.hpp"
 #include "Vertex.hpp"
 
 class ObjLoader
 {
   public:
-    ObjLoader(VulkanDevice *device, VkQueue transfer_queue, VkCommandPool command_pool);
+    // geometryPool and textureCache are only needed by loadModel(); without textureStreamer cooked
+    // textures load all levels
+    ObjLoader(VulkanDevice *device,
+      VulkanUploadManager *uploadManager,
+      GeometryPool *geometryPool = nullptr,
+      TextureCache *textureCache = nullptr,
+      TextureStreamer *textureStreamer = nullptr);
 
-    std::shared_ptr<Model> loadModel(const std::string &modelFile);
+    // vertices are uploaded in the given layout; the cooked mesh stays full precision
+    std::shared_ptr<Model> loadModel(const std::string &modelFile, VertexLayout vertexLayout);
+
+    // cpu side only: parse the file once and build vertices/indices/materials
+    void loadGeometry(const std::string &modelFile);
+    // one submesh per run of equal material ids; unknown ids fall back to material 0
+    static std::vector<Submesh> buildSubmeshes(std::span<const unsigned int> materialIndex,
+      std::span<const ObjMaterial> materials);
+    // gpu friendly triangle + vertex order of the loaded geometry (see MeshOptimizer)
+    void optimizeGeometry(const std::string &modelFile);
+    // appends the simplified levels of the loaded geometry to its indices (see MeshSimplifier)
+    std::vector<MeshLod> buildLods(const std::string &modelFile, std::span<const Submesh> submeshes);
+    // former tinyobj path parsing the file twice; kept as reference for tests + benchmarks
+    void loadGeometryTinyObj(const std::string &modelFile);
+
+    std::vector<Vertex> &getVertices() { return vertices; };
+    std::vector<unsigned int> &getIndices() { return indices; };
+    std::vector<unsigned int> &getMaterialIndex() { return materialIndex; };
+    std::vector<ObjMaterial> &getMaterials() { return materials; };
+    std::vector<std::string> &getTextures() { return textures; };
+    // files the last loadGeometry() read from (.obj + .mtl)
+    std::vector<std::string> &getSourceFiles() { return sourceFiles; };
 
   private:
     VulkanDevice *device;
-    VkQueue transfer_queue;
-    VkCommandPool command_pool;
+    VulkanUploadManager *uploadManager;
+    GeometryPool *geometryPool;
+    TextureCache *textureCache;
+    TextureStreamer *textureStreamer;
 
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     std::vector<ObjMaterial> materials;
     std::vector<unsigned int> materialIndex;
     std::vector<std::string> textures;
+    std::vector<std::string> sourceFiles;
+
+    void clear();
+
+    // decodes (or loads the cooked ktx2 of) the textures in parallel and adds them to model in material order;
+    // files already in the texture cache (by path or content) are shared instead
+    void loadTextures(Model *model);
 
     std::vector<std::string> loadTexturesAndMaterials(const std::string &modelFile);
     void loadVertices(const std::string &fileName);
+
+    // returns material id per usemtl slot of the parse result
+    std::vector<int> loadMaterialLibrary(const std::string &modelFile, const ObjParseResult &parsed);
+    void buildVertices(const ObjParseResult &parsed, const std::vector<int> &slotToMaterial);
+    void computeFaceNormals();
 };
@@ -0,0 +1,417 @@
+#include "ObjParser.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "MappedFile.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// below this size per thread spawning threads costs more than it saves
+constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+constexpr uint8_t RELATIVE_VERTEX = 1;
+constexpr uint8_t RELATIVE_TEXCOORD = 2;
+constexpr uint8_t RELATIVE_NORMAL = 4;
+
+template<typename Function> void parallelFor(uint32_t count, Function function)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(count > 0 ? count - 1 : 0);
+    for (uint32_t i = 1; i < count; i++) { workers.emplace_back(function, i); }
+    if (count > 0) function(0);
+    for (std::thread &worker : workers) { worker.join(); }
+}
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+inline const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p)) p++;
+    return p;
+}
+
+inline const char *parseFloat(const char *p, const char *end, float &value, bool &ok)
+{
+    p = skipSpace(p, end);
+    if (p < end && *p == '+') p++;
+    // parse as double and narrow afterwards like tinyobj does
+    double parsed = 0.0;
+    auto [next, error] = std::from_chars(p, end, parsed);
+    ok = error == std::errc();
+    if (ok) value = static_cast<float>(parsed);
+    return ok ? next : p;
+}
+
+inline const char *parseInt(const char *p, const char *end, int &value, bool &ok)
+{
+    if (p < end && *p == '+') p++;
+    auto [next, error] = std::from_chars(p, end, value);
+    ok = error == std::errc();
+    return ok ? next : p;
+}
+
+inline std::string_view trim(const char *begin, const char *end)
+{
+    begin = skipSpace(begin, end);
+    while (end > begin && (isSpace(end[-1]) || end[-1] == '\r')) end--;
+    return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+}// namespace
+
+struct ObjParser::Chunk
+{
+    // index as written in the file, relative ones already made chunk local
+    struct Corner
+    {
+        int v{ 0 };
+        int vt{ 0 };
+        int vn{ 0 };
+        uint8_t relative{ 0 };
+    };
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+    bool has_colors{ false };
+
+    std::vector<Corner> corners;
+    std::vector<uint32_t> face_sizes;
+    // index into material_names; -1 means whatever was active at chunk start
+    std::vector<int> face_materials;
+    std::vector<std::string> material_names;
+    std::vector<std::string> material_libraries;
+
+    // filled while stitching chunks together
+    int position_offset{ 0 };
+    int normal_offset{ 0 };
+    int texcoord_offset{ 0 };
+    std::vector<int> material_slots;
+    int material_at_start{ -1 };
+};
+
+ObjParser::ObjParser() {}
+
+bool ObjParser::parse(const std::string &file_name, ObjParseResult &result, uint32_t thread_count)
+{
+    MappedFile file(file_name);
+    if (!file.isOpen()) return false;
+
+    const char *data = file.data();
+    const size_t size = file.size();
+
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t chunk_count = static_cast<uint32_t>(std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, thread_count));
+
+    // split at line boundaries
+    std::vector<const char *> chunk_begin(chunk_count + 1);
+    chunk_begin[0] = data;
+    chunk_begin[chunk_count] = data + size;
+    for (uint32_t i = 1; i < chunk_count; i++) {
+        const char *split = data + size * i / chunk_count;
+        split = std::max(split, chunk_begin[i - 1]);
+        const char *line_end = static_cast<const char *>(memchr(split, '\n', static_cast<size_t>(data + size - split)));
+        chunk_begin[i] = line_end ? line_end + 1 : data + size;
+    }
+
+    std::vector<Chunk> chunks(chunk_count);
+    parallelFor(chunk_count, [&](uint32_t i) { parseChunk(chunk_begin[i], chunk_begin[i + 1], chunks[i]); });
+
+    // stitch: attribute offsets and the active material carry over chunk borders
+    size_t position_count = 0;
+    size_t normal_count = 0;
+    size_t texcoord_count = 0;
+    bool has_colors = false;
+    int active_material = -1;
+    std::unordered_map<std::string, int> material_lookup;
+
+    result = ObjParseResult{};
+    for (Chunk &chunk : chunks) {
+        chunk.position_offset = static_cast<int>(position_count / 3);
+        chunk.normal_offset = static_cast<int>(normal_count / 3);
+        chunk.texcoord_offset = static_cast<int>(texcoord_count / 2);
+        position_count += chunk.positions.size();
+        normal_count += chunk.normals.size();
+        texcoord_count += chunk.texcoords.size();
+        has_colors |= chunk.has_colors;
+
+        chunk.material_at_start = active_material;
+        chunk.material_slots.resize(chunk.material_names.size());
+        for (size_t m = 0; m < chunk.material_names.size(); m++) {
+            auto [entry, inserted] =
+              material_lookup.try_emplace(chunk.material_names[m], static_cast<int>(result.material_names.size()));
+            if (inserted) result.material_names.push_back(chunk.material_names[m]);
+            chunk.material_slots[m] = entry->second;
+        }
+        // the last usemtl of a chunk stays active in the next one
+        if (!chunk.material_slots.empty()) active_material = chunk.material_slots.back();
+
+        result.material_libraries.insert(
+          result.material_libraries.end(), chunk.material_libraries.begin(), chunk.material_libraries.end());
+    }
+
+    result.positions.resize(position_count);
+    result.normals.resize(normal_count);
+    result.texcoords.resize(texcoord_count);
+    if (has_colors) result.colors.resize(position_count);
+
+    parallelFor(chunk_count, [&](uint32_t i) {
+        const Chunk &chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), result.positions.begin() + chunk.position_offset * 3);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), result.normals.begin() + chunk.normal_offset * 3);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), result.texcoords.begin() + chunk.texcoord_offset * 2);
+        if (has_colors) {
+            std::copy(chunk.colors.begin(), chunk.colors.end(), result.colors.begin() + chunk.position_offset * 3);
+        }
+    });
+
+    // triangulation needs the final positions for quads and the attribute counts for validation
+    std::vector<std::vector<ObjIndex>> chunk_indices(chunk_count);
+    std::vector<std::vector<int>> chunk_material_slots(chunk_count);
+    std::vector<uint8_t> chunk_valid(chunk_count);
+    parallelFor(chunk_count, [&](uint32_t i) {
+        chunk_valid[i] = triangulateChunk(chunks[i], result, chunk_indices[i], chunk_material_slots[i]);
+    });
+    if (std::find(chunk_valid.begin(), chunk_valid.end(), 0) != chunk_valid.end()) {
+        spdlog::error("ObjParser: face with an invalid vertex, texcoord or normal index in {}", file_name);
+        result = ObjParseResult{};
+        return false;
+    }
+
+    size_t index_count = 0;
+    for (const std::vector<ObjIndex> &indices : chunk_indices) index_count += indices.size();
+    result.indices.reserve(index_count);
+    result.material_slots.reserve(index_count / 3);
+    for (uint32_t i = 0; i < chunk_count; i++) {
+        result.indices.insert(result.indices.end(), chunk_indices[i].begin(), chunk_indices[i].end());
+        result.material_slots.insert(
+          result.material_slots.end(), chunk_material_slots[i].begin(), chunk_material_slots[i].end());
+    }
+
+    return true;
+}
+
+ObjParser::~ObjParser() {}
+
+void ObjParser::parseChunk(const char *begin, const char *end, Chunk &chunk)
+{
+    // rough guess: an average obj line has ~30 characters
+    size_t expected_lines = static_cast<size_t>(end - begin) / 30;
+    chunk.positions.reserve(expected_lines);
+    chunk.colors.reserve(expected_lines);
+    chunk.corners.reserve(expected_lines);
+
+    int current_material = -1;
+    const char *line = begin;
+
+    while (line < end) {
+        const char *line_end = static_cast<const char *>(memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!line_end) line_end = end;
+
+        const char *p = skipSpace(line, line_end);
+        const char *next_line = line_end + 1;
+
+        if (p + 1 < line_end && p[0] == 'v' && isSpace(p[1])) {
+            float xyz[3] = { 0.f, 0.f, 0.f };
+            float rgb[3] = { 1.f, 1.f, 1.f };
+            bool ok = true;
+            p += 2;
+            for (float &value : xyz) p = parseFloat(p, line_end, value, ok);
+            // optional vertex colors; only "v x y z r g b" has them, a single fourth value is
+            // the homogeneous w and ignored like tinyobj does
+            float trailing[3] = { 0.f, 0.f, 0.f };
+            uint32_t trailing_count = 0;
+            for (float &value : trailing) {
+                p = parseFloat(p, line_end, value, ok);
+                if (!ok) break;
+                trailing_count++;
+            }
+            if (trailing_count == 3) {
+                std::copy(trailing, trailing + 3, rgb);
+                chunk.has_colors = true;
+            }
+            chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+            chunk.colors.insert(chunk.colors.end(), rgb, rgb + 3);
+
+        } else if (p + 2 < line_end && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            float xyz[3] = { 0.f, 0.f, 0.f };
+            bool ok = true;
+            p += 3;
+            for (float &value : xyz) p = parseFloat(p, line_end, value, ok);
+            chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+
+        } else if (p + 2 < line_end && p[0] == 'v' && p[1] == 't' && isSpace(p[2])) {
+            float uv[2] = { 0.f, 0.f };
+            bool ok = true;
+            p += 3;
+            for (float &value : uv) p = parseFloat(p, line_end, value, ok);
+            chunk.texcoords.insert(chunk.texcoords.end(), uv, uv + 2);
+
+        } else if (p + 1 < line_end && p[0] == 'f' && isSpace(p[1])) {
+            p += 2;
+            const int local_positions = static_cast<int>(chunk.positions.size() / 3);
+            const int local_normals = static_cast<int>(chunk.normals.size() / 3);
+            const int local_texcoords = static_cast<int>(chunk.texcoords.size() / 2);
+
+            uint32_t face_size = 0;
+            while (true) {
+                p = skipSpace(p, line_end);
+                if (p >= line_end || *p == '\r') break;
+
+                Chunk::Corner corner{};
+                bool ok = true;
+                p = parseInt(p, line_end, corner.v, ok);
+                if (!ok) break;
+                if (p < line_end && *p == '/') {
+                    p++;
+                    if (p < line_end && *p != '/') p = parseInt(p, line_end, corner.vt, ok);
+                    if (p < line_end && *p == '/') {
+                        p++;
+                        p = parseInt(p, line_end, corner.vn, ok);
+                    }
+                }
+
+                // relative indices count back from the current end
+                if (corner.v < 0) {
+                    corner.v += local_positions;
+                    corner.relative |= RELATIVE_VERTEX;
+                }
+                if (corner.vt < 0) {
+                    corner.vt += local_texcoords;
+                    corner.relative |= RELATIVE_TEXCOORD;
+                }
+                if (corner.vn < 0) {
+                    corner.vn += local_normals;
+                    corner.relative |= RELATIVE_NORMAL;
+                }
+
+                chunk.corners.push_back(corner);
+                face_size++;
+
+                while (p < line_end && !isSpace(*p) && *p != '\r') p++;
+            }
+
+            if (face_size > 0) {
+                chunk.face_sizes.push_back(face_size);
+                chunk.face_materials.push_back(current_material);
+            }
+
+        } else if (static_cast<size_t>(line_end - p) > 7 && std::memcmp(p, "usemtl", 6) == 0 && isSpace(p[6])) {
+            std::string_view name = trim(p + 7, line_end);
+            chunk.material_names.emplace_back(name);
+            current_material = static_cast<int>(chunk.material_names.size()) - 1;
+
+        } else if (static_cast<size_t>(line_end - p) > 7 && std::memcmp(p, "mtllib", 6) == 0 && isSpace(p[6])) {
+            const char *name = p + 7;
+            while (true) {
+                name = skipSpace(name, line_end);
+                const char *name_end = name;
+                while (name_end < line_end && !isSpace(*name_end) && *name_end != '\r') name_end++;
+                if (name_end == name) break;
+                chunk.material_libraries.emplace_back(name, name_end);
+                name = name_end;
+            }
+        }
+
+        line = next_line;
+    }
+}
+
+bool ObjParser::triangulateChunk(const Chunk &chunk,
+  const ObjParseResult &result,
+  std::vector<ObjIndex> &indices,
+  std::vector<int> &material_slots)
+{
+    indices.reserve(chunk.corners.size() * 3 / 2);
+    material_slots.reserve(chunk.face_sizes.size());
+
+    // 1-based absolute or chunk local relative -> global 0-based
+    auto resolve = [](int index, bool relative, int offset) {
+        if (relative) return offset + index;
+        return index > 0 ? index - 1 : -1;
+    };
+
+    // 0 or past the end (absolute or relative) resolves outside of [0, count)
+    auto inRange = [](int index, size_t count) { return index >= 0 && static_cast<size_t>(index) < count; };
+    const size_t position_count = result.positions.size() / 3;
+    const size_t normal_count = result.normals.size() / 3;
+    const size_t texcoord_count = result.texcoords.size() / 2;
+    std::vector<ObjIndex> face;
+
+    size_t corner = 0;
+    for (size_t f = 0; f < chunk.face_sizes.size(); f++) {
+        const uint32_t face_size = chunk.face_sizes[f];
+
+        face.resize(face_size);
+        for (uint32_t k = 0; k < face_size; k++) {
+            const Chunk::Corner &c = chunk.corners[corner + k];
+            face[k].vertex_index = resolve(c.v, c.relative & RELATIVE_VERTEX, chunk.position_offset);
+            face[k].texcoord_index = c.vt == 0 && !(c.relative & RELATIVE_TEXCOORD)
+                                       ? -1
+                                       : resolve(c.vt, c.relative & RELATIVE_TEXCOORD, chunk.texcoord_offset);
+            face[k].normal_index = c.vn == 0 && !(c.relative & RELATIVE_NORMAL)
+                                     ? -1
+                                     : resolve(c.vn, c.relative & RELATIVE_NORMAL, chunk.normal_offset);
+
+            // tinyobj rejects the whole file as well
+            if (!inRange(face[k].vertex_index, position_count)
+                || (face[k].texcoord_index != -1 && !inRange(face[k].texcoord_index, texcoord_count))
+                || (face[k].normal_index != -1 && !inRange(face[k].normal_index, normal_count))) {
+                return false;
+            }
+        }
+        corner += face_size;
+
+        const int local_material = chunk.face_materials[f];
+        const int material = local_material >= 0 ? chunk.material_slots[local_material] : chunk.material_at_start;
+
+        if (face_size < 3) continue;
+
+        auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+            indices.push_back(face[a]);
+            indices.push_back(face[b]);
+            indices.push_back(face[c]);
+            material_slots.push_back(material);
+        };
+
+        if (face_size == 3) {
+            emit(0, 1, 2);
+            continue;
+        }
+
+        if (face_size == 4) {
+            // split along the shorter diagonal, same as tinyobj
+            auto position = [&](uint32_t k) { return &result.positions[3 * static_cast<size_t>(face[k].vertex_index)]; };
+            const float *v0 = position(0);
+            const float *v1 = position(1);
+            const float *v2 = position(2);
+            const float *v3 = position(3);
+            float diagonal_02 = 0.f;
+            float diagonal_13 = 0.f;
+            for (int axis = 0; axis < 3; axis++) {
+                diagonal_02 += (v2[axis] - v0[axis]) * (v2[axis] - v0[axis]);
+                diagonal_13 += (v3[axis] - v1[axis]) * (v3[axis] - v1[axis]);
+            }
+            if (diagonal_02 < diagonal_13) {
+                emit(0, 1, 2);
+                emit(0, 2, 3);
+            } else {
+                emit(0, 1, 3);
+                emit(1, 2, 3);
+            }
+            continue;
+        }
+
+        // larger polygons: triangle fan
+        for (uint32_t k = 2; k < face_size; k++) emit(0, k - 1, k);
+    }
+
+    return true;
+}
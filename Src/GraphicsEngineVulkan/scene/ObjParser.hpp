@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// one corner of a face; 0-based, -1 if not given
+struct ObjIndex
+{
+    int vertex_index{ -1 };
+    int normal_index{ -1 };
+    int texcoord_index{ -1 };
+};
+
+// everything we need from an .obj after one pass over the file;
+// polygons are already triangulated like tinyobj does it
+struct ObjParseResult
+{
+    std::vector<float> positions;// xyz
+    std::vector<float> colors;// rgb, empty if the file has no vertex colors
+    std::vector<float> normals;// xyz
+    std::vector<float> texcoords;// uv
+    std::vector<ObjIndex> indices;// 3 per triangle
+    std::vector<int> material_slots;// per triangle, index into material_names or -1
+    std::vector<std::string> material_names;// in order of first usemtl
+    std::vector<std::string> material_libraries;
+};
+
+// memory maps the file, splits it at line boundaries and tokenizes
+// the chunks on all cores; chunks are stitched together afterwards
+// (relative indices, active material) so the result matches a serial parse
+class ObjParser
+{
+  public:
+    ObjParser();
+
+    // thread_count 0 picks std::thread::hardware_concurrency();
+    // false if the file can not be read or a face index is out of range
+    bool parse(const std::string &file_name, ObjParseResult &result, uint32_t thread_count = 0);
+
+    ~ObjParser();
+
+  private:
+    struct Chunk;
+
+    void parseChunk(const char *begin, const char *end, Chunk &chunk);
+    // false if a face refers to a missing attribute
+    bool triangulateChunk(const Chunk &chunk,
+      const ObjParseResult &result,
+      std::vector<ObjIndex> &indices,
+      std::vector<int> &material_slots);
+};
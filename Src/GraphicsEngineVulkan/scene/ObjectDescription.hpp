@@ -8,10 +8,11 @@
 #include <vulkan/vulkan.h>
 #endif
 
+// one per submesh; the submeshes of a model are consecutive, starting at the
+// TLAS instance custom index, and ordered like the geometries of its BLAS
 struct ObjectDescription
 {
     uint64_t vertex_address;
-    uint64_t index_address;
-    uint64_t material_index_address;
-    uint64_t material_address;
+    uint64_t index_address;// first index of the submesh
+    uint64_t material_address;// the single material of the submesh
 };
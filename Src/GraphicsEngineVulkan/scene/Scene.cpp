@@ -7,14 +7,34 @@ Scene::Scene() {}
 
 void Scene::update_user_input(GUI *gui) { guiSceneSharedVars = gui->getGuiSceneSharedVars(); }
 
-void Scene::loadModel(VulkanDevice *device, VkCommandPool commandPool)
+void Scene::loadModel(VulkanDevice *device, VulkanUploadManager *uploadManager)
 {
-    ObjLoader obj_loader(device, device->getGraphicsQueue(), commandPool);
+    geometryPool.init(device, uploadManager);
+    textureCache.init(device);
+    textureStreamer.init(
+      device, uploadManager, &textureCache, static_cast<VkDeviceSize>(sceneConfig::getTextureBudgetMiB()) << 20);
+    ObjLoader obj_loader(device,
+      uploadManager,
+      &geometryPool,
+      &textureCache,
+      sceneConfig::getTextureStreaming() ? &textureStreamer : nullptr);
 
     std::string modelFileName = sceneConfig::getModelFile();
-    std::shared_ptr<Model> new_model = obj_loader.loadModel(modelFileName);
+    std::shared_ptr<Model> new_model = obj_loader.loadModel(modelFileName, sceneConfig::getVertexLayout());
 
     add_model(new_model);
+    spdlog::info("Geometry pool: {} vertex and {} index buffer(s), {} KiB used",
+      geometryPool.getBlockCount(GeometryPool::Kind::Vertex),
+      geometryPool.getBlockCount(GeometryPool::Kind::Index),
+      (geometryPool.getUsedBytes(GeometryPool::Kind::Vertex) + geometryPool.getUsedBytes(GeometryPool::Kind::Index)
+        + geometryPool.getUsedBytes(GeometryPool::Kind::Material))
+        / 1024);
+    spdlog::info("Texture cache holds {} textures and {} samplers",
+      textureCache.getTextureCount(),
+      textureCache.getSamplerCount());
+    spdlog::info("Streaming {} textures, {} KiB of mip tails resident",
+      textureStreamer.getTextureCount(),
+      textureStreamer.getResidentBytes() / 1024);
 
     glm::mat4 modelMatrix = sceneConfig::getModelMatrix();
 
@@ -24,12 +44,10 @@ void Scene::loadModel(VulkanDevice *device, VkCommandPool commandPool)
 void Scene::add_model(std::shared_ptr<Model> model)
 {
     model_list.push_back(model);
-    object_descriptions.push_back(model->getObjectDescription());
-}
-
-void Scene::add_object_description(ObjectDescription object_description)
-{
-    object_descriptions.push_back(object_description);
+    object_description_offsets.push_back(static_cast<uint32_t>(object_descriptions.size()));
+    for (const ObjectDescription &object_description : model->getObjectDescriptions()) {
+        object_descriptions.push_back(object_description);
+    }
 }
 
 void Scene::update_model_matrix(glm::mat4 model_matrix, int model_id)
@@ -41,9 +59,23 @@ void Scene::update_model_matrix(glm::mat4 model_matrix, int model_id)
     model_list[model_id]->set_model(model_matrix);
 }
 
+void Scene::requestTextureMips(glm::vec3 camera_position, float projection_scale)
+{
+    for (std::shared_ptr<Model> model : model_list) {
+        if (model->getTextureCount() == 0) continue;
+        for (size_t submesh = 0; submesh < model->getMesh(0)->getSubmeshes().size(); submesh++) {
+            textureStreamer.request(
+              model->getSubmeshTextureSlot(submesh), model->getProjectedSize(submesh, camera_position, projection_scale));
+        }
+    }
+}
+
 void Scene::cleanUp()
 {
+    textureStreamer.cleanUp();
     for (std::shared_ptr<Model> model : model_list) { model->cleanUp(); }
+    geometryPool.cleanUp();
+    textureCache.cleanUp();
 }
 
 uint32_t Scene::getNumberMeshes()
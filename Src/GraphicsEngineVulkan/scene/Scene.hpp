@@ -15,8 +15,11 @@
 
 #include "GUI.hpp"
 #include "GUISceneSharedVars.hpp"
+#include "GeometryPool.hpp"
 #include "Mesh.hpp"
 #include "Model.hpp"
+#include "TextureCache.hpp"
+#include "TextureStreamer.hpp"
 
 #include "SceneConfig.hpp"
 
@@ -30,43 +33,57 @@ class Scene
 
     const GUISceneSharedVars &getGuiSceneSharedVars() { return guiSceneSharedVars; };
 
-    std::vector<Texture> &getTextures(int model_index) { return model_list[model_index]->getTextures(); };
-    std::vector<VkSampler> &getTextureSampler(int model_index)
-    {
-        return model_list[model_index]->getTextureSamplers();
-    };
     uint32_t getTextureCount(int model_index) { return model_list[model_index]->getTextureCount(); };
     uint32_t getModelCount() { return static_cast<uint32_t>(model_list.size()); };
     glm::mat4 getModelMatrix(int model_index) { return model_list[model_index]->getModel(); };
     uint32_t getMeshCount(int model_index) { return static_cast<uint32_t>(model_list[model_index]->getMeshCount()); };
-    VkBuffer getVertexBuffer(int model_index, int mesh_index)
+    Mesh *getMesh(int model_index, int mesh_index) { return model_list[model_index]->getMesh(mesh_index); };
+    uint32_t getIndexCount(int model_index, int mesh_index)
+    {
+        return model_list[model_index]->getMesh(mesh_index)->getIndexCount();
+    };
+    std::vector<Submesh> &getSubmeshes(int model_index, int mesh_index)
     {
-        return model_list[model_index]->getMesh(mesh_index)->getVertexBuffer();
+        return model_list[model_index]->getMesh(mesh_index)->getSubmeshes();
     };
-    VkBuffer getIndexBuffer(int model_index, int mesh_index)
+    std::vector<MeshLod> &getLods(int model_index, int mesh_index)
     {
-        return model_list[model_index]->getMesh(mesh_index)->getIndexBuffer();
+        return model_list[model_index]->getMesh(mesh_index)->getLods();
     };
-    uint32_t getIndexCount(int model_index, int mesh_index)
+    uint32_t selectLod(int model_index, int submesh_index, glm::vec3 camera_position, float projection_scale)
     {
-        return model_list[model_index]->getMesh(mesh_index)->getIndexCount();
+        return model_list[model_index]->selectLod(
+          submesh_index, camera_position, projection_scale, sceneConfig::getMaxLodPixelError());
     };
+    // index of the model's first submesh in the object descriptions; used as
+    // TLAS instance custom index and as first instance of the raster draws
+    uint32_t getObjectDescriptionOffset(int model_index) { return object_description_offsets[model_index]; };
     uint32_t getNumberObjectDescriptions() { return static_cast<uint32_t>(object_descriptions.size()); };
     uint32_t getNumberMeshes();
     std::vector<ObjectDescription> getObjectDescriptions() { return object_descriptions; };
     std::vector<std::shared_ptr<Model>> const &get_model_list() { return model_list; };
+    GeometryPool &getGeometryPool() { return geometryPool; };
+    TextureCache &getTextureCache() { return textureCache; };
+    TextureStreamer &getTextureStreamer() { return textureStreamer; };
+    // asks the texture streamer for the mip levels every textured submesh needs from this camera
+    void requestTextureMips(glm::vec3 camera_position, float projection_scale);
 
-    void loadModel(VulkanDevice *device, VkCommandPool commandPool);
+    void loadModel(VulkanDevice *device, VulkanUploadManager *uploadManager);
 
     void add_model(std::shared_ptr<Model> model);
-    void add_object_description(ObjectDescription object_description);
 
     void cleanUp();
     ~Scene();
 
   private:
     std::vector<ObjectDescription> object_descriptions;
+    std::vector<uint32_t> object_description_offsets;
     std::vector<std::shared_ptr<Model>> model_list;
+    // vertices, indices and materials of all models
+    GeometryPool geometryPool;
+    // textures and samplers shared by all models
+    TextureCache textureCache;
+    TextureStreamer textureStreamer;
 
     GUISceneSharedVars guiSceneSharedVars;
 };
@@ -75,4 +75,18 @@ glm::mat4 getModelMatrix()
     return modelMatrix;
 }
 
+VertexLayout getVertexLayout() { return VertexLayout::Compact; }
+
+float getMaxLodPixelError() { return 1.0f; }
+
+bool getComputeMipGeneration() { return true; }
+
+bool getTextureStreaming() { return true; }
+
+uint32_t getTextureBudgetMiB() { return 1024; }
+
+VkPresentModeKHR getPresentMode() { return VK_PRESENT_MODE_FIFO_KHR; }
+
+uint32_t getMaxQueuedFrames() { return 1; }
+
 }// namespace sceneConfig
@@ -1,12 +1,30 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <string>
 
+#include "Vertex.hpp"
+
 namespace sceneConfig {
 
 std::string getModelFile();
 glm::mat4 getModelMatrix();
+// vertex buffer layout of all loaded meshes; the pipelines are built for it
+VertexLayout getVertexLayout();
+// screen space error in pixels up to which the rasterizer uses coarser levels of detail
+float getMaxLodPixelError();
+// single compute dispatch per texture instead of one blit per mip level
+bool getComputeMipGeneration();
+// cooked textures keep only their mip tail resident and stream finer levels on demand
+bool getTextureStreaming();
+// upper bound for streamed textures; VK_EXT_memory_budget may grant less
+uint32_t getTextureBudgetMiB();
+// present mode the swapchain starts with; FIFO if the surface does not support it
+VkPresentModeKHR getPresentMode();
+// frames queued for presentation before input of the next one is sampled; trades latency for throughput
+uint32_t getMaxQueuedFrames();
 
 }// namespace sceneConfig
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+// range of the shared index buffer of a Mesh drawn with a single material.
+// the rasterizer issues one draw and the BLAS gets one geometry per submesh
+struct Submesh
+{
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t material_id;
+    // material is not see through (dissolve == 1); drives the geometry flags of the BLAS
+    bool opaque{ true };
+};
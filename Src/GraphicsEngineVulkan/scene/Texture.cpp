@@ -1,35 +1,41 @@
 #include "Texture.hpp"
 
 #include "Utilities.hpp"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
+#include <vector>
 #include "spdlog/spdlog.h"
 
 Texture::Texture() {}
 
-void Texture::createFromFile(VulkanDevice *device, VkCommandPool commandPool, const std::string &fileName)
+void Texture::createFromFile(VulkanDevice *device, VulkanUploadManager *uploadManager, const std::string &fileName)
 {
     int width, height;
     VkDeviceSize size;
     stbi_uc *image_data = loadTextureData(fileName, &width, &height, &size);
 
-    mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+    createFromPixels(device, uploadManager, image_data, width, height);
 
-    // create staging buffer to hold loaded data, ready to copy to device
-    VulkanBuffer stagingBuffer;
-    stagingBuffer.create(device,
-      size,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    stbi_image_free(image_data);
+}
 
-    // copy image data to staging buffer
-    void *data;
-    vkMapMemory(device->getLogicalDevice(), stagingBuffer.getBufferMemory(), 0, size, 0, &data);
-    memcpy(data, image_data, static_cast<size_t>(size));
-    vkUnmapMemory(device->getLogicalDevice(), stagingBuffer.getBufferMemory());
+void Texture::createFromPixels(VulkanDevice *device,
+  VulkanUploadManager *uploadManager,
+  const stbi_uc *pixels,
+  int width,
+  int height)
+{
+    VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
 
-    // free original image data
-    stbi_image_free(image_data);
+    mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+    // storage only if the compute mip generation runs for it, transfer src for the blit fallback
+    VkImageUsageFlags usage =
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (uploadManager->usesComputeMipGeneration(VK_FORMAT_R8G8B8A8_UNORM, width, height)) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
 
     createImage(device,
       width,
@@ -37,44 +43,68 @@ void Texture::createFromFile(VulkanDevice *device, VkCommandPool commandPool, co
       mip_levels,
       VK_FORMAT_R8G8B8A8_UNORM,
       VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    // copy data to image
-    // transition image to be DST for copy operation
-    vulkanImage.transitionImageLayout(device->getLogicalDevice(),
-      device->getGraphicsQueue(),
-      commandPool,
-      VK_IMAGE_LAYOUT_UNDEFINED,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      VK_IMAGE_ASPECT_COLOR_BIT,
-      mip_levels);
-
-    // copy data to image
-    vulkanBufferManager.copyImageBuffer(device->getLogicalDevice(),
-      device->getGraphicsQueue(),
-      commandPool,
-      stagingBuffer.getBuffer(),
-      vulkanImage.getImage(),
-      width,
-      height);
-
-    // generate mipmaps
-    generateMipMaps(device->getPhysicalDevice(),
-      device->getLogicalDevice(),
-      commandPool,
-      device->getGraphicsQueue(),
-      vulkanImage.getImage(),
-      VK_FORMAT_R8G8B8A8_SRGB,
-      width,
-      height,
-      mip_levels);
+      usage,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::Texture);
 
-    stagingBuffer.cleanUp();
+    // pixels are copied into the staging ring right away,
+    // so the caller can free the image data afterwards
+    uploadManager->uploadImage(vulkanImage, pixels, size, width, height, mip_levels);
+
+    // generate mipmaps within the same upload batch
+    uploadManager->generateMipMaps(vulkanImage, VK_FORMAT_R8G8B8A8_UNORM, usage, width, height, mip_levels);
 
     createImageView(device, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, mip_levels);
 }
 
+void Texture::createFromCooked(VulkanDevice *device,
+  VulkanUploadManager *uploadManager,
+  const CookedTexture &cooked,
+  uint32_t first_level)
+{
+    first_level = std::min(first_level, static_cast<uint32_t>(cooked.levels.size()) - 1);
+    mip_levels = static_cast<uint32_t>(cooked.levels.size()) - first_level;
+
+    createImage(device,
+      cooked.levels[first_level].width,
+      cooked.levels[first_level].height,
+      mip_levels,
+      cooked.format,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::Texture);
+
+    // the ktx2 file stores the smallest level first, so the levels
+    // form one contiguous range ending with first_level
+    const uint64_t first_offset = cooked.levels.back().offset;
+    const uint64_t end_offset = cooked.levels[first_level].offset + cooked.levels[first_level].size;
+
+    std::vector<VkBufferImageCopy> regions(mip_levels);
+    for (uint32_t level = 0; level < mip_levels; level++) {
+        const CookedTexture::Level &cooked_level = cooked.levels[first_level + level];
+        regions[level] = {};
+        regions[level].bufferOffset = cooked_level.offset - first_offset;
+        regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].imageSubresource.mipLevel = level;
+        regions[level].imageSubresource.baseArrayLayer = 0;
+        regions[level].imageSubresource.layerCount = 1;
+        regions[level].imageOffset = { 0, 0, 0 };
+        regions[level].imageExtent = { cooked_level.width, cooked_level.height, 1 };
+    }
+
+    uploadManager->uploadImage(
+      vulkanImage, cooked.getData() + first_offset, end_offset - first_offset, regions, mip_levels);
+
+    vulkanImage.transitionImageLayout(uploadManager->getCommandBuffer(),
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      mip_levels,
+      VK_IMAGE_ASPECT_COLOR_BIT);
+
+    createImageView(device, cooked.format, VK_IMAGE_ASPECT_COLOR_BIT, mip_levels);
+}
+
 void Texture::setImage(VkImage image) { vulkanImage.setImage(image); }
 
 void Texture::setImageView(VkImageView imageView) { vulkanImageView.setImageView(imageView); }
@@ -86,9 +116,10 @@ void Texture::createImage(VulkanDevice *device,
   VkFormat format,
   VkImageTiling tiling,
   VkImageUsageFlags use_flags,
-  VkMemoryPropertyFlags prop_flags)
+  VkMemoryPropertyFlags prop_flags,
+  MemoryCategory category)
 {
-    vulkanImage.create(device, width, height, mip_levels, format, tiling, use_flags, prop_flags);
+    vulkanImage.create(device, width, height, mip_levels, format, tiling, use_flags, prop_flags, category);
 }
 
 void Texture::createImageView(VulkanDevice *device,
@@ -124,128 +155,3 @@ stbi_uc *Texture::loadTextureData(const std::string &file_name, int *width, int
 
     return image;
 }
-
-void Texture::generateMipMaps(VkPhysicalDevice physical_device,
-  VkDevice device,
-  VkCommandPool command_pool,
-  VkQueue queue,
-  VkImage image,
-  VkFormat image_format,
-  int32_t width,
-  int32_t height,
-  uint32_t mip_levels)
-{
-    // Check if image format supports linear blitting
-    VkFormatProperties formatProperties;
-    vkGetPhysicalDeviceFormatProperties(physical_device, image_format, &formatProperties);
-
-    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-        spdlog::error("Texture image format does not support linear blitting!");
-    }
-
-    VkCommandBuffer command_buffer = commandBufferManager.beginCommandBuffer(device, command_pool);
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.image = image;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.subresourceRange.levelCount = 1;
-
-    // TEMP VARS needed for decreasing step by step for factor 2
-    int32_t tmp_width = width;
-    int32_t tmp_height = height;
-
-    // -- WE START AT 1 !
-    for (uint32_t i = 1; i < mip_levels; i++) {
-        // WAIT for previous mip map level for being ready
-        barrier.subresourceRange.baseMipLevel = i - 1;
-        // HERE we TRANSITION for having a SRC format now
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-        vkCmdPipelineBarrier(command_buffer,
-          VK_PIPELINE_STAGE_TRANSFER_BIT,
-          VK_PIPELINE_STAGE_TRANSFER_BIT,
-          0,
-          0,
-          nullptr,
-          0,
-          nullptr,
-          1,
-          &barrier);
-
-        // when barrier over we can now blit :)
-        VkImageBlit blit{};
-
-        // -- OFFSETS describing the 3D-dimesnion of the region
-        blit.srcOffsets[0] = { 0, 0, 0 };
-        blit.srcOffsets[1] = { tmp_width, tmp_height, 1 };
-        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        // copy from previous level
-        blit.srcSubresource.mipLevel = i - 1;
-        blit.srcSubresource.baseArrayLayer = 0;
-        blit.srcSubresource.layerCount = 1;
-        // -- OFFSETS describing the 3D-dimesnion of the region
-        blit.dstOffsets[0] = { 0, 0, 0 };
-        blit.dstOffsets[1] = { tmp_width > 1 ? tmp_width / 2 : 1, tmp_height > 1 ? tmp_height / 2 : 1, 1 };
-        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        // -- COPY to next mipmap level
-        blit.dstSubresource.mipLevel = i;
-        blit.dstSubresource.baseArrayLayer = 0;
-        blit.dstSubresource.layerCount = 1;
-
-        vkCmdBlitImage(command_buffer,
-          image,
-          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-          image,
-          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-          1,
-          &blit,
-          VK_FILTER_LINEAR);
-
-        // REARRANGE image formats for having the correct image formats again
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(command_buffer,
-          VK_PIPELINE_STAGE_TRANSFER_BIT,
-          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-          0,
-          0,
-          nullptr,
-          0,
-          nullptr,
-          1,
-          &barrier);
-
-        if (tmp_width > 1) tmp_width /= 2;
-        if (tmp_height > 1) tmp_height /= 2;
-    }
-
-    barrier.subresourceRange.baseMipLevel = mip_levels - 1;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(command_buffer,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-      0,
-      0,
-      nullptr,
-      0,
-      nullptr,
-      1,
-      &barrier);
-
-    commandBufferManager.endAndSubmitCommandBuffer(device, command_pool, queue, command_buffer);
-}
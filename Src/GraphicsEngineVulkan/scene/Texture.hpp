@@ -4,17 +4,31 @@
 
 #include <string>
 
+#include "TextureCooker.hpp"
 #include "VulkanBuffer.hpp"
 #include "VulkanBufferManager.hpp"
 #include "VulkanImage.hpp"
 #include "VulkanImageView.hpp"
+#include "VulkanUploadManager.hpp"
 
 class Texture
 {
   public:
     Texture();
 
-    void createFromFile(VulkanDevice *device, VkCommandPool commandPool, const std::string &fileName);
+    void createFromFile(VulkanDevice *device, VulkanUploadManager *uploadManager, const std::string &fileName);
+    // rgba8 pixels, e.g. decoded by the TextureDecoder; copied into staging right away
+    void createFromPixels(VulkanDevice *device,
+      VulkanUploadManager *uploadManager,
+      const stbi_uc *pixels,
+      int width,
+      int height);
+    // block compressed mip chain (see TextureCooker); uploaded as is, no mip generation.
+    // the image only holds the levels from first_level on (see TextureStreamer)
+    void createFromCooked(VulkanDevice *device,
+      VulkanUploadManager *uploadManager,
+      const CookedTexture &cooked,
+      uint32_t first_level = 0);
 
     void setImage(VkImage image);
     void setImageView(VkImageView imageView);
@@ -32,7 +46,8 @@ class Texture
       VkFormat format,
       VkImageTiling tiling,
       VkImageUsageFlags use_flags,
-      VkMemoryPropertyFlags prop_flags);
+      VkMemoryPropertyFlags prop_flags,
+      MemoryCategory category);
 
     void createImageView(VulkanDevice *device, VkFormat format, VkImageAspectFlags aspect_flags, uint32_t mip_levels);
 
@@ -45,19 +60,6 @@ class Texture
 
     stbi_uc *loadTextureData(const std::string &file_name, int *width, int *height, VkDeviceSize *image_size);
 
-    void generateMipMaps(VkPhysicalDevice physical_device,
-      VkDevice device,
-      VkCommandPool command_pool,
-      VkQueue queue,
-      VkImage image,
-      VkFormat image_format,
-      int32_t width,
-      int32_t height,
-      uint32_t mip_levels);
-
-    CommandBufferManager commandBufferManager;
-    VulkanBufferManager vulkanBufferManager;
-
     VulkanImage vulkanImage;
     VulkanImageView vulkanImageView;
 };
@@ -0,0 +1,275 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#include "MappedFile.hpp"
+#include "MeshCache.hpp"
+#include "Utilities.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// everything after sType and pNext; all members are 32 bit, so there is no padding to hash
+constexpr size_t SAMPLER_INFO_OFFSET = offsetof(VkSamplerCreateInfo, flags);
+constexpr size_t SAMPLER_INFO_SIZE = sizeof(VkSamplerCreateInfo) - SAMPLER_INFO_OFFSET;
+
+const char *samplerInfoBytes(const VkSamplerCreateInfo &create_info)
+{
+    return reinterpret_cast<const char *>(&create_info) + SAMPLER_INFO_OFFSET;
+}
+
+}// namespace
+
+TextureCache::TextureCache() {}
+
+void TextureCache::init(VulkanDevice *device)
+{
+    this->device = device;
+    table_capacity = device->getTextureTableCapacity();
+}
+
+TextureCache::Key TextureCache::makeKey(const std::string &file) const
+{
+    Key key;
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(file, error);
+    key.path = error ? std::filesystem::path(file).lexically_normal().string() : canonical.string();
+
+    auto cached = texture_by_path.find(key.path);
+    if (cached != texture_by_path.end()) {
+        key.content_hash = textures.at(cached->second).content_hash;
+        return key;
+    }
+
+    if (std::filesystem::exists(key.path, error)) {
+        MappedFile mapping(key.path);
+        if (mapping.isOpen()) key.content_hash = MeshCache::hashContent(mapping.data(), mapping.size());
+    }
+    return key;
+}
+
+bool TextureCache::contains(const Key &key) const
+{
+    uint64_t id;
+    return findId(key, id);
+}
+
+uint32_t TextureCache::insertTexture(const Key &key, const Texture &texture, VkSampler sampler)
+{
+    Texture copy = texture;
+    const uint64_t id = next_texture_id++;
+
+    TextureEntry &entry = textures[id];
+    entry.texture = copy;
+    entry.paths.push_back(key.path);
+    entry.content_hash = key.content_hash;
+    entry.slot = allocateSlot({ copy.getImageView(), sampler });
+    if (entry.slot == INVALID_SLOT) {
+        spdlog::error("The texture table is full ({} textures); {} falls back to slot 0!", table_capacity, key.path);
+    }
+
+    texture_by_path[key.path] = id;
+    if (key.content_hash != 0) texture_by_content.emplace(key.content_hash, id);
+    return entry.slot == INVALID_SLOT ? 0 : entry.slot;
+}
+
+bool TextureCache::acquireTexture(const Key &key, Texture &texture, uint32_t &slot)
+{
+    uint64_t id;
+    if (!findId(key, id)) return false;
+    TextureEntry &entry = textures.at(id);
+
+    // same content under another path: remember the path for the next lookup
+    if (texture_by_path.emplace(key.path, id).second) entry.paths.push_back(key.path);
+
+    entry.references++;
+    texture = entry.texture;
+    slot = entry.slot == INVALID_SLOT ? 0 : entry.slot;
+    return true;
+}
+
+void TextureCache::releaseTexture(const Key &key)
+{
+    uint64_t id;
+    if (!findId(key, id)) {
+        spdlog::error("Released texture " + key.path + " is not in the texture cache!");
+        return;
+    }
+
+    auto cached = textures.find(id);
+    TextureEntry &entry = cached->second;
+    if (entry.references > 0) entry.references--;
+    if (entry.references > 0) return;
+
+    for (const std::string &path : entry.paths) texture_by_path.erase(path);
+    if (entry.content_hash != 0) texture_by_content.erase(entry.content_hash);
+    if (entry.slot != INVALID_SLOT) {
+        VkSampler sampler = table[entry.slot].sampler;
+        freeSlot(entry.slot);
+        if (sampler != VK_NULL_HANDLE) releaseSampler(sampler);
+    }
+    entry.texture.cleanUp();
+    textures.erase(cached);
+}
+
+bool TextureCache::replaceTexture(uint32_t slot, const Texture &texture, Texture &old)
+{
+    for (auto &[id, entry] : textures) {
+        if (entry.slot != slot) continue;
+
+        old = entry.texture;
+        entry.texture = texture;
+        table[slot].image_view = entry.texture.getImageView();
+        if (std::find(pending_slots.begin(), pending_slots.end(), slot) == pending_slots.end()) {
+            pending_slots.push_back(slot);
+        }
+        return true;
+    }
+
+    spdlog::error("Texture table slot {} is not in use!", slot);
+    return false;
+}
+
+VkSampler TextureCache::acquireSampler(const VkSamplerCreateInfo &create_info)
+{
+    const uint64_t hash = MeshCache::hashContent(samplerInfoBytes(create_info), SAMPLER_INFO_SIZE);
+
+    for (SamplerEntry &entry : samplers) {
+        if (entry.hash == hash
+            && std::memcmp(samplerInfoBytes(entry.create_info), samplerInfoBytes(create_info), SAMPLER_INFO_SIZE)
+                 == 0) {
+            entry.references++;
+            return entry.sampler;
+        }
+    }
+
+    SamplerEntry entry;
+    entry.create_info = create_info;
+    entry.create_info.pNext = nullptr;
+    entry.hash = hash;
+    entry.references = 1;
+
+    VkResult result = vkCreateSampler(device->getLogicalDevice(), &entry.create_info, nullptr, &entry.sampler);
+    ASSERT_VULKAN(result, "Failed to create a texture sampler!")
+
+    samplers.push_back(entry);
+    return entry.sampler;
+}
+
+void TextureCache::releaseSampler(VkSampler sampler)
+{
+    for (size_t i = 0; i < samplers.size(); i++) {
+        if (samplers[i].sampler != sampler) continue;
+
+        if (--samplers[i].references == 0) {
+            vkDestroySampler(device->getLogicalDevice(), sampler, nullptr);
+            samplers.erase(samplers.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        return;
+    }
+    spdlog::error("Released a sampler that is not in the texture cache!");
+}
+
+VkSamplerCreateInfo TextureCache::getTextureSamplerInfo()
+{
+    // sampler create info
+    VkSamplerCreateInfo sampler_create_info{};
+    sampler_create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_create_info.magFilter = VK_FILTER_LINEAR;
+    sampler_create_info.minFilter = VK_FILTER_LINEAR;
+    sampler_create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    sampler_create_info.unnormalizedCoordinates = VK_FALSE;
+    sampler_create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_create_info.mipLodBias = 0.0f;
+    sampler_create_info.minLod = 0.0f;
+    // the image views already limit the levels; an unclamped maxLod lets all textures share one sampler
+    sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
+    sampler_create_info.anisotropyEnable = VK_TRUE;
+    sampler_create_info.maxAnisotropy = 16;// max anisotropy sample level
+    return sampler_create_info;
+}
+
+std::vector<uint32_t> TextureCache::takePendingSlots()
+{
+    std::vector<uint32_t> slots;
+    slots.swap(pending_slots);
+    if (!slots.empty()) table_version++;
+    return slots;
+}
+
+uint32_t TextureCache::getReferences(const Key &key) const
+{
+    uint64_t id;
+    return findId(key, id) ? textures.at(id).references : 0;
+}
+
+void TextureCache::cleanUp()
+{
+    for (auto &[id, entry] : textures) entry.texture.cleanUp();
+    textures.clear();
+    texture_by_path.clear();
+    texture_by_content.clear();
+    table.clear();
+    free_slots.clear();
+    pending_slots.clear();
+
+    for (SamplerEntry &entry : samplers) vkDestroySampler(device->getLogicalDevice(), entry.sampler, nullptr);
+    samplers.clear();
+}
+
+TextureCache::~TextureCache() {}
+
+uint32_t TextureCache::allocateSlot(const TableSlot &table_slot)
+{
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        // lowest free slot first keeps the used part of the table dense
+        auto lowest = std::min_element(free_slots.begin(), free_slots.end());
+        slot = *lowest;
+        free_slots.erase(lowest);
+    } else if (table.size() < table_capacity) {
+        slot = static_cast<uint32_t>(table.size());
+        table.emplace_back();
+    } else {
+        return INVALID_SLOT;
+    }
+
+    table[slot] = table_slot;
+    pending_slots.push_back(slot);
+    return slot;
+}
+
+void TextureCache::freeSlot(uint32_t slot)
+{
+    // the descriptor keeps pointing at the destroyed view; partially bound tables allow that while
+    // it is unused, the others need the slot written again (see VulkanRenderer::writeTextureTable)
+    table[slot] = TableSlot{};
+    free_slots.push_back(slot);
+    if (std::find(pending_slots.begin(), pending_slots.end(), slot) == pending_slots.end()) {
+        pending_slots.push_back(slot);
+    }
+}
+
+bool TextureCache::findId(const Key &key, uint64_t &id) const
+{
+    auto by_path = texture_by_path.find(key.path);
+    if (by_path != texture_by_path.end()) {
+        id = by_path->second;
+        return true;
+    }
+
+    if (key.content_hash == 0) return false;
+    auto by_content = texture_by_content.find(key.content_hash);
+    if (by_content != texture_by_content.end()) {
+        id = by_content->second;
+        return true;
+    }
+
+    return false;
+}
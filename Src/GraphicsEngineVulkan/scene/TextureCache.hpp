@@ -0,0 +1,121 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.hpp"
+#include "Utilities.hpp"
+#include "VulkanDevice.hpp"
+
+// textures and samplers shared by all models of a scene. a texture file is
+// found by its canonical path or, under any other path, by the hash of its
+// content; a sampler by the hash of its create info. every acquire takes a
+// reference and the last release destroys the vulkan objects, so a texture
+// used by several materials or models is decoded, uploaded and kept only once.
+// every cached texture also owns a slot of the scene wide texture table the
+// shaders index; slots stay stable while the texture lives and are reused
+// once it is destroyed. the texture behind a slot may be replaced (e.g. by a
+// version with more mip levels, see TextureStreamer)
+class TextureCache
+{
+  public:
+    struct Key
+    {
+        std::string path;
+        // 0 if the file could not be read; such files are only shared by path
+        uint64_t content_hash{ 0 };
+    };
+
+    struct TableSlot
+    {
+        VkImageView image_view{ VK_NULL_HANDLE };
+        VkSampler sampler{ VK_NULL_HANDLE };
+    };
+
+    TextureCache();
+
+    // the table capacity comes from the device limits
+    void init(VulkanDevice *device);
+
+    // the content is only hashed if the canonical path is not cached yet
+    Key makeKey(const std::string &file) const;
+    bool contains(const Key &key) const;
+
+    // takes ownership of a freshly created texture and of a reference on the
+    // sampler its table slot uses; no texture reference is taken yet.
+    // returns the texture's index into the texture table
+    uint32_t insertTexture(const Key &key, const Texture &texture, VkSampler sampler);
+    // false if neither path nor content of key are cached
+    bool acquireTexture(const Key &key, Texture &texture, uint32_t &slot);
+    void releaseTexture(const Key &key);
+    // swaps the texture of a table slot and hands the old one back; it must
+    // stay alive until every descriptor set has seen getTableVersion() + 1.
+    // false (and nothing swapped) if the slot is unused
+    bool replaceTexture(uint32_t slot, const Texture &texture, Texture &old);
+
+    // pNext chains are not supported
+    VkSampler acquireSampler(const VkSamplerCreateInfo &create_info);
+    void releaseSampler(VkSampler sampler);
+    static VkSamplerCreateInfo getTextureSamplerInfo();
+
+    uint32_t getTableCapacity() const { return table_capacity; };
+    const TableSlot &getTableSlot(uint32_t slot) const { return table[slot]; };
+    // slots filled or freed since the last call; only their descriptors need
+    // to be written. every call that returns slots bumps the table version
+    std::vector<uint32_t> takePendingSlots();
+    uint64_t getTableVersion() const { return table_version; };
+
+    uint32_t getTextureCount() const { return static_cast<uint32_t>(textures.size()); };
+    uint32_t getSamplerCount() const { return static_cast<uint32_t>(samplers.size()); };
+    uint32_t getReferences(const Key &key) const;
+
+    // destroys everything, referenced or not
+    void cleanUp();
+
+    ~TextureCache();
+
+  private:
+    struct TextureEntry
+    {
+        Texture texture;
+        // canonical paths this texture was requested under
+        std::vector<std::string> paths;
+        uint64_t content_hash{ 0 };
+        uint32_t references{ 0 };
+        uint32_t slot{ INVALID_SLOT };
+    };
+
+    struct SamplerEntry
+    {
+        VkSamplerCreateInfo create_info{};
+        uint64_t hash{ 0 };
+        VkSampler sampler{ VK_NULL_HANDLE };
+        uint32_t references{ 0 };
+    };
+
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    VulkanDevice *device{ VK_NULL_HANDLE };
+
+    // entries are keyed by an id of their own, their image changes on replaceTexture()
+    std::unordered_map<uint64_t, TextureEntry> textures;
+    std::unordered_map<std::string, uint64_t> texture_by_path;
+    std::unordered_map<uint64_t, uint64_t> texture_by_content;
+    uint64_t next_texture_id{ 0 };
+    std::vector<SamplerEntry> samplers;
+
+    uint32_t table_capacity{ static_cast<uint32_t>(MAX_BINDLESS_TEXTURE_COUNT) };
+    std::vector<TableSlot> table;
+    std::vector<uint32_t> free_slots;
+    std::vector<uint32_t> pending_slots;
+    uint64_t table_version{ 0 };
+
+    uint32_t allocateSlot(const TableSlot &table_slot);
+    void freeSlot(uint32_t slot);
+
+    // by path first, then by content
+    bool findId(const Key &key, uint64_t &id) const;
+};
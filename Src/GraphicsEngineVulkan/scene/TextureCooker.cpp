@@ -0,0 +1,631 @@
+#include "TextureCooker.hpp"
+
+#include <khr_df.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "MeshCache.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr std::array<unsigned char, 12> KTX2_IDENTIFIER = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+constexpr char SOURCE_KEY[] = "GraphicsEngineVulkan.source";
+constexpr char WRITER_KEY[] = "KTXwriter";
+constexpr char WRITER[] = "GraphicsEngineVulkan TextureCooker";
+
+struct Ktx2Header
+{
+    unsigned char identifier[12];
+    uint32_t vk_format;
+    uint32_t type_size;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t layer_count;
+    uint32_t face_count;
+    uint32_t level_count;
+    uint32_t supercompression_scheme;
+    uint32_t dfd_byte_offset;
+    uint32_t dfd_byte_length;
+    uint32_t kvd_byte_offset;
+    uint32_t kvd_byte_length;
+    uint64_t sgd_byte_offset;
+    uint64_t sgd_byte_length;
+};
+static_assert(sizeof(Ktx2Header) == 80, "ktx2 header is 80 bytes");
+
+struct Ktx2Level
+{
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+// value of SOURCE_KEY
+struct Source
+{
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t size;
+    int64_t mtime;
+    uint64_t hash;
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+uint32_t getBlockBytes(VkFormat format) { return format == VK_FORMAT_BC1_RGB_UNORM_BLOCK ? 8 : 16; }
+
+uint64_t getLevelBytes(VkFormat format, uint32_t width, uint32_t height)
+{
+    return uint64_t((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+}
+
+int64_t lastWriteTime(const std::string &file, std::error_code &error)
+{
+    return static_cast<int64_t>(std::filesystem::last_write_time(file, error).time_since_epoch().count());
+}
+
+bool sourceUpToDate(const std::string &file, const Source &source)
+{
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(file, error);
+    if (error || size != source.size) return false;
+
+    const int64_t mtime = lastWriteTime(file, error);
+    if (!error && mtime == source.mtime) return true;
+
+    MappedFile source_mapping(file);
+    return source_mapping.isOpen()
+           && MeshCache::hashContent(source_mapping.data(), source_mapping.size()) == source.hash;
+}
+
+void appendBytes(std::vector<unsigned char> &out, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+void appendKeyValue(std::vector<unsigned char> &kvd, const char *key, const void *value, size_t value_size)
+{
+    const size_t key_size = std::strlen(key) + 1;
+    const uint32_t length = static_cast<uint32_t>(key_size + value_size);
+    appendBytes(kvd, &length, sizeof(length));
+    appendBytes(kvd, key, key_size);
+    appendBytes(kvd, value, value_size);
+    kvd.resize(alignUp(kvd.size(), 4), 0);
+}
+
+// the texture files are srgb encoded; averaging them as stored darkens every mip
+float srgbToLinear(stbi_uc value)
+{
+    static const std::array<float, 256> table = []() {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; i++) {
+            const float c = i / 255.f;
+            t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table[value];
+}
+
+stbi_uc linearToSrgb(float value)
+{
+    value = std::clamp(value, 0.f, 1.f);
+    const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+    return static_cast<stbi_uc>(c * 255.f + 0.5f);
+}
+
+// premultiplied linear rgba
+std::vector<float> toLinear(const stbi_uc *pixels, size_t pixel_count)
+{
+    std::vector<float> linear(4 * pixel_count);
+    for (size_t p = 0; p < pixel_count; p++) {
+        const float alpha = pixels[4 * p + 3] / 255.f;
+        for (int c = 0; c < 3; c++) linear[4 * p + c] = srgbToLinear(pixels[4 * p + c]) * alpha;
+        linear[4 * p + 3] = alpha;
+    }
+    return linear;
+}
+
+std::vector<stbi_uc> toSrgb(const std::vector<float> &linear)
+{
+    std::vector<stbi_uc> pixels(linear.size());
+    for (size_t p = 0; p < linear.size() / 4; p++) {
+        const float alpha = linear[4 * p + 3];
+        for (int c = 0; c < 3; c++) pixels[4 * p + c] = alpha > 0.f ? linearToSrgb(linear[4 * p + c] / alpha) : 0;
+        pixels[4 * p + 3] = static_cast<stbi_uc>(std::clamp(alpha, 0.f, 1.f) * 255.f + 0.5f);
+    }
+    return pixels;
+}
+
+// area weighted box filter along one axis: with an odd source size every
+// destination texel covers one and a half source texels instead of dropping
+// the last row/column like a plain 2x2 average
+std::vector<float> filterAxis(const std::vector<float> &src,
+  uint32_t size,
+  uint32_t dst_size,
+  uint32_t line_count,
+  size_t texel_stride,
+  size_t line_stride,
+  size_t dst_texel_stride,
+  size_t dst_line_stride)
+{
+    std::vector<float> dst(4 * size_t(dst_size) * line_count, 0.f);
+    const float scale = float(size) / float(dst_size);
+    for (uint32_t d = 0; d < dst_size; d++) {
+        const float begin = d * scale;
+        const float end = (d + 1) * scale;
+        for (uint32_t s = uint32_t(begin); s < size && float(s) < end; s++) {
+            const float weight = (std::min(end, float(s + 1)) - std::max(begin, float(s))) / scale;
+            for (uint32_t line = 0; line < line_count; line++) {
+                const float *from = &src[4 * (s * texel_stride + line * line_stride)];
+                float *to = &dst[4 * (d * dst_texel_stride + line * dst_line_stride)];
+                for (int c = 0; c < 4; c++) to[c] += weight * from[c];
+            }
+        }
+    }
+    return dst;
+}
+
+std::vector<float>
+  downsample(const std::vector<float> &src, uint32_t width, uint32_t height, uint32_t dst_width, uint32_t dst_height)
+{
+    std::vector<float> rows = filterAxis(src, width, dst_width, height, 1, width, 1, dst_width);
+    return filterAxis(rows, height, dst_height, dst_width, dst_width, 1, dst_width, 1);
+}
+
+void unpackRgb565(uint16_t packed, int rgb[3])
+{
+    const int r = (packed >> 11) & 31;
+    const int g = (packed >> 5) & 63;
+    const int b = packed & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+uint16_t packRgb565(const float rgb[3])
+{
+    const uint16_t r = static_cast<uint16_t>(std::clamp(rgb[0], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+    const uint16_t g = static_cast<uint16_t>(std::clamp(rgb[1], 0.f, 255.f) * 63.f / 255.f + 0.5f);
+    const uint16_t b = static_cast<uint16_t>(std::clamp(rgb[2], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+// best of the 4 palette colors per texel; returns the summed squared error
+uint32_t pickColorIndices(const stbi_uc texels[64], uint16_t color0, uint16_t color1, uint32_t &indices)
+{
+    int palette[4][3];
+    unpackRgb565(color0, palette[0]);
+    unpackRgb565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+    }
+
+    indices = 0;
+    uint32_t error = 0;
+    for (int t = 0; t < 16; t++) {
+        uint32_t best_error = UINT32_MAX;
+        uint32_t best = 0;
+        for (uint32_t p = 0; p < 4; p++) {
+            uint32_t e = 0;
+            for (int c = 0; c < 3; c++) {
+                const int d = int(texels[4 * t + c]) - palette[p][c];
+                e += d * d;
+            }
+            if (e < best_error) {
+                best_error = e;
+                best = p;
+            }
+        }
+        indices |= best << (2 * t);
+        error += best_error;
+    }
+    return error;
+}
+
+// least squares endpoints for fixed indices; false if the system is singular
+bool refineEndpoints(const stbi_uc texels[64], uint32_t indices, uint16_t &color0, uint16_t &color1)
+{
+    constexpr float WEIGHT[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+    float aa = 0.f, ab = 0.f, bb = 0.f;
+    float ax[3] = {}, bx[3] = {};
+    for (int t = 0; t < 16; t++) {
+        const float a = WEIGHT[(indices >> (2 * t)) & 3];
+        const float b = 1.f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < 3; c++) {
+            ax[c] += a * texels[4 * t + c];
+            bx[c] += b * texels[4 * t + c];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f) return false;
+
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; c++) {
+        end0[c] = (bb * ax[c] - ab * bx[c]) / det;
+        end1[c] = (aa * bx[c] - ab * ax[c]) / det;
+    }
+    color0 = packRgb565(end0);
+    color1 = packRgb565(end1);
+    return true;
+}
+
+void writeColorBlock(uint16_t color0, uint16_t color1, uint32_t indices, unsigned char block[8])
+{
+    // color0 > color1 selects the 4 color mode in BC1 (BC3 always uses it)
+    if (color0 < color1) {
+        std::swap(color0, color1);
+        // 0 <-> 1, 2 <-> 3
+        indices ^= 0x55555555u;
+    } else if (color0 == color1) {
+        indices = 0;
+    }
+    std::memcpy(block, &color0, 2);
+    std::memcpy(block + 2, &color1, 2);
+    std::memcpy(block + 4, &indices, 4);
+}
+
+void compressAlphaBlock(const stbi_uc texels[64], unsigned char block[8])
+{
+    int min_alpha = 255, max_alpha = 0;
+    for (int t = 0; t < 16; t++) {
+        min_alpha = std::min<int>(min_alpha, texels[4 * t + 3]);
+        max_alpha = std::max<int>(max_alpha, texels[4 * t + 3]);
+    }
+
+    // alpha0 > alpha1: 6 interpolated values between them
+    uint64_t indices = 0;
+    if (max_alpha > min_alpha) {
+        int palette[8] = { max_alpha, min_alpha };
+        for (int i = 2; i < 8; i++) palette[i] = ((8 - i) * max_alpha + (i - 1) * min_alpha + 3) / 7;
+
+        for (int t = 0; t < 16; t++) {
+            uint64_t best = 0;
+            int best_error = 256;
+            for (int p = 0; p < 8; p++) {
+                const int e = std::abs(int(texels[4 * t + 3]) - palette[p]);
+                if (e < best_error) {
+                    best_error = e;
+                    best = p;
+                }
+            }
+            indices |= best << (3 * t);
+        }
+    }
+
+    block[0] = static_cast<unsigned char>(max_alpha);
+    block[1] = static_cast<unsigned char>(min_alpha);
+    for (int b = 0; b < 6; b++) block[2 + b] = static_cast<unsigned char>(indices >> (8 * b));
+}
+
+std::vector<unsigned char> compressLevel(const stbi_uc *pixels, uint32_t width, uint32_t height, VkFormat format)
+{
+    const uint32_t block_bytes = getBlockBytes(format);
+    const uint32_t blocks_x = (width + 3) / 4;
+    const uint32_t blocks_y = (height + 3) / 4;
+    std::vector<unsigned char> blocks(size_t(blocks_x) * blocks_y * block_bytes);
+
+    stbi_uc texels[64];
+    for (uint32_t by = 0; by < blocks_y; by++) {
+        for (uint32_t bx = 0; bx < blocks_x; bx++) {
+            // levels smaller than a block repeat their edge texels
+            for (uint32_t t = 0; t < 16; t++) {
+                const uint32_t x = std::min(4 * bx + t % 4, width - 1);
+                const uint32_t y = std::min(4 * by + t / 4, height - 1);
+                std::memcpy(&texels[4 * t], &pixels[4 * (size_t(y) * width + x)], 4);
+            }
+            unsigned char *block = &blocks[(size_t(by) * blocks_x + bx) * block_bytes];
+            if (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK) {
+                TextureCooker::compressBC1(texels, block);
+            } else {
+                TextureCooker::compressBC3(texels, block);
+            }
+        }
+    }
+    return blocks;
+}
+
+}// namespace
+
+uint64_t CookedTexture::getLevelBytes() const
+{
+    uint64_t bytes = 0;
+    for (const Level &level : levels) bytes += level.size;
+    return bytes;
+}
+
+std::string TextureCooker::getCookedFile(const std::string &textureFile) { return textureFile + ".ktx2"; }
+
+void TextureCooker::compressBC1(const stbi_uc texels[64], unsigned char block[8])
+{
+    float mean[3] = {};
+    for (int t = 0; t < 16; t++) {
+        for (int c = 0; c < 3; c++) mean[c] += texels[4 * t + c] / 16.f;
+    }
+
+    // principal axis of the colors by power iteration on their covariance
+    float covariance[3][3] = {};
+    for (int t = 0; t < 16; t++) {
+        float d[3];
+        for (int c = 0; c < 3; c++) d[c] = texels[4 * t + c] - mean[c];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) covariance[i][j] += d[i] * d[j];
+        }
+    }
+    float axis[3] = { 1.f, 1.f, 1.f };
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3];
+        for (int i = 0; i < 3; i++) {
+            next[i] = covariance[i][0] * axis[0] + covariance[i][1] * axis[1] + covariance[i][2] * axis[2];
+        }
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        // single colored block
+        if (length < 1e-6f) break;
+        for (int i = 0; i < 3; i++) axis[i] = next[i] / length;
+    }
+
+    float min_t = 0.f, max_t = 0.f;
+    for (int t = 0; t < 16; t++) {
+        float projection = 0.f;
+        for (int c = 0; c < 3; c++) projection += (texels[4 * t + c] - mean[c]) * axis[c];
+        min_t = std::min(min_t, projection);
+        max_t = std::max(max_t, projection);
+    }
+
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; c++) {
+        end0[c] = mean[c] + axis[c] * max_t;
+        end1[c] = mean[c] + axis[c] * min_t;
+    }
+    uint16_t color0 = packRgb565(end0);
+    uint16_t color1 = packRgb565(end1);
+    uint32_t indices = 0;
+    uint32_t error = pickColorIndices(texels, color0, color1, indices);
+
+    // the extremes along the axis are rarely the best endpoints
+    uint16_t refined0 = color0, refined1 = color1;
+    if (error > 0 && refineEndpoints(texels, indices, refined0, refined1)) {
+        uint32_t refined_indices = 0;
+        if (pickColorIndices(texels, refined0, refined1, refined_indices) < error) {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refined_indices;
+        }
+    }
+
+    writeColorBlock(color0, color1, indices, block);
+}
+
+void TextureCooker::compressBC3(const stbi_uc texels[64], unsigned char block[16])
+{
+    compressAlphaBlock(texels, block);
+    compressBC1(texels, block + 8);
+}
+
+CookedTexture TextureCooker::cook(const stbi_uc *pixels, int width, int height, const std::string &textureFile)
+{
+    CookedTexture cooked;
+    cooked.width = static_cast<uint32_t>(width);
+    cooked.height = static_cast<uint32_t>(height);
+    const size_t pixel_count = size_t(width) * height;
+    const uint32_t level_count = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+    bool has_alpha = false;
+    for (size_t p = 0; p < pixel_count && !has_alpha; p++) has_alpha = pixels[4 * p + 3] != 255;
+    cooked.format = has_alpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    const uint32_t block_bytes = getBlockBytes(cooked.format);
+
+    // level 0 straight from the source, every further level filtered from the one above
+    std::vector<std::vector<unsigned char>> level_blocks(level_count);
+    std::vector<float> linear = toLinear(pixels, pixel_count);
+    std::vector<stbi_uc> level_pixels;
+    uint32_t level_width = cooked.width;
+    uint32_t level_height = cooked.height;
+    cooked.levels.resize(level_count);
+    for (uint32_t l = 0; l < level_count; l++) {
+        if (l > 0) {
+            const uint32_t next_width = std::max(1u, level_width / 2);
+            const uint32_t next_height = std::max(1u, level_height / 2);
+            linear = downsample(linear, level_width, level_height, next_width, next_height);
+            level_width = next_width;
+            level_height = next_height;
+            level_pixels = toSrgb(linear);
+        }
+        level_blocks[l] =
+          compressLevel(l == 0 ? pixels : level_pixels.data(), level_width, level_height, cooked.format);
+        cooked.levels[l] = { 0, level_blocks[l].size(), level_width, level_height };
+    }
+
+    // data format descriptor: one basic block with a sample per 64 bit half
+    const uint32_t sample_count = has_alpha ? 2 : 1;
+    std::vector<uint32_t> dfd(1 + KHR_DFDSIZEWORDS(sample_count), 0);
+    dfd[0] = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+    uint32_t *bdb = dfd.data() + 1;
+    KHR_DFDSETVAL(bdb, VENDORID, uint32_t(KHR_DF_VENDORID_KHRONOS));
+    KHR_DFDSETVAL(bdb, DESCRIPTORTYPE, uint32_t(KHR_DF_KHR_DESCRIPTORTYPE_BASICFORMAT));
+    KHR_DFDSETVAL(bdb, VERSIONNUMBER, uint32_t(KHR_DF_VERSIONNUMBER_LATEST));
+    KHR_DFDSETVAL(bdb, DESCRIPTORBLOCKSIZE, KHR_DFDSIZEWORDS(sample_count) * sizeof(uint32_t));
+    KHR_DFDSETVAL(bdb, MODEL, uint32_t(has_alpha ? KHR_DF_MODEL_BC3 : KHR_DF_MODEL_BC1A));
+    KHR_DFDSETVAL(bdb, PRIMARIES, uint32_t(KHR_DF_PRIMARIES_BT709));
+    // sampled as unorm like the uncompressed textures
+    KHR_DFDSETVAL(bdb, TRANSFER, uint32_t(KHR_DF_TRANSFER_LINEAR));
+    KHR_DFDSETVAL(bdb, FLAGS, uint32_t(KHR_DF_FLAG_ALPHA_STRAIGHT));
+    KHR_DFDSETVAL(bdb, TEXELBLOCKDIMENSION0, 3);
+    KHR_DFDSETVAL(bdb, TEXELBLOCKDIMENSION1, 3);
+    KHR_DFDSETVAL(bdb, BYTESPLANE0, block_bytes);
+    for (uint32_t s = 0; s < sample_count; s++) {
+        const uint32_t channel =
+          has_alpha && s == 0 ? uint32_t(KHR_DF_CHANNEL_BC3_ALPHA) : uint32_t(KHR_DF_CHANNEL_BC1A_COLOR);
+        KHR_DFDSETSVAL(bdb, s, BITOFFSET, 64 * s);
+        KHR_DFDSETSVAL(bdb, s, BITLENGTH, 63);
+        KHR_DFDSETSVAL(bdb, s, CHANNELID, channel);
+        KHR_DFDSETSVAL(bdb, s, SAMPLEUPPER, UINT32_MAX);
+    }
+
+    // key/value data sorted by key
+    Source source{};
+    source.version = VERSION;
+    if (!textureFile.empty()) {
+        MappedFile source_mapping(textureFile);
+        std::error_code error;
+        if (source_mapping.isOpen()) {
+            source.size = source_mapping.size();
+            source.hash = MeshCache::hashContent(source_mapping.data(), source_mapping.size());
+            source.mtime = lastWriteTime(textureFile, error);
+        }
+    }
+    std::vector<unsigned char> kvd;
+    appendKeyValue(kvd, SOURCE_KEY, &source, sizeof(source));
+    appendKeyValue(kvd, WRITER_KEY, WRITER, sizeof(WRITER));
+
+    Ktx2Header header{};
+    std::memcpy(header.identifier, KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size());
+    header.vk_format = cooked.format;
+    header.type_size = 1;
+    header.pixel_width = cooked.width;
+    header.pixel_height = cooked.height;
+    header.face_count = 1;
+    header.level_count = level_count;
+    header.dfd_byte_offset = static_cast<uint32_t>(sizeof(Ktx2Header) + level_count * sizeof(Ktx2Level));
+    header.dfd_byte_length = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+    header.kvd_byte_offset = header.dfd_byte_offset + header.dfd_byte_length;
+    header.kvd_byte_length = static_cast<uint32_t>(kvd.size());
+
+    // smallest level first, each aligned to the block size
+    uint64_t offset = header.kvd_byte_offset + header.kvd_byte_length;
+    for (uint32_t l = level_count; l-- > 0;) {
+        offset = alignUp(offset, block_bytes);
+        cooked.levels[l].offset = offset;
+        offset += cooked.levels[l].size;
+    }
+
+    cooked.storage.resize(offset, 0);
+    unsigned char *data = cooked.storage.data();
+    std::memcpy(data, &header, sizeof(header));
+    for (uint32_t l = 0; l < level_count; l++) {
+        const Ktx2Level level{ cooked.levels[l].offset, cooked.levels[l].size, cooked.levels[l].size };
+        std::memcpy(data + sizeof(Ktx2Header) + l * sizeof(Ktx2Level), &level, sizeof(level));
+        std::memcpy(data + cooked.levels[l].offset, level_blocks[l].data(), level_blocks[l].size());
+    }
+    std::memcpy(data + header.dfd_byte_offset, dfd.data(), header.dfd_byte_length);
+    std::memcpy(data + header.kvd_byte_offset, kvd.data(), kvd.size());
+
+    return cooked;
+}
+
+bool TextureCooker::write(const std::string &textureFile, const CookedTexture &cooked)
+{
+    // write next to the final file and rename, like the mesh cache
+    const std::string cooked_file = getCookedFile(textureFile);
+    const std::string temp_file = cooked_file + ".tmp";
+    {
+        std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            spdlog::warn("Texture cache: could not write {}", temp_file);
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(cooked.getData()), static_cast<std::streamsize>(cooked.getSize()));
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(temp_file);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_file, cooked_file, error);
+    if (error) {
+        spdlog::warn("Texture cache: could not move {} into place: {}", cooked_file, error.message());
+        std::filesystem::remove(temp_file, error);
+        return false;
+    }
+
+    return true;
+}
+
+bool TextureCooker::open(const std::string &textureFile, CookedTexture &cooked)
+{
+    const std::string cooked_file = getCookedFile(textureFile);
+    std::error_code error;
+    if (!std::filesystem::exists(cooked_file, error)) return false;
+
+    auto mapping = std::make_unique<MappedFile>(cooked_file);
+    if (!mapping->isOpen() || mapping->size() < sizeof(Ktx2Header)) return false;
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(mapping->data());
+    const uint64_t size = mapping->size();
+
+    Ktx2Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.identifier, KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) != 0) return false;
+
+    // only what cook() writes: 2d, one layer, not supercompressed
+    const VkFormat format = static_cast<VkFormat>(header.vk_format);
+    if (format != VK_FORMAT_BC1_RGB_UNORM_BLOCK && format != VK_FORMAT_BC3_UNORM_BLOCK) return false;
+    if (header.pixel_width == 0 || header.pixel_height == 0 || header.pixel_depth != 0) return false;
+    if (header.layer_count > 1 || header.face_count != 1 || header.supercompression_scheme != 0) return false;
+    const uint32_t max_levels =
+      static_cast<uint32_t>(std::floor(std::log2(std::max(header.pixel_width, header.pixel_height)))) + 1;
+    if (header.level_count == 0 || header.level_count > max_levels) return false;
+    if (size < sizeof(Ktx2Header) + uint64_t(header.level_count) * sizeof(Ktx2Level)) return false;
+
+    std::vector<CookedTexture::Level> levels(header.level_count);
+    for (uint32_t l = 0; l < header.level_count; l++) {
+        Ktx2Level level;
+        std::memcpy(&level, data + sizeof(Ktx2Header) + l * sizeof(Ktx2Level), sizeof(level));
+        const uint32_t width = std::max(1u, header.pixel_width >> l);
+        const uint32_t height = std::max(1u, header.pixel_height >> l);
+        if (level.byte_length != getLevelBytes(format, width, height)) return false;
+        // byte_length first so size - byte_length cannot wrap around on truncated files
+        if (level.byte_length > size || level.byte_offset > size - level.byte_length
+            || level.byte_offset % getBlockBytes(format) != 0) {
+            return false;
+        }
+        levels[l] = { level.byte_offset, level.byte_length, width, height };
+    }
+
+    // find the source description in the key/value data
+    if (uint64_t(header.kvd_byte_offset) + header.kvd_byte_length > size) return false;
+    const unsigned char *kvd = data + header.kvd_byte_offset;
+    const unsigned char *kvd_end = kvd + header.kvd_byte_length;
+    bool found = false;
+    Source source{};
+    while (!found && kvd_end - kvd >= 4) {
+        uint32_t length = 0;
+        std::memcpy(&length, kvd, sizeof(length));
+        if (length > static_cast<uint64_t>(kvd_end - kvd - 4)) return false;
+        const char *key = reinterpret_cast<const char *>(kvd + 4);
+        if (length == sizeof(SOURCE_KEY) + sizeof(Source) && std::memcmp(key, SOURCE_KEY, sizeof(SOURCE_KEY)) == 0) {
+            std::memcpy(&source, kvd + 4 + sizeof(SOURCE_KEY), sizeof(Source));
+            found = true;
+        }
+        kvd += std::min<uint64_t>(alignUp(4 + uint64_t(length), 4), kvd_end - kvd);
+    }
+    if (!found || source.version != VERSION) return false;
+
+    if (!sourceUpToDate(textureFile, source)) {
+        spdlog::info("Texture cache: {} changed, cooking it again", textureFile);
+        return false;
+    }
+
+    cooked.format = format;
+    cooked.width = header.pixel_width;
+    cooked.height = header.pixel_height;
+    cooked.levels = std::move(levels);
+    cooked.storage.clear();
+    cooked.mapping = std::move(mapping);
+    return true;
+}
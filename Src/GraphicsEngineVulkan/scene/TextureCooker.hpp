@@ -0,0 +1,68 @@
+#pragma once
+#include <stb_image.h>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+// a complete ktx2 file image: either cooked in memory or mapped from disk
+struct CookedTexture
+{
+    struct Level
+    {
+        // byte range inside getData()
+        uint64_t offset;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    VkFormat format{ VK_FORMAT_UNDEFINED };
+    uint32_t width{ 0 };
+    uint32_t height{ 0 };
+    // level 0 first (the file stores the smallest level first)
+    std::vector<Level> levels;
+
+    std::vector<unsigned char> storage;
+    std::unique_ptr<MappedFile> mapping;
+
+    const unsigned char *getData() const
+    {
+        return mapping ? reinterpret_cast<const unsigned char *>(mapping->data()) : storage.data();
+    };
+    uint64_t getSize() const { return mapping ? mapping->size() : storage.size(); };
+    // bytes of all levels, i.e. what the image occupies in vram
+    uint64_t getLevelBytes() const;
+};
+
+// turns rgba8 images into block compressed ktx2 files with a full mip chain.
+// the mips are box filtered in linear light with premultiplied alpha, so they
+// neither darken nor bleed the color of transparent texels. every level is
+// stored as BC1 (opaque images, 8x smaller than rgba8) or BC3 (images with
+// alpha, 4x smaller). the cooked file sits next to the source texture and
+// remembers size, mtime and content hash of it (see MeshCache)
+class TextureCooker
+{
+  public:
+    // bump whenever filtering or encoding changes
+    static constexpr uint32_t VERSION = 1;
+
+    static std::string getCookedFile(const std::string &textureFile);
+
+    // textureFile is only used to describe the source in the ktx2 key/value data (may be empty)
+    static CookedTexture cook(const stbi_uc *pixels, int width, int height, const std::string &textureFile);
+
+    // returns false (and leaves no partial file behind) if writing fails
+    static bool write(const std::string &textureFile, const CookedTexture &cooked);
+
+    // maps the cooked file of textureFile; false if missing, corrupt or stale
+    static bool open(const std::string &textureFile, CookedTexture &cooked);
+
+    // 4x4 block encoders on rgba8 texels in row order
+    static void compressBC1(const stbi_uc texels[64], unsigned char block[8]);
+    static void compressBC3(const stbi_uc texels[64], unsigned char block[16]);
+};
@@ -0,0 +1,71 @@
+#include "TextureDecoder.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "spdlog/spdlog.h"
+
+TextureDecoder::TextureDecoder(std::vector<std::string> files, uint32_t thread_count, bool cook)
+  : files(std::move(files)), cook(cook)
+{
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    const size_t worker_count = std::min<size_t>(thread_count, this->files.size());
+
+    workers.reserve(worker_count);
+    for (size_t w = 0; w < worker_count; w++) workers.emplace_back([this]() { decodeFiles(); });
+}
+
+TextureDecoder::~TextureDecoder()
+{
+    // nothing left to hand out once the workers ran out of files
+    next_file = files.size();
+    for (std::thread &worker : workers) worker.join();
+}
+
+bool TextureDecoder::next(DecodedTexture &decoded)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (handed_out == files.size()) return false;
+
+    decoded_condition.wait(lock, [this]() { return !finished.empty(); });
+    decoded = std::move(finished.front());
+    finished.pop_front();
+    handed_out++;
+    return true;
+}
+
+void TextureDecoder::decodeFiles()
+{
+    // every worker takes the next undecoded file until none is left
+    for (size_t index = next_file++; index < files.size(); index = next_file++) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        DecodedTexture decoded;
+        decoded.index = index;
+        if (cook && TextureCooker::open(files[index], decoded.cooked)) {
+            decoded.width = static_cast<int>(decoded.cooked.width);
+            decoded.height = static_cast<int>(decoded.cooked.height);
+            decoded.cache_hit = true;
+        } else {
+            int channels = 0;
+            decoded.pixels.reset(
+              stbi_load(files[index].c_str(), &decoded.width, &decoded.height, &channels, STBI_rgb_alpha));
+            if (!decoded.pixels) spdlog::error("Failed to load a texture file! (" + files[index] + ")");
+
+            if (cook && decoded.pixels) {
+                decoded.cooked = TextureCooker::cook(decoded.pixels.get(), decoded.width, decoded.height, files[index]);
+                TextureCooker::write(files[index], decoded.cooked);
+                decoded.pixels.reset();
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        decoded.decode_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(std::move(decoded));
+        }
+        decoded_condition.notify_one();
+    }
+}
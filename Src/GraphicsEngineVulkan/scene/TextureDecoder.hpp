@@ -0,0 +1,64 @@
+#pragma once
+#include <stb_image.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureCooker.hpp"
+
+struct DecodedTexture
+{
+    // position in the file list given to the decoder
+    size_t index{ 0 };
+    int width{ 0 };
+    int height{ 0 };
+    // rgba8; null if the file could not be decoded or got cooked
+    std::unique_ptr<stbi_uc, void (*)(void *)> pixels{ nullptr, stbi_image_free };
+    // only when cooking: no levels if the file could not be decoded
+    CookedTexture cooked;
+    // the cooked file was up to date, nothing got decoded
+    bool cache_hit{ false };
+    double decode_ms{ 0.0 };
+};
+
+// decodes image files with stb_image on a pool of worker threads. the
+// decoded pixels are handed out in completion order on the calling thread,
+// so the (single threaded) gpu upload can start with the first finished one.
+// with cooking enabled the workers load the cooked ktx2 file instead and only
+// decode + cook (see TextureCooker) the files without an up to date one
+class TextureDecoder
+{
+  public:
+    // starts decoding right away; thread_count 0 picks std::thread::hardware_concurrency()
+    explicit TextureDecoder(std::vector<std::string> files, uint32_t thread_count = 0, bool cook = false);
+    ~TextureDecoder();
+
+    TextureDecoder(const TextureDecoder &) = delete;
+    TextureDecoder &operator=(const TextureDecoder &) = delete;
+
+    // blocks until the next texture is decoded; false once all were handed out
+    bool next(DecodedTexture &decoded);
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); };
+    const std::string &getFile(size_t index) const { return files[index]; };
+
+  private:
+    std::vector<std::string> files;
+    bool cook;
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> next_file{ 0 };
+    std::mutex mutex;
+    std::condition_variable decoded_condition;
+    std::deque<DecodedTexture> finished;
+    size_t handed_out{ 0 };
+
+    void decodeFiles();
+};
@@ -0,0 +1,218 @@
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "spdlog/spdlog.h"
+
+TextureStreamer::TextureStreamer() {}
+
+void TextureStreamer::init(VulkanDevice *device,
+  VulkanUploadManager *uploadManager,
+  TextureCache *textureCache,
+  VkDeviceSize budget_bytes)
+{
+    this->device = device;
+    this->uploadManager = uploadManager;
+    this->textureCache = textureCache;
+    budget_limit = budget_bytes;
+    budget = budget_bytes;
+}
+
+uint32_t TextureStreamer::getTailLevel(const CookedTexture &cooked)
+{
+    uint32_t level = 0;
+    while (level + 1 < cooked.levels.size()
+           && std::max(cooked.levels[level].width, cooked.levels[level].height) > TAIL_EXTENT) {
+        level++;
+    }
+    return level;
+}
+
+uint32_t TextureStreamer::getWantedLevel(uint32_t width, uint32_t height, float pixels, float bias)
+{
+    const float extent = static_cast<float>(std::max(width, height));
+    const float level = std::floor(std::log2(extent / std::max(pixels, 1.0f)) - bias);
+    return level > 0.0f ? static_cast<uint32_t>(level) : 0;
+}
+
+uint64_t TextureStreamer::getResidentBytes(std::span<const uint64_t> level_bytes, uint32_t first_level)
+{
+    if (first_level >= level_bytes.size()) return 0;
+    return std::accumulate(level_bytes.begin() + first_level, level_bytes.end(), uint64_t{ 0 });
+}
+
+std::vector<uint32_t> TextureStreamer::planResidency(std::span<const Residency> textures, VkDeviceSize budget_bytes)
+{
+    std::vector<uint32_t> levels(textures.size());
+    VkDeviceSize total = 0;
+    for (size_t i = 0; i < textures.size(); i++) {
+        levels[i] = std::min(textures[i].wanted_level, textures[i].tail_level);
+        total += getResidentBytes(textures[i].level_bytes, levels[i]);
+    }
+    if (total <= budget_bytes) return levels;
+
+    // least recently used first; among equally old ones the biggest frees the most
+    std::vector<size_t> order(textures.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (textures[a].last_used != textures[b].last_used) return textures[a].last_used < textures[b].last_used;
+        return getResidentBytes(textures[a].level_bytes, levels[a]) > getResidentBytes(textures[b].level_bytes, levels[b]);
+    });
+
+    for (size_t i : order) {
+        if (total <= budget_bytes) break;
+        total -= getResidentBytes(textures[i].level_bytes, levels[i])
+                 - getResidentBytes(textures[i].level_bytes, textures[i].tail_level);
+        levels[i] = textures[i].tail_level;
+    }
+    return levels;
+}
+
+void TextureStreamer::add(uint32_t slot, const std::string &textureFile, CookedTexture cooked, uint32_t first_level)
+{
+    // freshly cooked textures live in memory; the file written next to the source does not cost any
+    if (!cooked.mapping) {
+        CookedTexture mapped;
+        if (TextureCooker::open(textureFile, mapped)) cooked = std::move(mapped);
+    }
+
+    StreamedTexture &texture = textures[slot];
+    texture.level_bytes.clear();
+    for (const CookedTexture::Level &level : cooked.levels) texture.level_bytes.push_back(level.size);
+    texture.cooked = std::move(cooked);
+    texture.tail_level = getTailLevel(texture.cooked);
+    texture.resident_level = first_level;
+    texture.wanted_level = first_level;
+
+    resident_bytes += getResidentBytes(texture.level_bytes, first_level);
+}
+
+uint32_t TextureStreamer::getResidentLevel(uint32_t slot) const
+{
+    auto streamed = textures.find(slot);
+    return streamed != textures.end() ? streamed->second.resident_level : 0;
+}
+
+void TextureStreamer::request(uint32_t slot, float pixels)
+{
+    auto streamed = textures.find(slot);
+    if (streamed == textures.end()) return;
+
+    StreamedTexture &texture = streamed->second;
+    const uint32_t level = getWantedLevel(texture.cooked.width, texture.cooked.height, pixels, MIP_BIAS);
+    if (!texture.requested || level < texture.wanted_level) texture.wanted_level = level;
+    texture.requested = true;
+}
+
+void TextureStreamer::update(uint64_t visible_table_version)
+{
+    frame++;
+    finishUploads();
+    releaseRetired(visible_table_version);
+    updateBudget();
+
+    std::vector<uint32_t> slots;
+    std::vector<Residency> residencies;
+    slots.reserve(textures.size());
+    residencies.reserve(textures.size());
+    for (auto &[slot, texture] : textures) {
+        // nobody asked: keep what is resident (or on its way) while the budget allows
+        if (texture.requested) {
+            texture.last_used = frame;
+        } else {
+            texture.wanted_level = texture.pending ? texture.pending_level : texture.resident_level;
+        }
+        texture.requested = false;
+
+        slots.push_back(slot);
+        residencies.push_back({ texture.wanted_level, texture.tail_level, texture.last_used, texture.level_bytes });
+    }
+
+    const std::vector<uint32_t> levels = planResidency(residencies, budget);
+
+    // evictions first, they only make room; then the most recently used get their detail
+    std::vector<size_t> order(slots.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const bool evict_a = levels[a] > textures.at(slots[a]).resident_level;
+        const bool evict_b = levels[b] > textures.at(slots[b]).resident_level;
+        if (evict_a != evict_b) return evict_a;
+        return residencies[a].last_used > residencies[b].last_used;
+    });
+
+    std::vector<StreamedTexture *> started;
+    VkDeviceSize upload_bytes = 0;
+    for (size_t i : order) {
+        StreamedTexture &texture = textures.at(slots[i]);
+        if (texture.pending || levels[i] == texture.resident_level) continue;
+
+        const VkDeviceSize bytes = getResidentBytes(texture.level_bytes, levels[i]);
+        if (upload_bytes > 0 && upload_bytes + bytes > MAX_UPDATE_BYTES) continue;
+
+        texture.pending_texture = Texture();
+        texture.pending_texture.createFromCooked(device, uploadManager, texture.cooked, levels[i]);
+        texture.pending_level = levels[i];
+        texture.pending = true;
+        started.push_back(&texture);
+        upload_bytes += bytes;
+    }
+
+    if (started.empty()) return;
+    const uint64_t ticket = uploadManager->flush();
+    for (StreamedTexture *texture : started) texture->pending_ticket = ticket;
+    streamed_bytes += upload_bytes;
+}
+
+void TextureStreamer::cleanUp()
+{
+    for (auto &[slot, texture] : textures) {
+        if (texture.pending) texture.pending_texture.cleanUp();
+    }
+    textures.clear();
+
+    for (RetiredTexture &texture : retired) texture.texture.cleanUp();
+    retired.clear();
+
+    resident_bytes = 0;
+}
+
+TextureStreamer::~TextureStreamer() {}
+
+void TextureStreamer::finishUploads()
+{
+    for (auto &[slot, texture] : textures) {
+        if (!texture.pending || !uploadManager->isComplete(texture.pending_ticket)) continue;
+
+        // the descriptor sets still point at the old image until they get the next table version
+        Texture old;
+        if (textureCache->replaceTexture(slot, texture.pending_texture, old)) {
+            retired.push_back({ old, textureCache->getTableVersion() + 1 });
+
+            resident_bytes -= getResidentBytes(texture.level_bytes, texture.resident_level);
+            resident_bytes += getResidentBytes(texture.level_bytes, texture.pending_level);
+            texture.resident_level = texture.pending_level;
+        } else {
+            // no descriptor set ever saw the new image and its upload has finished
+            texture.pending_texture.cleanUp();
+        }
+        texture.pending_texture = Texture();
+        texture.pending = false;
+    }
+}
+
+void TextureStreamer::releaseRetired(uint64_t visible_table_version)
+{
+    auto visible = std::partition(retired.begin(), retired.end(), [visible_table_version](const RetiredTexture &texture) {
+        return texture.table_version > visible_table_version;
+    });
+    for (auto texture = visible; texture != retired.end(); ++texture) texture->texture.cleanUp();
+    retired.erase(visible, retired.end());
+}
+
+void TextureStreamer::updateBudget()
+{
+    // whatever the rest of the application uses is off limits; when it grows we evict
+    budget = device->getAllocator().getMemoryBudget().getStreamingBudget(budget_limit, resident_bytes);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.hpp"
+#include "TextureCache.hpp"
+#include "TextureCooker.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanUploadManager.hpp"
+
+// streams the fine mip levels of cooked textures. every texture keeps its mip
+// tail (levels up to TAIL_EXTENT texels) resident; finer levels are read from
+// the mapped ktx2 file into a new image that takes over the texture table slot
+// once its upload finished. the old image lives on until no descriptor set
+// refers to it any more. the wanted level follows the screen size of the
+// submeshes sampling the texture; textures nobody asks for keep what they have
+// until the resident bytes exceed the budget, then the least recently used
+// ones fall back to their tail first
+class TextureStreamer
+{
+  public:
+    // one texture as seen by planResidency()
+    struct Residency
+    {
+        uint32_t wanted_level{ 0 };
+        uint32_t tail_level{ 0 };
+        uint64_t last_used{ 0 };
+        // bytes of every level, level 0 first
+        std::span<const uint64_t> level_bytes;
+    };
+
+    static constexpr uint32_t TAIL_EXTENT = 128;
+    // uvs usually repeat across a submesh, so one level sharper than its bounds suggest
+    static constexpr float MIP_BIAS = 1.0f;
+    // new residencies started per update; keeps a burst of requests from stalling a frame
+    static constexpr VkDeviceSize MAX_UPDATE_BYTES = 32 * 1024 * 1024;
+
+    TextureStreamer();
+
+    // budget_bytes is an upper bound, memory pressure may lower it (see MemoryBudget)
+    void init(VulkanDevice *device,
+      VulkanUploadManager *uploadManager,
+      TextureCache *textureCache,
+      VkDeviceSize budget_bytes);
+
+    // finest level that always stays resident
+    static uint32_t getTailLevel(const CookedTexture &cooked);
+    // level whose larger extent is about pixels texels
+    static uint32_t getWantedLevel(uint32_t width, uint32_t height, float pixels, float bias);
+    // bytes of the levels from first_level on
+    static uint64_t getResidentBytes(std::span<const uint64_t> level_bytes, uint32_t first_level);
+    // first resident level per texture: the wanted one, then in least recently
+    // used order back to the tail until all of them fit into budget_bytes
+    static std::vector<uint32_t> planResidency(std::span<const Residency> textures, VkDeviceSize budget_bytes);
+
+    // takes over the cooked file of the texture in slot, created from first_level on;
+    // textureFile lets a cooked texture that only lives in memory be mapped from disk instead
+    void add(uint32_t slot, const std::string &textureFile, CookedTexture cooked, uint32_t first_level);
+    bool isStreamed(uint32_t slot) const { return textures.count(slot) != 0; };
+    uint32_t getResidentLevel(uint32_t slot) const;
+
+    // collect the requests of a frame (pixels: screen size of a submesh sampling slot), then update() once
+    void request(uint32_t slot, float pixels);
+    // visible_table_version: texture table version every descriptor set has been written up to
+    void update(uint64_t visible_table_version);
+
+    uint32_t getTextureCount() const { return static_cast<uint32_t>(textures.size()); };
+    VkDeviceSize getResidentBytes() const { return resident_bytes; };
+    VkDeviceSize getBudget() const { return budget; };
+    VkDeviceSize getStreamedBytes() const { return streamed_bytes; };
+
+    // the device has to be idle
+    void cleanUp();
+
+    ~TextureStreamer();
+
+  private:
+    struct StreamedTexture
+    {
+        CookedTexture cooked;
+        std::vector<uint64_t> level_bytes;
+        uint32_t tail_level{ 0 };
+        uint32_t resident_level{ 0 };
+        // finest level requested this frame
+        uint32_t wanted_level{ 0 };
+        bool requested{ false };
+        uint64_t last_used{ 0 };
+
+        // a new residency being uploaded
+        bool pending{ false };
+        Texture pending_texture;
+        uint32_t pending_level{ 0 };
+        uint64_t pending_ticket{ 0 };
+    };
+
+    struct RetiredTexture
+    {
+        Texture texture;
+        uint64_t table_version{ 0 };
+    };
+
+    VulkanDevice *device{ VK_NULL_HANDLE };
+    VulkanUploadManager *uploadManager{ nullptr };
+    TextureCache *textureCache{ nullptr };
+
+    std::unordered_map<uint32_t, StreamedTexture> textures;
+    std::vector<RetiredTexture> retired;
+
+    VkDeviceSize budget_limit{ 0 };
+    VkDeviceSize budget{ 0 };
+    VkDeviceSize resident_bytes{ 0 };
+    VkDeviceSize streamed_bytes{ 0 };
+    uint64_t frame{ 0 };
+
+    void finishUploads();
+    void releaseRetired(uint64_t visible_table_version);
+    void updateBudget();
+};
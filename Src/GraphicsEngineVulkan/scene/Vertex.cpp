@@ -1,5 +1,40 @@
 #include "Vertex.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// wyhash style 64x64 -> 128 bit multiply folded back to 64 bit
+inline uint64_t mix(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    uint64_t ha = a >> 32, la = a & 0xFFFFFFFFull;
+    uint64_t hb = b >> 32, lb = b & 0xFFFFFFFFull;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t low = t + (rm1 << 32);
+    carry += low < t;
+    uint64_t high = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return low ^ high;
+#endif
+}
+
+}// namespace
+
 Vertex::Vertex()
 {
     this->pos = glm::vec3(-1.f);
@@ -18,9 +53,24 @@ Vertex::Vertex(glm::vec3 pos, glm::vec3 normal, glm::vec3 color, glm::vec2 textu
 
 namespace vertex {
 
-std::array<VkVertexInputAttributeDescription, 4> getVertexInputAttributeDesc()
+std::vector<VkVertexInputAttributeDescription> getVertexInputAttributeDesc(VertexLayout layout)
 {
-    std::array<VkVertexInputAttributeDescription, 4> attribute_describtions;
+    if (layout != VertexLayout::Full) {
+        // no color; the shader decodes the octahedral normal from location 1
+        const uint32_t normal_offset = layout == VertexLayout::Compact ? offsetof(CompactVertex, normal)
+                                                                       : offsetof(QuantizedVertex, normal);
+        const uint32_t texture_coords_offset = layout == VertexLayout::Compact
+                                                 ? offsetof(CompactVertex, texture_coords)
+                                                 : offsetof(QuantizedVertex, texture_coords);
+
+        std::vector<VkVertexInputAttributeDescription> attribute_describtions(3);
+        attribute_describtions[0] = { 0, 0, getPositionFormat(layout), 0 };
+        attribute_describtions[1] = { 1, 0, VK_FORMAT_R16G16_SNORM, normal_offset };
+        attribute_describtions[2] = { 3, 0, VK_FORMAT_R16G16_SFLOAT, texture_coords_offset };
+        return attribute_describtions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> attribute_describtions(4);
 
     // Position attribute
     attribute_describtions[0].binding = 0;
@@ -55,4 +105,102 @@ std::array<VkVertexInputAttributeDescription, 4> getVertexInputAttributeDesc()
     return attribute_describtions;
 }
 
+uint32_t getVertexStride(VertexLayout layout)
+{
+    switch (layout) {
+    case VertexLayout::Compact:
+        return sizeof(CompactVertex);
+    case VertexLayout::Quantized:
+        return sizeof(QuantizedVertex);
+    default:
+        return sizeof(Vertex);
+    }
+}
+
+VkFormat getPositionFormat(VertexLayout layout)
+{
+    // both formats are mandatory for acceleration structure vertex buffers
+    return layout == VertexLayout::Quantized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+}
+
+std::string getShaderDefines(VertexLayout layout)
+{
+    return " -DVERTEX_LAYOUT=" + std::to_string(static_cast<uint32_t>(layout)) + " ";
+}
+
+uint32_t encodeOctahedral(glm::vec3 normal)
+{
+    float length_l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length_l1 == 0.f) return glm::packSnorm2x16(glm::vec2(0.f));
+
+    glm::vec2 e = glm::vec2(normal.x, normal.y) / length_l1;
+    if (normal.z < 0.f) {
+        // fold the lower hemisphere over the diagonals
+        glm::vec2 folded = 1.f - glm::abs(glm::vec2(e.y, e.x));
+        e = glm::vec2(e.x >= 0.f ? folded.x : -folded.x, e.y >= 0.f ? folded.y : -folded.y);
+    }
+    return glm::packSnorm2x16(e);
+}
+
+glm::vec3 decodeOctahedral(uint32_t encoded)
+{
+    glm::vec2 e = glm::unpackSnorm2x16(encoded);
+    glm::vec3 n(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+    return glm::normalize(n);
+}
+
+CompactVertex compact(const Vertex &vertex)
+{
+    return CompactVertex{ vertex.pos, encodeOctahedral(vertex.normal), glm::packHalf2x16(vertex.texture_coords) };
+}
+
+QuantizedVertex quantize(const Vertex &vertex, glm::vec3 center, float scale)
+{
+    glm::vec3 q = glm::round(glm::clamp((vertex.pos - center) / scale, -1.f, 1.f) * 32767.f);
+
+    QuantizedVertex result;
+    result.pos[0] = static_cast<int16_t>(q.x);
+    result.pos[1] = static_cast<int16_t>(q.y);
+    result.pos[2] = static_cast<int16_t>(q.z);
+    result.pos[3] = 0;
+    result.normal = encodeOctahedral(vertex.normal);
+    result.texture_coords = glm::packHalf2x16(vertex.texture_coords);
+    return result;
+}
+
+Vertex canonical(const Vertex &vertex)
+{
+    uint32_t bits[11];
+    std::memcpy(bits, &vertex, sizeof(bits));
+    for (uint32_t &b : bits) {
+        if ((b & 0x7FFFFFFFu) == 0) b = 0;
+    }
+
+    Vertex result;
+    std::memcpy(&result, bits, sizeof(bits));
+    return result;
+}
+
+uint64_t hash(const Vertex &vertex)
+{
+    constexpr uint64_t SECRET_0 = 0xa0761d6478bd642full;
+    constexpr uint64_t SECRET_1 = 0xe7037ed1a0b428dbull;
+    constexpr uint64_t SECRET_2 = 0x8ebc6af09c88c6e3ull;
+    constexpr uint64_t SECRET_3 = 0x589965cc75374cc3ull;
+
+    Vertex key = canonical(vertex);
+    uint64_t words[5];
+    uint32_t tail;
+    std::memcpy(words, &key, sizeof(words));
+    std::memcpy(&tail, reinterpret_cast<const char *>(&key) + sizeof(words), sizeof(tail));
+
+    uint64_t a = mix(words[0] ^ SECRET_0, words[1] ^ SECRET_1);
+    uint64_t b = mix(words[2] ^ SECRET_2, words[3] ^ SECRET_3);
+    uint64_t c = mix(words[4] ^ SECRET_1, (static_cast<uint64_t>(tail) << 8 | sizeof(Vertex)) ^ SECRET_0);
+    return mix(a ^ c ^ SECRET_2, b ^ SECRET_1);
+}
+
 }// namespace vertex
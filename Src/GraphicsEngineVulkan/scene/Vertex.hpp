@@ -2,14 +2,20 @@
 // CPU side as well for the GPU side :)
 // inspired by the NVDIDIA tutorial:
 // https://nvpro-samples.github.io/vk_raytracing_tutorial_KHR/
+// vertex layouts; the shaders get the selected one as VERTEX_LAYOUT define
+#define VERTEX_LAYOUT_FULL 0
+#define VERTEX_LAYOUT_COMPACT 1
+#define VERTEX_LAYOUT_QUANTIZED 2
+
 #ifdef __cplusplus
 #pragma once
 #define GLM_ENABLE_EXPERIMENTAL
 #include <vulkan/vulkan.h>
 
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
-#include <glm/gtx/hash.hpp>
+#include <string>
 #include <vector>
 
 class Vertex
@@ -25,31 +31,81 @@ class Vertex
 
     bool operator==(const Vertex &other) const
     {
-        return pos == other.pos && normal == other.normal && texture_coords == other.texture_coords;
+        return pos == other.pos && normal == other.normal && color == other.color
+               && texture_coords == other.texture_coords;
     }
 };
 
+// the welder compares vertices as raw bytes
+static_assert(sizeof(Vertex) == 11 * sizeof(float), "Vertex must not contain padding");
+
+enum class VertexLayout : uint32_t {
+    // Vertex as is (44 bytes)
+    Full = VERTEX_LAYOUT_FULL,
+    // CompactVertex (20 bytes)
+    Compact = VERTEX_LAYOUT_COMPACT,
+    // QuantizedVertex (16 bytes)
+    Quantized = VERTEX_LAYOUT_QUANTIZED,
+};
+
+// float position, octahedral normal as 2 x snorm16, uv as 2 x half; no color
+struct CompactVertex
+{
+    glm::vec3 pos;
+    uint32_t normal;
+    uint32_t texture_coords;
+};
+
+// position as 3 x snorm16 inside the mesh bounds (w is padding), the rest as
+// CompactVertex. the object space of such a mesh is the unit cube around its
+// center; Mesh::getDequantization() maps it back
+struct QuantizedVertex
+{
+    int16_t pos[4];
+    uint32_t normal;
+    uint32_t texture_coords;
+};
+
+static_assert(sizeof(CompactVertex) == 20, "CompactVertex must not contain padding");
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must not contain padding");
+
 namespace vertex {
 
-std::array<VkVertexInputAttributeDescription, 4> getVertexInputAttributeDesc();
+std::vector<VkVertexInputAttributeDescription> getVertexInputAttributeDesc(VertexLayout layout = VertexLayout::Full);
+uint32_t getVertexStride(VertexLayout layout);
+// format of the position attribute, as seen by the vertex input and the BLAS build
+VkFormat getPositionFormat(VertexLayout layout);
+// glslc arguments selecting the layout in Vertex.hpp and the shaders
+std::string getShaderDefines(VertexLayout layout);
 
-}
+// unit vector <-> octahedral map packed as 2 x snorm16
+uint32_t encodeOctahedral(glm::vec3 normal);
+glm::vec3 decodeOctahedral(uint32_t encoded);
+
+CompactVertex compact(const Vertex &vertex);
+// center/scale: quantized = (pos - center) / scale, with scale the largest half extent
+QuantizedVertex quantize(const Vertex &vertex, glm::vec3 center, float scale);
+
+// same as the vertex but with -0.f turned into 0.f, so bitwise equality
+// of canonical vertices matches operator==
+Vertex canonical(const Vertex &vertex);
+// 64 bit hash over the canonical bit pattern of all attributes
+uint64_t hash(const Vertex &vertex);
+
+}// namespace vertex
 
 namespace std {
 template<> struct hash<Vertex>
 {
-    size_t operator()(Vertex const &vertex) const
-    {
-        size_t h1 = hash<glm::vec3>()(vertex.pos);
-        size_t h2 = hash<glm::vec3>()(vertex.color);
-        size_t h3 = hash<glm::vec2>()(vertex.texture_coords);
-        size_t h4 = hash<glm::vec3>()(vertex.normal);
-
-        return (((((((h2 << 1) ^ h1) >> 1) ^ h3) << 1) ^ h4));
-    }
+    size_t operator()(Vertex const &vertex) const { return static_cast<size_t>(vertex::hash(vertex)); }
 };
 }// namespace std
 #else
+#ifndef VERTEX_LAYOUT
+#define VERTEX_LAYOUT VERTEX_LAYOUT_FULL
+#endif
+
+// the decoded vertex all shaders work with
 struct Vertex
 {
     vec3 pos;
@@ -58,4 +114,50 @@ struct Vertex
     vec2 texture_coords;
 };
 
+struct CompactVertex
+{
+    vec3 pos;
+    uint normal;
+    uint texture_coords;
+};
+
+struct QuantizedVertex
+{
+    uvec2 pos;
+    uint normal;
+    uint texture_coords;
+};
+
+// how VERTEX_LAYOUT is stored in the vertex buffer
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_COMPACT
+#define VertexStorage CompactVertex
+#elif VERTEX_LAYOUT == VERTEX_LAYOUT_QUANTIZED
+#define VertexStorage QuantizedVertex
+#else
+#define VertexStorage Vertex
+#endif
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+Vertex decodeVertex(Vertex v) { return v; }
+
+Vertex decodeVertex(CompactVertex v)
+{
+    return Vertex(v.pos, decodeOctahedral(unpackSnorm2x16(v.normal)), vec3(-1.0f), unpackHalf2x16(v.texture_coords));
+}
+
+// positions stay in the quantized object space; the instance transform dequantizes
+Vertex decodeVertex(QuantizedVertex v)
+{
+    vec3 pos = vec3(unpackSnorm2x16(v.pos.x), unpackSnorm2x16(v.pos.y).x);
+    return Vertex(pos, decodeOctahedral(unpackSnorm2x16(v.normal)), vec3(-1.0f), unpackHalf2x16(v.texture_coords));
+}
+
 #endif
@@ -0,0 +1,139 @@
+#include "VertexWelder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// below this many corners spawning threads costs more than it saves
+constexpr size_t MIN_CORNERS_PER_THREAD = 64 * 1024;
+
+}// namespace
+
+VertexWelder::Table::Table(size_t expected_count)
+{
+    // keep the load factor at or below 0.5
+    allocate(std::bit_ceil(std::max<size_t>(expected_count * 2, 16)));
+}
+
+void VertexWelder::Table::allocate(size_t capacity)
+{
+    slots.assign(capacity, Slot{ 0, EMPTY });
+    mask = capacity - 1;
+}
+
+void VertexWelder::Table::grow(const std::vector<Vertex> &unique)
+{
+    allocate(slots.size() * 2);
+    for (uint32_t index = 0; index < static_cast<uint32_t>(unique.size()); index++) {
+        uint64_t hash = vertex::hash(unique[index]);
+        size_t position = static_cast<size_t>(hash) & mask;
+        while (slots[position].index != EMPTY) position = (position + 1) & mask;
+        slots[position] = Slot{ static_cast<uint32_t>(hash >> 32), index };
+    }
+}
+
+uint32_t VertexWelder::Table::insert(const Vertex &key, uint64_t hash, std::vector<Vertex> &unique)
+{
+    if ((count + 1) * 2 > slots.size()) grow(unique);
+
+    const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t position = static_cast<size_t>(hash) & mask;
+
+    while (true) {
+        Slot &slot = slots[position];
+        if (slot.index == EMPTY) {
+            slot.tag = tag;
+            slot.index = static_cast<uint32_t>(unique.size());
+            unique.push_back(key);
+            count++;
+            return slot.index;
+        }
+        // the tag filters nearly all mismatches before touching the vertex
+        if (slot.tag == tag && std::memcmp(&unique[slot.index], &key, sizeof(Vertex)) == 0) return slot.index;
+
+        position = (position + 1) & mask;
+    }
+}
+
+void VertexWelder::weldRange(std::span<const Vertex> corners, std::vector<Vertex> &unique, uint32_t *indices)
+{
+    // closed triangle meshes share every vertex ~6 times; starting small keeps
+    // the table cache resident and growing is cheap compared to the probes
+    Table table(corners.size() / 4);
+    unique.reserve(corners.size() / 4);
+
+    for (size_t i = 0; i < corners.size(); i++) {
+        Vertex key = vertex::canonical(corners[i]);
+        indices[i] = table.insert(key, vertex::hash(key), unique);
+    }
+}
+
+WeldStats VertexWelder::weld(std::span<const Vertex> corners,
+  std::vector<Vertex> &vertices,
+  std::vector<uint32_t> &indices,
+  uint32_t thread_count)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    vertices.clear();
+    indices.resize(corners.size());
+
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk_count = std::min<size_t>(thread_count, corners.size() / MIN_CORNERS_PER_THREAD);
+
+    if (chunk_count <= 1) {
+        weldRange(corners, vertices, indices.data());
+    } else {
+        // weld every chunk on its own ...
+        const size_t chunk_size = (corners.size() + chunk_count - 1) / chunk_count;
+        std::vector<std::vector<Vertex>> chunk_unique(chunk_count);
+        std::vector<std::thread> workers;
+        workers.reserve(chunk_count);
+        for (size_t c = 0; c < chunk_count; c++) {
+            size_t begin = c * chunk_size;
+            size_t count = std::min(chunk_size, corners.size() - begin);
+            workers.emplace_back([&, c, begin, count]() {
+                weldRange(corners.subspan(begin, count), chunk_unique[c], indices.data() + begin);
+            });
+        }
+        for (std::thread &worker : workers) worker.join();
+
+        // ... then merge the chunk local vertices in chunk order, which keeps
+        // the first occurrence order of a serial weld
+        size_t total_unique = 0;
+        for (const auto &unique : chunk_unique) total_unique += unique.size();
+
+        Table table(total_unique);
+        vertices.reserve(total_unique);
+        std::vector<std::vector<uint32_t>> remap(chunk_count);
+        for (size_t c = 0; c < chunk_count; c++) {
+            remap[c].resize(chunk_unique[c].size());
+            for (size_t i = 0; i < chunk_unique[c].size(); i++) {
+                const Vertex &key = chunk_unique[c][i];
+                remap[c][i] = table.insert(key, vertex::hash(key), vertices);
+            }
+        }
+
+        workers.clear();
+        for (size_t c = 0; c < chunk_count; c++) {
+            size_t begin = c * chunk_size;
+            size_t count = std::min(chunk_size, corners.size() - begin);
+            workers.emplace_back([&, c, begin, count]() {
+                for (size_t i = begin; i < begin + count; i++) indices[i] = remap[c][indices[i]];
+            });
+        }
+        for (std::thread &worker : workers) worker.join();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    WeldStats stats;
+    stats.input_count = corners.size();
+    stats.unique_count = vertices.size();
+    stats.seconds = std::chrono::duration<double>(end - start).count();
+    return stats;
+}
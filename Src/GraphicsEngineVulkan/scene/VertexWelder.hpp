@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Vertex.hpp"
+
+struct WeldStats
+{
+    size_t input_count{ 0 };
+    size_t unique_count{ 0 };
+    double seconds{ 0.0 };
+
+    // input corners per unique vertex (>= 1)
+    double weldRatio() const { return unique_count ? double(input_count) / double(unique_count) : 0.0; };
+    double verticesPerSecond() const { return seconds > 0.0 ? double(input_count) / seconds : 0.0; };
+};
+
+// de-duplicates a stream of vertices ("corners") into unique vertices plus
+// one index per corner. keys live in a flat open addressing table (linear
+// probing, power of two capacity, grows at 50% load) storing a hash tag +
+// vertex id per slot; candidates are compared as canonical raw bytes.
+// the output order is the order of first occurrence, for any thread count
+class VertexWelder
+{
+  public:
+    // thread_count 0 picks one per hardware thread; small inputs stay serial
+    static WeldStats weld(std::span<const Vertex> corners,
+      std::vector<Vertex> &vertices,
+      std::vector<uint32_t> &indices,
+      uint32_t thread_count = 1);
+
+  private:
+    struct Slot
+    {
+        uint32_t tag;
+        uint32_t index;
+    };
+
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    class Table
+    {
+      public:
+        explicit Table(size_t expected_count);
+
+        // returns the id of an equal vertex in unique or appends key to it
+        uint32_t insert(const Vertex &key, uint64_t hash, std::vector<Vertex> &unique);
+
+      private:
+        std::vector<Slot> slots;
+        size_t mask{ 0 };
+        size_t count{ 0 };
+
+        void allocate(size_t capacity);
+        void grow(const std::vector<Vertex> &unique);
+    };
+
+    static void weldRange(std::span<const Vertex> corners, std::vector<Vertex> &unique, uint32_t *indices);
+};
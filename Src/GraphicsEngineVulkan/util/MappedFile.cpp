@@ -0,0 +1,84 @@
+#include "MappedFile.hpp"
+#include "spdlog/spdlog.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &file_location)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_location.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("Failed to open a file on location: {}!", file_location);
+        return;
+    }
+    file_handle = file;
+    opened = true;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    file_size = static_cast<size_t>(size.QuadPart);
+    if (file_size == 0) return;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        spdlog::error("Failed to map file: {}!", file_location);
+        return;
+    }
+    mapping_handle = mapping;
+    mapped_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int file_descriptor = open(file_location.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        spdlog::error("Failed to open a file on location: {}!", file_location);
+        return;
+    }
+    opened = true;
+
+    struct stat file_stat
+    {
+    };
+    fstat(file_descriptor, &file_stat);
+    file_size = static_cast<size_t>(file_stat.st_size);
+
+    if (file_size > 0) {
+        void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            spdlog::error("Failed to map file: {}!", file_location);
+        } else {
+            mapped_data = mapping;
+            // the whole file gets read right away, so prefetch it
+            madvise(mapped_data, file_size, MADV_WILLNEED);
+        }
+    }
+
+    // the mapping keeps its own reference to the file
+    close(file_descriptor);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (mapped_data) UnmapViewOfFile(mapped_data);
+    if (mapping_handle) CloseHandle(mapping_handle);
+    if (file_handle) CloseHandle(file_handle);
+#else
+    if (mapped_data) munmap(mapped_data, file_size);
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// read only memory mapping of a whole file; the mapping lives
+// as long as the object, so views into data() must not outlive it
+class MappedFile
+{
+  public:
+    explicit MappedFile(const std::string &file_location);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return mapped_data != nullptr || (opened && file_size == 0); };
+    const char *data() const { return static_cast<const char *>(mapped_data); };
+    size_t size() const { return file_size; };
+
+    ~MappedFile();
+
+  private:
+    void *mapped_data{ nullptr };
+    size_t file_size{ 0 };
+    bool opened{ false };
+
+#ifdef _WIN32
+    void *file_handle{ nullptr };
+    void *mapping_handle{ nullptr };
+#endif
+};
@@ -10,7 +10,9 @@
 
 ShaderHelper::ShaderHelper() {}
 
-void ShaderHelper::compileShader(const std::string &shader_src_dir, const std::string &shader_name)
+void ShaderHelper::compileShader(const std::string &shader_src_dir,
+  const std::string &shader_name,
+  const std::string &defines)
 {
     // GLSLC_EXE is set by cmake to the location of the vulkan glslc
     std::stringstream shader_src_path;
@@ -27,7 +29,7 @@ void ShaderHelper::compileShader(const std::string &shader_src_dir, const std::s
     log_stdout_and_stderr << " > " << shader_log_file.str() << " 2> " << shader_log_file.str();
 
     cmdShaderCompile//<< adminPriviliges.str()
-      << GLSLC_EXE << target << std::quoted(shader_src_path.str()) << " -o " << std::quoted(shader_spv_path)
+      << GLSLC_EXE << target << defines << std::quoted(shader_src_path.str()) << " -o " << std::quoted(shader_spv_path)
       << ShaderIncludes::getShaderIncludes();
     //<< log_stdout_and_stderr.str();
 
@@ -11,7 +11,10 @@ class ShaderHelper
   public:
     ShaderHelper();
 
-    void compileShader(const std::string &shader_src_dir, const std::string &shader_name);
+    // defines: extra glslc arguments, e.g. " -DVERTEX_LAYOUT=1 "
+    void compileShader(const std::string &shader_src_dir,
+      const std::string &shader_name,
+      const std::string &defines = "");
     std::string getShaderSpvDir(const std::string &shader_src_dir, const std::string &shader_name);
 
     VkShaderModule createShaderModule(VulkanDevice *device, const std::vector<char> &code);
@@ -2,7 +2,6 @@
 
 #include <stdexcept>
 
-#include "MemoryHelper.hpp"
 #include "Utilities.hpp"
 
 VulkanBuffer::VulkanBuffer() {}
@@ -10,9 +9,12 @@ VulkanBuffer::VulkanBuffer() {}
 void VulkanBuffer::create(VulkanDevice *device,
   VkDeviceSize buffer_size,
   VkBufferUsageFlags buffer_usage_flags,
-  VkMemoryPropertyFlags buffer_propertiy_flags)
+  VkMemoryPropertyFlags buffer_propertiy_flags,
+  MemoryCategory category)
 {
     this->device = device;
+    this->size = buffer_size;
+    this->category = category;
 
     // information to create a buffer (doesn't include assigning memory)
     VkBufferCreateInfo buffer_info{};
@@ -23,35 +25,26 @@ void VulkanBuffer::create(VulkanDevice *device,
     // similar to swap chain images, can share vertex buffers
     buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    VkResult result = vkCreateBuffer(device->getLogicalDevice(), &buffer_info, nullptr, &buffer);
-    ASSERT_VULKAN(result, "Failed to create a buffer!");
-
-    // get buffer memory requirements
-    VkMemoryRequirements memory_requirements{};
-    vkGetBufferMemoryRequirements(device->getLogicalDevice(), buffer, &memory_requirements);
-
-    // allocate memory to buffer
-    VkMemoryAllocateInfo memory_alloc_info{};
-    memory_alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memory_alloc_info.allocationSize = memory_requirements.size;
-
-    uint32_t memory_type_index =
-      find_memory_type_index(device->getPhysicalDevice(), memory_requirements.memoryTypeBits, buffer_propertiy_flags);
-
-    // VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |		/* memory is visible to
-    // CPU side
-    // */ VK_MEMORY_PROPERTY_HOST_COHERENT_BIT	/* data is placed straight into
-    // buffer */);
-    if (memory_type_index < 0) { spdlog::error("Failed to find suitable memory type!"); }
-
-    memory_alloc_info.memoryTypeIndex = memory_type_index;
-
-    // allocate memory to VkDeviceMemory
-    result = vkAllocateMemory(device->getLogicalDevice(), &memory_alloc_info, nullptr, &bufferMemory);
-    ASSERT_VULKAN(result, "Failed to allocate memory for buffer!");
+    // vma sub-allocates from large blocks and picks a dedicated
+    // allocation by itself whenever the driver prefers one
+    VmaAllocationCreateInfo allocation_create_info = Allocator::allocationCreateInfo(buffer_propertiy_flags);
+
+    VmaAllocationInfo allocation_info{};
+    VkResult result = vmaCreateBuffer(device->getAllocator().getVmaAllocator(),
+      &buffer_info,
+      &allocation_create_info,
+      &buffer,
+      &allocation,
+      &allocation_info);
+    if (result != VK_SUCCESS) {
+        spdlog::error("Failed to create a {} buffer of {} KiB!", getMemoryCategoryName(category), buffer_size / 1024);
+        device->getAllocator().logStats();
+        return;
+    }
 
-    // allocate memory to given buffer
-    vkBindBufferMemory(device->getLogicalDevice(), buffer, bufferMemory, 0);
+    mappedData = allocation_info.pMappedData;
+    allocated_bytes = allocation_info.size;
+    device->getAllocator().getMemoryBudget().track(category, allocated_bytes);
 
     created = true;
 }
@@ -59,8 +52,13 @@ void VulkanBuffer::create(VulkanDevice *device,
 void VulkanBuffer::cleanUp()
 {
     if (created) {
-        vkDestroyBuffer(device->getLogicalDevice(), buffer, nullptr);
-        vkFreeMemory(device->getLogicalDevice(), bufferMemory, nullptr);
+        vmaDestroyBuffer(device->getAllocator().getVmaAllocator(), buffer, allocation);
+        device->getAllocator().getMemoryBudget().untrack(category, allocated_bytes);
+        allocated_bytes = 0;
+        buffer = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
+        mappedData = nullptr;
+        created = false;
     }
 }
 
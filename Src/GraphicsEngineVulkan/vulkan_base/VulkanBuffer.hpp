@@ -1,4 +1,5 @@
 #pragma once
+#include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
 #include "VulkanDevice.hpp"
@@ -11,12 +12,17 @@ class VulkanBuffer
     void create(VulkanDevice *vulkanDevice,
       VkDeviceSize buffer_size,
       VkBufferUsageFlags buffer_usage_flags,
-      VkMemoryPropertyFlags buffer_propertiy_flags);
+      VkMemoryPropertyFlags buffer_propertiy_flags,
+      MemoryCategory category);
 
     void cleanUp();
 
     VkBuffer &getBuffer() { return buffer; };
-    VkDeviceMemory &getBufferMemory() { return bufferMemory; };
+    VmaAllocation getAllocation() const { return allocation; };
+    VkDeviceSize getSize() const { return size; };
+    MemoryCategory getCategory() const { return category; };
+    // only valid for host visible buffers; they stay mapped until cleanUp()
+    void *getMappedData() const { return mappedData; };
 
     ~VulkanBuffer();
 
@@ -24,7 +30,12 @@ class VulkanBuffer
     VulkanDevice *device{ VK_NULL_HANDLE };
 
     VkBuffer buffer{ VK_NULL_HANDLE };
-    VkDeviceMemory bufferMemory{ VK_NULL_HANDLE };
+    VmaAllocation allocation{ VK_NULL_HANDLE };
+    VkDeviceSize size{ 0 };
+    void *mappedData{ nullptr };
+    MemoryCategory category{ MemoryCategory::Other };
+    // what vma handed out, alignment included
+    VkDeviceSize allocated_bytes{ 0 };
 
     bool created{ false };
 };
@@ -35,6 +35,7 @@ class VulkanBufferManager
       VulkanBuffer &vulkanBuffer,
       VkBufferUsageFlags dstBufferUsageFlags,
       VkMemoryPropertyFlags dstBufferMemoryPropertyFlags,
+      MemoryCategory category,
       std::vector<T> &data);
 
     ~VulkanBufferManager();
@@ -49,6 +50,7 @@ inline void VulkanBufferManager::createBufferAndUploadVectorOnDevice(VulkanDevic
   VulkanBuffer &vulkanBuffer,
   VkBufferUsageFlags dstBufferUsageFlags,
   VkMemoryPropertyFlags dstBufferMemoryPropertyFlags,
+  MemoryCategory category,
   std::vector<T> &bufferData)
 {
     VkDeviceSize bufferSize = sizeof(T) * bufferData.size();
@@ -60,22 +62,16 @@ inline void VulkanBufferManager::createBufferAndUploadVectorOnDevice(VulkanDevic
     stagingBuffer.create(device,
       bufferSize,
       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    // Map memory to vertex buffer
-    // 1.) create pointer to a point in normal memory
-    void *data;
-    // 2.) map the vertex buffer memory to that point
-    vkMapMemory(device->getLogicalDevice(), stagingBuffer.getBufferMemory(), 0, bufferSize, 0, &data);
-    // 3.) copy memory from vertices vector to the point
-    std::memcpy(data, bufferData.data(), static_cast<size_t>(bufferSize));
-    // 4.) unmap the vertex buffer memory
-    vkUnmapMemory(device->getLogicalDevice(), stagingBuffer.getBufferMemory());
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      MemoryCategory::Staging);
+
+    // staging memory is persistently mapped, so a plain copy is enough
+    std::memcpy(stagingBuffer.getMappedData(), bufferData.data(), static_cast<size_t>(bufferSize));
 
     // create buffer with TRANSFER_DST_BIT to mark as recipient of transfer data
     // (also VERTEX_BUFFER) buffer memory is to be DEVICE_LOCAL_BIT meaning memory
     // is on the GPU and only accessible by it and not CPU (host)
-    vulkanBuffer.create(device, bufferSize, dstBufferUsageFlags, dstBufferMemoryPropertyFlags);
+    vulkanBuffer.create(device, bufferSize, dstBufferUsageFlags, dstBufferMemoryPropertyFlags, category);
 
     // copy staging buffer to vertex buffer on GPU
     copyBuffer(
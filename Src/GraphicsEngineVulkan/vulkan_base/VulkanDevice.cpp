@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include <Utilities.hpp>
+#include <algorithm>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -14,54 +15,23 @@ VulkanDevice::VulkanDevice(VulkanInstance *instance, VkSurfaceKHR *surface)
     this->surface = surface;
     get_physical_device();
     create_logical_device();
+
+    allocator =
+      Allocator(logical_device, physical_device, instance->getVulkanInstance(), deviceSupportsMemoryBudget);
 }
 
 SwapChainDetails VulkanDevice::getSwapchainDetails() { return getSwapchainDetails(physical_device); }
 
-void VulkanDevice::cleanUp() { vkDestroyDevice(logical_device, nullptr); }
-
-VulkanDevice::~VulkanDevice() {}
-
-QueueFamilyIndices VulkanDevice::getQueueFamilies()
+void VulkanDevice::cleanUp()
 {
-    QueueFamilyIndices indices{};
-
-    uint32_t queue_family_count = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, nullptr);
-
-    std::vector<VkQueueFamilyProperties> queue_family_list(queue_family_count);
-    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_family_list.data());
-
-    // Go through each queue family and check if it has at least 1 of required
-    // types we need to keep track th eindex by our own
-    int index = 0;
-    for (const auto &queue_family : queue_family_list) {
-        // first check if queue family has at least 1 queue in that family
-        // Queue can be multiple types defined through bitfield. Need to bitwise AND
-        // with VK_QUE_*_BIT to check if has required  type
-        if (queue_family.queueCount > 0 && queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            indices.graphics_family = index;// if queue family valid, than get index
-        }
-
-        if (queue_family.queueCount > 0 && queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) {
-            indices.compute_family = index;
-        }
-
-        // check if queue family suppports presentation
-        VkBool32 presentation_support = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, index, *surface, &presentation_support);
-        // check if queue is presentation type (can be both graphics and
-        // presentation)
-        if (queue_family.queueCount > 0 && presentation_support) { indices.presentation_family = index; }
-
-        // check if queue family indices are in a valid state
-        if (indices.is_valid()) { break; }
+    deletionQueue.flush();
+    allocator.cleanUp();
+    vkDestroyDevice(logical_device, nullptr);
+}
 
-        index++;
-    }
+VulkanDevice::~VulkanDevice() {}
 
-    return indices;
-}
+QueueFamilyIndices VulkanDevice::getQueueFamilies() { return getQueueFamilies(physical_device); }
 
 void VulkanDevice::get_physical_device()
 {
@@ -95,17 +65,17 @@ void VulkanDevice::create_logical_device()
     // vector for queue creation information and set for family indices
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
     std::set<int> queue_family_indices = {
-        indices.graphics_family, indices.presentation_family, indices.compute_family
+        indices.graphics_family, indices.presentation_family, indices.compute_family, indices.transfer_family
     };
 
     // Queue the logical device needs to create and info to do so (only 1 for now,
     // will add more later!)
+    float priority = 1.0f;
     for (int queue_family_index : queue_family_indices) {
         VkDeviceQueueCreateInfo queue_create_info{};
         queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         queue_create_info.queueFamilyIndex = queue_family_index;// the index of the family to create a queue from
         queue_create_info.queueCount = 1;// number of queues to create
-        float priority = 1.0f;
         queue_create_info.pQueuePriorities = &priority;// Vulkan needs to know how to handle multiple queues, so
                                                        // decide priority (1 = highest)
 
@@ -113,10 +83,33 @@ void VulkanDevice::create_logical_device()
     }
 
     // -- ALL EXTENSION WE NEED
+    VkPhysicalDevicePresentIdFeaturesKHR supported_present_id_features{};
+    supported_present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    VkPhysicalDevicePresentWaitFeaturesKHR supported_present_wait_features{};
+    supported_present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    supported_present_wait_features.pNext = &supported_present_id_features;
+    VkPhysicalDeviceDescriptorIndexingFeatures supported_indexing_features{};
+    supported_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    supported_indexing_features.pNext = &supported_present_wait_features;
+    VkPhysicalDeviceFeatures2 supported_features2{};
+    supported_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features2.pNext = &supported_indexing_features;
+    vkGetPhysicalDeviceFeatures2(physical_device, &supported_features2);
+
+    // the bindless texture table is written while frames using other slots are in flight
+    const bool supports_bindless_textures = supported_indexing_features.descriptorBindingPartiallyBound == VK_TRUE
+                                            && supported_indexing_features.descriptorBindingSampledImageUpdateAfterBind
+                                                 == VK_TRUE
+                                            && supported_indexing_features.descriptorBindingUpdateUnusedWhilePending
+                                                 == VK_TRUE;
+
     VkPhysicalDeviceDescriptorIndexingFeatures indexing_features{};
     indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
     indexing_features.runtimeDescriptorArray = VK_TRUE;
     indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    indexing_features.descriptorBindingPartiallyBound = supports_bindless_textures;
+    indexing_features.descriptorBindingSampledImageUpdateAfterBind = supports_bindless_textures;
+    indexing_features.descriptorBindingUpdateUnusedWhilePending = supports_bindless_textures;
     indexing_features.pNext = nullptr;
 
     // -- NEEDED FOR QUERING THE DEVICE ADDRESS WHEN CREATING ACCELERATION
@@ -156,7 +149,7 @@ void VulkanDevice::create_logical_device()
     features13.shaderTerminateInvocation = VK_FALSE;
     features13.subgroupSizeControl = VK_FALSE;
     features13.computeFullSubgroups = VK_FALSE;
-    features13.synchronization2 = VK_FALSE;
+    features13.synchronization2 = VK_TRUE;
     features13.textureCompressionASTC_HDR = VK_FALSE;
     features13.shaderZeroInitializeWorkgroupMemory = VK_FALSE;
     features13.dynamicRendering = VK_FALSE;
@@ -176,6 +169,10 @@ void VulkanDevice::create_logical_device()
     features2.features.geometryShader = VK_TRUE;
     features2.features.logicOp = VK_TRUE;
 
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+    features2.features.textureCompressionBC = supported_features.textureCompressionBC;
+
     // -- PREPARE FOR HAVING MORE EXTENSION BECAUSE WE NEED RAYTRACING
     // CAPABILITIES
     std::vector<const char *> extensions(device_extensions);
@@ -209,6 +206,27 @@ void VulkanDevice::create_logical_device()
         extensions.begin(), device_extensions_for_raytracing.begin(), device_extensions_for_raytracing.end());
     }
 
+    // optional: lets texture streaming stay within what the driver actually grants us
+    deviceSupportsMemoryBudget = isExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (deviceSupportsMemoryBudget) extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    // optional: lets the renderer wait for presents by id to pace input and measure latency
+    deviceSupportsPresentWait = isExtensionSupported(VK_KHR_PRESENT_ID_EXTENSION_NAME)
+                                && isExtensionSupported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)
+                                && supported_present_id_features.presentId == VK_TRUE
+                                && supported_present_wait_features.presentWait == VK_TRUE;
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+    present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    present_id_features.presentId = VK_TRUE;
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+    present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    present_wait_features.pNext = &present_id_features;
+    present_wait_features.presentWait = VK_TRUE;
+    if (deviceSupportsPresentWait) {
+        extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+
     // information to create logical device (sometimes called "device")
     VkDeviceCreateInfo device_create_info{};
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -226,6 +244,18 @@ void VulkanDevice::create_logical_device()
         device_create_info.pNext = &features2;
     }
 
+    // in front of whatever feature chain there is
+    if (deviceSupportsPresentWait) {
+        present_id_features.pNext = const_cast<void *>(device_create_info.pNext);
+        device_create_info.pNext = &present_wait_features;
+    }
+
+    // the features above are only enabled through features2
+    deviceSupportsTextureCompressionBC =
+      deviceSupportsHardwareAcceleratedRRT && supported_features.textureCompressionBC == VK_TRUE;
+    deviceSupportsBindlessTextures = deviceSupportsHardwareAcceleratedRRT && supports_bindless_textures;
+    query_texture_table_capacity();
+
     // create logical device for the given physical device
     VkResult result = vkCreateDevice(physical_device, &device_create_info, nullptr, &logical_device);
     ASSERT_VULKAN(result, "Failed to create a logical device!");
@@ -237,6 +267,44 @@ void VulkanDevice::create_logical_device()
     vkGetDeviceQueue(logical_device, indices.graphics_family, 0, &graphics_queue);
     vkGetDeviceQueue(logical_device, indices.presentation_family, 0, &presentation_queue);
     vkGetDeviceQueue(logical_device, indices.compute_family, 0, &compute_queue);
+    vkGetDeviceQueue(logical_device, indices.transfer_family, 0, &transfer_queue);
+
+    // queue handles of one family may differ, the ownership barriers only care about the family
+    dedicatedTransferFamily = indices.transfer_family != indices.graphics_family;
+    if (hasDedicatedTransferQueue()) {
+        spdlog::info("Using dedicated transfer queue family {}", indices.transfer_family);
+    }
+}
+
+void VulkanDevice::query_texture_table_capacity()
+{
+    VkPhysicalDeviceDescriptorIndexingProperties indexing_properties{};
+    indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &indexing_properties;
+    vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+    // the table holds one image and one sampler per slot
+    uint32_t capacity = static_cast<uint32_t>(MAX_BINDLESS_TEXTURE_COUNT);
+    if (deviceSupportsBindlessTextures) {
+        capacity = std::min({ capacity,
+          indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+          indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+          indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+          indexing_properties.maxDescriptorSetUpdateAfterBindSamplers });
+    } else {
+        const VkPhysicalDeviceLimits &limits = device_properties.limits;
+        capacity = std::min({ capacity,
+          limits.maxPerStageDescriptorSampledImages,
+          limits.maxPerStageDescriptorSamplers,
+          limits.maxDescriptorSetSampledImages,
+          limits.maxDescriptorSetSamplers });
+    }
+    textureTableCapacity = capacity;
+
+    spdlog::info("Texture table holds {} textures ({})", textureTableCapacity,
+      deviceSupportsBindlessTextures ? "bindless" : "bound up front");
 }
 
 QueueFamilyIndices VulkanDevice::getQueueFamilies(VkPhysicalDevice physical_device)
@@ -277,6 +345,20 @@ QueueFamilyIndices VulkanDevice::getQueueFamilies(VkPhysicalDevice physical_devi
         index++;
     }
 
+    // a transfer only family (no graphics/compute bit) is backed by the
+    // dedicated copy engines on most desktop GPUs
+    for (uint32_t i = 0; i < queue_family_count; i++) {
+        const VkQueueFamilyProperties &queue_family = queue_family_list[i];
+        if (queue_family.queueCount > 0 && (queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT)
+            && !(queue_family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            indices.transfer_family = static_cast<int>(i);
+            break;
+        }
+    }
+
+    // e.g. lavapipe only exposes one family; graphics queues can always transfer
+    if (indices.transfer_family < 0) indices.transfer_family = indices.graphics_family;
+
     return indices;
 }
 
@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "Allocator.hpp"
+#include "DeletionQueue.hpp"
 #include "QueueFamilyIndices.hpp"
 #include "SwapChainDetails.hpp"
 #include "VulkanInstance.hpp"
@@ -19,8 +21,24 @@ class VulkanDevice
     VkQueue getGraphicsQueue() const { return graphics_queue; };
     VkQueue getComputeQueue() const { return compute_queue; };
     VkQueue getPresentationQueue() const { return presentation_queue; };
+    VkQueue getTransferQueue() const { return transfer_queue; };
+    // the transfer queue is of another family than the graphics queue; uploads then need ownership transfers
+    bool hasDedicatedTransferQueue() const { return dedicatedTransferFamily; };
     SwapChainDetails getSwapchainDetails();
     bool supportsHardwareAcceleratedRRT() { return deviceSupportsHardwareAcceleratedRRT; };
+    // BC1-7 images can be sampled (cooked textures)
+    bool supportsTextureCompressionBC() const { return deviceSupportsTextureCompressionBC; };
+    // the texture table can be partially bound and written after binding
+    bool supportsBindlessTextures() const { return deviceSupportsBindlessTextures; };
+    // VK_EXT_memory_budget is enabled; the allocator reports real heap budgets
+    bool supportsMemoryBudget() const { return deviceSupportsMemoryBudget; };
+    // VK_KHR_present_id and VK_KHR_present_wait are enabled; presents can be waited for by id
+    bool supportsPresentWait() const { return deviceSupportsPresentWait; };
+    // number of textures the shared texture table can hold
+    uint32_t getTextureTableCapacity() const { return textureTableCapacity; };
+    Allocator &getAllocator() { return allocator; };
+    // resources still referenced by frames in flight are destroyed through this
+    DeletionQueue &getDeletionQueue() { return deletionQueue; };
 
     void cleanUp();
 
@@ -32,6 +50,10 @@ class VulkanDevice
 
     VkDevice logical_device;
 
+    // all buffer and image memory is sub-allocated through vma
+    Allocator allocator;
+    DeletionQueue deletionQueue;
+
     VulkanInstance *instance;
     VkSurfaceKHR *surface;
 
@@ -39,10 +61,18 @@ class VulkanDevice
     VkQueue graphics_queue;
     VkQueue presentation_queue;
     VkQueue compute_queue;
+    VkQueue transfer_queue;
+    bool dedicatedTransferFamily = false;
     bool deviceSupportsHardwareAcceleratedRRT = true;
+    bool deviceSupportsTextureCompressionBC = false;
+    bool deviceSupportsBindlessTextures = false;
+    bool deviceSupportsMemoryBudget = false;
+    bool deviceSupportsPresentWait = false;
+    uint32_t textureTableCapacity = 0;
 
     void get_physical_device();
     void create_logical_device();
+    void query_texture_table_capacity();
 
     QueueFamilyIndices getQueueFamilies(VkPhysicalDevice physical_device);
     SwapChainDetails getSwapchainDetails(VkPhysicalDevice device);
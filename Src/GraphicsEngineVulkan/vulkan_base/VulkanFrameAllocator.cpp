@@ -0,0 +1,39 @@
+#include "VulkanFrameAllocator.hpp"
+
+#include "spdlog/spdlog.h"
+
+VulkanFrameAllocator::VulkanFrameAllocator() {}
+
+void VulkanFrameAllocator::init(VulkanDevice *device, VkDeviceSize frame_size, uint32_t frame_count)
+{
+    // dynamic offsets have to be multiples of this
+    const VkDeviceSize alignment = device->getPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+    linearAllocator.init(frame_size, frame_count, alignment);
+
+    buffer.create(device,
+      linearAllocator.getCapacity(),
+      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      MemoryCategory::Uniform);
+}
+
+void VulkanFrameAllocator::beginFrame(uint32_t frame) { linearAllocator.beginFrame(frame); }
+
+void *VulkanFrameAllocator::allocate(VkDeviceSize size, uint32_t &dynamic_offset)
+{
+    VkDeviceSize offset = 0;
+    if (buffer.getMappedData() == nullptr || !linearAllocator.allocate(size, offset)) {
+        spdlog::error("Failed to allocate {} bytes of per frame data ({} of {} bytes used)!",
+          size,
+          linearAllocator.getFrameUsed(),
+          linearAllocator.getFrameSize());
+        return nullptr;
+    }
+
+    dynamic_offset = static_cast<uint32_t>(offset);
+    return static_cast<char *>(buffer.getMappedData()) + offset;
+}
+
+void VulkanFrameAllocator::cleanUp() { buffer.cleanUp(); }
+
+VulkanFrameAllocator::~VulkanFrameAllocator() {}
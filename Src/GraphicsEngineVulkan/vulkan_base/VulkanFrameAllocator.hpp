@@ -0,0 +1,48 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "LinearAllocator.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+
+// one persistently mapped, host coherent buffer for everything the shaders
+// read once per frame (uniforms, per draw constants); every frame in flight
+// writes its own region with a plain memcpy and binds the data through
+// dynamic uniform buffer offsets, so no transfer or barrier is recorded
+class VulkanFrameAllocator
+{
+  public:
+    VulkanFrameAllocator();
+
+    void init(VulkanDevice *device, VkDeviceSize frame_size, uint32_t frame_count);
+
+    // only once the fence of this frame in flight has signalled
+    void beginFrame(uint32_t frame);
+
+    // returns the mapped memory to write size bytes into and the dynamic offset
+    // to bind it with; nullptr if the frame's region is full
+    void *allocate(VkDeviceSize size, uint32_t &dynamic_offset);
+
+    template<typename T>
+    uint32_t push(const T &data)
+    {
+        uint32_t dynamic_offset = 0;
+        void *memory = allocate(sizeof(T), dynamic_offset);
+        if (memory) memcpy(memory, &data, sizeof(T));
+        return dynamic_offset;
+    }
+
+    VkBuffer getBuffer() { return buffer.getBuffer(); };
+    const LinearAllocator &getLinearAllocator() const { return linearAllocator; };
+
+    void cleanUp();
+
+    ~VulkanFrameAllocator();
+
+  private:
+    VulkanBuffer buffer;
+    LinearAllocator linearAllocator;
+};
@@ -1,6 +1,5 @@
 #include "VulkanImage.hpp"
 
-#include "MemoryHelper.hpp"
 #include "Utilities.hpp"
 
 VulkanImage::VulkanImage() {}
@@ -12,9 +11,11 @@ void VulkanImage::create(VulkanDevice *device,
   VkFormat format,
   VkImageTiling tiling,
   VkImageUsageFlags use_flags,
-  VkMemoryPropertyFlags prop_flags)
+  VkMemoryPropertyFlags prop_flags,
+  MemoryCategory category)
 {
     this->device = device;
+    this->category = category;
     // CREATE image
     // image creation info
     VkImageCreateInfo image_create_info{};
@@ -32,26 +33,30 @@ void VulkanImage::create(VulkanDevice *device,
     image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;// number of samples for multisampling
     image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;// whether image can be shared between queues
 
-    VkResult result = vkCreateImage(device->getLogicalDevice(), &image_create_info, nullptr, &image);
-    ASSERT_VULKAN(result, "Failed to create an image!")
-
-    // CREATE memory for image
-    // get memory requirements for a type of image
-    VkMemoryRequirements memory_requirements;
-    vkGetImageMemoryRequirements(device->getLogicalDevice(), image, &memory_requirements);
-
-    // allocate memory using image requirements and user defined properties
-    VkMemoryAllocateInfo memory_alloc_info{};
-    memory_alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memory_alloc_info.allocationSize = memory_requirements.size;
-    memory_alloc_info.memoryTypeIndex =
-      find_memory_type_index(device->getPhysicalDevice(), memory_requirements.memoryTypeBits, prop_flags);
-
-    result = vkAllocateMemory(device->getLogicalDevice(), &memory_alloc_info, nullptr, &imageMemory);
-    ASSERT_VULKAN(result, "Failed to allocate memory!")
+    // render targets and storage images get their own VkDeviceMemory;
+    // they are large, long lived and recreated together with the swapchain.
+    // textures only need STORAGE for the compute mip generation and stay sub allocated
+    VmaAllocationCreateInfo allocation_create_info = Allocator::allocationCreateInfo(prop_flags);
+    const bool attachment =
+      use_flags & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    const bool storage_target = (use_flags & VK_IMAGE_USAGE_STORAGE_BIT) && category != MemoryCategory::Texture;
+    if (attachment || storage_target) { allocation_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT; }
+
+    VmaAllocationInfo allocation_info{};
+    VkResult result = vmaCreateImage(device->getAllocator().getVmaAllocator(),
+      &image_create_info,
+      &allocation_create_info,
+      &image,
+      &allocation,
+      &allocation_info);
+    if (result != VK_SUCCESS) {
+        spdlog::error("Failed to create a {}x{} {} image!", width, height, getMemoryCategoryName(category));
+        device->getAllocator().logStats();
+        return;
+    }
 
-    // connect memory to image
-    vkBindImageMemory(device->getLogicalDevice(), image, imageMemory, 0);
+    allocated_bytes = allocation_info.size;
+    device->getAllocator().getMemoryBudget().track(category, allocated_bytes);
 }
 
 void VulkanImage::transitionImageLayout(VkDevice device,
@@ -150,8 +155,14 @@ void VulkanImage::setImage(VkImage image) { this->image = image; }
 
 void VulkanImage::cleanUp()
 {
-    vkDestroyImage(device->getLogicalDevice(), image, nullptr);
-    vkFreeMemory(device->getLogicalDevice(), imageMemory, nullptr);
+    // images handed in via setImage() (e.g. swapchain images) are not owned by us
+    if (allocation != VK_NULL_HANDLE) {
+        vmaDestroyImage(device->getAllocator().getVmaAllocator(), image, allocation);
+        device->getAllocator().getMemoryBudget().untrack(category, allocated_bytes);
+        allocated_bytes = 0;
+        allocation = VK_NULL_HANDLE;
+        image = VK_NULL_HANDLE;
+    }
 }
 
 VulkanImage::~VulkanImage() {}
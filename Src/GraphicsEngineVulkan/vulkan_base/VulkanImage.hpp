@@ -1,4 +1,5 @@
 #pragma once
+#include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
 #include "CommandBufferManager.hpp"
@@ -16,7 +17,8 @@ class VulkanImage
       VkFormat format,
       VkImageTiling tiling,
       VkImageUsageFlags use_flags,
-      VkMemoryPropertyFlags prop_flags);
+      VkMemoryPropertyFlags prop_flags,
+      MemoryCategory category);
 
     void transitionImageLayout(VkDevice device,
       VkQueue queue,
@@ -43,8 +45,10 @@ class VulkanImage
     VulkanDevice *device{ VK_NULL_HANDLE };
     CommandBufferManager commandBufferManager;
 
-    VkImage image;
-    VkDeviceMemory imageMemory;
+    VkImage image{ VK_NULL_HANDLE };
+    VmaAllocation allocation{ VK_NULL_HANDLE };
+    MemoryCategory category{ MemoryCategory::Other };
+    VkDeviceSize allocated_bytes{ 0 };
 
     VkAccessFlags accessFlagsForImageLayout(VkImageLayout layout);
     VkPipelineStageFlags pipelineStageForLayout(VkImageLayout oldImageLayout);
@@ -0,0 +1,320 @@
+#include "VulkanMipGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <sstream>
+
+#include "File.hpp"
+#include "ShaderHelper.hpp"
+#include "Utilities.hpp"
+#include "VulkanRendererConfig.hpp"
+
+VulkanMipGenerator::VulkanMipGenerator() {}
+
+void VulkanMipGenerator::init(VulkanDevice *device)
+{
+    this->device = device;
+
+    counter_buffer.create(device,
+      COUNTER_SLOTS * sizeof(uint32_t),
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      MemoryCategory::Other);
+
+    createDescriptorSetLayout();
+    createPipeline();
+}
+
+bool VulkanMipGenerator::supports(uint32_t width, uint32_t height)
+{
+    // the last workgroup reduces level 6 as a single 64x64 tile
+    return std::max(width, height) <= (1u << (MIP_GENERATION_MAX_LEVELS - 1));
+}
+
+uint32_t VulkanMipGenerator::getWorkgroupCount(uint32_t width, uint32_t height)
+{
+    // every workgroup reduces a 64x64 tile of level 0
+    return ((width + 63) / 64) * ((height + 63) / 64);
+}
+
+VulkanMipGenerator::Dispatch VulkanMipGenerator::record(VkCommandBuffer command_buffer,
+  VkImage image,
+  VkFormat format,
+  uint32_t width,
+  uint32_t height,
+  uint32_t mip_levels)
+{
+    VkBufferMemoryBarrier counter_barrier{};
+    counter_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    counter_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    counter_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counter_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counter_barrier.buffer = counter_buffer.getBuffer();
+    counter_barrier.offset = 0;
+    counter_barrier.size = VK_WHOLE_SIZE;
+
+    if (!counters_cleared) {
+        vkCmdFillBuffer(command_buffer, counter_buffer.getBuffer(), 0, VK_WHOLE_SIZE, 0);
+        counter_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          0,
+          0,
+          nullptr,
+          1,
+          &counter_barrier,
+          0,
+          nullptr);
+        counters_cleared = true;
+    } else if (next_counter_slot == COUNTER_SLOTS) {
+        // the slots are reused: wait until their last workgroups have reset them
+        counter_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          0,
+          0,
+          nullptr,
+          1,
+          &counter_barrier,
+          0,
+          nullptr);
+    }
+    if (next_counter_slot == COUNTER_SLOTS) next_counter_slot = 0;
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+
+    Dispatch dispatch;
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pool_sizes[0].descriptorCount = MIP_GENERATION_MAX_LEVELS;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo pool_create_info{};
+    pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_create_info.maxSets = 1;
+    pool_create_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_create_info.pPoolSizes = pool_sizes.data();
+
+    VkResult result =
+      vkCreateDescriptorPool(device->getLogicalDevice(), &pool_create_info, nullptr, &dispatch.descriptor_pool);
+    ASSERT_VULKAN(result, "Failed to create mip generation descriptor pool!")
+
+    VkDescriptorSetAllocateInfo set_alloc_info{};
+    set_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    set_alloc_info.descriptorPool = dispatch.descriptor_pool;
+    set_alloc_info.descriptorSetCount = 1;
+    set_alloc_info.pSetLayouts = &descriptor_set_layout;
+
+    VkDescriptorSet descriptor_set;
+    result = vkAllocateDescriptorSets(device->getLogicalDevice(), &set_alloc_info, &descriptor_set);
+    ASSERT_VULKAN(result, "Failed to allocate mip generation descriptor set!")
+
+    // one view per level; the shader never touches the entries past mip_levels
+    dispatch.level_views.resize(mip_levels);
+    for (uint32_t level = 0; level < mip_levels; level++) {
+        VkImageViewCreateInfo view_create_info{};
+        view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_create_info.image = image;
+        view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_create_info.format = format;
+        view_create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_create_info.subresourceRange.baseMipLevel = level;
+        view_create_info.subresourceRange.levelCount = 1;
+        view_create_info.subresourceRange.baseArrayLayer = 0;
+        view_create_info.subresourceRange.layerCount = 1;
+
+        result =
+          vkCreateImageView(device->getLogicalDevice(), &view_create_info, nullptr, &dispatch.level_views[level]);
+        ASSERT_VULKAN(result, "Failed to create a mip level image view!")
+    }
+
+    std::array<VkDescriptorImageInfo, MIP_GENERATION_MAX_LEVELS> image_infos{};
+    for (uint32_t level = 0; level < MIP_GENERATION_MAX_LEVELS; level++) {
+        image_infos[level].imageView = dispatch.level_views[std::min(level, mip_levels - 1)];
+        image_infos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    VkDescriptorBufferInfo counter_info{};
+    counter_info.buffer = counter_buffer.getBuffer();
+    counter_info.offset = 0;
+    counter_info.range = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = descriptor_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].descriptorCount = static_cast<uint32_t>(image_infos.size());
+    writes[0].pImageInfo = image_infos.data();
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = descriptor_set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].descriptorCount = 1;
+    writes[1].pBufferInfo = &counter_info;
+
+    vkUpdateDescriptorSets(
+      device->getLogicalDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    PushConstantMipGeneration push_constant{};
+    push_constant.width = width;
+    push_constant.height = height;
+    push_constant.mip_levels = mip_levels;
+    push_constant.workgroup_count = getWorkgroupCount(width, height);
+    push_constant.counter_slot = next_counter_slot++;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(
+      command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+    vkCmdPushConstants(command_buffer,
+      pipeline_layout,
+      VK_SHADER_STAGE_COMPUTE_BIT,
+      0,
+      sizeof(PushConstantMipGeneration),
+      &push_constant);
+    vkCmdDispatch(command_buffer, (width + 63) / 64, (height + 63) / 64, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // textures are sampled by the rasterizer as well as by the ray tracing and path tracing stages
+    vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+
+    return dispatch;
+}
+
+void VulkanMipGenerator::release(Dispatch &dispatch)
+{
+    for (VkImageView view : dispatch.level_views) vkDestroyImageView(device->getLogicalDevice(), view, nullptr);
+    dispatch.level_views.clear();
+
+    vkDestroyDescriptorPool(device->getLogicalDevice(), dispatch.descriptor_pool, nullptr);
+    dispatch.descriptor_pool = VK_NULL_HANDLE;
+}
+
+void VulkanMipGenerator::cleanUp()
+{
+    vkDestroyPipeline(device->getLogicalDevice(), pipeline, nullptr);
+    vkDestroyPipelineLayout(device->getLogicalDevice(), pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device->getLogicalDevice(), descriptor_set_layout, nullptr);
+    counter_buffer.cleanUp();
+}
+
+VulkanMipGenerator::~VulkanMipGenerator() {}
+
+void VulkanMipGenerator::createDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = MIP_GENERATION_MAX_LEVELS;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_create_info{};
+    layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_create_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_create_info.pBindings = bindings.data();
+
+    VkResult result = vkCreateDescriptorSetLayout(
+      device->getLogicalDevice(), &layout_create_info, nullptr, &descriptor_set_layout);
+    ASSERT_VULKAN(result, "Failed to create mip generation descriptor set layout!")
+}
+
+void VulkanMipGenerator::createPipeline()
+{
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(PushConstantMipGeneration);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_create_info{};
+    pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_create_info.setLayoutCount = 1;
+    pipeline_layout_create_info.pSetLayouts = &descriptor_set_layout;
+    pipeline_layout_create_info.pushConstantRangeCount = 1;
+    pipeline_layout_create_info.pPushConstantRanges = &push_constant_range;
+
+    ASSERT_VULKAN(
+      vkCreatePipelineLayout(device->getLogicalDevice(), &pipeline_layout_create_info, nullptr, &pipeline_layout),
+      "Failed to create mip generation pipeline layout!");
+
+    std::stringstream mip_generation_shader_dir;
+    std::filesystem::path cwd = std::filesystem::current_path();
+    mip_generation_shader_dir << cwd.string();
+    mip_generation_shader_dir << RELATIVE_RESOURCE_PATH;
+    mip_generation_shader_dir << "Shaders/mip_generation/";
+
+    std::string mip_generation_shader = "mip_generation.comp";
+
+    ShaderHelper shaderHelper;
+    // glslc does not create the output directory
+    std::filesystem::create_directories(mip_generation_shader_dir.str() + "spv");
+    shaderHelper.compileShader(mip_generation_shader_dir.str(), mip_generation_shader);
+
+    File mipGenerationShaderFile(shaderHelper.getShaderSpvDir(mip_generation_shader_dir.str(), mip_generation_shader));
+    std::vector<char> mipGenerationShaderCode = mipGenerationShaderFile.readCharSequence();
+    VkShaderModule mipGenerationModule = shaderHelper.createShaderModule(device, mipGenerationShaderCode);
+
+    VkPipelineShaderStageCreateInfo shader_stage_create_info{};
+    shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stage_create_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shader_stage_create_info.module = mipGenerationModule;
+    shader_stage_create_info.pName = "main";
+
+    VkComputePipelineCreateInfo compute_pipeline_create_info{};
+    compute_pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    compute_pipeline_create_info.stage = shader_stage_create_info;
+    compute_pipeline_create_info.layout = pipeline_layout;
+
+    ASSERT_VULKAN(vkCreateComputePipelines(
+                    device->getLogicalDevice(), VK_NULL_HANDLE, 1, &compute_pipeline_create_info, nullptr, &pipeline),
+      "Failed to create mip generation pipeline!");
+
+    vkDestroyShaderModule(device->getLogicalDevice(), mipGenerationModule, nullptr);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "PushConstantMipGeneration.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+
+// generates the whole mip chain of an rgba8 image in one compute dispatch
+// (see mip_generation.comp) instead of one blit + barrier per level.
+// levels are averaged in linear light with premultiplied alpha, like the
+// TextureCooker does on the cpu; odd extents round down as in vkCmdBlitImage
+class VulkanMipGenerator
+{
+  public:
+    // descriptors of one dispatch; must outlive the command buffer it was recorded into
+    struct Dispatch
+    {
+        VkDescriptorPool descriptor_pool{ VK_NULL_HANDLE };
+        std::vector<VkImageView> level_views;
+    };
+
+    VulkanMipGenerator();
+
+    void init(VulkanDevice *device);
+
+    // up to 4096x4096; the image needs STORAGE usage
+    static bool supports(uint32_t width, uint32_t height);
+    static uint32_t getWorkgroupCount(uint32_t width, uint32_t height);
+
+    // expects level 0 written and all levels in TRANSFER_DST_OPTIMAL;
+    // leaves all levels in SHADER_READ_ONLY_OPTIMAL
+    Dispatch record(VkCommandBuffer command_buffer,
+      VkImage image,
+      VkFormat format,
+      uint32_t width,
+      uint32_t height,
+      uint32_t mip_levels);
+    void release(Dispatch &dispatch);
+
+    void cleanUp();
+
+    ~VulkanMipGenerator();
+
+  private:
+    // concurrently running dispatches each count their finished workgroups in their own slot
+    static constexpr uint32_t COUNTER_SLOTS = 64;
+
+    VulkanDevice *device{ VK_NULL_HANDLE };
+
+    VkDescriptorSetLayout descriptor_set_layout{ VK_NULL_HANDLE };
+    VkPipelineLayout pipeline_layout{ VK_NULL_HANDLE };
+    VkPipeline pipeline{ VK_NULL_HANDLE };
+
+    VulkanBuffer counter_buffer;
+    bool counters_cleared{ false };
+    uint32_t next_counter_slot{ 0 };
+
+    void createDescriptorSetLayout();
+    void createPipeline();
+};
@@ -1,36 +1,61 @@
 #include "VulkanSwapChain.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include "Utilities.hpp"
 
 VulkanSwapChain::VulkanSwapChain() {}
 
+void VulkanSwapChain::setPresentation(VkPresentModeKHR present_mode, uint32_t max_queued_frames)
+{
+    requested_present_mode = present_mode;
+    this->max_queued_frames = std::max(1u, max_queued_frames);
+}
+
 void VulkanSwapChain::initVulkanContext(VulkanDevice *device, Window *window, const VkSurfaceKHR &surface)
 {
     this->device = device;
     this->window = window;
 
-    // get swap chain details so we can pick the best settings
+    createSwapChain(surface, device->getSwapchainDetails(), VK_NULL_HANDLE);
+}
+
+bool VulkanSwapChain::recreate(const VkSurfaceKHR &surface)
+{
+    // a minimized window has no extent to create images for
     SwapChainDetails swap_chain_details = device->getSwapchainDetails();
+    VkExtent2D extent = choose_swap_extent(swap_chain_details.surface_capabilities);
+    if (extent.width == 0 || extent.height == 0) return false;
+
+    VkSwapchainKHR old_swapchain = swapchain;
+    std::vector<Texture> old_images = swap_chain_images;
+    createSwapChain(surface, swap_chain_details, old_swapchain);
+
+    // the old swapchain is retired but frames in flight may still present its images
+    VkDevice logical_device = device->getLogicalDevice();
+    device->getDeletionQueue().push([logical_device, old_swapchain, old_images]() mutable {
+        for (Texture &image : old_images) vkDestroyImageView(logical_device, image.getImageView(), nullptr);
+        vkDestroySwapchainKHR(logical_device, old_swapchain, nullptr);
+    });
 
+    return true;
+}
+
+void VulkanSwapChain::createSwapChain(const VkSurfaceKHR &surface,
+  const SwapChainDetails &swap_chain_details,
+  VkSwapchainKHR old_swapchain)
+{
     // 1. choose best surface format
     // 2. choose best presentation mode
     // 3. choose swap chain image resolution
 
     VkSurfaceFormatKHR surface_format = choose_best_surface_format(swap_chain_details.formats);
-    VkPresentModeKHR present_mode = choose_best_presentation_mode(swap_chain_details.presentation_mode);
+    present_mode = choosePresentMode(requested_present_mode, swap_chain_details.presentation_mode);
     VkExtent2D extent = choose_swap_extent(swap_chain_details.surface_capabilities);
 
-    // how many images are in the swap chain; get 1 more than the minimum to allow
-    // tiple buffering
-    uint32_t image_count = swap_chain_details.surface_capabilities.minImageCount + 1;
-
-    // if maxImageCount == 0, then limitless
-    if (swap_chain_details.surface_capabilities.maxImageCount > 0
-        && swap_chain_details.surface_capabilities.maxImageCount < image_count) {
-        image_count = swap_chain_details.surface_capabilities.maxImageCount;
-    }
+    // how many images are in the swap chain
+    uint32_t image_count = chooseImageCount(swap_chain_details.surface_capabilities, present_mode, max_queued_frames);
 
     VkSwapchainCreateInfoKHR swap_chain_create_info{};
     swap_chain_create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -70,7 +95,7 @@ void VulkanSwapChain::initVulkanContext(VulkanDevice *device, Window *window, co
 
     // if old swap chain been destroyed and this one replaces it then link old one
     // to quickly hand over responsibilities
-    swap_chain_create_info.oldSwapchain = VK_NULL_HANDLE;
+    swap_chain_create_info.oldSwapchain = old_swapchain;
 
     // create swap chain
     VkResult result = vkCreateSwapchainKHR(device->getLogicalDevice(), &swap_chain_create_info, nullptr, &swapchain);
@@ -133,17 +158,43 @@ VkSurfaceFormatKHR VulkanSwapChain::choose_best_surface_format(const std::vector
     return formats[0];
 }
 
-VkPresentModeKHR VulkanSwapChain::choose_best_presentation_mode(const std::vector<VkPresentModeKHR> &presentation_modes)
+VkPresentModeKHR VulkanSwapChain::choosePresentMode(VkPresentModeKHR requested,
+  const std::vector<VkPresentModeKHR> &presentation_modes)
 {
-    // look for mailbox presentation mode
-    for (const auto &presentation_mode : presentation_modes) {
-        if (presentation_mode == VK_PRESENT_MODE_MAILBOX_KHR) { return presentation_mode; }
+    auto isSupported = [&presentation_modes](VkPresentModeKHR mode) {
+        return std::find(presentation_modes.begin(), presentation_modes.end(), mode) != presentation_modes.end();
+    };
+
+    if (isSupported(requested)) return requested;
+
+    // mailbox does not wait for the vertical blank either, it only does not tear
+    if (requested == VK_PRESENT_MODE_IMMEDIATE_KHR && isSupported(VK_PRESENT_MODE_MAILBOX_KHR)) {
+        return VK_PRESENT_MODE_MAILBOX_KHR;
     }
 
     // if can't find, use FIFO as Vulkan spec says it must be present
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+uint32_t VulkanSwapChain::chooseImageCount(const VkSurfaceCapabilitiesKHR &surface_capabilities,
+  VkPresentModeKHR present_mode,
+  uint32_t max_queued_frames)
+{
+    // the queued frames plus the one being rendered; mailbox needs one image more than the
+    // minimum so it never blocks in vkAcquireNextImageKHR
+    uint32_t image_count = std::max(1u, max_queued_frames) + 1;
+    const uint32_t min_image_count =
+      surface_capabilities.minImageCount + (present_mode == VK_PRESENT_MODE_MAILBOX_KHR ? 1 : 0);
+    image_count = std::max(image_count, min_image_count);
+
+    // if maxImageCount == 0, then limitless
+    if (surface_capabilities.maxImageCount > 0 && surface_capabilities.maxImageCount < image_count) {
+        image_count = surface_capabilities.maxImageCount;
+    }
+
+    return image_count;
+}
+
 VkExtent2D VulkanSwapChain::choose_swap_extent(const VkSurfaceCapabilitiesKHR &surface_capabilities)
 {
     // if current extent is at numeric limits, than extent can vary. Otherwise it
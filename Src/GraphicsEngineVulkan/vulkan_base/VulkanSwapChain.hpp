@@ -10,13 +10,31 @@ class VulkanSwapChain
   public:
     VulkanSwapChain();
 
+    // present mode and number of frames queued for presentation; take effect with the
+    // next initVulkanContext() or recreate()
+    void setPresentation(VkPresentModeKHR present_mode, uint32_t max_queued_frames);
+
     void initVulkanContext(VulkanDevice *device, Window *window, const VkSurfaceKHR &surface);
+    // replaces the swapchain by one for the current surface extent, handing the old one over
+    // as oldSwapchain; it is destroyed through the deletion queue. false while the window is
+    // minimized, the old swapchain is kept then
+    bool recreate(const VkSurfaceKHR &surface);
 
     const VkSwapchainKHR &getSwapChain() const { return swapchain; };
     uint32_t getNumberSwapChainImages() const { return static_cast<uint32_t>(swap_chain_images.size()); };
     const VkExtent2D &getSwapChainExtent() const { return swap_chain_extent; };
     const VkFormat &getSwapChainFormat() const { return swap_chain_image_format; };
     Texture &getSwapChainImage(uint32_t index) { return swap_chain_images[index]; };
+    // the mode the swapchain was created with; may differ from the requested one
+    VkPresentModeKHR getPresentMode() const { return present_mode; };
+
+    // the requested mode if the surface supports it, otherwise the closest supported one
+    static VkPresentModeKHR choosePresentMode(VkPresentModeKHR requested,
+      const std::vector<VkPresentModeKHR> &presentation_modes);
+    // enough images that max_queued_frames can wait for presentation while one is rendered to
+    static uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR &surface_capabilities,
+      VkPresentModeKHR present_mode,
+      uint32_t max_queued_frames);
 
     void cleanUp();
 
@@ -32,7 +50,13 @@ class VulkanSwapChain
     VkFormat swap_chain_image_format{ VK_FORMAT_B8G8R8A8_UNORM };
     VkExtent2D swap_chain_extent{ 0, 0 };
 
+    VkPresentModeKHR requested_present_mode{ VK_PRESENT_MODE_FIFO_KHR };
+    VkPresentModeKHR present_mode{ VK_PRESENT_MODE_FIFO_KHR };
+    uint32_t max_queued_frames{ 2 };
+
+    void createSwapChain(const VkSurfaceKHR &surface,
+      const SwapChainDetails &swap_chain_details,
+      VkSwapchainKHR old_swapchain);
     VkSurfaceFormatKHR choose_best_surface_format(const std::vector<VkSurfaceFormatKHR> &formats);
-    VkPresentModeKHR choose_best_presentation_mode(const std::vector<VkPresentModeKHR> &presentation_modes);
     VkExtent2D choose_swap_extent(const VkSurfaceCapabilitiesKHR &surface_capabilities);
 };
@@ -0,0 +1,630 @@
+#include "VulkanUploadManager.hpp"
+
+#include <cstring>
+
+#include "Utilities.hpp"
+#include "spdlog/spdlog.h"
+
+VulkanUploadManager::VulkanUploadManager() {}
+
+void VulkanUploadManager::init(VulkanDevice *device, VkDeviceSize staging_size)
+{
+    this->device = device;
+
+    QueueFamilyIndices indices = device->getQueueFamilies();
+    graphics_family = static_cast<uint32_t>(indices.graphics_family);
+    transfer_family = static_cast<uint32_t>(indices.transfer_family);
+    graphics_queue = device->getGraphicsQueue();
+    transfer_queue = device->getTransferQueue();
+    dedicated_transfer = device->hasDedicatedTransferQueue();
+
+    command_pool = createCommandPool(graphics_family);
+    std::array<VkCommandBuffer, MAX_UPLOAD_BATCHES> command_buffers{};
+    allocateCommandBuffers(command_pool, command_buffers);
+
+    std::array<VkCommandBuffer, MAX_UPLOAD_BATCHES> transfer_command_buffers = command_buffers;
+    if (dedicated_transfer) {
+        transfer_command_pool = createCommandPool(transfer_family);
+        allocateCommandBuffers(transfer_command_pool, transfer_command_buffers);
+    }
+
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkQueryPoolCreateInfo query_pool_info{};
+    query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = 2;
+
+    for (uint32_t i = 0; i < MAX_UPLOAD_BATCHES; i++) {
+        batches[i].command_buffer = command_buffers[i];
+        batches[i].transfer_command_buffer = transfer_command_buffers[i];
+
+        VkResult result = vkCreateFence(device->getLogicalDevice(), &fence_info, nullptr, &batches[i].fence);
+        ASSERT_VULKAN(result, "Failed to create upload fence!")
+
+        if (dedicated_transfer) {
+            result = vkCreateSemaphore(
+              device->getLogicalDevice(), &semaphore_info, nullptr, &batches[i].transfer_finished);
+            ASSERT_VULKAN(result, "Failed to create upload semaphore!")
+        }
+
+        result = vkCreateQueryPool(device->getLogicalDevice(), &query_pool_info, nullptr, &batches[i].query_pool);
+        ASSERT_VULKAN(result, "Failed to create upload query pool!")
+    }
+    timestamp_period = device->getPhysicalDeviceProperties().limits.timestampPeriod;
+
+    mip_generator.init(device);
+
+    staging_buffer.create(device,
+      staging_size,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      MemoryCategory::Staging);
+    staging_ring.init(staging_size);
+}
+
+void VulkanUploadManager::uploadBuffer(VulkanBuffer &dst_buffer,
+  const void *data,
+  VkDeviceSize size,
+  VkDeviceSize dst_offset)
+{
+    if (size == 0) return;
+
+    VkDeviceSize src_offset = 0;
+    VkBuffer src_buffer = stage(data, size, 16, src_offset);
+
+    VkBufferCopy buffer_copy_region{};
+    buffer_copy_region.srcOffset = src_offset;
+    buffer_copy_region.dstOffset = dst_offset;
+    buffer_copy_region.size = size;
+
+    vkCmdCopyBuffer(getTransferCommandBuffer(), src_buffer, dst_buffer.getBuffer(), 1, &buffer_copy_region);
+
+    if (!dedicated_transfer) return;
+
+    // queue family ownership transfer; released and acquired for the whole batch in flush()
+    VkBufferMemoryBarrier ownership_barrier{};
+    ownership_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    ownership_barrier.srcQueueFamilyIndex = transfer_family;
+    ownership_barrier.dstQueueFamilyIndex = graphics_family;
+    ownership_barrier.buffer = dst_buffer.getBuffer();
+    ownership_barrier.offset = dst_offset;
+    ownership_barrier.size = size;
+    batches[current_batch].buffer_ownership.push_back(ownership_barrier);
+}
+
+void VulkanUploadManager::uploadImage(VulkanImage &image,
+  const void *data,
+  VkDeviceSize size,
+  uint32_t width,
+  uint32_t height,
+  uint32_t mip_levels)
+{
+    VkBufferImageCopy image_region{};
+    image_region.bufferOffset = 0;
+    image_region.bufferRowLength = 0;
+    image_region.bufferImageHeight = 0;
+    image_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    image_region.imageSubresource.mipLevel = 0;
+    image_region.imageSubresource.baseArrayLayer = 0;
+    image_region.imageSubresource.layerCount = 1;
+    image_region.imageOffset = { 0, 0, 0 };
+    image_region.imageExtent = { width, height, 1 };
+
+    uploadImage(image, data, size, std::span<const VkBufferImageCopy>(&image_region, 1), mip_levels);
+}
+
+void VulkanUploadManager::uploadImage(VulkanImage &image,
+  const void *data,
+  VkDeviceSize size,
+  std::span<const VkBufferImageCopy> regions,
+  uint32_t mip_levels)
+{
+    // 16 keeps every block compressed level offset valid as long as
+    // the levels are block aligned relative to data
+    VkDeviceSize src_offset = 0;
+    VkBuffer src_buffer = stage(data, size, 16, src_offset);
+
+    VkCommandBuffer transfer_command_buffer = getTransferCommandBuffer();
+
+    image.transitionImageLayout(transfer_command_buffer,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      mip_levels,
+      VK_IMAGE_ASPECT_COLOR_BIT);
+
+    std::vector<VkBufferImageCopy> image_regions(regions.begin(), regions.end());
+    for (VkBufferImageCopy &image_region : image_regions) image_region.bufferOffset += src_offset;
+
+    vkCmdCopyBufferToImage(transfer_command_buffer,
+      src_buffer,
+      image.getImage(),
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      static_cast<uint32_t>(image_regions.size()),
+      image_regions.data());
+
+    if (!dedicated_transfer) return;
+
+    // hand all mips over to the graphics queue, keeping TRANSFER_DST_OPTIMAL
+    // so mip generation can continue right away
+    VkImageMemoryBarrier ownership_barrier{};
+    ownership_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    ownership_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    ownership_barrier.dstAccessMask = 0;
+    ownership_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    ownership_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    ownership_barrier.srcQueueFamilyIndex = transfer_family;
+    ownership_barrier.dstQueueFamilyIndex = graphics_family;
+    ownership_barrier.image = image.getImage();
+    ownership_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    ownership_barrier.subresourceRange.baseMipLevel = 0;
+    ownership_barrier.subresourceRange.levelCount = mip_levels;
+    ownership_barrier.subresourceRange.baseArrayLayer = 0;
+    ownership_barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(transfer_command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &ownership_barrier);
+
+    ownership_barrier.srcAccessMask = 0;
+    ownership_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(getCommandBuffer(),
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &ownership_barrier);
+}
+
+void VulkanUploadManager::generateMipMaps(VulkanImage &image,
+  VkFormat format,
+  VkImageUsageFlags usage,
+  uint32_t width,
+  uint32_t height,
+  uint32_t mip_levels)
+{
+    UploadBatch &batch = batches[current_batch];
+    VkCommandBuffer command_buffer = getCommandBuffer();
+
+    if (!batch.mip_timing) {
+        vkCmdResetQueryPool(command_buffer, batch.query_pool, 0, 2);
+        vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.query_pool, 0);
+        batch.mip_timing = true;
+    }
+
+    if ((usage & VK_IMAGE_USAGE_STORAGE_BIT) && usesComputeMipGeneration(format, width, height)) {
+        batch.mip_dispatches.push_back(
+          mip_generator.record(command_buffer, image.getImage(), format, width, height, mip_levels));
+    } else {
+        blitMipMaps(command_buffer,
+          image.getImage(),
+          format,
+          static_cast<int32_t>(width),
+          static_cast<int32_t>(height),
+          mip_levels);
+    }
+    mip_generated_images++;
+}
+
+bool VulkanUploadManager::usesComputeMipGeneration(VkFormat format, uint32_t width, uint32_t height) const
+{
+    return compute_mip_generation && format == VK_FORMAT_R8G8B8A8_UNORM && VulkanMipGenerator::supports(width, height);
+}
+
+VkCommandBuffer VulkanUploadManager::getCommandBuffer()
+{
+    UploadBatch &batch = batches[current_batch];
+
+    if (!batch.recording) {
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult result = vkBeginCommandBuffer(batch.command_buffer, &begin_info);
+        ASSERT_VULKAN(result, "Failed to begin upload command buffer!")
+        batch.recording = true;
+    }
+
+    return batch.command_buffer;
+}
+
+VkCommandBuffer VulkanUploadManager::getTransferCommandBuffer()
+{
+    if (!dedicated_transfer) return getCommandBuffer();
+
+    UploadBatch &batch = batches[current_batch];
+
+    if (!batch.transfer_recording) {
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult result = vkBeginCommandBuffer(batch.transfer_command_buffer, &begin_info);
+        ASSERT_VULKAN(result, "Failed to begin upload transfer command buffer!")
+        batch.transfer_recording = true;
+    }
+
+    return batch.transfer_command_buffer;
+}
+
+uint64_t VulkanUploadManager::flush()
+{
+    UploadBatch &batch = batches[current_batch];
+    if (!batch.recording && !batch.transfer_recording) return submitted_tickets;
+
+    VkResult result;
+    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+    if (batch.transfer_recording) {
+        // release on the transfer queue ...
+        if (!batch.buffer_ownership.empty()) {
+            for (VkBufferMemoryBarrier &barrier : batch.buffer_ownership) {
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+            }
+            vkCmdPipelineBarrier(batch.transfer_command_buffer,
+              VK_PIPELINE_STAGE_TRANSFER_BIT,
+              VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+              0,
+              0,
+              nullptr,
+              static_cast<uint32_t>(batch.buffer_ownership.size()),
+              batch.buffer_ownership.data(),
+              0,
+              nullptr);
+        }
+
+        result = vkEndCommandBuffer(batch.transfer_command_buffer);
+        ASSERT_VULKAN(result, "Failed to end upload transfer command buffer!")
+
+        VkSubmitInfo transfer_submit_info{};
+        transfer_submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        transfer_submit_info.commandBufferCount = 1;
+        transfer_submit_info.pCommandBuffers = &batch.transfer_command_buffer;
+        transfer_submit_info.signalSemaphoreCount = 1;
+        transfer_submit_info.pSignalSemaphores = &batch.transfer_finished;
+
+        result = vkQueueSubmit(transfer_queue, 1, &transfer_submit_info, VK_NULL_HANDLE);
+        ASSERT_VULKAN(result, "Failed to submit upload batch to transfer queue!")
+
+        submit_info.waitSemaphoreCount = 1;
+        submit_info.pWaitSemaphores = &batch.transfer_finished;
+        submit_info.pWaitDstStageMask = &wait_stage;
+    }
+
+    // the fence always sits on the graphics submit (possibly empty),
+    // which only starts once all copies of this batch are done
+    getCommandBuffer();
+    // ... and acquire on the graphics queue
+    if (!batch.buffer_ownership.empty()) {
+        for (VkBufferMemoryBarrier &barrier : batch.buffer_ownership) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        }
+        vkCmdPipelineBarrier(batch.command_buffer,
+          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+          0,
+          0,
+          nullptr,
+          static_cast<uint32_t>(batch.buffer_ownership.size()),
+          batch.buffer_ownership.data(),
+          0,
+          nullptr);
+        batch.buffer_ownership.clear();
+    }
+    if (batch.mip_timing) {
+        vkCmdWriteTimestamp(batch.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, batch.query_pool, 1);
+    }
+    result = vkEndCommandBuffer(batch.command_buffer);
+    ASSERT_VULKAN(result, "Failed to end upload command buffer!")
+
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch.command_buffer;
+
+    result = vkQueueSubmit(graphics_queue, 1, &submit_info, batch.fence);
+    ASSERT_VULKAN(result, "Failed to submit upload batch!")
+
+    batch.transfer_recording = false;
+    batch.recording = false;
+    batch.pending = true;
+    batch.ticket = ++submitted_tickets;
+
+    // the next slot may still be in flight from an earlier round
+    current_batch = (current_batch + 1) % MAX_UPLOAD_BATCHES;
+    if (batches[current_batch].pending) retire(batches[current_batch]);
+
+    return batch.ticket;
+}
+
+void VulkanUploadManager::wait(uint64_t ticket)
+{
+    while (completed_tickets < ticket && retireOldest()) {}
+}
+
+bool VulkanUploadManager::isComplete(uint64_t ticket)
+{
+    if (completed_tickets >= ticket) return true;
+
+    for (UploadBatch &batch : batches) {
+        if (batch.pending && batch.ticket <= ticket
+            && vkGetFenceStatus(device->getLogicalDevice(), batch.fence) != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    // everything up to ticket has signaled; recycle the slots in order
+    wait(ticket);
+    return true;
+}
+
+void VulkanUploadManager::waitIdle() { wait(flush()); }
+
+void VulkanUploadManager::cleanUp()
+{
+    waitIdle();
+
+    for (UploadBatch &batch : batches) {
+        vkDestroyFence(device->getLogicalDevice(), batch.fence, nullptr);
+        if (batch.transfer_finished != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device->getLogicalDevice(), batch.transfer_finished, nullptr);
+        }
+        vkDestroyQueryPool(device->getLogicalDevice(), batch.query_pool, nullptr);
+    }
+    mip_generator.cleanUp();
+
+    vkDestroyCommandPool(device->getLogicalDevice(), command_pool, nullptr);
+    if (transfer_command_pool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device->getLogicalDevice(), transfer_command_pool, nullptr);
+    }
+    staging_buffer.cleanUp();
+}
+
+VulkanUploadManager::~VulkanUploadManager() {}
+
+VkBuffer
+  VulkanUploadManager::stage(const void *data, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &src_offset)
+{
+    uploaded_bytes += size;
+
+    if (size > staging_ring.getCapacity()) {
+        // too big for the ring at all; keep a one off staging buffer alive
+        // until the batch that reads from it has retired
+        UploadBatch &batch = batches[current_batch];
+        batch.oversized_staging.emplace_back();
+        VulkanBuffer &oversized = batch.oversized_staging.back();
+        oversized.create(device,
+          size,
+          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+          MemoryCategory::Staging);
+        std::memcpy(oversized.getMappedData(), data, static_cast<size_t>(size));
+        src_offset = 0;
+        return oversized.getBuffer();
+    }
+
+    VkDeviceSize consumed = 0;
+    while (!staging_ring.allocate(size, alignment, src_offset, consumed)) {
+        // ring is full: submit what we have and recycle the oldest batch
+        if (!retireOldest()) flush();
+    }
+
+    batches[current_batch].staging_consumed += consumed;
+    std::memcpy(static_cast<char *>(staging_buffer.getMappedData()) + src_offset, data, static_cast<size_t>(size));
+
+    return staging_buffer.getBuffer();
+}
+
+VkCommandPool VulkanUploadManager::createCommandPool(uint32_t queue_family)
+{
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family;
+
+    VkCommandPool pool;
+    VkResult result = vkCreateCommandPool(device->getLogicalDevice(), &pool_info, nullptr, &pool);
+    ASSERT_VULKAN(result, "Failed to create upload command pool!")
+
+    return pool;
+}
+
+void VulkanUploadManager::allocateCommandBuffers(VkCommandPool pool,
+  std::array<VkCommandBuffer, MAX_UPLOAD_BATCHES> &command_buffers)
+{
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandPool = pool;
+    alloc_info.commandBufferCount = MAX_UPLOAD_BATCHES;
+
+    VkResult result = vkAllocateCommandBuffers(device->getLogicalDevice(), &alloc_info, command_buffers.data());
+    ASSERT_VULKAN(result, "Failed to allocate upload command buffers!")
+}
+
+void VulkanUploadManager::retire(UploadBatch &batch)
+{
+    VkResult result = vkWaitForFences(device->getLogicalDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    ASSERT_VULKAN(result, "Failed to wait for upload fence!")
+    result = vkResetFences(device->getLogicalDevice(), 1, &batch.fence);
+    ASSERT_VULKAN(result, "Failed to reset upload fence!")
+
+    staging_ring.release(batch.staging_consumed);
+    batch.staging_consumed = 0;
+
+    for (VulkanBuffer &buffer : batch.oversized_staging) { buffer.cleanUp(); }
+    batch.oversized_staging.clear();
+
+    for (VulkanMipGenerator::Dispatch &dispatch : batch.mip_dispatches) { mip_generator.release(dispatch); }
+    batch.mip_dispatches.clear();
+
+    if (batch.mip_timing) {
+        uint64_t timestamps[2];
+        result = vkGetQueryPoolResults(device->getLogicalDevice(),
+          batch.query_pool,
+          0,
+          2,
+          sizeof(timestamps),
+          timestamps,
+          sizeof(uint64_t),
+          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+        if (result == VK_SUCCESS) {
+            mip_generation_ms += static_cast<double>(timestamps[1] - timestamps[0]) * timestamp_period / 1000000.0;
+        }
+        batch.mip_timing = false;
+    }
+
+    batch.pending = false;
+    if (batch.ticket > completed_tickets) completed_tickets = batch.ticket;
+}
+
+bool VulkanUploadManager::retireOldest()
+{
+    // batches are submitted round robin, so the oldest pending one
+    // is the first pending slot after the one we record into
+    for (uint32_t i = 1; i <= MAX_UPLOAD_BATCHES; i++) {
+        UploadBatch &batch = batches[(current_batch + i) % MAX_UPLOAD_BATCHES];
+        if (batch.pending) {
+            retire(batch);
+            return true;
+        }
+    }
+    return false;
+}
+
+void VulkanUploadManager::blitMipMaps(VkCommandBuffer command_buffer,
+  VkImage image,
+  VkFormat format,
+  int32_t width,
+  int32_t height,
+  uint32_t mip_levels)
+{
+    // Check if image format supports linear blitting
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &formatProperties);
+
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+        spdlog::error("Texture image format does not support linear blitting!");
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.levelCount = 1;
+
+    // TEMP VARS needed for decreasing step by step for factor 2
+    int32_t tmp_width = width;
+    int32_t tmp_height = height;
+
+    // -- WE START AT 1 !
+    for (uint32_t i = 1; i < mip_levels; i++) {
+        // WAIT for previous mip map level for being ready
+        barrier.subresourceRange.baseMipLevel = i - 1;
+        // HERE we TRANSITION for having a SRC format now
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0,
+          0,
+          nullptr,
+          0,
+          nullptr,
+          1,
+          &barrier);
+
+        // when barrier over we can now blit :)
+        VkImageBlit blit{};
+
+        // -- OFFSETS describing the 3D-dimesnion of the region
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { tmp_width, tmp_height, 1 };
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        // copy from previous level
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        // -- OFFSETS describing the 3D-dimesnion of the region
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { tmp_width > 1 ? tmp_width / 2 : 1, tmp_height > 1 ? tmp_height / 2 : 1, 1 };
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        // -- COPY to next mipmap level
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(command_buffer,
+          image,
+          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+          image,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          1,
+          &blit,
+          VK_FILTER_LINEAR);
+
+        // REARRANGE image formats for having the correct image formats again
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+          0,
+          0,
+          nullptr,
+          0,
+          nullptr,
+          1,
+          &barrier);
+
+        if (tmp_width > 1) tmp_width /= 2;
+        if (tmp_height > 1) tmp_height /= 2;
+    }
+
+    barrier.subresourceRange.baseMipLevel = mip_levels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "StagingRing.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanImage.hpp"
+#include "VulkanMipGenerator.hpp"
+
+// collects buffer and image uploads into a few large submissions;
+// source data goes through one persistently mapped staging ring and
+// every submitted batch is tracked by a fence instead of vkQueueWaitIdle.
+// copies run on the dedicated transfer queue if the device has one; the
+// graphics queue then acquires ownership of the uploaded resources
+class VulkanUploadManager
+{
+  public:
+    VulkanUploadManager();
+
+    void init(VulkanDevice *device, VkDeviceSize staging_size = 64 * 1024 * 1024);
+
+    // create a device local buffer and record the copy of bufferData into it
+    template<typename T>
+    void uploadVector(VulkanBuffer &dst_buffer,
+      VkBufferUsageFlags buffer_usage_flags,
+      VkMemoryPropertyFlags memory_property_flags,
+      MemoryCategory category,
+      std::span<const T> bufferData);
+
+    template<typename T>
+    void uploadVector(VulkanBuffer &dst_buffer,
+      VkBufferUsageFlags buffer_usage_flags,
+      VkMemoryPropertyFlags memory_property_flags,
+      MemoryCategory category,
+      const std::vector<T> &bufferData)
+    {
+        uploadVector(dst_buffer, buffer_usage_flags, memory_property_flags, category, std::span<const T>(bufferData));
+    }
+
+    void uploadBuffer(VulkanBuffer &dst_buffer, const void *data, VkDeviceSize size, VkDeviceSize dst_offset = 0);
+
+    // copies data into mip 0; the image is left in TRANSFER_DST_OPTIMAL
+    // and owned by the graphics queue for the caller to continue
+    // recording into getCommandBuffer()
+    void uploadImage(VulkanImage &image,
+      const void *data,
+      VkDeviceSize size,
+      uint32_t width,
+      uint32_t height,
+      uint32_t mip_levels);
+    // same for precomputed levels (e.g. a cooked mip chain) in one staging
+    // allocation; the buffer offsets of regions are relative to data
+    void uploadImage(VulkanImage &image,
+      const void *data,
+      VkDeviceSize size,
+      std::span<const VkBufferImageCopy> regions,
+      uint32_t mip_levels);
+
+    // fills levels 1.. of an image uploaded by uploadImage() and transitions all
+    // of them to SHADER_READ_ONLY_OPTIMAL. rgba8 images up to 4096x4096 with
+    // STORAGE usage get a single compute dispatch (see VulkanMipGenerator),
+    // all others (or all images with compute mip generation off) a blit per level
+    void generateMipMaps(VulkanImage &image,
+      VkFormat format,
+      VkImageUsageFlags usage,
+      uint32_t width,
+      uint32_t height,
+      uint32_t mip_levels);
+    void setComputeMipGeneration(bool enabled) { compute_mip_generation = enabled; };
+    // whether generateMipMaps() dispatches the compute path for such an image if it has STORAGE usage
+    bool usesComputeMipGeneration(VkFormat format, uint32_t width, uint32_t height) const;
+
+    // graphics queue command buffer of the batch currently being recorded;
+    // it runs after all copies of the batch have finished
+    VkCommandBuffer getCommandBuffer();
+
+    // submit everything recorded so far; returns a ticket for wait()
+    uint64_t flush();
+    void wait(uint64_t ticket);
+    // non blocking check, e.g. for streaming while frames are rendered
+    bool isComplete(uint64_t ticket);
+    void waitIdle();
+
+    uint64_t getSubmitCount() const { return submitted_tickets; };
+    VkDeviceSize getUploadedBytes() const { return uploaded_bytes; };
+    uint32_t getMipGeneratedImages() const { return mip_generated_images; };
+    // gpu time of mip generation in all retired batches
+    double getMipGenerationMs() const { return mip_generation_ms; };
+
+    void cleanUp();
+
+    ~VulkanUploadManager();
+
+  private:
+    static constexpr uint32_t MAX_UPLOAD_BATCHES = 3;
+
+    struct UploadBatch
+    {
+        // equal to command_buffer if there is no dedicated transfer queue
+        VkCommandBuffer transfer_command_buffer{ VK_NULL_HANDLE };
+        VkCommandBuffer command_buffer{ VK_NULL_HANDLE };
+        VkSemaphore transfer_finished{ VK_NULL_HANDLE };
+        VkFence fence{ VK_NULL_HANDLE };
+        uint64_t ticket{ 0 };
+        VkDeviceSize staging_consumed{ 0 };
+        // uploads bigger than the whole ring get their own staging buffer
+        std::vector<VulkanBuffer> oversized_staging;
+        std::vector<VulkanMipGenerator::Dispatch> mip_dispatches;
+        // queue family ownership of all buffers copied in this batch is
+        // released and acquired with one barrier each on flush()
+        std::vector<VkBufferMemoryBarrier> buffer_ownership;
+        // timestamps around all mip generation in command_buffer
+        VkQueryPool query_pool{ VK_NULL_HANDLE };
+        bool mip_timing{ false };
+        bool transfer_recording{ false };
+        bool recording{ false };
+        bool pending{ false };
+    };
+
+    VulkanDevice *device{ VK_NULL_HANDLE };
+    VkQueue graphics_queue{ VK_NULL_HANDLE };
+    VkQueue transfer_queue{ VK_NULL_HANDLE };
+    uint32_t graphics_family{ 0 };
+    uint32_t transfer_family{ 0 };
+    bool dedicated_transfer{ false };
+    VkCommandPool command_pool{ VK_NULL_HANDLE };
+    VkCommandPool transfer_command_pool{ VK_NULL_HANDLE };
+
+    VulkanBuffer staging_buffer;
+    StagingRing staging_ring;
+
+    std::array<UploadBatch, MAX_UPLOAD_BATCHES> batches;
+    uint32_t current_batch{ 0 };
+    uint64_t submitted_tickets{ 0 };
+    uint64_t completed_tickets{ 0 };
+    VkDeviceSize uploaded_bytes{ 0 };
+
+    VulkanMipGenerator mip_generator;
+    bool compute_mip_generation{ true };
+    float timestamp_period{ 0 };
+    uint32_t mip_generated_images{ 0 };
+    double mip_generation_ms{ 0.0 };
+
+    // copy data into staging memory, returns buffer + offset to copy from
+    VkBuffer stage(const void *data, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &src_offset);
+
+    VkCommandBuffer getTransferCommandBuffer();
+    VkCommandPool createCommandPool(uint32_t queue_family);
+    void allocateCommandBuffers(VkCommandPool pool, std::array<VkCommandBuffer, MAX_UPLOAD_BATCHES> &command_buffers);
+
+    void blitMipMaps(VkCommandBuffer command_buffer,
+      VkImage image,
+      VkFormat format,
+      int32_t width,
+      int32_t height,
+      uint32_t mip_levels);
+
+    void retire(UploadBatch &batch);
+    bool retireOldest();
+};
+
+template<typename T>
+inline void VulkanUploadManager::uploadVector(VulkanBuffer &dst_buffer,
+  VkBufferUsageFlags buffer_usage_flags,
+  VkMemoryPropertyFlags memory_property_flags,
+  MemoryCategory category,
+  std::span<const T> bufferData)
+{
+    VkDeviceSize buffer_size = sizeof(T) * bufferData.size();
+
+    dst_buffer.create(
+      device, buffer_size, buffer_usage_flags | VK_BUFFER_USAGE_TRANSFER_DST_BIT, memory_property_flags, category);
+
+    uploadBuffer(dst_buffer, bufferData.data(), buffer_size);
+}
@@ -7,6 +7,12 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <glm/glm.hpp>
 #include <glm/mat4x4.hpp>
 #include <iostream>
@@ -14,8 +20,29 @@
 #include <stdexcept>
 #include <vector>
 
+#include "DeletionQueue.hpp"
+#include "FramePacer.hpp"
 #include "GUI.hpp"
+#include "LinearAllocator.hpp"
+#include "MemoryBudget.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "ObjLoader.hpp"
+#include "ObjParser.hpp"
+#include "ParallelRecorder.hpp"
+#include "RangeAllocator.hpp"
+#include "RenderGraph.hpp"
+#include "StagingRing.hpp"
+#include "TextureCache.hpp"
+#include "TextureCooker.hpp"
+#include "TextureDecoder.hpp"
+#include "TextureStreamer.hpp"
+#include "VertexWelder.hpp"
+#include "VulkanMipGenerator.hpp"
 #include "VulkanRenderer.hpp"
+#include "VulkanSwapChain.hpp"
+#include "VulkanUploadManager.hpp"
 #include "Window.hpp"
 
 
@@ -29,6 +56,1063 @@ TEST(HelloTestCommit, BasicAssertions)
     EXPECT_EQ(7 * 6, 42);
 }
 
+TEST(StagingRing, WrapsAroundAndReleasesInOrder)
+{
+    StagingRing ring;
+    ring.init(256);
+
+    VkDeviceSize offset = 0;
+    VkDeviceSize first = 0;
+    VkDeviceSize second = 0;
+    VkDeviceSize third = 0;
+
+    EXPECT_TRUE(ring.allocate(100, 16, offset, first));
+    EXPECT_EQ(offset, 0u);
+    EXPECT_TRUE(ring.allocate(100, 16, offset, second));
+    EXPECT_EQ(offset, 112u);
+    EXPECT_EQ(second, 112u);
+
+    // the tail only has 44 bytes left and the front is still in flight
+    EXPECT_FALSE(ring.allocate(64, 16, offset, third));
+
+    ring.release(first);
+    EXPECT_TRUE(ring.allocate(64, 16, offset, third));
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.getUsed(), second + third);
+
+    ring.release(second);
+    ring.release(third);
+    EXPECT_EQ(ring.getUsed(), 0u);
+
+    EXPECT_FALSE(ring.allocate(512, 16, offset, first));
+}
+
+TEST(MemoryBudget, TracksCategoriesAndPressure)
+{
+    MemoryBudget budget;
+    budget.track(MemoryCategory::Geometry, 300);
+    budget.track(MemoryCategory::Geometry, 200);
+    budget.track(MemoryCategory::Texture, 1000);
+    budget.untrack(MemoryCategory::Geometry, 300);
+
+    EXPECT_EQ(budget.getUsage(MemoryCategory::Geometry).bytes, 200u);
+    EXPECT_EQ(budget.getUsage(MemoryCategory::Geometry).peak_bytes, 500u);
+    EXPECT_EQ(budget.getUsage(MemoryCategory::Geometry).allocations, 1u);
+    EXPECT_EQ(budget.getTrackedBytes(), 1200u);
+
+    // without a heap budget streaming gets its limit
+    EXPECT_EQ(budget.getPressure(), MemoryPressure::Low);
+    EXPECT_EQ(budget.getStreamingBudget(4000, 1000), 4000u);
+
+    // 5000 of 10000 used, 1000 of it streamed: up to 8500 - 4000 may be streamed
+    budget.setHeapBudget(5000, 10000);
+    EXPECT_EQ(budget.getPressure(), MemoryPressure::Low);
+    EXPECT_EQ(budget.getStreamingBudget(100000, 1000), 4500u);
+    EXPECT_EQ(budget.getStreamingBudget(2000, 1000), 2000u);
+
+    // everyone else grew: the streamer has to give memory back
+    budget.setHeapBudget(9000, 10000);
+    EXPECT_EQ(budget.getPressure(), MemoryPressure::High);
+    EXPECT_EQ(budget.getStreamingBudget(100000, 1000), 500u);
+    budget.setHeapBudget(9800, 10000);
+    EXPECT_EQ(budget.getPressure(), MemoryPressure::Critical);
+    EXPECT_EQ(budget.getStreamingBudget(100000, 500), 0u);
+
+    const std::string json = budget.toJson();
+    EXPECT_NE(json.find("\"critical\""), std::string::npos);
+    EXPECT_NE(json.find("\"acceleration_structure\""), std::string::npos);
+}
+
+TEST(RangeAllocator, AlignsAndMergesFreedRanges)
+{
+    RangeAllocator ranges;
+    ranges.init(1000);
+
+    VkDeviceSize first = 0;
+    VkDeviceSize second = 0;
+    VkDeviceSize third = 0;
+    EXPECT_TRUE(ranges.allocate(100, 16, first));
+    EXPECT_EQ(first, 0u);
+    // a vertex stride of 48 bytes as alignment
+    EXPECT_TRUE(ranges.allocate(200, 48, second));
+    EXPECT_EQ(second, 144u);
+    EXPECT_TRUE(ranges.allocate(300, 16, third));
+    EXPECT_EQ(third, 352u);
+    EXPECT_EQ(ranges.getUsed(), 600u);
+
+    // the padding in front of second is still there for small ranges
+    VkDeviceSize padding = 0;
+    EXPECT_TRUE(ranges.allocate(32, 16, padding));
+    EXPECT_EQ(padding, 112u);
+    EXPECT_FALSE(ranges.allocate(400, 16, padding));
+
+    ranges.free(second, 200);
+    EXPECT_TRUE(ranges.allocate(150, 16, second));
+    EXPECT_EQ(second, 144u);
+
+    ranges.free(first, 100);
+    ranges.free(second, 150);
+    ranges.free(third, 300);
+    ranges.free(112, 32);
+    EXPECT_EQ(ranges.getUsed(), 0u);
+    EXPECT_EQ(ranges.getFreeRangeCount(), 1u);
+    EXPECT_EQ(ranges.getLargestFreeRange(), 1000u);
+}
+
+TEST(DeletionQueue, ReleasesOnceFramesHaveFinished)
+{
+    DeletionQueue deletionQueue;
+    std::vector<int> deleted;
+
+    deletionQueue.setFrame(4);
+    deletionQueue.push([&deleted]() { deleted.push_back(0); });
+    deletionQueue.push([&deleted]() { deleted.push_back(1); });
+    deletionQueue.setFrame(6);
+    deletionQueue.push([&deleted]() { deleted.push_back(2); });
+    EXPECT_EQ(deletionQueue.getPendingCount(), 3u);
+
+    // frame 4 itself is still running
+    deletionQueue.release(4);
+    EXPECT_TRUE(deleted.empty());
+
+    deletionQueue.release(5);
+    EXPECT_EQ(deleted, (std::vector<int>{ 0, 1 }));
+    deletionQueue.release(6);
+    EXPECT_EQ(deletionQueue.getPendingCount(), 1u);
+
+    deletionQueue.flush();
+    EXPECT_EQ(deleted, (std::vector<int>{ 0, 1, 2 }));
+    EXPECT_EQ(deletionQueue.getPendingCount(), 0u);
+}
+
+TEST(LinearAllocator, ResetsRegionOfEachFrameInFlight)
+{
+    LinearAllocator frames;
+    // 1000 bytes per frame round up to 1024 with a 256 byte uniform offset alignment
+    frames.init(1000, 3, 256);
+    EXPECT_EQ(frames.getFrameSize(), 1024u);
+    EXPECT_EQ(frames.getCapacity(), 3072u);
+
+    VkDeviceSize offset = 0;
+    frames.beginFrame(1);
+    EXPECT_TRUE(frames.allocate(64, offset));
+    EXPECT_EQ(offset, 1024u);
+    EXPECT_TRUE(frames.allocate(300, offset));
+    EXPECT_EQ(offset, 1280u);
+    EXPECT_TRUE(frames.allocate(100, offset));
+    EXPECT_EQ(offset, 1792u);
+    // does not spill into the region of frame 2
+    EXPECT_FALSE(frames.allocate(256, offset));
+    EXPECT_EQ(frames.getFrameUsed(), 868u);
+
+    frames.beginFrame(2);
+    EXPECT_EQ(frames.getFrameUsed(), 0u);
+    EXPECT_TRUE(frames.allocate(1024, offset));
+    EXPECT_EQ(offset, 2048u);
+
+    frames.beginFrame(1);
+    EXPECT_TRUE(frames.allocate(16, offset));
+    EXPECT_EQ(offset, 1024u);
+    EXPECT_EQ(frames.getPeakFrameUsed(), 1024u);
+    EXPECT_FALSE(frames.allocate(0, offset));
+}
+
+TEST(ParallelRecorder, RecordsEveryDrawOnce)
+{
+    // at most 4 ranges, each at least 256 draws
+    std::vector<ParallelRecorder::Range> ranges = ParallelRecorder::split(1000, 4, 256);
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[0].begin, 0u);
+    EXPECT_EQ(ranges[0].end, 334u);
+    EXPECT_EQ(ranges[1].end, 667u);
+    EXPECT_EQ(ranges[2].end, 1000u);
+    EXPECT_EQ(ParallelRecorder::split(10, 4, 256).size(), 1u);
+    EXPECT_TRUE(ParallelRecorder::split(0, 4, 256).empty());
+
+    ParallelRecorder recorder(4);
+    EXPECT_EQ(recorder.getWorkerCount(), 4u);
+
+    std::vector<uint32_t> recorded_by(5000, UINT32_MAX);
+    for (uint32_t draws : { 5000u, 100u, 5000u }) {
+        std::fill(recorded_by.begin(), recorded_by.end(), UINT32_MAX);
+        const uint32_t range_count =
+          recorder.record(draws, 256, [&recorded_by](uint32_t worker, uint32_t begin, uint32_t end) {
+              for (uint32_t d = begin; d < end; d++) recorded_by[d] = worker;
+          });
+        EXPECT_EQ(range_count, draws / 256 < 4 ? std::max(1u, draws / 256) : 4u);
+        for (uint32_t d = 0; d < draws; d++) EXPECT_LT(recorded_by[d], range_count);
+        EXPECT_TRUE(std::is_sorted(recorded_by.begin(), recorded_by.begin() + draws));
+    }
+}
+
+TEST(RenderGraph, CullsPassesAndBatchesBarriers)
+{
+    // the frame of the engine with path tracing on: the rasterizer's image is overwritten
+    RenderGraph graph;
+    RenderGraph::Handle offscreen =
+      graph.importImage("offscreen", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    RenderGraph::Handle raster = graph.addPass("rasterizer", nullptr);
+    graph.write(raster, offscreen, RenderGraphUsage::ColorAttachment);
+    RenderGraph::Handle path_tracing = graph.addPass("path tracing", nullptr);
+    graph.write(path_tracing, offscreen, RenderGraphUsage::StorageCompute);
+    RenderGraph::Handle post = graph.addPass("post", nullptr);
+    graph.read(post, offscreen, RenderGraphUsage::SampledFragment);
+    graph.setOutput(post);
+    graph.compile();
+
+    EXPECT_TRUE(graph.isCulled(raster));
+    EXPECT_FALSE(graph.isCulled(path_tracing));
+    EXPECT_FALSE(graph.isCulled(post));
+    EXPECT_EQ(graph.getBarrierCount(), 2u);
+    ASSERT_EQ(graph.getBarriers(path_tracing).size(), 1u);
+    EXPECT_EQ(graph.getBarriers(path_tracing)[0].oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_EQ(graph.getBarriers(path_tracing)[0].newLayout, VK_IMAGE_LAYOUT_GENERAL);
+    ASSERT_EQ(graph.getBarriers(post).size(), 1u);
+    const VkImageMemoryBarrier2 &to_post = graph.getBarriers(post)[0];
+    EXPECT_EQ(to_post.srcStageMask, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+    EXPECT_EQ(to_post.srcAccessMask, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    EXPECT_EQ(to_post.dstStageMask, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+    EXPECT_EQ(to_post.oldLayout, VK_IMAGE_LAYOUT_GENERAL);
+    EXPECT_EQ(to_post.newLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    EXPECT_EQ(graph.getFinalLayout(offscreen), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // a second read in the same layout needs no barrier; writing again only waits for the reads;
+    // a pass whose image nobody reads is dropped
+    graph.reset(0);
+    RenderGraph::Handle color =
+      graph.importImage("color", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    RenderGraph::Handle unused =
+      graph.importImage("unused", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    RenderGraph::Handle fill = graph.addPass("fill", nullptr);
+    graph.write(fill, color, RenderGraphUsage::ColorAttachment);
+    RenderGraph::Handle first_read = graph.addPass("first read", nullptr);
+    graph.read(first_read, color, RenderGraphUsage::SampledFragment);
+    graph.setOutput(first_read);
+    RenderGraph::Handle second_read = graph.addPass("second read", nullptr);
+    graph.read(second_read, color, RenderGraphUsage::SampledFragment);
+    graph.setOutput(second_read);
+    RenderGraph::Handle dead = graph.addPass("dead", nullptr);
+    graph.write(dead, unused, RenderGraphUsage::StorageCompute);
+    RenderGraph::Handle overwrite = graph.addPass("overwrite", nullptr);
+    graph.write(overwrite, color, RenderGraphUsage::ColorAttachment);
+    graph.setOutput(overwrite);
+    graph.compile();
+
+    EXPECT_TRUE(graph.isCulled(dead));
+    EXPECT_EQ(graph.getBarriers(fill).size(), 1u);
+    EXPECT_EQ(graph.getBarriers(first_read).size(), 1u);
+    EXPECT_TRUE(graph.getBarriers(second_read).empty());
+    ASSERT_EQ(graph.getBarriers(overwrite).size(), 1u);
+    EXPECT_EQ(graph.getBarriers(overwrite)[0].srcStageMask, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+    EXPECT_EQ(graph.getBarriers(overwrite)[0].srcAccessMask, VK_ACCESS_2_NONE);
+    EXPECT_EQ(graph.getBarriers(overwrite)[0].oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_EQ(graph.getBarrierCount(), 3u);
+}
+
+TEST(RenderGraph, AliasesDisjointLifetimes)
+{
+    std::vector<RenderGraph::Lifetime> lifetimes = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 0, 3 }, { 4, 4 } };
+    std::vector<VkMemoryRequirements> requirements = {
+        { 100, 16, 0x1 }, { 200, 64, 0x1 }, { 50, 256, 0x1 }, { 80, 16, 0x1 }, { 10, 16, 0x2 }
+    };
+    std::vector<VkMemoryRequirements> slots;
+    std::vector<uint32_t> assigned = RenderGraph::planAliasing(lifetimes, requirements, slots);
+
+    // the third image takes over the memory of the first; the last one needs another memory type
+    ASSERT_EQ(assigned.size(), 5u);
+    EXPECT_EQ(assigned[0], assigned[2]);
+    EXPECT_NE(assigned[1], assigned[3]);
+    EXPECT_NE(assigned[0], assigned[1]);
+    EXPECT_NE(assigned[0], assigned[3]);
+    ASSERT_EQ(slots.size(), 4u);
+    EXPECT_EQ(slots[assigned[0]].size, 100u);
+    EXPECT_EQ(slots[assigned[0]].alignment, 256u);
+    EXPECT_EQ(slots[assigned[4]].memoryTypeBits, 0x2u);
+
+    VkDeviceSize aliased = 0;
+    for (const VkMemoryRequirements &slot : slots) aliased += slot.size;
+    EXPECT_EQ(aliased, 390u);
+
+    // unused images get no memory at all
+    std::vector<VkMemoryRequirements> no_slots;
+    assigned = RenderGraph::planAliasing({ RenderGraph::Lifetime{} }, { { 100, 16, 0x1 } }, no_slots);
+    EXPECT_EQ(assigned[0], RenderGraph::NO_SLOT);
+    EXPECT_TRUE(no_slots.empty());
+}
+
+TEST(FramePacer, LimitsQueuedPresentsAndMeasuresLatency)
+{
+    FramePacer pacer;
+    pacer.setMaxQueuedFrames(2);
+    const FramePacer::Clock::time_point start = FramePacer::Clock::now();
+
+    // two presents may be queued before the first has to be on screen
+    EXPECT_EQ(pacer.getWaitId(), 0u);
+    pacer.markInputSampled(start);
+    EXPECT_EQ(pacer.beginPresent(), 1u);
+    EXPECT_EQ(pacer.getWaitId(), 0u);
+    pacer.markInputSampled(start + std::chrono::milliseconds(16));
+    EXPECT_EQ(pacer.beginPresent(), 2u);
+    EXPECT_EQ(pacer.getWaitId(), 1u);
+
+    pacer.presentCompleted(1, start + std::chrono::milliseconds(30));
+    EXPECT_NEAR(pacer.getLatencyMs(), 30.0, 1e-6);
+    EXPECT_NEAR(pacer.getAverageLatencyMs(), 30.0, 1e-6);
+    EXPECT_EQ(pacer.getWaitId(), 0u);
+
+    pacer.beginPresent();
+    EXPECT_EQ(pacer.getWaitId(), 2u);
+    pacer.presentCompleted(2, start + std::chrono::milliseconds(56));
+    EXPECT_NEAR(pacer.getLatencyMs(), 40.0, 1e-6);
+    EXPECT_NEAR(pacer.getAverageLatencyMs(), 31.0, 1e-6);
+
+    // a single queued frame waits for the previous present; never for one of a retired swapchain
+    pacer.setMaxQueuedFrames(1);
+    EXPECT_EQ(pacer.getWaitId(), 3u);
+    pacer.resetSwapchain();
+    EXPECT_EQ(pacer.getWaitId(), 0u);
+    EXPECT_EQ(pacer.beginPresent(), 4u);
+    EXPECT_EQ(pacer.getWaitId(), 4u);
+
+    pacer.setMaxQueuedFrames(0);
+    EXPECT_EQ(pacer.getMaxQueuedFrames(), 1u);
+    pacer.setMaxQueuedFrames(100);
+    EXPECT_EQ(pacer.getMaxQueuedFrames(), static_cast<uint32_t>(MAX_FRAME_DRAWS));
+}
+
+TEST(VulkanSwapChain, ChoosesPresentModeAndImageCount)
+{
+    const std::vector<VkPresentModeKHR> modes = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR };
+    EXPECT_EQ(VulkanSwapChain::choosePresentMode(VK_PRESENT_MODE_MAILBOX_KHR, modes), VK_PRESENT_MODE_MAILBOX_KHR);
+    EXPECT_EQ(VulkanSwapChain::choosePresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR, modes), VK_PRESENT_MODE_MAILBOX_KHR);
+    EXPECT_EQ(VulkanSwapChain::choosePresentMode(VK_PRESENT_MODE_FIFO_RELAXED_KHR, modes), VK_PRESENT_MODE_FIFO_KHR);
+    EXPECT_EQ(VulkanSwapChain::choosePresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR, { VK_PRESENT_MODE_FIFO_KHR }),
+      VK_PRESENT_MODE_FIFO_KHR);
+
+    VkSurfaceCapabilitiesKHR capabilities{};
+    capabilities.minImageCount = 2;
+    capabilities.maxImageCount = 3;
+    EXPECT_EQ(VulkanSwapChain::chooseImageCount(capabilities, VK_PRESENT_MODE_FIFO_KHR, 1), 2u);
+    EXPECT_EQ(VulkanSwapChain::chooseImageCount(capabilities, VK_PRESENT_MODE_FIFO_KHR, 2), 3u);
+    EXPECT_EQ(VulkanSwapChain::chooseImageCount(capabilities, VK_PRESENT_MODE_MAILBOX_KHR, 1), 3u);
+    EXPECT_EQ(VulkanSwapChain::chooseImageCount(capabilities, VK_PRESENT_MODE_FIFO_KHR, 3), 3u);
+    capabilities.maxImageCount = 0;
+    EXPECT_EQ(VulkanSwapChain::chooseImageCount(capabilities, VK_PRESENT_MODE_FIFO_KHR, 3), 4u);
+}
+
+TEST(ObjLoader, SinglePassParserMatchesTinyObj)
+{
+    for (const char *model : { "Models/VikingRoom/viking_room.obj", "Models/mori_knob/testObj.obj" }) {
+        std::string model_file = std::filesystem::current_path().string() + RELATIVE_RESOURCE_PATH + model;
+
+        // no vulkan objects needed for the cpu side
+        ObjLoader reference(nullptr, nullptr);
+        reference.loadGeometryTinyObj(model_file);
+        ObjLoader single_pass(nullptr, nullptr);
+        single_pass.loadGeometry(model_file);
+
+        EXPECT_EQ(single_pass.getIndices(), reference.getIndices()) << model;
+        EXPECT_EQ(single_pass.getMaterialIndex(), reference.getMaterialIndex()) << model;
+        EXPECT_EQ(single_pass.getTextures(), reference.getTextures()) << model;
+        ASSERT_EQ(single_pass.getVertices().size(), reference.getVertices().size()) << model;
+        for (size_t i = 0; i < reference.getVertices().size(); i++) {
+            // colors are left out: tinyobj fills in a default where the file has none
+            const Vertex &a = single_pass.getVertices()[i];
+            const Vertex &b = reference.getVertices()[i];
+            ASSERT_TRUE(a.pos == b.pos && a.normal == b.normal && a.texture_coords == b.texture_coords)
+              << model << " vertex " << i;
+        }
+    }
+}
+
+TEST(ObjParser, RejectsFacesWithInvalidIndices)
+{
+    const std::string file = (std::filesystem::temp_directory_path() / "obj_parser_test.obj").string();
+    auto parse = [&file](const std::string &faces) {
+        {
+            std::ofstream obj(file, std::ios::trunc);
+            obj << "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\n" << faces;
+        }
+        ObjParser parser;
+        ObjParseResult result;
+        return parser.parse(file, result, 1);
+    };
+
+    EXPECT_TRUE(parse("f 1/1/1 2/1/1 3/1/1\nf -3 -2 -1\n"));
+    EXPECT_FALSE(parse("f 0 1 2\n"));
+    EXPECT_FALSE(parse("f 1 2 4\n"));
+    EXPECT_FALSE(parse("f -4 -2 -1\n"));
+    EXPECT_FALSE(parse("f 1/2 2/1 3/1\n"));
+    EXPECT_FALSE(parse("f 1//1 2//2 3//1\n"));
+
+    std::filesystem::remove(file);
+}
+
+TEST(VertexWelder, ParallelWeldMatchesSerial)
+{
+    // a grid with every vertex shared by several corners; -0.f and 0.f must weld.
+    // the six corners of a vertex are 50000 apart, every other one has -0.f
+    std::vector<Vertex> corners;
+    for (int i = 0; i < 300000; i++) {
+        int k = static_cast<int>((int64_t(i) * 7919) % 50000);
+        float z = ((i / 50000) % 2) ? 0.f : -0.f;
+        corners.emplace_back(glm::vec3(float(k % 250), float(k / 250), z),
+          glm::vec3(0.f, 1.f, 0.f),
+          glm::vec3(-1.f),
+          glm::vec2(float(k % 3), 0.f));
+    }
+
+    std::vector<Vertex> serial_vertices;
+    std::vector<uint32_t> serial_indices;
+    WeldStats serial = VertexWelder::weld(corners, serial_vertices, serial_indices, 1);
+    EXPECT_EQ(serial.unique_count, 50000u);
+    EXPECT_DOUBLE_EQ(serial.weldRatio(), 6.0);
+
+    std::vector<Vertex> parallel_vertices;
+    std::vector<uint32_t> parallel_indices;
+    VertexWelder::weld(corners, parallel_vertices, parallel_indices, 4);
+    EXPECT_EQ(parallel_indices, serial_indices);
+    ASSERT_EQ(parallel_vertices.size(), serial_vertices.size());
+    for (size_t i = 0; i < corners.size(); i++) {
+        ASSERT_TRUE(serial_vertices[serial_indices[i]] == corners[i]);
+    }
+
+    EXPECT_EQ(std::hash<Vertex>()(corners[0]), std::hash<Vertex>()(vertex::canonical(corners[0])));
+}
+
+TEST(MeshOptimizer, ReordersForCacheAndKeepsTriangles)
+{
+    // grid in scrambled triangle order, four material bands
+    const uint32_t n = 64;
+    std::vector<Vertex> vertices;
+    for (uint32_t y = 0; y <= n; y++) {
+        for (uint32_t x = 0; x <= n; x++) {
+            vertices.emplace_back(glm::vec3(float(x), float(y), 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(-1.f), glm::vec2(0.f));
+        }
+    }
+    std::vector<uint32_t> indices;
+    std::vector<unsigned int> materialIndex;
+    for (uint32_t i = 0; i < n * n; i++) {
+        uint32_t cell = (i * 2654435761u) % (n * n);
+        uint32_t a = (cell / n) * (n + 1) + cell % n;
+        indices.insert(indices.end(), { a, a + 1, a + n + 1, a + 1, a + n + 2, a + n + 1 });
+        uint32_t band = (cell / n) * 4 / n;
+        materialIndex.insert(materialIndex.end(), { band, band });
+    }
+
+    std::vector<Vertex> original_vertices = vertices;
+    std::vector<uint32_t> original_indices = indices;
+    std::vector<unsigned int> original_material_index = materialIndex;
+
+    MeshOptimizerStats stats = MeshOptimizer::optimize(vertices, indices, materialIndex);
+    EXPECT_LT(stats.acmr_after, 0.8f);
+    EXPECT_LT(stats.acmr_after, stats.acmr_before);
+    EXPECT_LT(stats.atvr_after, stats.atvr_before);
+    EXPECT_GE(stats.cluster_count, 1u);
+    EXPECT_FLOAT_EQ(stats.acmr_after, MeshOptimizer::computeACMR(indices, vertices.size(), MeshOptimizer::CACHE_SIZE));
+
+    // same triangles (as positions + winding + material) in a different order
+    auto triangleKeys = [](const std::vector<Vertex> &v, const std::vector<uint32_t> &i, const std::vector<unsigned int> &m) {
+        std::vector<std::array<float, 7>> keys;
+        for (size_t t = 0; t < m.size(); t++) {
+            const glm::vec3 &p0 = v[i[3 * t + 0]].pos;
+            const glm::vec3 &p1 = v[i[3 * t + 1]].pos;
+            const glm::vec3 &p2 = v[i[3 * t + 2]].pos;
+            keys.push_back({ p0.x, p0.y, p1.x, p1.y, p2.x, p2.y, float(m[t]) });
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+    ASSERT_EQ(vertices.size(), original_vertices.size());
+    ASSERT_EQ(indices.size(), original_indices.size());
+    EXPECT_EQ(triangleKeys(vertices, indices, materialIndex),
+      triangleKeys(original_vertices, original_indices, original_material_index));
+
+    // one contiguous range per material, in ascending order
+    EXPECT_TRUE(std::is_sorted(materialIndex.begin(), materialIndex.end()));
+
+    // vertex fetch order: every index is at most one past the largest seen so far
+    uint32_t next = 0;
+    for (uint32_t index : indices) {
+        ASSERT_LE(index, next);
+        if (index == next) next++;
+    }
+}
+
+TEST(ObjLoader, SubmeshesFollowMaterialRuns)
+{
+    std::vector<ObjMaterial> materials(2);
+    materials[0].dissolve = 1.f;
+    materials[1].dissolve = 0.5f;
+    // -1 (no material) falls back to material 0
+    std::vector<unsigned int> materialIndex = { 0, 0, 1, 1, 1, static_cast<unsigned int>(-1) };
+
+    std::vector<Submesh> submeshes = ObjLoader::buildSubmeshes(materialIndex, materials);
+    ASSERT_EQ(submeshes.size(), 3u);
+    EXPECT_EQ(submeshes[0].first_index, 0u);
+    EXPECT_EQ(submeshes[0].index_count, 6u);
+    EXPECT_EQ(submeshes[1].first_index, 6u);
+    EXPECT_EQ(submeshes[1].index_count, 9u);
+    EXPECT_EQ(submeshes[1].material_id, 1u);
+    EXPECT_FALSE(submeshes[1].opaque);
+    EXPECT_EQ(submeshes[2].first_index, 15u);
+    EXPECT_EQ(submeshes[2].material_id, 0u);
+    EXPECT_TRUE(submeshes[2].opaque);
+}
+
+TEST(MeshSimplifier, BuildsLodsInsideSubmeshes)
+{
+    // curved height field, left and right half are different submeshes
+    const uint32_t n = 64;
+    std::vector<Vertex> vertices;
+    for (uint32_t y = 0; y <= n; y++) {
+        for (uint32_t x = 0; x <= n; x++) {
+            const float u = float(x) / n;
+            const float v = float(y) / n;
+            const float height = 0.1f * std::sin(6.f * u) * std::cos(4.f * v);
+            vertices.emplace_back(glm::vec3(u, v, height), glm::vec3(0.f, 0.f, 1.f), glm::vec3(-1.f), glm::vec2(u, v));
+        }
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t half = 0; half < 2; half++) {
+        for (uint32_t y = 0; y < n; y++) {
+            for (uint32_t x = half * n / 2; x < (half + 1) * n / 2; x++) {
+                uint32_t a = y * (n + 1) + x;
+                indices.insert(indices.end(), { a, a + 1, a + n + 1, a + 1, a + n + 2, a + n + 1 });
+            }
+        }
+    }
+    const uint32_t half_count = static_cast<uint32_t>(indices.size() / 2);
+    std::vector<Submesh> submeshes = { { 0, half_count, 0, true }, { half_count, half_count, 1, true } };
+
+    std::vector<MeshLod> lods = MeshSimplifier::buildLods(vertices, indices, submeshes);
+    ASSERT_GE(lods.size(), 2u);
+
+    uint32_t previous_count = 2 * half_count;
+    float previous_error = 0.f;
+    uint32_t next_first_index = 2 * half_count;
+    for (const MeshLod &lod : lods) {
+        ASSERT_EQ(lod.submeshes.size(), 2u);
+        EXPECT_GT(lod.error, previous_error);
+        EXPECT_LE(lod.error, MeshSimplifier::MAX_LOD_ERROR);
+
+        uint32_t count = 0;
+        for (uint32_t s = 0; s < 2; s++) {
+            const Submesh &submesh = lod.submeshes[s];
+            EXPECT_EQ(submesh.first_index, next_first_index);
+            EXPECT_EQ(submesh.material_id, s);
+            next_first_index += submesh.index_count;
+            count += submesh.index_count;
+
+            // the boundary between the submeshes stays where it is
+            for (uint32_t i = submesh.first_index; i < submesh.first_index + submesh.index_count; i++) {
+                const float x = vertices[indices[i]].pos.x;
+                EXPECT_TRUE(s == 0 ? x <= 0.5f : x >= 0.5f);
+            }
+        }
+        EXPECT_LE(count, previous_count * 9 / 10);
+        previous_count = count;
+        previous_error = lod.error;
+    }
+    EXPECT_EQ(indices.size(), next_first_index);
+
+    // a flat square goes down to two triangles without any error
+    std::vector<Vertex> plane;
+    for (uint32_t y = 0; y <= 8; y++) {
+        for (uint32_t x = 0; x <= 8; x++) {
+            plane.emplace_back(
+              glm::vec3(float(x), float(y), 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(-1.f), glm::vec2(0.f));
+        }
+    }
+    std::vector<uint32_t> plane_indices;
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            uint32_t a = y * 9 + x;
+            plane_indices.insert(plane_indices.end(), { a, a + 1, a + 9, a + 1, a + 10, a + 9 });
+        }
+    }
+    std::vector<uint32_t> no_groups;
+    EXPECT_FLOAT_EQ(MeshSimplifier::simplify(plane, plane_indices, no_groups, 0, 0.01f), 0.f);
+    EXPECT_EQ(plane_indices.size(), 6u);
+
+    // with 1000 pixels per unit, level 1 is good for one pixel from 1000 * its error on
+    std::vector<MeshLod> chain = { { 0.f, submeshes } };
+    chain.insert(chain.end(), lods.begin(), lods.end());
+    const float projection_scale = lod::getProjectionScale(glm::radians(90.f), 2000.f);
+    EXPECT_NEAR(projection_scale, 1000.f, 1e-2f);
+    EXPECT_EQ(lod::select(chain, 1.f, 0.f, projection_scale, 1.f), 0u);
+    EXPECT_EQ(lod::select(chain, 1.f, 1001.f * chain[1].error, projection_scale, 1.f), 1u);
+    EXPECT_EQ(lod::select(chain, 2.f, 1001.f * chain[1].error, projection_scale, 1.f), 0u);
+    EXPECT_EQ(lod::select(chain, 1.f, 1e9f, projection_scale, 1.f), static_cast<uint32_t>(lods.size()));
+}
+
+TEST(Vertex, CompactLayoutsRoundTrip)
+{
+    // octahedral normals stay within a few hundredths of a degree
+    for (int i = 0; i < 1000; i++) {
+        float phi = float(i) * 2.39996f;
+        float z = 1.f - 2.f * (float(i) + 0.5f) / 1000.f;
+        float r = std::sqrt(1.f - z * z);
+        glm::vec3 n(r * std::cos(phi), r * std::sin(phi), z);
+        EXPECT_GT(glm::dot(n, vertex::decodeOctahedral(vertex::encodeOctahedral(n))), 0.99999f);
+    }
+
+    Vertex v(glm::vec3(3.f, -1.f, 2.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(-1.f), glm::vec2(0.25f, 0.5f));
+    CompactVertex compact = vertex::compact(v);
+    EXPECT_EQ(compact.pos, v.pos);
+    EXPECT_EQ(glm::unpackHalf2x16(compact.texture_coords), v.texture_coords);
+
+    // bounds [-1, 3] on the largest axis: center 1, scale 2
+    QuantizedVertex quantized = vertex::quantize(v, glm::vec3(1.f, 0.f, 0.f), 2.f);
+    EXPECT_EQ(quantized.pos[0], 32767);
+    EXPECT_EQ(quantized.pos[1], -16384);
+    EXPECT_EQ(quantized.pos[2], 32767);
+    EXPECT_EQ(vertex::decodeOctahedral(quantized.normal), glm::vec3(0.f, 0.f, -1.f));
+
+    EXPECT_EQ(vertex::getVertexStride(VertexLayout::Full), 44u);
+    EXPECT_EQ(vertex::getVertexStride(VertexLayout::Compact), 20u);
+    EXPECT_EQ(vertex::getVertexStride(VertexLayout::Quantized), 16u);
+    EXPECT_EQ(vertex::getVertexInputAttributeDesc(VertexLayout::Quantized)[0].format, VK_FORMAT_R16G16B16A16_SNORM);
+}
+
+TEST(MeshCache, RoundTripAndInvalidation)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "mesh_cache_test";
+    std::filesystem::create_directories(dir);
+    std::string model_file = (dir / "quad.obj").string();
+    {
+        std::ofstream obj(model_file);
+        obj << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nf 1/1 2/2 3/3 4/4\n";
+    }
+    std::filesystem::remove(MeshCache::getCacheFile(model_file));
+
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(model_file);
+    std::vector<MeshLod> lods = { { 0.25f, { Submesh{ 0, 3, 0, true } } } };
+    ASSERT_TRUE(MeshCache::write(model_file,
+      { loader.getVertices(),
+        loader.getIndices(),
+        loader.getMaterialIndex(),
+        loader.getMaterials(),
+        loader.getTextures(),
+        loader.getSourceFiles(),
+        lods }));
+
+    MeshCache cache;
+    ASSERT_TRUE(cache.open(model_file));
+    ASSERT_EQ(cache.getVertices().size(), loader.getVertices().size());
+    for (size_t i = 0; i < loader.getVertices().size(); i++) {
+        EXPECT_TRUE(cache.getVertices()[i] == loader.getVertices()[i]);
+    }
+    EXPECT_TRUE(std::equal(
+      cache.getIndices().begin(), cache.getIndices().end(), loader.getIndices().begin(), loader.getIndices().end()));
+    EXPECT_EQ(cache.getMaterialIndex().size(), loader.getMaterialIndex().size());
+    EXPECT_EQ(cache.getMaterials().size(), loader.getMaterials().size());
+    EXPECT_EQ(cache.getTextures(), loader.getTextures());
+    ASSERT_EQ(cache.getLods().size(), 1u);
+    EXPECT_FLOAT_EQ(cache.getLods()[0].error, 0.25f);
+    ASSERT_EQ(cache.getLods()[0].submeshes.size(), 1u);
+    EXPECT_EQ(cache.getLods()[0].submeshes[0].index_count, 3u);
+
+    // editing the source has to invalidate the cooked mesh
+    {
+        std::ofstream obj(model_file, std::ios::app);
+        obj << "v 2 2 2\n";
+    }
+    EXPECT_FALSE(cache.open(model_file));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TextureDecoder, DecodesAllFilesInParallel)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "texture_decoder_test";
+    std::filesystem::create_directories(dir);
+
+    // binary ppm files of different sizes, filled with their own index
+    std::vector<std::string> files;
+    for (int i = 0; i < 8; i++) {
+        std::string file = (dir / ("texture_" + std::to_string(i) + ".ppm")).string();
+        const int size = 4 + i;
+        std::ofstream ppm(file, std::ios::binary);
+        ppm << "P6\n" << size << " " << size << "\n255\n";
+        for (int p = 0; p < size * size; p++) ppm << char(i) << char(2 * i) << char(3 * i);
+        files.push_back(file);
+    }
+    files.push_back((dir / "missing.ppm").string());
+
+    TextureDecoder decoder(files, 4);
+    EXPECT_EQ(decoder.getThreadCount(), 4u);
+
+    std::vector<bool> seen(files.size(), false);
+    DecodedTexture decoded;
+    while (decoder.next(decoded)) {
+        ASSERT_LT(decoded.index, files.size());
+        EXPECT_FALSE(seen[decoded.index]);
+        seen[decoded.index] = true;
+
+        if (decoded.index == 8) {
+            EXPECT_EQ(decoded.pixels, nullptr);
+            continue;
+        }
+        const int i = static_cast<int>(decoded.index);
+        ASSERT_NE(decoded.pixels, nullptr);
+        EXPECT_EQ(decoded.width, 4 + i);
+        EXPECT_EQ(decoded.height, 4 + i);
+        // expanded to rgba
+        const stbi_uc *last = decoded.pixels.get() + 4 * (decoded.width * decoded.height - 1);
+        EXPECT_EQ(last[0], i);
+        EXPECT_EQ(last[1], 2 * i);
+        EXPECT_EQ(last[2], 3 * i);
+        EXPECT_EQ(last[3], 255);
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](bool s) { return s; }));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TextureCache, SharesTexturesByPathAndContent)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "texture_cache_test";
+    std::filesystem::create_directories(dir / "other");
+
+    // the same image twice under different names, plus a different one
+    const std::string a = (dir / "a.ppm").string();
+    const std::string copy = (dir / "other" / "copy.ppm").string();
+    const std::string b = (dir / "b.ppm").string();
+    for (const std::string &file : { a, copy, b }) {
+        std::ofstream ppm(file, std::ios::binary);
+        ppm << "P6\n1 1\n255\n" << char(file == b ? 1 : 7) << char(2) << char(3);
+    }
+
+    TextureCache cache;
+    const TextureCache::Key key_a = cache.makeKey(a);
+    const TextureCache::Key key_copy = cache.makeKey(copy);
+    const TextureCache::Key key_b = cache.makeKey(b);
+    EXPECT_NE(key_a.content_hash, 0u);
+    EXPECT_EQ(key_a.content_hash, key_copy.content_hash);
+    EXPECT_NE(key_a.content_hash, key_b.content_hash);
+    EXPECT_EQ(cache.makeKey((dir / "other" / ".." / "a.ppm").string()).path, key_a.path);
+    EXPECT_EQ(cache.makeKey((dir / "missing.ppm").string()).content_hash, 0u);
+
+    Texture texture;
+    cache.insertTexture(key_a, texture, VK_NULL_HANDLE);
+    EXPECT_TRUE(cache.contains(key_a));
+    EXPECT_TRUE(cache.contains(key_copy));
+    EXPECT_FALSE(cache.contains(key_b));
+
+    Texture shared;
+    uint32_t slot_a = 0;
+    uint32_t slot_copy = 0;
+    uint32_t slot = 0;
+    EXPECT_TRUE(cache.acquireTexture(key_a, shared, slot_a));
+    EXPECT_TRUE(cache.acquireTexture(key_copy, shared, slot_copy));
+    EXPECT_FALSE(cache.acquireTexture(key_b, shared, slot));
+    EXPECT_EQ(cache.getTextureCount(), 1u);
+    EXPECT_EQ(cache.getReferences(key_a), 2u);
+
+    // one texture table slot per cached texture, written once
+    EXPECT_EQ(slot_a, 0u);
+    EXPECT_EQ(slot_copy, slot_a);
+    EXPECT_EQ(cache.takePendingSlots(), std::vector<uint32_t>{ 0u });
+    EXPECT_TRUE(cache.takePendingSlots().empty());
+
+    // the copy's path now resolves without hashing the file again
+    std::filesystem::remove(copy);
+    EXPECT_EQ(cache.makeKey(copy).content_hash, key_a.content_hash);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TextureStreamer, PlansResidencyWithinBudget)
+{
+    // 1024x512 mip chain with 1 byte per texel
+    CookedTexture cooked;
+    std::vector<uint64_t> level_bytes;
+    for (uint32_t width = 1024, height = 512; width > 0; width /= 2, height = std::max(height / 2, 1u)) {
+        cooked.levels.push_back({ 0, uint64_t{ width } * height, width, height });
+        level_bytes.push_back(uint64_t{ width } * height);
+    }
+    cooked.width = 1024;
+    cooked.height = 512;
+
+    // the tail starts at 128x64
+    EXPECT_EQ(TextureStreamer::getTailLevel(cooked), 3u);
+    EXPECT_EQ(TextureStreamer::getWantedLevel(1024, 512, 2000.0f, 0.0f), 0u);
+    EXPECT_EQ(TextureStreamer::getWantedLevel(1024, 512, 256.0f, 0.0f), 2u);
+    EXPECT_EQ(TextureStreamer::getWantedLevel(1024, 512, 256.0f, 1.0f), 1u);
+    EXPECT_EQ(TextureStreamer::getWantedLevel(1024, 512, 0.0f, 0.0f), 10u);
+
+    const uint64_t tail = TextureStreamer::getResidentBytes(level_bytes, 3);
+    const uint64_t full = TextureStreamer::getResidentBytes(level_bytes, 0);
+    EXPECT_EQ(full - TextureStreamer::getResidentBytes(level_bytes, 1), 1024u * 512u);
+
+    // everything wanted fits
+    std::vector<TextureStreamer::Residency> textures = {
+        { 0, 3, 10, level_bytes }, { 1, 3, 5, level_bytes }, { 7, 3, 1, level_bytes }
+    };
+    EXPECT_EQ(TextureStreamer::planResidency(textures, 10 * full), (std::vector<uint32_t>{ 0, 1, 3 }));
+
+    // the least recently used one falls back to its tail first
+    const uint64_t wanted = full + TextureStreamer::getResidentBytes(level_bytes, 1) + tail;
+    EXPECT_EQ(TextureStreamer::planResidency(textures, wanted - 1), (std::vector<uint32_t>{ 0, 3, 3 }));
+    // nothing goes below the tail
+    EXPECT_EQ(TextureStreamer::planResidency(textures, 0), (std::vector<uint32_t>{ 3, 3, 3 }));
+}
+
+TEST(TextureCooker, CooksBlockCompressedMipChain)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "texture_cooker_test";
+    std::filesystem::create_directories(dir);
+    const std::string file = (dir / "gradient.ppm").string();
+    auto writePpm = [&file](int shift) {
+        std::ofstream ppm(file, std::ios::binary | std::ios::trunc);
+        ppm << "P6\n20 12\n255\n";
+        for (int y = 0; y < 12; y++) {
+            for (int x = 0; x < 20; x++) ppm << char(10 * x + shift) << char(20 * y) << char(128);
+        }
+    };
+    writePpm(0);
+
+    auto cookOnce = [&file](DecodedTexture &decoded) {
+        TextureDecoder decoder({ file }, 1, true);
+        ASSERT_TRUE(decoder.next(decoded));
+    };
+
+    DecodedTexture cooked;
+    cookOnce(cooked);
+    EXPECT_FALSE(cooked.cache_hit);
+    EXPECT_EQ(cooked.pixels, nullptr);
+    EXPECT_EQ(cooked.cooked.format, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    // 20x12 down to 1x1, 8 bytes per 4x4 block
+    ASSERT_EQ(cooked.cooked.levels.size(), 5u);
+    const uint32_t expected_width[5] = { 20, 10, 5, 2, 1 };
+    const uint32_t expected_height[5] = { 12, 6, 3, 1, 1 };
+    for (size_t l = 0; l < 5; l++) {
+        const CookedTexture::Level &level = cooked.cooked.levels[l];
+        EXPECT_EQ(level.width, expected_width[l]);
+        EXPECT_EQ(level.height, expected_height[l]);
+        EXPECT_EQ(level.size, uint64_t((level.width + 3) / 4) * ((level.height + 3) / 4) * 8);
+        EXPECT_EQ(level.offset % 8, 0u);
+        EXPECT_LE(level.offset + level.size, cooked.cooked.getSize());
+    }
+    EXPECT_GT(cooked.cooked.levels.front().offset, cooked.cooked.levels.back().offset);
+    EXPECT_TRUE(std::filesystem::exists(TextureCooker::getCookedFile(file)));
+
+    // the written file is picked up as is
+    DecodedTexture cached;
+    cookOnce(cached);
+    EXPECT_TRUE(cached.cache_hit);
+    ASSERT_EQ(cached.cooked.getSize(), cooked.cooked.getSize());
+    EXPECT_EQ(std::memcmp(cached.cooked.getData(), cooked.cooked.getData(), cooked.cooked.getSize()), 0);
+
+    // a changed source gets cooked again
+    writePpm(1);
+    DecodedTexture recooked;
+    cookOnce(recooked);
+    EXPECT_FALSE(recooked.cache_hit);
+    EXPECT_FALSE(recooked.cooked.levels.empty());
+
+    // single colored blocks keep their color (within 565 precision) and alpha
+    stbi_uc texels[64];
+    for (int t = 0; t < 16; t++) {
+        texels[4 * t + 0] = 200;
+        texels[4 * t + 1] = 100;
+        texels[4 * t + 2] = 48;
+        texels[4 * t + 3] = t < 8 ? 0 : 255;
+    }
+    unsigned char block[16];
+    TextureCooker::compressBC3(texels, block);
+    EXPECT_EQ(block[0], 255);
+    EXPECT_EQ(block[1], 0);
+    uint16_t color0 = 0;
+    std::memcpy(&color0, block + 8, 2);
+    EXPECT_EQ(color0 >> 11, (200 * 31 + 127) / 255);
+    EXPECT_EQ((color0 >> 5) & 63, (100 * 63 + 127) / 255);
+    EXPECT_EQ(color0 & 31, (48 * 31 + 127) / 255);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(VulkanMipGenerator, CoversImagesUpTo4096)
+{
+    // one workgroup per 64x64 tile of level 0, partial tiles included
+    EXPECT_EQ(VulkanMipGenerator::getWorkgroupCount(1, 1), 1u);
+    EXPECT_EQ(VulkanMipGenerator::getWorkgroupCount(64, 64), 1u);
+    EXPECT_EQ(VulkanMipGenerator::getWorkgroupCount(65, 64), 2u);
+    EXPECT_EQ(VulkanMipGenerator::getWorkgroupCount(1000, 300), 16u * 5u);
+    EXPECT_EQ(VulkanMipGenerator::getWorkgroupCount(4096, 4096), 64u * 64u);
+
+    // level 6 of anything bigger than 4096 no longer fits the last workgroup
+    EXPECT_TRUE(VulkanMipGenerator::supports(4096, 4096));
+    EXPECT_TRUE(VulkanMipGenerator::supports(4096, 3));
+    EXPECT_FALSE(VulkanMipGenerator::supports(4097, 16));
+    EXPECT_FALSE(VulkanMipGenerator::supports(8192, 8192));
+}
+
+namespace {
+float srgbToLinear(float c) { return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f); }
+float linearToSrgb(float c) { return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f; }
+}// namespace
+
+TEST(VulkanMipGenerator, MatchesCpuReduction)
+{
+    // needs a gpu, like the integration test
+    Window window(64, 64);
+    VulkanInstance instance;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    ASSERT_EQ(
+      glfwCreateWindowSurface(instance.getVulkanInstance(), window.get_window(), nullptr, &surface), VK_SUCCESS);
+    VulkanDevice device(&instance, &surface);
+    VulkanUploadManager upload_manager;
+    upload_manager.init(&device);
+
+    // a level one texel high below 256x4 and odd sizes split over several workgroups
+    const std::array<std::array<uint32_t, 2>, 2> sizes = { { { 256, 4 }, { 97, 33 } } };
+    for (const auto &[width, height] : sizes) {
+        SCOPED_TRACE(std::to_string(width) + "x" + std::to_string(height));
+        ASSERT_TRUE(upload_manager.usesComputeMipGeneration(VK_FORMAT_R8G8B8A8_UNORM, width, height));
+        const uint32_t mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+        // rows differ a lot, so averaging in texels from the wrong row shows
+        std::vector<stbi_uc> pixels(width * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                stbi_uc *texel = &pixels[4 * (y * width + x)];
+                texel[0] = static_cast<stbi_uc>((37 * x + 91 * y) % 256);
+                texel[1] = static_cast<stbi_uc>((80 * y) % 256);
+                texel[2] = static_cast<stbi_uc>((5 * x * x + 11 * y) % 256);
+                texel[3] = static_cast<stbi_uc>(128 + (7 * x + 13 * y) % 128);
+            }
+        }
+
+        // cpu reference: premultiplied linear colors, floor sizes, reads clamped to the level
+        std::vector<std::vector<glm::vec4>> reference(mip_levels);
+        reference[0].resize(width * height);
+        for (uint32_t t = 0; t < width * height; t++) {
+            const float alpha = pixels[4 * t + 3] / 255.0f;
+            for (int c = 0; c < 3; c++) reference[0][t][c] = srgbToLinear(pixels[4 * t + c] / 255.0f) * alpha;
+            reference[0][t].a = alpha;
+        }
+        std::vector<VkBufferImageCopy> regions(mip_levels);
+        VkDeviceSize readback_size = 0;
+        for (uint32_t level = 0; level < mip_levels; level++) {
+            const uint32_t level_width = std::max(width >> level, 1u);
+            const uint32_t level_height = std::max(height >> level, 1u);
+            if (level > 0) {
+                const uint32_t src_width = std::max(width >> (level - 1), 1u);
+                const uint32_t src_height = std::max(height >> (level - 1), 1u);
+                auto src = [&](uint32_t x, uint32_t y) {
+                    return reference[level - 1][std::min(y, src_height - 1) * src_width + std::min(x, src_width - 1)];
+                };
+                reference[level].resize(level_width * level_height);
+                for (uint32_t y = 0; y < level_height; y++) {
+                    for (uint32_t x = 0; x < level_width; x++) {
+                        reference[level][y * level_width + x] = 0.25f
+                                                                * (src(2 * x, 2 * y) + src(2 * x + 1, 2 * y)
+                                                                   + src(2 * x, 2 * y + 1) + src(2 * x + 1, 2 * y + 1));
+                    }
+                }
+            }
+
+            regions[level].bufferOffset = readback_size;
+            regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[level].imageSubresource.mipLevel = level;
+            regions[level].imageSubresource.layerCount = 1;
+            regions[level].imageExtent = { level_width, level_height, 1 };
+            readback_size += VkDeviceSize(level_width) * level_height * 4;
+        }
+
+        const VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+                                        | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+        VulkanImage image;
+        image.create(&device,
+          width,
+          height,
+          mip_levels,
+          VK_FORMAT_R8G8B8A8_UNORM,
+          VK_IMAGE_TILING_OPTIMAL,
+          usage,
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+          MemoryCategory::Texture);
+        VulkanBuffer readback;
+        readback.create(&device,
+          readback_size,
+          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+          MemoryCategory::Other);
+
+        upload_manager.uploadImage(image, pixels.data(), pixels.size(), width, height, mip_levels);
+        upload_manager.generateMipMaps(image, VK_FORMAT_R8G8B8A8_UNORM, usage, width, height, mip_levels);
+
+        VkCommandBuffer command_buffer = upload_manager.getCommandBuffer();
+        VkImageMemoryBarrier image_barrier{};
+        image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        image_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        image_barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image = image.getImage();
+        image_barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mip_levels, 0, 1 };
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0,
+          0,
+          nullptr,
+          0,
+          nullptr,
+          1,
+          &image_barrier);
+        vkCmdCopyImageToBuffer(command_buffer,
+          image.getImage(),
+          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+          readback.getBuffer(),
+          mip_levels,
+          regions.data());
+        VkMemoryBarrier host_barrier{};
+        host_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_HOST_BIT,
+          0,
+          1,
+          &host_barrier,
+          0,
+          nullptr,
+          0,
+          nullptr);
+        upload_manager.wait(upload_manager.flush());
+
+        // levels past 6 start over from the rgba8 level 6, so allow for a little rounding
+        const auto *texels = static_cast<const stbi_uc *>(readback.getMappedData());
+        for (uint32_t level = 1; level < mip_levels; level++) {
+            float max_error = 0.0f;
+            for (size_t t = 0; t < reference[level].size(); t++) {
+                const glm::vec4 &linear = reference[level][t];
+                for (int c = 0; c < 4; c++) {
+                    const float expected = 255.0f * (c == 3 ? linear.a : linearToSrgb(linear[c] / linear.a));
+                    const float actual = texels[regions[level].bufferOffset + 4 * t + c];
+                    max_error = std::max(max_error, std::abs(expected - actual));
+                }
+            }
+            EXPECT_LE(max_error, 2.0f) << "level " << level;
+        }
+
+        readback.cleanUp();
+        image.cleanUp();
+    }
+
+    upload_manager.cleanUp();
+    device.cleanUp();
+    vkDestroySurfaceKHR(instance.getVulkanInstance(), surface, nullptr);
+    instance.cleanUp();
+}
+
 TEST(Integration, VulkanEngine)
 {
   EXPECT_EQ(7 * 6, 42);
@@ -1,6 +1,23 @@
+#include "MeshLod.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "ObjLoader.hpp"
+#include "ObjParser.hpp"
+#include "ParallelRecorder.hpp"
+#include "TextureCooker.hpp"
+#include "TextureDecoder.hpp"
+#include "VertexWelder.hpp"
 #include "VulkanBuffer.hpp"
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+static std::string benchmarkModelFile()
+{
+    return std::filesystem::current_path().string() + RELATIVE_RESOURCE_PATH + "Models/JurassicPark/JurassicPark.obj";
+}
 
 static void BM_StringCreation(benchmark::State &state)
 {
@@ -17,4 +34,214 @@ static void BM_StringCopy(benchmark::State &state)
 }
 BENCHMARK(BM_StringCopy);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+// former loader path: two tinyobj parses + serial vertex build
+static void BM_ObjLoaderTinyObj(benchmark::State &state)
+{
+    std::string model_file = benchmarkModelFile();
+    for (auto _ : state) {
+        ObjLoader loader(nullptr, nullptr);
+        loader.loadGeometryTinyObj(model_file);
+        benchmark::DoNotOptimize(loader.getVertices().data());
+    }
+}
+BENCHMARK(BM_ObjLoaderTinyObj)->Unit(benchmark::kMillisecond);
+
+static void BM_ObjLoaderSinglePass(benchmark::State &state)
+{
+    std::string model_file = benchmarkModelFile();
+    for (auto _ : state) {
+        ObjLoader loader(nullptr, nullptr);
+        loader.loadGeometry(model_file);
+        benchmark::DoNotOptimize(loader.getVertices().data());
+    }
+}
+BENCHMARK(BM_ObjLoaderSinglePass)->Unit(benchmark::kMillisecond);
+
+// tokenizing only, scaled over the thread count
+static void BM_ObjParser(benchmark::State &state)
+{
+    std::string model_file = benchmarkModelFile();
+    ObjParser parser;
+    for (auto _ : state) {
+        ObjParseResult result;
+        parser.parse(model_file, result, static_cast<uint32_t>(state.range(0)));
+        benchmark::DoNotOptimize(result.indices.data());
+    }
+}
+BENCHMARK(BM_ObjParser)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+// un-welded corner stream of the benchmark model
+static std::vector<Vertex> benchmarkCorners()
+{
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(benchmarkModelFile());
+    std::vector<Vertex> corners;
+    corners.reserve(loader.getIndices().size());
+    for (uint32_t index : loader.getIndices()) corners.push_back(loader.getVertices()[index]);
+    return corners;
+}
+
+static void BM_WeldUnorderedMap(benchmark::State &state)
+{
+    std::vector<Vertex> corners = benchmarkCorners();
+    for (auto _ : state) {
+        std::unordered_map<Vertex, uint32_t> vertices_map{};
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        indices.reserve(corners.size());
+        for (const Vertex &vert : corners) {
+            auto [entry, inserted] = vertices_map.try_emplace(vert, static_cast<uint32_t>(vertices.size()));
+            if (inserted) vertices.push_back(vert);
+            indices.push_back(entry->second);
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(corners.size()));
+}
+BENCHMARK(BM_WeldUnorderedMap)->Unit(benchmark::kMillisecond);
+
+static void BM_VertexWelder(benchmark::State &state)
+{
+    std::vector<Vertex> corners = benchmarkCorners();
+    WeldStats stats;
+    for (auto _ : state) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        stats = VertexWelder::weld(corners, vertices, indices, static_cast<uint32_t>(state.range(0)));
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(corners.size()));
+    state.counters["weld_ratio"] = stats.weldRatio();
+}
+BENCHMARK(BM_VertexWelder)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+static void BM_MeshOptimizer(benchmark::State &state)
+{
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(benchmarkModelFile());
+    MeshOptimizerStats stats;
+    for (auto _ : state) {
+        std::vector<Vertex> vertices = loader.getVertices();
+        std::vector<uint32_t> indices = loader.getIndices();
+        std::vector<unsigned int> materialIndex = loader.getMaterialIndex();
+        stats = MeshOptimizer::optimize(vertices, indices, materialIndex);
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(loader.getIndices().size() / 3));
+    state.counters["acmr_before"] = stats.acmr_before;
+    state.counters["acmr_after"] = stats.acmr_after;
+    state.counters["atvr_after"] = stats.atvr_after;
+}
+BENCHMARK(BM_MeshOptimizer)->Unit(benchmark::kMillisecond);
+
+static void BM_MeshSimplifierLods(benchmark::State &state)
+{
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(benchmarkModelFile());
+    loader.optimizeGeometry(benchmarkModelFile());
+    std::vector<Submesh> submeshes = ObjLoader::buildSubmeshes(loader.getMaterialIndex(), loader.getMaterials());
+    std::vector<MeshLod> lods;
+    for (auto _ : state) {
+        std::vector<uint32_t> indices = loader.getIndices();
+        lods = MeshSimplifier::buildLods(loader.getVertices(), indices, submeshes);
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(loader.getIndices().size() / 3));
+    state.counters["levels"] = double(lods.size());
+    state.counters["coarsest_error"] = lods.empty() ? 0.0 : double(lods.back().error);
+}
+BENCHMARK(BM_MeshSimplifierLods)->Unit(benchmark::kMillisecond);
+
+// decoding only (no upload), scaled over the thread count
+static void BM_TextureDecoder(benchmark::State &state)
+{
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(benchmarkModelFile());
+    std::vector<std::string> files;
+    for (const std::string &texture : loader.getTextures()) {
+        if (!texture.empty()) files.push_back(texture);
+    }
+    for (auto _ : state) {
+        TextureDecoder decoder(files, static_cast<uint32_t>(state.range(0)));
+        DecodedTexture decoded;
+        while (decoder.next(decoded)) benchmark::DoNotOptimize(decoded.pixels.get());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(files.size()));
+}
+BENCHMARK(BM_TextureDecoder)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// mip filtering + block compression of the first model texture, single threaded
+static void BM_TextureCooker(benchmark::State &state)
+{
+    ObjLoader loader(nullptr, nullptr);
+    loader.loadGeometry(benchmarkModelFile());
+    auto texture = std::find_if(
+      loader.getTextures().begin(), loader.getTextures().end(), [](const std::string &t) { return !t.empty(); });
+    if (texture == loader.getTextures().end()) {
+        state.SkipWithError("model has no textures");
+        return;
+    }
+    TextureDecoder decoder({ *texture }, 1);
+    DecodedTexture decoded;
+    decoder.next(decoded);
+    if (!decoded.pixels) {
+        state.SkipWithError("texture could not be decoded");
+        return;
+    }
+    for (auto _ : state) {
+        CookedTexture cooked = TextureCooker::cook(decoded.pixels.get(), decoded.width, decoded.height, "");
+        benchmark::DoNotOptimize(cooked.getData());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * decoded.width * decoded.height);
+}
+BENCHMARK(BM_TextureCooker)->Unit(benchmark::kMillisecond);
+
+// the split and hand-off of the rasterizer's draw recording, scaled over draw and
+// worker count; every draw selects its level of detail like Rasterizer::recordDraws
+// and is encoded into a cpu side stream of its worker in place of the vkCmd* calls,
+// which need a device
+static void BM_ParallelRecorder(benchmark::State &state)
+{
+    struct DrawCommand
+    {
+        uint32_t index_count;
+        uint32_t first_index;
+        int32_t vertex_offset;
+        uint32_t first_instance;
+    };
+
+    std::vector<MeshLod> lods;
+    for (uint32_t level = 0; level < 4; level++) {
+        Submesh submesh{};
+        submesh.index_count = 3 * (4096u >> (2 * level));
+        lods.push_back({ 0.01f * float(level), { submesh } });
+    }
+    const float projection_scale = lod::getProjectionScale(glm::radians(45.0f), 1080.0f);
+
+    const uint32_t draw_count = static_cast<uint32_t>(state.range(0));
+    ParallelRecorder recorder(static_cast<uint32_t>(state.range(1)));
+    std::vector<std::vector<DrawCommand>> streams(recorder.getWorkerCount());
+    for (std::vector<DrawCommand> &stream : streams) stream.reserve(draw_count);
+
+    for (auto _ : state) {
+        recorder.record(draw_count, 256, [&](uint32_t worker, uint32_t begin, uint32_t end) {
+            std::vector<DrawCommand> &stream = streams[worker];
+            stream.clear();
+            for (uint32_t d = begin; d < end; d++) {
+                const float distance = 1.0f + float(d % 1000);
+                const uint32_t level = lod::select(lods, 1.0f, distance, projection_scale, 1.0f);
+                const Submesh &submesh = lods[level].submeshes[0];
+                stream.push_back({ submesh.index_count, submesh.first_index, static_cast<int32_t>(d * 16), d });
+            }
+            benchmark::DoNotOptimize(stream.data());
+        });
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(draw_count));
+}
+BENCHMARK(BM_ParallelRecorder)
+  ->ArgsProduct({ { 1000, 10000, 100000 }, { 1, 2, 4, 8 } })
+  ->ArgNames({ "draws", "workers" })
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime();
+
+BENCHMARK_MAIN();